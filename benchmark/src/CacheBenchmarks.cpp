@@ -0,0 +1,118 @@
+/**
+ * @file CacheBenchmarks.cpp
+ *
+ * This module contains benchmarks of the Discord::Cache class in
+ * keeping up with updates to the members of large guilds.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <benchmark/benchmark.h>
+#include <Discord/Cache.hpp>
+#include <Json/Value.hpp>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    std::string MakeMember(size_t index) {
+        return Json::Object({
+            {"user", Json::Object({
+                {"id", std::to_string(index + 1)},
+                {"username", "Frog #" + std::to_string(index + 1)},
+                {"discriminator", "0001"},
+            })},
+            {"roles", Json::Array({"10"})},
+            {"joined_at", "2020-05-01T12:34:56.789000+00:00"},
+        }).ToEncoding();
+    }
+
+    /**
+     * Fill a cache with the members of one guild.
+     */
+    void FillGuild(
+        Discord::Cache& cache,
+        const std::vector< std::string >& ids,
+        const std::string& member
+    ) {
+        for (const auto& id: ids) {
+            cache.SetEntity(
+                "100",
+                Discord::Cache::EntityKind::Member,
+                id,
+                std::string(member)
+            );
+        }
+    }
+
+    /**
+     * Measure the cost of replacing members of a guild already in
+     * the cache, the way member and presence updates do.
+     *
+     * The argument is the number of members in the guild.
+     */
+    void UpdateMembers(benchmark::State& state) {
+        const auto numMembers = (size_t)state.range(0);
+        std::vector< std::string > ids;
+        for (size_t i = 0; i < numMembers; ++i) {
+            ids.push_back(std::to_string(i + 1));
+        }
+        const auto member = MakeMember(0);
+        Discord::Cache cache;
+        FillGuild(cache, ids, member);
+        size_t next = 0;
+        for (auto _: state) {
+            cache.SetEntity(
+                "100",
+                Discord::Cache::EntityKind::Member,
+                ids[next],
+                std::string(member)
+            );
+            if (++next == numMembers) {
+                next = 0;
+            }
+        }
+        state.SetItemsProcessed((int64_t)state.iterations());
+    }
+
+    /**
+     * Measure the cost of looking up members of a guild in the cache.
+     *
+     * The argument is the number of members in the guild.
+     */
+    void LookUpMembers(benchmark::State& state) {
+        const auto numMembers = (size_t)state.range(0);
+        std::vector< std::string > ids;
+        for (size_t i = 0; i < numMembers; ++i) {
+            ids.push_back(std::to_string(i + 1));
+        }
+        Discord::Cache cache;
+        FillGuild(cache, ids, MakeMember(0));
+        size_t next = 0;
+        for (auto _: state) {
+            benchmark::DoNotOptimize(
+                cache.GetEntity(
+                    "100",
+                    Discord::Cache::EntityKind::Member,
+                    ids[next]
+                )
+            );
+            if (++next == numMembers) {
+                next = 0;
+            }
+        }
+        state.SetItemsProcessed((int64_t)state.iterations());
+    }
+
+}
+
+BENCHMARK(UpdateMembers)
+    ->ArgName("members")
+    ->Arg(1000)
+    ->Arg(100000);
+
+BENCHMARK(LookUpMembers)
+    ->ArgName("members")
+    ->Arg(1000)
+    ->Arg(100000);
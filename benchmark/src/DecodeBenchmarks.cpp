@@ -0,0 +1,125 @@
+/**
+ * @file DecodeBenchmarks.cpp
+ *
+ * This module contains benchmarks of the Discord::Gateway class
+ * in decoding large dispatch events, comparing decoding them inline
+ * against decoding them on decode worker pools of various sizes.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Session.hpp"
+
+#include <benchmark/benchmark.h>
+#include <Discord/Cache.hpp>
+#include <Discord/Gateway.hpp>
+#include <Discord/WorkerPool.hpp>
+#include <Json/Value.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of GUILD_CREATE events sent to the gateway
+     * in each iteration of the benchmarks.
+     */
+    constexpr size_t NUM_GUILDS = 16;
+
+    /**
+     * This is the number of members in each guild sent to the gateway.
+     */
+    constexpr size_t NUM_MEMBERS_PER_GUILD = 2000;
+
+    std::string MakeGuildCreate(
+        const std::string& guildId,
+        int sequenceNumber
+    ) {
+        auto members = Json::Array({});
+        for (size_t i = 0; i < NUM_MEMBERS_PER_GUILD; ++i) {
+            members.Add(
+                Json::Object({
+                    {"user", Json::Object({
+                        {"id", std::to_string(i + 1)},
+                        {"username", "Frog #" + std::to_string(i + 1)},
+                        {"discriminator", "0001"},
+                    })},
+                    {"roles", Json::Array({"10"})},
+                    {"joined_at", "2020-05-01T12:34:56.789000+00:00"},
+                })
+            );
+        }
+        return (
+            "{\"t\":\"GUILD_CREATE\",\"s\":" + std::to_string(sequenceNumber)
+            + ",\"op\":0,\"d\":" + Json::Object({
+                {"id", guildId},
+                {"name", "Pepe's Pond"},
+                {"members", std::move(members)},
+            }).ToEncoding()
+            + "}"
+        );
+    }
+
+    /**
+     * Measure how fast a gateway decodes and applies GUILD_CREATE events.
+     *
+     * The first argument is the number of decode workers, where zero
+     * means events are decoded inline on the thread receiving them.
+     * The second argument is nonzero if a cache is set, so that guild
+     * entities are streamed into it rather than decoded into the event.
+     */
+    void DecodeGuildCreates(benchmark::State& state) {
+        const auto numWorkers = (size_t)state.range(0);
+        const auto useCache = (state.range(1) != 0);
+        Session session;
+        if (numWorkers > 0) {
+            session.gateway.SetDecodeWorkerPool(
+                std::make_shared< Discord::WorkerPool >(numWorkers)
+            );
+        }
+        if (useCache) {
+            session.gateway.SetCache(std::make_shared< Discord::Cache >());
+        }
+        if (!session.Connect()) {
+            state.SkipWithError("unable to connect gateway");
+            return;
+        }
+        std::vector< std::string > messages;
+        size_t bytesPerIteration = 0;
+        for (size_t i = 0; i < NUM_GUILDS; ++i) {
+            messages.push_back(
+                MakeGuildCreate(
+                    std::to_string(i + 1),
+                    (int)i + 1
+                )
+            );
+            bytesPerIteration += messages.back().length();
+        }
+        size_t numEventsSent = 0;
+        for (auto _: state) {
+            for (const auto& message: messages) {
+                session.webSocket->onText(std::string(message));
+            }
+            numEventsSent += messages.size();
+            session.AwaitEvents(numEventsSent);
+        }
+        state.SetBytesProcessed((int64_t)(state.iterations() * bytesPerIteration));
+        state.SetItemsProcessed((int64_t)(state.iterations() * messages.size()));
+    }
+
+    void DecodeGuildCreatesArguments(benchmark::internal::Benchmark* benchmark) {
+        for (int useCache = 0; useCache <= 1; ++useCache) {
+            for (int numWorkers: {0, 1, 2, 4, 8}) {
+                benchmark->Args({numWorkers, useCache});
+            }
+        }
+    }
+
+}
+
+BENCHMARK(DecodeGuildCreates)
+    ->ArgNames({"workers", "cache"})
+    ->Apply(DecodeGuildCreatesArguments)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,97 @@
+/**
+ * @file EventDispatcherBenchmarks.cpp
+ *
+ * This module contains benchmarks of the Discord::EventDispatcher class
+ * in fanning events out to handlers on worker pools of various sizes.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <benchmark/benchmark.h>
+#include <condition_variable>
+#include <Discord/EventDispatcher.hpp>
+#include <Discord/Gateway.hpp>
+#include <Discord/WorkerPool.hpp>
+#include <Json/Value.hpp>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of events dispatched in each iteration
+     * of the benchmark.
+     */
+    constexpr size_t EVENTS_PER_BATCH = 1024;
+
+    /**
+     * Measure how fast events are handed to handlers, as the number
+     * of worker threads and the number of guilds (partitions) grow.
+     *
+     * The first argument is the number of workers.  The second argument
+     * is the number of guilds among which the events are spread evenly.
+     */
+    void DispatchFanOut(benchmark::State& state) {
+        const auto numWorkers = (size_t)state.range(0);
+        const auto numGuilds = (size_t)state.range(1);
+        Discord::EventDispatcher dispatcher(
+            std::make_shared< Discord::WorkerPool >(numWorkers)
+        );
+        std::mutex mutex;
+        std::condition_variable eventsHandledCondition;
+        size_t numEventsHandled = 0;
+        dispatcher.RegisterEventCallback(
+            [&](Discord::Gateway::Event&& /* event */){
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                ++numEventsHandled;
+                eventsHandledCondition.notify_all();
+            }
+        );
+        std::vector< Discord::Gateway::Event > events(EVENTS_PER_BATCH);
+        for (size_t i = 0; i < EVENTS_PER_BATCH; ++i) {
+            auto& event = events[i];
+            event.name = "MESSAGE_CREATE";
+            event.sequenceNumber = (int)i + 1;
+            event.data = Json::Object({
+                {"id", std::to_string(i + 1)},
+                {"channel_id", std::to_string(i % numGuilds + 200)},
+                {"guild_id", std::to_string(i % numGuilds + 100)},
+                {"content", "Hello, World!"},
+            });
+        }
+        size_t numEventsDispatched = 0;
+        for (auto _: state) {
+            state.PauseTiming();
+            auto batch = events;
+            state.ResumeTiming();
+            for (auto& event: batch) {
+                dispatcher.Dispatch(std::move(event));
+            }
+            numEventsDispatched += batch.size();
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            eventsHandledCondition.wait(
+                lock,
+                [&]{ return numEventsHandled >= numEventsDispatched; }
+            );
+        }
+        state.SetItemsProcessed((int64_t)(state.iterations() * EVENTS_PER_BATCH));
+    }
+
+    void DispatchFanOutArguments(benchmark::internal::Benchmark* benchmark) {
+        for (int numGuilds: {1, 16, 256}) {
+            for (int numWorkers: {1, 2, 4, 8}) {
+                benchmark->Args({numWorkers, numGuilds});
+            }
+        }
+    }
+
+}
+
+BENCHMARK(DispatchFanOut)
+    ->ArgNames({"workers", "guilds"})
+    ->Apply(DispatchFanOutArguments)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
@@ -0,0 +1,64 @@
+/**
+ * @file FleetSimulatorBenchmarks.cpp
+ *
+ * This module contains benchmarks which simulate an hour of a fleet
+ * of Discord::Gateway sessions on virtual time.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "../../test/src/FleetSimulator.hpp"
+
+#include <benchmark/benchmark.h>
+#include <chrono>
+
+namespace {
+
+    /**
+     * Simulate an hour of a fleet of gateway sessions connecting as fast
+     * as Discord allows, over a network which loses messages and leaves
+     * connections as zombies now and then, and report how the fleet
+     * fared along with how fast the simulation ran.
+     *
+     * The first argument is the number of sessions.  The second
+     * argument is the chance, in tenths of a percent, that each message
+     * is lost and has to be sent again.
+     */
+    void SimulatedFleetHour(benchmark::State& state) {
+        FleetSimulation simulation;
+        simulation.numSessions = (size_t)state.range(0);
+        simulation.lossRate = (double)state.range(1) / 1000.0;
+        simulation.zombiesPerSessionHour = 1.0;
+        simulation.maxConcurrency = 16;
+        FleetReport report;
+        double elapsed = 0.0;
+        for (auto _: state) {
+            const auto start = std::chrono::steady_clock::now();
+            report = SimulateFleet(simulation);
+            elapsed = std::chrono::duration< double >(
+                std::chrono::steady_clock::now() - start
+            ).count();
+        }
+        state.counters["simulated_per_real_second"] = simulation.duration / elapsed;
+        state.counters["connects"] = (double)report.connects;
+        state.counters["reconnects"] = (double)report.reconnects;
+        state.counters["connect_timeouts"] = (double)report.connectTimeouts;
+        state.counters["sessions_ready"] = (double)report.sessionsReady;
+        state.counters["zombies"] = (double)report.zombies;
+        state.counters["zombie_detection_s_mean"] = report.zombieDetectionMean;
+        state.counters["heartbeat_jitter_ms_p99"] = 1000.0 * report.heartbeatJitterP99;
+        state.counters["heartbeat_jitter_ms_max"] = 1000.0 * report.heartbeatJitterMax;
+        state.counters["identifies_per_window_max"] = (double)report.maxIdentifiesPerWindow;
+        state.counters["identify_rate_violations"] = (double)report.identifyRateViolations;
+        state.counters["identify_wait_s_mean"] = report.identifyWaitMean;
+        state.counters["identify_wait_s_max"] = report.identifyWaitMax;
+    }
+
+}
+
+BENCHMARK(SimulatedFleetHour)
+    ->ArgNames({"sessions", "loss_permille"})
+    ->ArgsProduct({{1000, 5000}, {0, 10}})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,273 @@
+/**
+ * @file GatewayBenchmarks.cpp
+ *
+ * This module contains benchmarks of the Discord::Gateway class
+ * in the paths taken for every session and every message received:
+ * connecting, receiving dispatch events, and keeping up heartbeats.
+ * Receiving events and heartbeats also report how many heap allocations
+ * the gateway made for each.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Session.hpp"
+
+#include <benchmark/benchmark.h>
+#include <Discord/Gateway.hpp>
+#include <Json/Value.hpp>
+#include <mutex>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of events sent to the gateway in each iteration
+     * of the benchmarks of receiving events.
+     */
+    constexpr size_t EVENTS_PER_BATCH = 64;
+
+    /**
+     * These are the kinds of events sent to the gateway in the
+     * InboundEvents benchmark, indexed by the benchmark's argument.
+     */
+    const char* const EVENT_NAMES[] = {
+        "MESSAGE_CREATE",
+        "PRESENCE_UPDATE",
+        "TYPING_START",
+        "GUILD_MEMBER_UPDATE",
+    };
+
+    Json::Value MakeUser(size_t index) {
+        return Json::Object({
+            {"id", std::to_string(index + 1000)},
+            {"username", "Frog #" + std::to_string(index + 1)},
+            {"discriminator", "0001"},
+            {"avatar", "8342729096ea3675442027381ff50dfe"},
+        });
+    }
+
+    /**
+     * Return the payload of a typical event of the given kind, with
+     * the content of the message (if any) padded to the given length.
+     */
+    Json::Value MakeEventData(
+        const std::string& eventName,
+        size_t index,
+        size_t contentLength
+    ) {
+        if (eventName == "MESSAGE_CREATE") {
+            return Json::Object({
+                {"id", std::to_string(index + 700000000000000000)},
+                {"channel_id", "200"},
+                {"guild_id", "100"},
+                {"author", MakeUser(index)},
+                {"member", Json::Object({
+                    {"roles", Json::Array({"10", "11"})},
+                    {"joined_at", "2020-05-01T12:34:56.789000+00:00"},
+                    {"deaf", false},
+                    {"mute", false},
+                })},
+                {"content", std::string(contentLength, 'x')},
+                {"timestamp", "2020-05-05T12:34:56.789000+00:00"},
+                {"tts", false},
+                {"mention_everyone", false},
+                {"mentions", Json::Array({})},
+                {"mention_roles", Json::Array({})},
+                {"attachments", Json::Array({})},
+                {"embeds", Json::Array({})},
+                {"pinned", false},
+                {"type", 0},
+            });
+        } else if (eventName == "PRESENCE_UPDATE") {
+            return Json::Object({
+                {"user", Json::Object({
+                    {"id", std::to_string(index + 1000)},
+                })},
+                {"guild_id", "100"},
+                {"status", "online"},
+                {"activities", Json::Array({
+                    Json::Object({
+                        {"name", "Frogger"},
+                        {"type", 0},
+                        {"created_at", 1588682096},
+                    }),
+                })},
+                {"client_status", Json::Object({
+                    {"desktop", "online"},
+                })},
+            });
+        } else if (eventName == "TYPING_START") {
+            return Json::Object({
+                {"channel_id", "200"},
+                {"guild_id", "100"},
+                {"user_id", std::to_string(index + 1000)},
+                {"timestamp", 1588682096},
+            });
+        } else {
+            return Json::Object({
+                {"guild_id", "100"},
+                {"roles", Json::Array({"10", "11"})},
+                {"user", MakeUser(index)},
+                {"nick", "Pepe"},
+                {"joined_at", "2020-05-01T12:34:56.789000+00:00"},
+            });
+        }
+    }
+
+    std::vector< std::string > MakeEvents(
+        const std::string& eventName,
+        size_t contentLength
+    ) {
+        std::vector< std::string > messages;
+        for (size_t i = 0; i < EVENTS_PER_BATCH; ++i) {
+            messages.push_back(
+                Json::Object({
+                    {"t", eventName},
+                    {"s", (int)i + 1},
+                    {"op", 0},
+                    {"d", MakeEventData(eventName, i, contentLength)},
+                }).ToEncoding()
+            );
+        }
+        return messages;
+    }
+
+    /**
+     * Send the given messages to the gateway over and over, measuring
+     * how fast it decodes them and delivers their events.
+     */
+    void ReceiveEvents(
+        benchmark::State& state,
+        const std::vector< std::string >& messages
+    ) {
+        Session session;
+        if (!session.Connect()) {
+            state.SkipWithError("unable to connect gateway");
+            return;
+        }
+        size_t bytesPerIteration = 0;
+        for (const auto& message: messages) {
+            bytesPerIteration += message.length();
+        }
+        size_t numEventsSent = 0;
+        const auto allocationsBefore = session.gateway.GetAllocationStatistics();
+        for (auto _: state) {
+            for (const auto& message: messages) {
+                session.webSocket->onText(std::string(message));
+            }
+            numEventsSent += messages.size();
+            session.AwaitEvents(numEventsSent);
+        }
+        const auto allocationsAfter = session.gateway.GetAllocationStatistics();
+        const auto numMessages = (double)(allocationsAfter.messages - allocationsBefore.messages);
+        if (numMessages > 0.0) {
+            state.counters["allocs_per_message"] = (double)(allocationsAfter.messageAllocations - allocationsBefore.messageAllocations) / numMessages;
+            state.counters["alloc_bytes_per_message"] = (double)(allocationsAfter.messageBytes - allocationsBefore.messageBytes) / numMessages;
+        }
+        state.SetBytesProcessed((int64_t)(state.iterations() * bytesPerIteration));
+        state.SetItemsProcessed((int64_t)(state.iterations() * messages.size()));
+    }
+
+    /**
+     * Measure how fast a gateway receives typical events of various kinds.
+     *
+     * The argument selects the kind of event from EVENT_NAMES.
+     */
+    void InboundEvents(benchmark::State& state) {
+        const std::string eventName = EVENT_NAMES[state.range(0)];
+        state.SetLabel(eventName);
+        ReceiveEvents(state, MakeEvents(eventName, 32));
+    }
+
+    /**
+     * Measure how fast a gateway receives MESSAGE_CREATE events as
+     * the messages grow larger.
+     *
+     * The argument is the length of the content of each message.
+     */
+    void InboundMessageSize(benchmark::State& state) {
+        ReceiveEvents(
+            state,
+            MakeEvents("MESSAGE_CREATE", (size_t)state.range(0))
+        );
+    }
+
+    /**
+     * Measure the cost of one heartbeat exchange: Discord asks the gateway
+     * for a heartbeat, the gateway sends one, and Discord acknowledges it.
+     */
+    void Heartbeat(benchmark::State& state) {
+        Session session;
+        if (!session.Connect()) {
+            state.SkipWithError("unable to connect gateway");
+            return;
+        }
+        const auto heartbeatRequest = Json::Object({
+            {"op", 1},
+            {"d", nullptr},
+        }).ToEncoding();
+        const auto heartbeatAck = Json::Object({
+            {"op", 11},
+        }).ToEncoding();
+        const auto allocationsBefore = session.gateway.GetAllocationStatistics();
+        for (auto _: state) {
+            session.webSocket->onText(std::string(heartbeatRequest));
+            session.webSocket->onText(std::string(heartbeatAck));
+
+            // Forget the heartbeat sent, so that the mock doesn't
+            // keep growing.
+            std::lock_guard< decltype(session.webSocket->mutex) > lock(session.webSocket->mutex);
+            session.webSocket->textSent.clear();
+        }
+        const auto allocationsAfter = session.gateway.GetAllocationStatistics();
+        const auto numHeartbeats = (double)(allocationsAfter.heartbeats - allocationsBefore.heartbeats);
+        if (numHeartbeats > 0.0) {
+            state.counters["allocs_per_heartbeat"] = (double)(allocationsAfter.heartbeatAllocations - allocationsBefore.heartbeatAllocations) / numHeartbeats;
+            state.counters["alloc_bytes_per_heartbeat"] = (double)(allocationsAfter.heartbeatBytes - allocationsBefore.heartbeatBytes) / numHeartbeats;
+        }
+        state.SetItemsProcessed((int64_t)state.iterations());
+    }
+
+    /**
+     * Measure the cost of setting up a session: constructing a gateway,
+     * looking up the gateway endpoint, opening the WebSocket, and being
+     * greeted, followed by tearing it all down again.
+     */
+    void ConnectSession(benchmark::State& state) {
+        for (auto _: state) {
+            Session session;
+            if (!session.Connect()) {
+                state.SkipWithError("unable to connect gateway");
+                return;
+            }
+        }
+        state.SetItemsProcessed((int64_t)state.iterations());
+    }
+
+}
+
+BENCHMARK(InboundEvents)
+    ->ArgName("event")
+    ->DenseRange(0, (int)(sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0])) - 1)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+BENCHMARK(InboundMessageSize)
+    ->ArgName("content")
+    ->Arg(0)
+    ->Arg(256)
+    ->Arg(2000)
+    ->Arg(16384)
+    ->Arg(65536)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+BENCHMARK(Heartbeat)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+BENCHMARK(ConnectSession)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
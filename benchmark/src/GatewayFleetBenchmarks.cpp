@@ -0,0 +1,304 @@
+/**
+ * @file GatewayFleetBenchmarks.cpp
+ *
+ * This module contains a load test of many Discord::Gateway sessions
+ * running at once over Discord::SocketConnections against a stand-in
+ * for Discord's gateway on the loopback interface.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "../../src/ProcessMemory.hpp"
+#include "../../test/src/Common.hpp"
+#include "../../test/src/MockGatewayServer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <Discord/Gateway.hpp>
+#include <Discord/GatewayEndpointCache.hpp>
+#include <Discord/SocketConnections.hpp>
+#include <Discord/TimerWheel.hpp>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * This is how long, in seconds, the sessions are left running once
+     * they've all been started.
+     */
+    constexpr double RUN_SECONDS = 2.0;
+
+    /**
+     * This is the number of events per second the stand-in server sends
+     * to each session.
+     */
+    constexpr double EVENTS_PER_SECOND_PER_SESSION = 5.0;
+
+    double GetCpuSeconds() {
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0.0;
+        }
+        return (
+            (double)usage.ru_utime.tv_sec + (double)usage.ru_utime.tv_usec / 1000000.0
+            + (double)usage.ru_stime.tv_sec + (double)usage.ru_stime.tv_usec / 1000000.0
+        );
+    }
+
+    /**
+     * This is the state of one gateway session in the load test.
+     */
+    struct Session {
+        Discord::Gateway gateway;
+
+        /**
+         * This is kept so that connecting isn't waited on, since
+         * the future returned by Connect waits for it when destroyed.
+         */
+        std::future< bool > connected;
+
+        /**
+         * This is when the session last started connecting.
+         */
+        Clock::time_point connectStart;
+
+        bool awaitingReady = false;
+    };
+
+    /**
+     * This runs a fleet of gateway sessions against a stand-in server,
+     * reconnecting sessions whenever they're closed, and keeping track
+     * of how they fare.
+     */
+    struct Fleet {
+        // Properties
+
+        std::shared_ptr< Discord::Connections > connections;
+        Discord::Gateway::Configuration configuration;
+        std::shared_ptr< Discord::GatewayEndpointCache > endpointCache = std::make_shared< Discord::GatewayEndpointCache >();
+        std::shared_ptr< Discord::TimerWheel > timerWheel = std::make_shared< Discord::TimerWheel >();
+        std::vector< std::unique_ptr< Session > > sessions;
+
+        std::mutex mutex;
+        std::condition_variable wakeCondition;
+        std::deque< size_t > sessionsToReconnect;
+        bool stop = false;
+        std::thread reconnector;
+
+        std::vector< double > connectLatencies;
+        std::atomic< size_t > numEventsReceived{0};
+        size_t numReconnects = 0;
+
+        // Lifecycle
+
+        ~Fleet() {
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                stop = true;
+                wakeCondition.notify_all();
+            }
+            reconnector.join();
+            for (auto& session: sessions) {
+                session->gateway.Disconnect();
+            }
+        }
+
+        // Methods
+
+        Fleet(
+            const std::shared_ptr< Discord::Connections >& connections,
+            size_t numSessions
+        )
+            : connections(connections)
+        {
+            timerWheel->SetClock(std::make_shared< SteadyClock >());
+            configuration.userAgent = "DiscordBot";
+            configuration.heartbeatPhase = Discord::Gateway::HeartbeatPhase::Spread;
+            for (size_t i = 0; i < numSessions; ++i) {
+                sessions.emplace_back(new Session());
+                auto& gateway = sessions.back()->gateway;
+                gateway.SetTimerWheel(timerWheel);
+                gateway.SetGatewayEndpointCache(endpointCache);
+                gateway.RegisterEventCallback(
+                    [this, i](Discord::Gateway::Event&& event){
+                        OnEvent(i, event);
+                    }
+                );
+                gateway.RegisterCloseCallback(
+                    [this, i]{
+                        std::lock_guard< decltype(mutex) > lock(mutex);
+                        sessionsToReconnect.push_back(i);
+                        wakeCondition.notify_all();
+                    }
+                );
+            }
+            reconnector = std::thread(
+                [this]{
+                    Reconnect();
+                }
+            );
+        }
+
+        void OnEvent(
+            size_t index,
+            const Discord::Gateway::Event& event
+        ) {
+            ++numEventsReceived;
+            if (event.name != "READY") {
+                return;
+            }
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            auto& session = *sessions[index];
+            if (session.awaitingReady) {
+                session.awaitingReady = false;
+                connectLatencies.push_back(
+                    std::chrono::duration< double >(
+                        Clock::now() - session.connectStart
+                    ).count()
+                );
+            }
+        }
+
+        void Connect(size_t index) {
+            auto& session = *sessions[index];
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                session.connectStart = Clock::now();
+                session.awaitingReady = true;
+            }
+            session.connected = session.gateway.Connect(connections, configuration);
+        }
+
+        /**
+         * Connect again any sessions which have been closed, until
+         * told to stop.
+         */
+        void Reconnect() {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            for (;;) {
+                wakeCondition.wait(
+                    lock,
+                    [this]{ return stop || !sessionsToReconnect.empty(); }
+                );
+                if (stop) {
+                    return;
+                }
+                const auto index = sessionsToReconnect.front();
+                sessionsToReconnect.pop_front();
+                ++numReconnects;
+                lock.unlock();
+                sessions[index]->gateway.Disconnect();
+                Connect(index);
+                lock.lock();
+            }
+        }
+    };
+
+    /**
+     * Start a number of gateway sessions against a stand-in for Discord's
+     * gateway, let them run for a while, and report how long they took
+     * to become ready, how many events they took in, how many times
+     * they had to reconnect, and what it cost in CPU time and memory.
+     * The stand-in server runs in the same process, so its CPU time
+     * is included.
+     *
+     * The first argument is the number of sessions.  The second
+     * argument is nonzero if the server should inject failures: asking
+     * sessions to reconnect, and dropping their connections.
+     */
+    void GatewayFleet(benchmark::State& state) {
+        const auto numSessions = (size_t)state.range(0);
+        const auto injectFailures = (state.range(1) != 0);
+        MockGatewayServer::Configuration serverConfiguration;
+        serverConfiguration.guildsPerSession = 4;
+        serverConfiguration.eventsPerSecond = EVENTS_PER_SECOND_PER_SESSION;
+        if (injectFailures) {
+            serverConfiguration.reconnectAfterEvents = 4;
+            serverConfiguration.dropAfterEvents = 8;
+        }
+        for (auto _: state) {
+            MockGatewayServer server(serverConfiguration);
+            const auto socketConnections = std::make_shared< Discord::SocketConnections >();
+            Discord::SocketConnections::Configuration connectionsConfiguration;
+            connectionsConfiguration.maxConnectionsPerHost = 16;
+            socketConnections->Configure(connectionsConfiguration);
+            const auto cpuStart = GetCpuSeconds();
+            const auto start = Clock::now();
+            std::unique_ptr< Fleet > fleet(
+                new Fleet(
+                    std::make_shared< RedirectedConnections >(
+                        socketConnections,
+                        server.GetBaseUri()
+                    ),
+                    numSessions
+                )
+            );
+            for (size_t i = 0; i < numSessions; ++i) {
+                fleet->Connect(i);
+            }
+            std::this_thread::sleep_until(
+                start
+                + std::chrono::duration_cast< Clock::duration >(
+                    std::chrono::duration< double >(RUN_SECONDS)
+                )
+            );
+            const auto elapsed = std::chrono::duration< double >(
+                Clock::now() - start
+            ).count();
+            std::vector< double > connectLatencies;
+            size_t numReconnects;
+            {
+                std::lock_guard< decltype(fleet->mutex) > lock(fleet->mutex);
+                connectLatencies = fleet->connectLatencies;
+                numReconnects = fleet->numReconnects;
+            }
+            const size_t numEventsReceived = fleet->numEventsReceived;
+            fleet.reset();
+            const auto cpuSeconds = GetCpuSeconds() - cpuStart;
+
+            std::sort(connectLatencies.begin(), connectLatencies.end());
+            double totalConnectLatency = 0.0;
+            for (const auto latency: connectLatencies) {
+                totalConnectLatency += latency;
+            }
+            if (!connectLatencies.empty()) {
+                state.counters["connect_ms_mean"] = 1000.0 * totalConnectLatency / (double)connectLatencies.size();
+                state.counters["connect_ms_p99"] = 1000.0 * connectLatencies[(connectLatencies.size() - 1) * 99 / 100];
+                state.counters["connect_ms_max"] = 1000.0 * connectLatencies.back();
+            }
+            state.counters["ready"] = (double)connectLatencies.size();
+            state.counters["events_per_second"] = (double)numEventsReceived / elapsed;
+            state.counters["reconnects"] = (double)numReconnects;
+            state.counters["cpu_seconds"] = cpuSeconds;
+            state.counters["peak_rss_mb"] = (double)Discord::ProcessMemory::GetPeakResidentSetSize() / 1048576.0;
+        }
+    }
+
+    void GatewayFleetArguments(benchmark::internal::Benchmark* benchmark) {
+        for (int injectFailures = 0; injectFailures <= 1; ++injectFailures) {
+            for (int numSessions: {10, 100, 1000}) {
+                benchmark->Args({numSessions, injectFailures});
+            }
+        }
+    }
+
+}
+
+BENCHMARK(GatewayFleet)
+    ->ArgNames({"sessions", "failures"})
+    ->Apply(GatewayFleetArguments)
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
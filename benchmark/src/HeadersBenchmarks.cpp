@@ -0,0 +1,98 @@
+/**
+ * @file HeadersBenchmarks.cpp
+ *
+ * This module contains benchmarks of the Discord::Headers class in
+ * holding the headers of typical responses from Discord's REST API,
+ * and reading the rate limit headers out of them.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <benchmark/benchmark.h>
+#include <Discord/Headers.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * These are the headers of a typical response from Discord's
+     * REST API, as received.
+     */
+    const std::vector< Discord::Header > RESPONSE_HEADERS{
+        {"Date", "Fri, 01 May 2020 12:34:56 GMT"},
+        {"Content-Type", "application/json"},
+        {"Transfer-Encoding", "chunked"},
+        {"Connection", "keep-alive"},
+        {"X-RateLimit-Bucket", "41f9cd5d28af77da04563bcb1d67fdfd"},
+        {"X-RateLimit-Limit", "5"},
+        {"X-RateLimit-Remaining", "4"},
+        {"X-RateLimit-Reset", "1588336500.123"},
+        {"X-RateLimit-Reset-After", "1.000"},
+        {"Via", "1.1 google"},
+        {"CF-Cache-Status", "DYNAMIC"},
+        {"Server", "cloudflare"},
+    };
+
+    /**
+     * Measure the cost of collecting the headers of a response,
+     * including identifying the name of each header.
+     */
+    void AddResponseHeaders(benchmark::State& state) {
+        for (auto _: state) {
+            Discord::Headers headers;
+            for (const auto& header: RESPONSE_HEADERS) {
+                headers.push_back(header);
+            }
+            benchmark::DoNotOptimize(headers);
+        }
+        state.SetItemsProcessed((int64_t)(state.iterations() * RESPONSE_HEADERS.size()));
+    }
+
+    /**
+     * Measure the cost of reading the rate limit headers of a response
+     * by their names, the way applications look up headers.
+     */
+    void FindRateLimitHeadersByString(benchmark::State& state) {
+        const Discord::Headers headers(RESPONSE_HEADERS);
+        const std::vector< std::string > names{
+            "x-ratelimit-bucket",
+            "x-ratelimit-remaining",
+            "x-ratelimit-reset-after",
+            "x-ratelimit-limit",
+            "retry-after",
+        };
+        for (auto _: state) {
+            for (const auto& name: names) {
+                benchmark::DoNotOptimize(headers.Find(name));
+            }
+        }
+        state.SetItemsProcessed((int64_t)(state.iterations() * names.size()));
+    }
+
+    /**
+     * Measure the cost of reading the rate limit headers of a response
+     * by their HeaderName, the way the REST client looks them up.
+     */
+    void FindRateLimitHeadersByHeaderName(benchmark::State& state) {
+        const Discord::Headers headers(RESPONSE_HEADERS);
+        const std::vector< Discord::HeaderName > names{
+            Discord::HeaderName::XRateLimitBucket,
+            Discord::HeaderName::XRateLimitRemaining,
+            Discord::HeaderName::XRateLimitResetAfter,
+            Discord::HeaderName::XRateLimitLimit,
+            Discord::HeaderName::RetryAfter,
+        };
+        for (auto _: state) {
+            for (const auto name: names) {
+                benchmark::DoNotOptimize(headers.Find(name));
+            }
+        }
+        state.SetItemsProcessed((int64_t)(state.iterations() * names.size()));
+    }
+
+}
+
+BENCHMARK(AddResponseHeaders);
+BENCHMARK(FindRateLimitHeadersByString);
+BENCHMARK(FindRateLimitHeadersByHeaderName);
@@ -0,0 +1,225 @@
+/**
+ * @file ReplayBenchmarks.cpp
+ *
+ * This module contains benchmarks of the Discord::Gateway class in
+ * taking in captured gateway traffic, played back as fast as possible,
+ * and of the JSON decoders in decoding it.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "../../test/src/Replayer.hpp"
+#include "Session.hpp"
+
+#include <benchmark/benchmark.h>
+#include <Discord/Cache.hpp>
+#include <Discord/Capture.hpp>
+#include <Discord/SimdJsonDecoder.hpp>
+#include <fstream>
+#include <iterator>
+#include <Json/Value.hpp>
+#include <memory>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of guilds in the ready burst made up when
+     * no capture is given.
+     */
+    constexpr size_t NUM_GUILDS = 50;
+
+    /**
+     * This is the number of members in each guild of the ready burst
+     * made up when no capture is given.
+     */
+    constexpr size_t NUM_MEMBERS_PER_GUILD = 200;
+
+    /**
+     * Return a made up capture of a bot being told it's ready, followed
+     * by the guilds it's in, followed by chatter in those guilds.
+     */
+    Discord::Capture MakeReadyBurst() {
+        Discord::Capture capture;
+        int sequenceNumber = 0;
+        const auto addDispatch = [&](
+            const std::string& eventName,
+            const Json::Value& data
+        ){
+            Discord::Capture::Frame frame;
+            frame.data = Json::Object({
+                {"t", eventName},
+                {"s", ++sequenceNumber},
+                {"op", 0},
+                {"d", data},
+            }).ToEncoding();
+            capture.frames.push_back(std::move(frame));
+        };
+        addDispatch("READY", Json::Object({
+            {"v", 6},
+            {"session_id", "abc"},
+        }));
+        for (size_t i = 0; i < NUM_GUILDS; ++i) {
+            auto members = Json::Array({});
+            for (size_t j = 0; j < NUM_MEMBERS_PER_GUILD; ++j) {
+                members.Add(
+                    Json::Object({
+                        {"user", Json::Object({
+                            {"id", std::to_string(j + 1)},
+                            {"username", "Frog #" + std::to_string(j + 1)},
+                            {"discriminator", "0001"},
+                        })},
+                        {"roles", Json::Array({"10"})},
+                        {"joined_at", "2020-05-01T12:34:56.789000+00:00"},
+                    })
+                );
+            }
+            addDispatch("GUILD_CREATE", Json::Object({
+                {"id", std::to_string(i + 100)},
+                {"name", "Pepe's Pond"},
+                {"members", std::move(members)},
+            }));
+        }
+        for (size_t i = 0; i < NUM_GUILDS * 10; ++i) {
+            addDispatch("MESSAGE_CREATE", Json::Object({
+                {"id", std::to_string(i + 1000)},
+                {"channel_id", "200"},
+                {"guild_id", std::to_string(i % NUM_GUILDS + 100)},
+                {"content", "Hello, World!"},
+            }));
+        }
+        return capture;
+    }
+
+    /**
+     * Return the capture named by the DISCORD_CAPTURE environment
+     * variable, if any, or else a made up ready burst.
+     */
+    Discord::Capture LoadCapture() {
+        const auto path = getenv("DISCORD_CAPTURE");
+        if (path != nullptr) {
+            std::ifstream file(path, std::ios::binary);
+            const std::string encoding(
+                (std::istreambuf_iterator< char >(file)),
+                std::istreambuf_iterator< char >()
+            );
+            Discord::Capture capture;
+            if (capture.FromEncoding(encoding)) {
+                return capture;
+            }
+        }
+        return MakeReadyBurst();
+    }
+
+    /**
+     * Measure how fast a gateway takes in the first connection of
+     * a capture, with the hello message skipped, since the session is
+     * already connected.
+     *
+     * The argument is nonzero if a cache is set, so that guild
+     * entities are streamed into it.
+     */
+    void ReplayCapture(benchmark::State& state) {
+        static const auto capture = LoadCapture();
+        size_t numFrames = 0;
+        size_t bytesPerIteration = 0;
+        Discord::Capture dispatches;
+        for (const auto& frame: capture.frames) {
+            if (
+                (frame.connection != 0)
+                || (frame.kind != Discord::Capture::FrameKind::Text)
+                || (frame.data.find("\"op\":10") != std::string::npos)
+            ) {
+                continue;
+            }
+            dispatches.frames.push_back(frame);
+            ++numFrames;
+            bytesPerIteration += frame.data.length();
+        }
+        Session session;
+        if (state.range(0) != 0) {
+            session.gateway.SetCache(std::make_shared< Discord::Cache >());
+        }
+        if (!session.Connect()) {
+            state.SkipWithError("unable to connect gateway");
+            return;
+        }
+        for (auto _: state) {
+            (void)Replay(dispatches, 0, *session.webSocket, false);
+        }
+        state.SetBytesProcessed((int64_t)(state.iterations() * bytesPerIteration));
+        state.SetItemsProcessed((int64_t)(state.iterations() * numFrames));
+    }
+
+    /**
+     * Measure how fast the text frames of a capture are decoded into
+     * JSON values.
+     *
+     * The argument selects the decoder: 0 for Json::Value::FromEncoding
+     * (what gateways use if not given a decoder), 1 for
+     * Discord::SimdJsonDecoder with its scalar kernel, and 2 for
+     * Discord::SimdJsonDecoder with its vector kernel.
+     */
+    void DecodeCapture(benchmark::State& state) {
+        static const auto capture = LoadCapture();
+        std::vector< const std::string* > texts;
+        size_t bytesPerIteration = 0;
+        for (const auto& frame: capture.frames) {
+            if (frame.kind != Discord::Capture::FrameKind::Text) {
+                continue;
+            }
+            texts.push_back(&frame.data);
+            bytesPerIteration += frame.data.length();
+        }
+        std::shared_ptr< Discord::JsonDecoder > decoder;
+        switch (state.range(0)) {
+            case 1: {
+                decoder = std::make_shared< Discord::SimdJsonDecoder >(
+                    Discord::SimdJsonDecoder::Kernel::Scalar
+                );
+            } break;
+
+            case 2: {
+                if (!Discord::SimdJsonDecoder::IsVectorKernelAvailable()) {
+                    state.SkipWithError("no vector kernel for this processor");
+                    return;
+                }
+                decoder = std::make_shared< Discord::SimdJsonDecoder >(
+                    Discord::SimdJsonDecoder::Kernel::Vector
+                );
+            } break;
+
+            default: break;
+        }
+        for (auto _: state) {
+            for (const auto text: texts) {
+                if (decoder == nullptr) {
+                    benchmark::DoNotOptimize(Json::Value::FromEncoding(*text));
+                } else {
+                    benchmark::DoNotOptimize(decoder->Decode(*text));
+                }
+            }
+        }
+        state.SetBytesProcessed((int64_t)(state.iterations() * bytesPerIteration));
+        state.SetItemsProcessed((int64_t)(state.iterations() * texts.size()));
+    }
+
+}
+
+BENCHMARK(ReplayCapture)
+    ->ArgName("cache")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(DecodeCapture)
+    ->ArgName("decoder")
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,81 @@
+/**
+ * @file Session.cpp
+ *
+ * This module contains the implementation of the Session structure used
+ * by the benchmarks of the Discord library.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Session.hpp"
+
+#include <chrono>
+#include <future>
+#include <Json/Value.hpp>
+
+Session::Session() {
+    scheduler->SetClock(clock);
+    gateway.SetScheduler(scheduler);
+    gateway.RegisterEventCallback(
+        [this](Discord::Gateway::Event&& /* event */){
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            ++numEventsReceived;
+            eventsReceivedCondition.notify_all();
+        }
+    );
+}
+
+Session::~Session() noexcept {
+    connections->TearDown();
+}
+
+void Session::AwaitEvents(size_t numEvents) {
+    std::unique_lock< decltype(mutex) > lock(mutex);
+    eventsReceivedCondition.wait(
+        lock,
+        [&]{ return numEventsReceived >= numEvents; }
+    );
+}
+
+bool Session::Connect() {
+    Discord::Gateway::Configuration configuration;
+    configuration.userAgent = "DiscordBot";
+    auto connected = gateway.Connect(connections, configuration);
+    if (!connections->RequireResourceRequests(1)) {
+        return false;
+    }
+    connections->RespondToResourceRequest(0, {
+        200,
+        {},
+        Json::Object({
+            {"url", "wss://gateway.discord.gg"},
+        }).ToEncoding()
+    });
+    if (!connections->RequireWebSocketRequests(1)) {
+        return false;
+    }
+    connections->RespondToWebSocketRequest(0, webSocket);
+    if (
+        webSocket->onTextRegistered.get_future().wait_for(
+            std::chrono::seconds(1)
+        )
+        != std::future_status::ready
+    ) {
+        return false;
+    }
+    webSocket->onText(
+        Json::Object({
+            {"op", 10},
+            {"d", Json::Object({
+                {"heartbeat_interval", 45000},
+            })},
+        }).ToEncoding()
+    );
+    return (
+        (
+            connected.wait_for(std::chrono::seconds(1))
+            == std::future_status::ready
+        )
+        && connected.get()
+    );
+}
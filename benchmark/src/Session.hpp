@@ -0,0 +1,53 @@
+#pragma once
+
+/**
+ * @file Session.hpp
+ *
+ * This module declares the Session structure used by the benchmarks
+ * of the Discord library to drive a gateway through mock dependencies.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "../../test/src/Common.hpp"
+
+#include <condition_variable>
+#include <Discord/Gateway.hpp>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <Timekeeping/Scheduler.hpp>
+
+/**
+ * This is a gateway connected to mock dependencies, along with
+ * whatever is needed to wait for it to deliver events.
+ */
+struct Session {
+    // Properties
+
+    std::shared_ptr< MockClock > clock = std::make_shared< MockClock >();
+    std::shared_ptr< MockConnections > connections = std::make_shared< MockConnections >();
+    std::condition_variable eventsReceivedCondition;
+    Discord::Gateway gateway;
+    std::mutex mutex;
+    size_t numEventsReceived = 0;
+    std::shared_ptr< Timekeeping::Scheduler > scheduler = std::make_shared< Timekeeping::Scheduler >();
+    std::shared_ptr< MockWebSocket > webSocket = std::make_shared< MockWebSocket >();
+
+    // Methods
+
+    Session();
+    ~Session() noexcept;
+    void AwaitEvents(size_t numEvents);
+
+    /**
+     * Connect the gateway, answering its request for the gateway
+     * endpoint, opening its WebSocket, and greeting it with a "hello"
+     * message.
+     *
+     * @return
+     *     An indication of whether or not the gateway connected
+     *     within a second is returned.
+     */
+    bool Connect();
+};
@@ -0,0 +1,117 @@
+/**
+ * @file SocketConnectionsBenchmarks.cpp
+ *
+ * This module contains benchmarks of the latency and throughput of
+ * Discord::SocketConnections, making requests of a stand-in server
+ * on the loopback interface.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "../../test/src/LoopbackServer.hpp"
+
+#include <benchmark/benchmark.h>
+#include <Discord/SocketConnections.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the body of every response given by the server,
+     * about the size of a typical message object.
+     */
+    const std::string RESPONSE_BODY(1024, 'x');
+
+    /**
+     * Answer every request on the given connection, closing
+     * the connection after each response unless it's to be kept alive.
+     */
+    void Serve(
+        int fd,
+        bool keepAlive
+    ) {
+        std::string buffer, request;
+        while (LoopbackServer::ReadRequest(fd, buffer, request)) {
+            LoopbackServer::WriteAll(
+                fd,
+                "HTTP/1.1 200 OK\r\n"
+                "Content-Length: " + std::to_string(RESPONSE_BODY.length()) + "\r\n"
+                + (keepAlive ? "" : "Connection: close\r\n")
+                + "\r\n"
+                + RESPONSE_BODY
+            );
+            if (!keepAlive) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Measure the time to make one request and receive its response.
+     *
+     * The argument is 1 if connections are kept alive, or 0 if a new
+     * connection is made for every request.
+     */
+    void SocketConnectionsRoundTrip(benchmark::State& state) {
+        const auto keepAlive = (state.range(0) != 0);
+        LoopbackServer server(
+            [keepAlive](size_t, int fd){
+                Serve(fd, keepAlive);
+            }
+        );
+        Discord::SocketConnections connections;
+        const auto uri = server.GetUri("/api/v6/channels/1234/messages/5678");
+        for (auto _: state) {
+            auto transaction = connections.QueueResourceRequest({"GET", uri});
+            benchmark::DoNotOptimize(transaction.response.get());
+        }
+        state.counters["connections"] = (double)connections.GetStatistics().connectionsOpened;
+    }
+
+    /**
+     * Measure how many requests can be completed per second when
+     * the given number of them are queued at once.
+     */
+    void SocketConnectionsThroughput(benchmark::State& state) {
+        const auto batchSize = (size_t)state.range(0);
+        LoopbackServer server(
+            [](size_t, int fd){
+                Serve(fd, true);
+            }
+        );
+        Discord::SocketConnections connections;
+        const auto uri = server.GetUri("/api/v6/channels/1234/messages/5678");
+        std::vector< Discord::Connections::ResourceRequestTransaction > transactions(batchSize);
+        for (auto _: state) {
+            for (auto& transaction: transactions) {
+                transaction = connections.QueueResourceRequest({"GET", uri});
+            }
+            for (auto& transaction: transactions) {
+                benchmark::DoNotOptimize(transaction.response.get());
+            }
+        }
+        state.SetItemsProcessed((int64_t)(state.iterations() * batchSize));
+        state.SetBytesProcessed((int64_t)(state.iterations() * batchSize * RESPONSE_BODY.length()));
+        const auto statistics = connections.GetStatistics();
+        state.counters["connections"] = (double)statistics.connectionsOpened;
+        state.counters["pipelined"] = (double)statistics.requestsPipelined;
+    }
+
+}
+
+BENCHMARK(SocketConnectionsRoundTrip)
+    ->ArgName("keepAlive")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+BENCHMARK(SocketConnectionsThroughput)
+    ->ArgName("batch")
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(64)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
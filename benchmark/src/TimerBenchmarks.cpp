@@ -0,0 +1,86 @@
+/**
+ * @file TimerBenchmarks.cpp
+ *
+ * This module contains benchmarks comparing Discord::TimerWheel with
+ * Timekeeping::Scheduler in keeping the heartbeat timers of a large
+ * number of gateway sessions.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "../../test/src/Common.hpp"
+
+#include <benchmark/benchmark.h>
+#include <Discord/TimerWheel.hpp>
+#include <memory>
+#include <Timekeeping/Scheduler.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of seconds between heartbeats of each session.
+     */
+    constexpr double HEARTBEAT_INTERVAL = 41.25;
+
+    /**
+     * Measure the cost of rescheduling the heartbeat of every session,
+     * the way a gateway does each time it sends a heartbeat: cancel the
+     * timer of the current heartbeat and schedule the next one.
+     *
+     * The argument is the number of sessions.
+     */
+    template< typename T > void RescheduleHeartbeats(
+        benchmark::State& state,
+        T& timekeeper
+    ) {
+        const auto numSessions = (size_t)state.range(0);
+        std::vector< int > tokens(numSessions);
+        std::vector< double > nextHeartbeatTimes(numSessions);
+        for (size_t i = 0; i < numSessions; ++i) {
+            nextHeartbeatTimes[i] = (
+                HEARTBEAT_INTERVAL * (double)i / (double)numSessions
+                + HEARTBEAT_INTERVAL
+            );
+            tokens[i] = timekeeper.Schedule([]{}, nextHeartbeatTimes[i]);
+        }
+        for (auto _: state) {
+            for (size_t i = 0; i < numSessions; ++i) {
+                timekeeper.Cancel(tokens[i]);
+                nextHeartbeatTimes[i] += HEARTBEAT_INTERVAL;
+                tokens[i] = timekeeper.Schedule([]{}, nextHeartbeatTimes[i]);
+            }
+        }
+        for (const auto token: tokens) {
+            timekeeper.Cancel(token);
+        }
+        state.SetItemsProcessed((int64_t)(state.iterations() * numSessions));
+    }
+
+    void RescheduleHeartbeatsScheduler(benchmark::State& state) {
+        Timekeeping::Scheduler scheduler;
+        scheduler.SetClock(std::make_shared< MockClock >());
+        RescheduleHeartbeats(state, scheduler);
+    }
+
+    void RescheduleHeartbeatsTimerWheel(benchmark::State& state) {
+        Discord::TimerWheel timerWheel;
+        timerWheel.SetClock(std::make_shared< MockClock >());
+        RescheduleHeartbeats(state, timerWheel);
+    }
+
+}
+
+BENCHMARK(RescheduleHeartbeatsScheduler)
+    ->ArgName("sessions")
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(RescheduleHeartbeatsTimerWheel)
+    ->ArgName("sessions")
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond);
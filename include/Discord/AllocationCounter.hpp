@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * @file AllocationCounter.hpp
+ *
+ * This module declares the Discord::AllocationCounter class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <stddef.h>
+
+namespace Discord {
+
+    /**
+     * This counts the heap allocations made by the current thread from
+     * when it's constructed, so that the cost in allocations of a piece
+     * of code can be measured.
+     *
+     * Allocations are only counted if the program replaces the global
+     * allocation functions with ones which call CountAllocation.  This is
+     * opt-in: configure the library with DISCORD_TRACK_ALLOCATIONS turned
+     * on to have it provide them, or build src/AllocationHooks.cpp into
+     * the program.  Otherwise, nothing is counted, and IsEnabled
+     * returns false.
+     */
+    class AllocationCounter {
+        // Types
+    public:
+        struct Counts {
+            size_t allocations = 0;
+            size_t bytes = 0;
+        };
+
+        // Public methods
+    public:
+        /**
+         * This constructs the counter, which counts from now on the
+         * allocations made by the thread constructing it.
+         */
+        AllocationCounter();
+
+        /**
+         * Return the allocations made by the thread which constructed
+         * the counter since it was constructed.  This must be called
+         * from the same thread.
+         */
+        Counts GetCounts() const;
+
+        /**
+         * Return an indication of whether or not allocations are
+         * being counted.
+         */
+        static bool IsEnabled();
+
+        /**
+         * Return the allocations made by the current thread since it
+         * started.
+         */
+        static Counts GetThreadCounts();
+
+        /**
+         * Count an allocation of the given number of bytes made by the
+         * current thread.  This is called by the replacement global
+         * allocation functions, and must not itself allocate.
+         */
+        static void CountAllocation(size_t size);
+
+        // Private properties
+    private:
+        Counts start_;
+    };
+
+}
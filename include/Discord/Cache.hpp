@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * @file Cache.hpp
+ *
+ * This module declares the Discord::Cache class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Discord {
+
+    /**
+     * This holds the entities (members, channels, roles, and presences)
+     * of the guilds seen by one or more gateways.  Each entity is kept
+     * in its JSON encoding, exactly as it was received from Discord,
+     * so that it can be stored without first being decoded.
+     *
+     * All methods are safe to call from any thread.
+     */
+    class Cache {
+        // Types
+    public:
+        enum class EntityKind {
+            Channel,
+            Member,
+            Presence,
+            Role,
+        };
+
+        // Lifecycle management
+    public:
+        ~Cache() noexcept;
+        Cache(const Cache& other) = delete;
+        Cache(Cache&&) noexcept;
+        Cache& operator=(const Cache& other) = delete;
+        Cache& operator=(Cache&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is the default constructor.
+         */
+        Cache();
+
+        /**
+         * Store the given entity, replacing any entity of the same kind
+         * and ID in the same guild.
+         *
+         * @param[in] guildId
+         *     This is the ID of the guild to which the entity belongs.
+         *
+         * @param[in] kind
+         *     This indicates what kind of entity is being stored.
+         *
+         * @param[in] id
+         *     This is the ID of the entity.  For members and presences,
+         *     this is the ID of the user.
+         *
+         * @param[in] encoding
+         *     This is the JSON encoding of the entity.
+         */
+        void SetEntity(
+            const std::string& guildId,
+            EntityKind kind,
+            const std::string& id,
+            std::string&& encoding
+        );
+
+        /**
+         * Return the JSON encoding of the given entity, or an empty
+         * string if the entity is not in the cache.
+         */
+        std::string GetEntity(
+            const std::string& guildId,
+            EntityKind kind,
+            const std::string& id
+        ) const;
+
+        /**
+         * Return the IDs of all entities of the given kind in the given
+         * guild.
+         */
+        std::vector< std::string > GetEntityIds(
+            const std::string& guildId,
+            EntityKind kind
+        ) const;
+
+        /**
+         * Return the IDs of all guilds which have entities in the cache.
+         */
+        std::vector< std::string > GetGuildIds() const;
+
+        void RemoveEntity(
+            const std::string& guildId,
+            EntityKind kind,
+            const std::string& id
+        );
+
+        void RemoveGuild(const std::string& guildId);
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @file Capture.hpp
+ *
+ * This module declares the Discord::Capture structure.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <map>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace Discord {
+
+    /**
+     * This holds a recording of the frames received on one or more
+     * WebSockets, such as the traffic of gateway sessions, so that it can
+     * be played back later.
+     */
+    struct Capture {
+        // Types
+
+        enum class FrameKind {
+            Text,
+            Binary,
+            Close,
+        };
+
+        struct Frame {
+            /**
+             * This is the time, in seconds, at which the frame was
+             * received, relative to the first frame of the capture.
+             */
+            double time = 0.0;
+
+            /**
+             * This identifies the WebSocket on which the frame was
+             * received, numbered in the order they were opened.
+             */
+            size_t connection = 0;
+
+            FrameKind kind = FrameKind::Text;
+            std::string data;
+        };
+
+        // Properties
+
+        /**
+         * These describe the capture, such as when and where it
+         * was recorded.
+         */
+        std::map< std::string, std::string > metadata;
+
+        std::vector< Frame > frames;
+
+        // Methods
+
+        /**
+         * Return a compact binary encoding of the capture.  Frame times
+         * are kept to the microsecond.
+         */
+        std::string ToEncoding() const;
+
+        /**
+         * Replace the contents of the capture with those of the given
+         * encoding, made by ToEncoding.
+         *
+         * @return
+         *     An indication of whether or not the encoding was valid
+         *     is returned.  If not, the capture is left empty.
+         */
+        bool FromEncoding(const std::string& encoding);
+    };
+
+}
@@ -8,10 +8,12 @@
  * © 2020 by Richard Walters
  */
 
+#include "Headers.hpp"
 #include "WebSocket.hpp"
 
 #include <functional>
 #include <future>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -25,26 +27,87 @@ namespace Discord {
     class Connections {
         // Types
     public:
+        /**
+         * This is called to abandon a request.  It may be called after
+         * the request has already completed, in which case it should
+         * have no effect.
+         */
         using CancelDelegate = std::function< void() >;
 
-        struct Header {
-            std::string key;
-            std::string value;
+        using Header = Discord::Header;
+        using Headers = Discord::Headers;
+
+        /**
+         * This indicates how urgently a request should be made, when
+         * requests have to wait their turn.  Requests which don't
+         * give one are Normal.
+         */
+        enum class Priority {
+            Normal,
+
+            /**
+             * This is for requests someone is waiting on, such as
+             * the response to an interaction.
+             */
+            Interactive,
+
+            /**
+             * This is for bulk work, such as fetching message history,
+             * which should give way to anything else.
+             */
+            Background,
         };
 
+        /**
+         * This describes a request for a resource.  Anything not given
+         * is left empty, and the priority defaults to Normal.
+         */
         struct ResourceRequest {
             std::string method;
             std::string uri;
-            std::vector< Header > headers;
+            Headers headers;
             std::string body;
+            Priority priority;
+
+            /**
+             * If this is set, it holds the body instead, so that a large
+             * body can be handed on, and the request made again, without
+             * copying it.  Use GetBody to read the body either way.
+             */
+            std::shared_ptr< const std::string > sharedBody;
+
+            ResourceRequest(
+                std::string method = "",
+                std::string uri = "",
+                Headers headers = Headers(),
+                std::string body = "",
+                Priority priority = Priority::Normal
+            )
+                : method(std::move(method))
+                , uri(std::move(uri))
+                , headers(std::move(headers))
+                , body(std::move(body))
+                , priority(priority)
+            {
+            }
+
+            const std::string& GetBody() const {
+                return (sharedBody == nullptr) ? body : *sharedBody;
+            }
         };
 
         struct Response {
             unsigned int status;
-            std::vector< Header > headers;
+            Headers headers;
             std::string body;
         };
 
+        /**
+         * This is called with the response to a request made with
+         * a delegate rather than a future.
+         */
+        using ResponseDelegate = std::function< void(Response&& response) >;
+
         struct ResourceRequestTransaction {
             std::future< Response > response;
             CancelDelegate cancel;
@@ -65,6 +128,37 @@ namespace Discord {
             const ResourceRequest& request
         ) = 0;
 
+        /**
+         * This is called instead of the other form when the request
+         * is no longer needed by the caller, so that its headers and body
+         * can be moved rather than copied.  Override it where that saves
+         * a copy; by default, it hands the request to the other form,
+         * with any shared body copied into the body, for transports
+         * which only look there.
+         */
+        virtual ResourceRequestTransaction QueueResourceRequest(
+            ResourceRequest&& request
+        );
+
+        /**
+         * This is called instead of the other forms by callers which
+         * would rather be told when the response arrives than wait
+         * for it.  The delegate is called exactly once, possibly before
+         * this returns, and never while the connections hold any lock,
+         * so it may make more requests.  If the request is canceled,
+         * the delegate is called with a "499 Client Closed Request"
+         * response.
+         *
+         * By default, this hands the request to the other forms and
+         * waits for the response on a thread of its own, so it
+         * should be overridden wherever the response can be handed
+         * over as soon as it arrives.
+         */
+        virtual CancelDelegate QueueResourceRequest(
+            ResourceRequest&& request,
+            ResponseDelegate&& onResponse
+        );
+
         virtual WebSocketRequestTransaction QueueWebSocketRequest(
             const WebSocketRequest& request
         ) = 0;
@@ -0,0 +1,96 @@
+#pragma once
+
+/**
+ * @file EventDispatcher.hpp
+ *
+ * This module declares the Discord::EventDispatcher class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Gateway.hpp"
+#include "WorkerPool.hpp"
+
+#include <memory>
+#include <string>
+
+namespace Discord {
+
+    /**
+     * This hands gateway events to an event handler on a pool of worker
+     * threads.  Events are divided into partitions: one per guild, one per
+     * direct message channel, and one for events which belong to neither.
+     * The events of a partition are handled one at a time, in the order
+     * in which they were dispatched, while the events of different
+     * partitions are handled in parallel.  This way a slow handler in one
+     * busy guild doesn't hold up the events of every other guild.
+     *
+     * To use it, register a callback with a gateway which passes each
+     * event to the dispatcher's Dispatch method.
+     *
+     * Events carrying traces have their Queued, Started, and Handled
+     * stages stamped by the dispatcher.
+     */
+    class EventDispatcher {
+        // Lifecycle management
+    public:
+        /**
+         * Any events still waiting to be handled continue to be handled
+         * after the dispatcher is destroyed.
+         */
+        ~EventDispatcher() noexcept;
+        EventDispatcher(const EventDispatcher& other) = delete;
+        EventDispatcher(EventDispatcher&&) noexcept;
+        EventDispatcher& operator=(const EventDispatcher& other) = delete;
+        EventDispatcher& operator=(EventDispatcher&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the dispatcher.
+         *
+         * @param[in] workerPool
+         *     This is the pool of worker threads on which to handle events.
+         */
+        explicit EventDispatcher(const std::shared_ptr< WorkerPool >& workerPool);
+
+        /**
+         * Return the name of the partition to which the given event belongs.
+         *
+         * @param[in] event
+         *     This is the event for which to find the partition.
+         *
+         * @return
+         *     The name of the partition is returned.  It's empty
+         *     for events which belong to no guild or channel.
+         */
+        static std::string GetPartition(const Gateway::Event& event);
+
+        /**
+         * Register the function to call to handle each event.
+         * It's called from the worker threads.
+         */
+        void RegisterEventCallback(Gateway::EventCallback&& onEvent);
+
+        /**
+         * Queue the given event to be handled after all the events
+         * previously dispatched to the same partition.
+         */
+        void Dispatch(Gateway::Event&& event);
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
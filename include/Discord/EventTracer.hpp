@@ -0,0 +1,258 @@
+#pragma once
+
+/**
+ * @file EventTracer.hpp
+ *
+ * This module declares the Discord::EventTracer class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <atomic>
+#include <chrono>
+#include <Json/Value.hpp>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Discord {
+
+    /**
+     * This measures how long gateway events spend in each stage on their
+     * way from the WebSocket to the code which handles them, keeping
+     * a latency histogram for each stage, and optionally the full
+     * traces of a sample of the events.
+     *
+     * To use it, give it to a gateway with SetEventTracer.  Each event
+     * then carries its trace, which an event dispatcher stamps as it
+     * queues and handles the event, and which subscribers may stamp
+     * or pass along to tracing of their own.
+     */
+    class EventTracer {
+        // Types
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * These are the stages through which an event passes,
+         * in order.  Not every event passes through every stage.
+         */
+        enum class Stage {
+            /**
+             * The frame carrying the event was received from the
+             * WebSocket.
+             */
+            Received,
+
+            /**
+             * The gateway took its lock to handle the frame.
+             */
+            Locked,
+
+            /**
+             * The frame was parsed.
+             */
+            Decoded,
+
+            /**
+             * The event's turn came, in the order in which frames were
+             * received, and the gateway (and its caches) took it in.
+             * It's about to be handed to the subscriber.
+             */
+            Applied,
+
+            /**
+             * The subscriber queued the event to be handled later,
+             * such as on the worker threads of an event dispatcher.
+             */
+            Queued,
+
+            /**
+             * The subscriber began handling a queued event.
+             */
+            Started,
+
+            /**
+             * The subscriber finished handling the event.
+             */
+            Handled,
+
+            NumStages
+        };
+
+        /**
+         * This follows one event through the stages, and is handed
+         * along with the event to subscribers.
+         */
+        class Trace;
+
+        /**
+         * This is a copy of a finished trace which was sampled.
+         */
+        struct SampledTrace {
+            uint64_t id = 0;
+            std::string eventName;
+            int sequenceNumber = 0;
+
+            /**
+             * These are the times at which each stage was stamped,
+             * in seconds since the Received stage, or negative numbers
+             * for stages the event didn't pass through.
+             */
+            double secondsSinceReceived[(size_t)Stage::NumStages];
+        };
+
+        /**
+         * This counts how many events took how long to pass
+         * through one stage.
+         */
+        struct Histogram {
+            size_t count = 0;
+            double totalSeconds = 0.0;
+            double maxSeconds = 0.0;
+
+            /**
+             * These are the number of events in each bucket.  The bounds
+             * of the buckets are given by GetBucketUpperBound.
+             */
+            std::vector< size_t > buckets;
+
+            /**
+             * Return the number of seconds within which the given
+             * fraction of the events passed through the stage,
+             * rounded up to the upper bound of a bucket.
+             */
+            double GetPercentile(double fraction) const;
+
+            /**
+             * Return the number of seconds below which all durations
+             * counted in the given bucket lie.
+             */
+            static double GetBucketUpperBound(size_t bucket);
+        };
+
+        // Lifecycle management
+    public:
+        ~EventTracer() noexcept;
+        EventTracer(const EventTracer& other) = delete;
+        EventTracer(EventTracer&&) noexcept;
+        EventTracer& operator=(const EventTracer& other) = delete;
+        EventTracer& operator=(EventTracer&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This is the default constructor.
+         */
+        EventTracer();
+
+        /**
+         * Keep the full traces of one event out of every given number,
+         * holding on to at most the given number of them.  If the
+         * interval is zero, which is the default, no traces are kept.
+         */
+        void SetSampling(
+            size_t sampleInterval,
+            size_t maxSampledTraces = 1000
+        );
+
+        /**
+         * Begin tracing an event whose frame has just been received.
+         *
+         * @return
+         *     The trace of the event, with its Received stage stamped,
+         *     is returned.
+         */
+        std::shared_ptr< Trace > StartTrace();
+
+        /**
+         * Return the histogram of how long events took to reach the
+         * given stage from the stage they passed through before it.
+         */
+        Histogram GetHistogram(Stage stage) const;
+
+        /**
+         * Return the histogram of how long events took from being
+         * received to being handled.
+         */
+        Histogram GetTotalHistogram() const;
+
+        /**
+         * Return the sampled traces kept so far, and forget them.
+         */
+        std::vector< SampledTrace > TakeSampledTraces();
+
+        /**
+         * Return a summary of the histograms, as JSON, giving for each
+         * stage the number of events, and the mean, 50th percentile,
+         * 99th percentile, and maximum number of seconds they took.
+         */
+        Json::Value GetReport() const;
+
+        /**
+         * Return the name of the given stage, as used in the report.
+         */
+        static std::string GetStageName(Stage stage);
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+    /**
+     * This follows one event through the stages of an EventTracer.
+     */
+    class EventTracer::Trace {
+    public:
+        /**
+         * This tells the trace apart from the traces of
+         * other events.
+         */
+        uint64_t id = 0;
+
+        /**
+         * This indicates whether or not the trace is one of the
+         * sample kept in full by the tracer.
+         */
+        bool sampled = false;
+
+        std::string eventName;
+        int sequenceNumber = 0;
+
+        /**
+         * Note that the event has reached the given stage.  Stamping
+         * the Handled stage finishes the trace, adding it to the
+         * tracer's histograms.  Stages already stamped aren't
+         * stamped again.
+         */
+        void Stamp(Stage stage);
+
+        bool IsStamped(Stage stage) const;
+
+        /**
+         * Return the time at which the given stage was stamped,
+         * in seconds since the Received stage, or a negative number
+         * if the stage hasn't been stamped.
+         */
+        double GetSecondsSinceReceived(Stage stage) const;
+
+    private:
+        friend class EventTracer;
+        Clock::time_point stamps[(size_t)Stage::NumStages];
+        std::atomic< unsigned int > stagesStamped{0};
+        std::weak_ptr< EventTracer::Impl > tracer;
+    };
+
+}
@@ -8,11 +8,22 @@
  * © 2020 by Richard Walters
  */
 
+#include "Cache.hpp"
 #include "Connections.hpp"
+#include "EventTracer.hpp"
+#include "GatewayEndpointCache.hpp"
+#include "JsonDecoder.hpp"
+#include "ResponseCache.hpp"
+#include "TimerWheel.hpp"
+#include "WorkerPool.hpp"
 
 #include <functional>
 #include <future>
+#include <Json/Value.hpp>
 #include <memory>
+#include <set>
+#include <stdint.h>
+#include <string>
 #include <Timekeeping/Scheduler.hpp>
 
 namespace Discord {
@@ -24,12 +35,121 @@ namespace Discord {
         // Types
     public:
         using CloseCallback = std::function< void() >;
+
+        /**
+         * These are the ways to choose when to send the first heartbeat
+         * after the gateway says hello.
+         */
+        enum class HeartbeatPhase {
+            /**
+             * Send the first heartbeat right away.
+             */
+            Immediate,
+
+            /**
+             * Wait a random fraction of the heartbeat interval before
+             * sending the first heartbeat, as Discord recommends.
+             */
+            Random,
+
+            /**
+             * Send heartbeats at a phase of the interval, counted from
+             * the epoch of the gateway's clock rather than from when it
+             * connected, chosen so that the heartbeats of all the
+             * gateways in the process are spread evenly across the
+             * interval, no matter how many there are or when they
+             * connected.
+             */
+            Spread,
+        };
+
+        /**
+         * These are the gateway intents: the groups of events a gateway
+         * can ask Discord to send.  Events of other groups aren't sent
+         * at all, which saves both Discord and the gateway the work.
+         * GuildMembers and GuildPresences are privileged, and have to be
+         * enabled for the bot before they can be asked for.
+         */
+        enum Intent : uint32_t {
+            Guilds = 1 << 0,
+            GuildMembers = 1 << 1,
+            GuildBans = 1 << 2,
+            GuildEmojis = 1 << 3,
+            GuildIntegrations = 1 << 4,
+            GuildWebhooks = 1 << 5,
+            GuildInvites = 1 << 6,
+            GuildVoiceStates = 1 << 7,
+            GuildPresences = 1 << 8,
+            GuildMessages = 1 << 9,
+            GuildMessageReactions = 1 << 10,
+            GuildMessageTyping = 1 << 11,
+            DirectMessages = 1 << 12,
+            DirectMessageReactions = 1 << 13,
+            DirectMessageTyping = 1 << 14,
+        };
+
         struct Configuration {
             std::string browser;
             std::string device;
             std::string os;
             std::string token;
             std::string userAgent;
+            HeartbeatPhase heartbeatPhase = HeartbeatPhase::Immediate;
+
+            /**
+             * If this is not zero, reconnecting is hedged: if a WebSocket
+             * can't be opened with the cached gateway URL within this many
+             * seconds, the gateway URL is looked up again in parallel, and
+             * whichever attempt opens a WebSocket first is used.
+             */
+            double hedgedConnectDelay = 0.0;
+
+            /**
+             * These are the names of the dispatch events which are
+             * expected to carry large payloads.  If a cache is set,
+             * their payloads are parsed as a stream directly into the
+             * cache, rather than being decoded in full first.  If a
+             * decode worker pool is set, they are decoded there,
+             * rather than on the thread which received them.
+             */
+            std::set< std::string > heavyEvents = {
+                "GUILD_CREATE",
+                "GUILD_MEMBERS_CHUNK",
+            };
+
+            /**
+             * These are the names of the dispatch events the subscriber
+             * wants.  If any are given, the fewest intents under which
+             * Discord sends all of them are worked out with
+             * GetIntentsForEvents, and sent when identifying, along with
+             * any given in intents.  Other events may still be received.
+             */
+            std::set< std::string > subscribedEvents;
+
+            /**
+             * These are intents (a bitwise-or of Intent values) to send
+             * when identifying, in addition to those worked out for the
+             * subscribed events.  If neither these nor any subscribed
+             * events are given, no intents are sent, and Discord sends
+             * every event the bot is allowed to receive.
+             */
+            uint32_t intents = 0;
+
+            /**
+             * If this is not zero, it's sent as the number of members
+             * above which Discord leaves offline members out of the
+             * guilds it sends.  Discord only accepts numbers between
+             * 50 and 250, so anything outside that range is replaced
+             * with the nearest number within it, and a diagnostic
+             * message is published.
+             */
+            size_t largeThreshold = 0;
+
+            /**
+             * If this is false, Discord is asked not to send presence
+             * and typing events of guilds.
+             */
+            bool guildSubscriptions = true;
         };
         using DiagnosticCallback = std::function<
             void(
@@ -38,6 +158,66 @@ namespace Discord {
             )
         >;
 
+        /**
+         * This holds a dispatch event received from the gateway.
+         */
+        struct Event {
+            /**
+             * This is the name of the event, such as "MESSAGE_CREATE".
+             */
+            std::string name;
+
+            int sequenceNumber = 0;
+
+            /**
+             * This is the payload of the event.  For heavy events streamed
+             * into the cache, the arrays of members, channels, roles, and
+             * presences in the payload are empty; look them up in the
+             * cache instead.
+             */
+            Json::Value data;
+
+            /**
+             * If the gateway has an event tracer, this is the trace of the
+             * event, which the subscriber may stamp as it handles the event.
+             * Unless the subscriber stamps the Queued stage before returning,
+             * the gateway stamps the Handled stage once it returns.
+             */
+            std::shared_ptr< EventTracer::Trace > trace;
+        };
+        using EventCallback = std::function< void(Event&& event) >;
+
+        /**
+         * These are the heap allocations made by the gateway, counted
+         * with Discord::AllocationCounter, so they're all zero unless
+         * allocations are being counted.
+         */
+        struct AllocationStatistics {
+            /**
+             * This is the number of messages received from the gateway.
+             */
+            size_t messages = 0;
+
+            /**
+             * These are the allocations made on the threads receiving
+             * messages while handling them, up to and including the
+             * delivery of their events to the event callback.
+             */
+            size_t messageAllocations = 0;
+            size_t messageBytes = 0;
+
+            /**
+             * This is the number of heartbeats sent to the gateway.
+             */
+            size_t heartbeats = 0;
+
+            /**
+             * These are the allocations made while sending heartbeats.
+             */
+            size_t heartbeatAllocations = 0;
+            size_t heartbeatBytes = 0;
+        };
+
         // Lifecycle management
     public:
         ~Gateway() noexcept;
@@ -55,6 +235,55 @@ namespace Discord {
 
         void SetScheduler(const std::shared_ptr< Timekeeping::Scheduler >& scheduler);
 
+        /**
+         * Set the timer wheel to use to schedule heartbeats.  If one is
+         * set, it's used instead of the scheduler.  One timer wheel can
+         * be shared by many gateways.
+         */
+        void SetTimerWheel(const std::shared_ptr< TimerWheel >& timerWheel);
+
+        /**
+         * Set the cache through which to look up the gateway URL.
+         * Gateways sharing a cache share the URL it remembers, and
+         * share lookups made while any of them are connecting.
+         */
+        void SetGatewayEndpointCache(const std::shared_ptr< GatewayEndpointCache >& endpointCache);
+
+        /**
+         * Set the tracer with which to measure how long the events
+         * received by the gateway take to reach each stage of their
+         * handling.  One tracer can be shared by many gateways.
+         */
+        void SetEventTracer(const std::shared_ptr< EventTracer >& eventTracer);
+
+        /**
+         * Set the cache into which the gateway stores the members,
+         * channels, roles, and presences of the guilds it receives.
+         */
+        void SetCache(const std::shared_ptr< Cache >& cache);
+
+        /**
+         * Set the cache of REST responses from which the gateway forgets
+         * responses for resources which its events report have changed.
+         */
+        void SetResponseCache(const std::shared_ptr< ResponseCache >& responseCache);
+
+        /**
+         * Set the pool of worker threads on which to decode heavy events.
+         * Events are still applied and delivered in the order in which
+         * they were received.  If no pool is set, all events are decoded
+         * on the thread which received them.
+         */
+        void SetDecodeWorkerPool(const std::shared_ptr< WorkerPool >& decodeWorkerPool);
+
+        /**
+         * Set the decoder through which to decode the JSON text of the
+         * messages the gateway receives.  If no decoder is set,
+         * Json::Value::FromEncoding is used.  One decoder can be shared
+         * by many gateways.
+         */
+        void SetJsonDecoder(const std::shared_ptr< JsonDecoder >& jsonDecoder);
+
         void WaitBeforeConnect(std::future< void >&& proceedWithConnect);
 
         std::future< bool > Connect(
@@ -66,8 +295,27 @@ namespace Discord {
 
         void RegisterDiagnosticMessageCallback(DiagnosticCallback&& onDiagnosticMessage);
 
+        /**
+         * Register the function to call with each dispatch event received
+         * from the gateway, in the order in which they were received.
+         */
+        void RegisterEventCallback(EventCallback&& onEvent);
+
         void Disconnect();
 
+        AllocationStatistics GetAllocationStatistics() const;
+
+        /**
+         * Return the fewest intents (a bitwise-or of Intent values) under
+         * which Discord sends all of the events with the given names.
+         * Events such as READY are always sent, and need no intent.
+         * Guilds is always included, since the gateway relies on the
+         * GUILD_CREATE events to tell when it's ready.  If any name isn't
+         * one the library knows, every intent which isn't privileged
+         * is included, to be safe.
+         */
+        static uint32_t GetIntentsForEvents(const std::set< std::string >& eventNames);
+
         // Private properties
     private:
         /**
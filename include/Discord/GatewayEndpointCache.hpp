@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * @file GatewayEndpointCache.hpp
+ *
+ * This module declares the Discord::GatewayEndpointCache class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Connections.hpp"
+
+#include <future>
+#include <memory>
+#include <string>
+#include <Timekeeping/Clock.hpp>
+
+namespace Discord {
+
+    /**
+     * This looks up the URL of Discord's gateway on behalf of any number
+     * of gateways, and remembers it for a while.  While a lookup is in
+     * progress, further lookups wait for it rather than asking Discord
+     * again, so that many gateways connecting at once only cost one
+     * request.
+     *
+     * All methods are safe to call from any thread.
+     */
+    class GatewayEndpointCache {
+        // Types
+    public:
+        /**
+         * This represents one caller's wait for the gateway URL.
+         */
+        struct Lookup {
+            /**
+             * This becomes ready with the gateway URL, or an empty string
+             * if the URL could not be found, or the lookup was canceled.
+             */
+            std::future< std::string > endpoint;
+
+            /**
+             * This abandons the caller's wait.  The request to Discord
+             * is only canceled once every caller waiting for it
+             * has abandoned it.
+             */
+            Connections::CancelDelegate cancel;
+        };
+
+        // Lifecycle management
+    public:
+        ~GatewayEndpointCache() noexcept;
+        GatewayEndpointCache(const GatewayEndpointCache& other) = delete;
+        GatewayEndpointCache(GatewayEndpointCache&&) noexcept;
+        GatewayEndpointCache& operator=(const GatewayEndpointCache& other) = delete;
+        GatewayEndpointCache& operator=(GatewayEndpointCache&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the cache.
+         *
+         * @param[in] timeToLive
+         *     This is the number of seconds for which to remember
+         *     the gateway URL once it's found.
+         */
+        explicit GatewayEndpointCache(double timeToLive = 600.0);
+
+        /**
+         * Set the clock used to tell when the remembered gateway URL
+         * has expired.  If no clock is set, the system's steady clock
+         * is used.
+         */
+        void SetClock(const std::shared_ptr< Timekeeping::Clock >& clock);
+
+        /**
+         * Return the remembered gateway URL, or an empty string if
+         * there is none, or it has expired.
+         */
+        std::string GetCachedEndpoint();
+
+        /**
+         * Look up the gateway URL, using the remembered one if it
+         * hasn't expired, or joining a lookup already in progress.
+         *
+         * @param[in] connections
+         *     This is used to make the request to Discord, if one is needed.
+         *
+         * @param[in] userAgent
+         *     This is the user agent to give in the request.
+         *
+         * @param[in] refresh
+         *     If this is true, the remembered URL is passed over, and
+         *     the URL is looked up afresh.  The remembered URL is still
+         *     given to others until the fresh one replaces it, since
+         *     it may only be slow rather than broken.
+         */
+        Lookup GetEndpoint(
+            const std::shared_ptr< Connections >& connections,
+            const std::string& userAgent,
+            bool refresh = false
+        );
+
+        /**
+         * Forget the given gateway URL, if it's the one remembered,
+         * because it didn't work.  This shouldn't be called for a URL
+         * which is merely slow.
+         */
+        void Invalidate(const std::string& endpoint);
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+/**
+ * @file GlobalRateLimiter.hpp
+ *
+ * This module declares the Discord::GlobalRateLimiter class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+
+namespace Discord {
+
+    /**
+     * This limits the rate of all requests made of Discord's REST API
+     * on behalf of one bot, to stay under the global rate limit Discord
+     * sets for the bot.  Share one limiter among all REST clients
+     * using the same bot token, and use a separate limiter for each
+     * bot token.
+     *
+     * The limiter is lock-free, so that threads making requests
+     * at the same time don't wait on each other.
+     */
+    class GlobalRateLimiter {
+        // Lifecycle management
+    public:
+        ~GlobalRateLimiter() noexcept;
+        GlobalRateLimiter(const GlobalRateLimiter& other) = delete;
+        GlobalRateLimiter(GlobalRateLimiter&&) noexcept;
+        GlobalRateLimiter& operator=(const GlobalRateLimiter& other) = delete;
+        GlobalRateLimiter& operator=(GlobalRateLimiter&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the limiter.
+         *
+         * @param[in] requestsPerSecond
+         *     This is the sustained rate at which requests are allowed.
+         *
+         * @param[in] burst
+         *     This is the number of requests allowed at once after
+         *     a quiet period.
+         */
+        explicit GlobalRateLimiter(
+            double requestsPerSecond = 50.0,
+            size_t burst = 50
+        );
+
+        /**
+         * Take permission to make one request at the given time.
+         *
+         * @param[in] now
+         *     This is the current time, in seconds.
+         *
+         * @return
+         *     If permission is granted, zero is returned.  Otherwise,
+         *     the number of seconds to wait before asking again
+         *     is returned.
+         */
+        double TryAcquire(double now);
+
+        /**
+         * Refuse all requests until the given time, because Discord
+         * reported that the global rate limit was exceeded.
+         *
+         * @param[in] until
+         *     This is the time, in seconds, when requests may
+         *     be made again.
+         */
+        void Pause(double until);
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+/**
+ * @file Headers.hpp
+ *
+ * This module declares the Discord::Header structure and
+ * Discord::Headers class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <initializer_list>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Discord {
+
+    struct Header {
+        std::string key;
+        std::string value;
+    };
+
+    /**
+     * These identify the names of headers commonly used with Discord.
+     * All other names are identified as Other.
+     */
+    enum class HeaderName : uint8_t {
+        Other,
+        Accept,
+        AcceptEncoding,
+        Authorization,
+        CacheControl,
+        Connection,
+        ContentEncoding,
+        ContentLength,
+        ContentType,
+        Date,
+        ETag,
+        IfModifiedSince,
+        IfNoneMatch,
+        RetryAfter,
+        TransferEncoding,
+        UserAgent,
+        XAuditLogReason,
+        XRateLimitBucket,
+        XRateLimitGlobal,
+        XRateLimitLimit,
+        XRateLimitRemaining,
+        XRateLimitReset,
+        XRateLimitResetAfter,
+        XRateLimitScope,
+    };
+
+    /**
+     * This holds the headers of a request or response.
+     *
+     * The first four headers are held inside the object itself, so that
+     * typical requests and responses don't need a separate allocation
+     * for their headers, at the cost of the object itself being a few
+     * hundred bytes in size.  Header names are compared without regard
+     * to case.
+     */
+    class Headers {
+        // Types
+    public:
+        using const_iterator = const Header*;
+
+        // Lifecycle management
+    public:
+        ~Headers() noexcept = default;
+        Headers(const Headers& other) = default;
+        Headers(Headers&& other) noexcept;
+        Headers& operator=(const Headers& other) = default;
+        Headers& operator=(Headers&& other) noexcept;
+
+        // Public methods
+    public:
+        Headers() = default;
+        Headers(std::initializer_list< Header > headers);
+        Headers(const std::vector< Header >& headers);
+        Headers(std::vector< Header >&& headers);
+
+        operator std::vector< Header >() const;
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        size_t size() const;
+        bool empty() const;
+        const Header& operator[](size_t index) const;
+
+        /**
+         * Add the given header after the others, even if there is
+         * already a header with the same name.
+         */
+        void push_back(const Header& header);
+        void push_back(Header&& header);
+
+        /**
+         * Return the value of the first header with the given name,
+         * or nullptr if there is no such header.
+         *
+         * Common headers may also be looked up by HeaderName, which
+         * saves converting the name being looked up to lower case.
+         * No header is found by HeaderName::Other.
+         */
+        const std::string* Find(const std::string& name) const;
+        const std::string* Find(HeaderName name) const;
+
+        /**
+         * Return the value of the first header with the given name,
+         * or an empty string if there is no such header.
+         */
+        std::string Get(const std::string& name) const;
+        std::string Get(HeaderName name) const;
+
+        bool Has(const std::string& name) const;
+        bool Has(HeaderName name) const;
+
+        /**
+         * Replace all headers with the given name with one header
+         * having the given value.
+         */
+        void Set(
+            const std::string& name,
+            std::string&& value
+        );
+
+        /**
+         * Remove all headers with the given name.
+         *
+         * @return
+         *     The number of headers removed is returned.
+         */
+        size_t Remove(const std::string& name);
+
+        // Private methods
+    private:
+        Header* GetHeaders();
+        const Header* GetHeaders() const;
+
+        bool Matches(
+            size_t index,
+            const std::string& name
+        ) const;
+
+        /**
+         * Return the index of the first header with the given name,
+         * starting at the given index, or size() if there is
+         * no such header.
+         */
+        size_t IndexOf(
+            const std::string& name,
+            size_t start = 0
+        ) const;
+        size_t IndexOf(HeaderName name) const;
+
+        /**
+         * Remove all headers with the given name, starting at
+         * the given index.
+         */
+        size_t Remove(
+            const std::string& name,
+            size_t start
+        );
+
+        // Private properties
+    private:
+        /**
+         * This is the number of headers held inside the object itself.
+         * Once there are more headers than this, they're all moved
+         * into separately allocated storage.
+         */
+        static constexpr size_t INLINE_CAPACITY = 4;
+
+        Header inlineHeaders_[INLINE_CAPACITY];
+        std::vector< Header > spilledHeaders_;
+        size_t size_ = 0;
+    };
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+/**
+ * @file JsonDecoder.hpp
+ *
+ * This module declares the Discord::JsonDecoder interface.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <Json/Value.hpp>
+#include <string>
+
+namespace Discord {
+
+    /**
+     * This interface represents a way to turn JSON text into the
+     * document object model used by the library.  Gateways decode every
+     * message they receive through one, if given one with SetJsonDecoder,
+     * or else through Json::Value::FromEncoding.
+     *
+     * Decoders may be called from many threads at once.
+     */
+    class JsonDecoder {
+        // Methods
+    public:
+        virtual ~JsonDecoder() = default;
+
+        /**
+         * Decode the given JSON text, returning an invalid value
+         * if the text isn't valid JSON.
+         */
+        virtual Json::Value Decode(const std::string& encoding) = 0;
+    };
+
+}
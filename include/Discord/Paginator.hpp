@@ -0,0 +1,141 @@
+#pragma once
+
+/**
+ * @file Paginator.hpp
+ *
+ * This module declares the Discord::Paginator class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Connections.hpp"
+
+#include <future>
+#include <Json/Value.hpp>
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+namespace Discord {
+
+    /**
+     * This walks through a list which Discord's REST API hands out a page
+     * at a time, such as the message history of a channel ("before" or
+     * "after" a message) or the members of a guild ("after" a user).
+     *
+     * Each page depends on the IDs in the one before it, so pages are
+     * fetched one at a time.  To keep the round trip out of the consumer's
+     * way, the next page is requested as soon as a page arrives, before
+     * the consumer asks for it.  This read-ahead is made with background
+     * priority, so that when the paginator is given a Discord::Rest client,
+     * it only uses rate limit headroom more urgent requests don't need.
+     * Once the consumer asks for a page still being read ahead, the same
+     * request is made again with the paginator's own priority; Discord::Rest
+     * shares one request between the two, at the more urgent priority.
+     *
+     * All methods are safe to call from any thread.
+     */
+    class Paginator {
+        // Types
+    public:
+        enum class Direction {
+            Before,
+            After,
+        };
+
+        struct Configuration {
+            Direction direction = Direction::Before;
+
+            /**
+             * This is the ID from which to start, or an empty string to
+             * start from the beginning of the list (or the end, when
+             * going backward).
+             */
+            std::string start;
+
+            /**
+             * This is the most items to ask for in each page.
+             */
+            size_t limit = 100;
+
+            /**
+             * This is the name of the field of each item holding the ID
+             * used to ask for the next page.  A dot separates the names
+             * of nested fields, such as "user.id" for guild members.
+             */
+            std::string idField = "id";
+        };
+
+        struct Page {
+            unsigned int status = 200;
+
+            /**
+             * This is the array of items in the page.
+             */
+            Json::Value items;
+
+            /**
+             * This indicates whether or not there are no pages
+             * after this one.
+             */
+            bool last = false;
+        };
+
+        // Lifecycle management
+    public:
+        ~Paginator() noexcept;
+        Paginator(const Paginator& other) = delete;
+        Paginator(Paginator&&) noexcept;
+        Paginator& operator=(const Paginator& other) = delete;
+        Paginator& operator=(Paginator&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the paginator.
+         *
+         * @param[in] connections
+         *     These are the connections through which to make requests,
+         *     normally a Discord::Rest client.
+         *
+         * @param[in] request
+         *     This is the GET request of the first page, without
+         *     the paging parameters, which are added to its URI.
+         *
+         * @param[in] configuration
+         *     This says which way to walk through the list,
+         *     and from where.
+         */
+        Paginator(
+            const std::shared_ptr< Connections >& connections,
+            const Connections::ResourceRequest& request,
+            const Configuration& configuration
+        );
+
+        /**
+         * Ask for the next page.  Don't ask again until the page
+         * asked for has arrived.
+         *
+         * @return
+         *     The next page is returned, once it arrives.  Once there are
+         *     no more pages, or a request fails, the page is marked as
+         *     the last one.
+         */
+        std::future< Page > NextPage();
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+/**
+ * @file RecordingConnections.hpp
+ *
+ * This module declares the Discord::RecordingConnections class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Capture.hpp"
+#include "Connections.hpp"
+
+#include <memory>
+#include <string>
+#include <Timekeeping/Clock.hpp>
+
+namespace Discord {
+
+    /**
+     * This wraps another set of connections, recording every frame
+     * received on the WebSockets opened through it, so that the traffic
+     * of real gateway sessions can be played back later.
+     *
+     * Frames are recorded as they're handed to the callbacks registered
+     * with each WebSocket.  Frames sent, and resource requests, are passed
+     * through unchanged and not recorded.  The URI of each WebSocket is
+     * kept in the metadata of the capture as "connection.N.uri", where N
+     * is the number of the connection.
+     *
+     * All methods are safe to call from any thread.
+     */
+    class RecordingConnections
+        : public Connections
+    {
+        // Lifecycle management
+    public:
+        ~RecordingConnections() noexcept;
+        RecordingConnections(const RecordingConnections& other) = delete;
+        RecordingConnections(RecordingConnections&&) noexcept;
+        RecordingConnections& operator=(const RecordingConnections& other) = delete;
+        RecordingConnections& operator=(RecordingConnections&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the recorder.
+         *
+         * @param[in] connections
+         *     This is used to actually make the requests.
+         */
+        explicit RecordingConnections(const std::shared_ptr< Connections >& connections);
+
+        /**
+         * Set the clock used to time frames as they're received.
+         * By default, the system's steady clock is used.
+         */
+        void SetClock(const std::shared_ptr< Timekeeping::Clock >& clock);
+
+        void SetMetadata(
+            const std::string& key,
+            const std::string& value
+        );
+
+        /**
+         * Return a copy of everything recorded so far.
+         */
+        Capture GetCapture() const;
+
+        /**
+         * Return everything recorded so far, and start a new capture
+         * (keeping the metadata).
+         */
+        Capture TakeCapture();
+
+        // Connections
+    public:
+        virtual ResourceRequestTransaction QueueResourceRequest(
+            const ResourceRequest& request
+        ) override;
+
+        virtual ResourceRequestTransaction QueueResourceRequest(
+            ResourceRequest&& request
+        ) override;
+
+        virtual CancelDelegate QueueResourceRequest(
+            ResourceRequest&& request,
+            ResponseDelegate&& onResponse
+        ) override;
+
+        virtual WebSocketRequestTransaction QueueWebSocketRequest(
+            const WebSocketRequest& request
+        ) override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
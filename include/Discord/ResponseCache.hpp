@@ -0,0 +1,206 @@
+#pragma once
+
+/**
+ * @file ResponseCache.hpp
+ *
+ * This module declares the Discord::ResponseCache class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Connections.hpp"
+
+#include <Json/Value.hpp>
+#include <memory>
+#include <stddef.h>
+#include <string>
+
+namespace Discord {
+
+    /**
+     * This remembers responses to GET requests of Discord's REST API,
+     * for routes which are given a time to live, so that slow-changing
+     * data isn't fetched again every time it's used.
+     *
+     * Once a response is older than its time to live, it's revalidated
+     * rather than fetched again, if Discord gave it an entity tag.  When
+     * the cache is full, the least recently used response is forgotten.
+     * Responses are also forgotten when a request which changes the same
+     * resource succeeds, or when a gateway event reports that
+     * the resource has changed.
+     *
+     * Give the cache to a Discord::Rest client to have it used,
+     * and to one or more gateways to have their events invalidate it.
+     *
+     * All methods are safe to call from any thread.
+     */
+    class ResponseCache {
+        // Types
+    public:
+        /**
+         * These are the counts of what happened to requests looked up
+         * in the cache, for routes which have a time to live.
+         */
+        struct Statistics {
+            /**
+             * This is the number of requests answered from the cache
+             * without asking Discord.
+             */
+            size_t hits = 0;
+
+            /**
+             * This is the number of requests answered from the cache
+             * after Discord confirmed the remembered response
+             * was still current.
+             */
+            size_t revalidations = 0;
+
+            /**
+             * This is the number of requests which had to be made
+             * of Discord in full.
+             */
+            size_t misses = 0;
+
+            size_t evictions = 0;
+            size_t invalidations = 0;
+        };
+
+        enum class Freshness {
+            /**
+             * There is no usable response in the cache.
+             */
+            Missing,
+
+            /**
+             * The response may be used as is.
+             */
+            Fresh,
+
+            /**
+             * The response must be revalidated, by making the request
+             * conditional on the response's entity tag.
+             */
+            Stale,
+        };
+
+        struct Lookup {
+            Freshness freshness = Freshness::Missing;
+            Connections::Response response;
+            std::string entityTag;
+        };
+
+        // Lifecycle management
+    public:
+        ~ResponseCache() noexcept;
+        ResponseCache(const ResponseCache& other) = delete;
+        ResponseCache(ResponseCache&&) noexcept;
+        ResponseCache& operator=(const ResponseCache& other) = delete;
+        ResponseCache& operator=(ResponseCache&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the cache.
+         *
+         * @param[in] maxEntries
+         *     This is the most responses to remember at once.
+         */
+        explicit ResponseCache(size_t maxEntries = 1024);
+
+        /**
+         * Set how long to remember responses for the given route.
+         * Responses are only remembered for routes given a time to live.
+         *
+         * @param[in] route
+         *     This is the method and path of the route, with every ID
+         *     replaced by "{id}", such as "GET /guilds/{id}/roles".
+         *
+         * @param[in] timeToLive
+         *     This is the number of seconds a response may be used
+         *     before it must be revalidated.
+         */
+        void SetTimeToLive(
+            const std::string& route,
+            double timeToLive
+        );
+
+        /**
+         * Look up the remembered response to the given request.
+         *
+         * @param[in] request
+         *     This is the request to look up.
+         *
+         * @param[in] now
+         *     This is the current time, in seconds.
+         */
+        Lookup Find(
+            const Connections::ResourceRequest& request,
+            double now
+        );
+
+        /**
+         * Update the cache with the response to the given request.
+         *
+         * @param[in] request
+         *     This is the request which was made.
+         *
+         * @param[in] response
+         *     This is the response received.
+         *
+         * @param[in] now
+         *     This is the current time, in seconds.
+         *
+         * @return
+         *     The response to give to the caller is returned.  This is
+         *     the remembered response if Discord confirmed it was still
+         *     current, or the given response otherwise.
+         */
+        Connections::Response Update(
+            const Connections::ResourceRequest& request,
+            Connections::Response&& response,
+            double now
+        );
+
+        /**
+         * Forget the responses for the given path.
+         *
+         * @param[in] path
+         *     This is the path of the resource, such as
+         *     "/guilds/1234/roles".  Queries are ignored.
+         *
+         * @param[in] includeSubpaths
+         *     This indicates whether or not to also forget responses for
+         *     paths beneath the given path.
+         */
+        void Invalidate(
+            const std::string& path,
+            bool includeSubpaths = false
+        );
+
+        /**
+         * Forget the responses for resources changed according to
+         * the given gateway event.
+         */
+        void InvalidateForEvent(
+            const std::string& eventName,
+            const Json::Value& data
+        );
+
+        Statistics GetStatistics() const;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::unique_ptr< Impl > impl_;
+    };
+
+}
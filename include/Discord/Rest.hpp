@@ -0,0 +1,172 @@
+#pragma once
+
+/**
+ * @file Rest.hpp
+ *
+ * This module declares the Discord::Rest class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Connections.hpp"
+#include "GlobalRateLimiter.hpp"
+#include "ResponseCache.hpp"
+
+#include <memory>
+#include <stddef.h>
+#include <string>
+#include <Timekeeping/Scheduler.hpp>
+
+namespace Discord {
+
+    /**
+     * This makes requests of Discord's REST API through another set of
+     * connections, holding each request back until Discord's rate limits
+     * allow it to be made.
+     *
+     * Rate limits are learned from the "X-RateLimit-*" headers of
+     * Discord's responses.  Requests are queued per bucket, where
+     * a bucket is identified by the route of the request and its major
+     * parameter (channel, guild, or webhook), or by the bucket Discord
+     * reports for the route once that is known.  Each queue is drained
+     * as fast as its bucket allows.  Requests which are rate limited
+     * anyway are made again once the limit resets, rather than
+     * the "429 Too Many Requests" response being returned.  A global
+     * "429 Too Many Requests" response pauses all requests sharing
+     * the client's global rate limiter.
+     *
+     * A GET request identical to one already queued or in progress
+     * (same URI and headers) isn't made again; it shares the response of
+     * the one in progress.  Canceling it doesn't affect the other callers
+     * sharing the response; the request is only canceled once all of
+     * them have canceled.
+     *
+     * Within each bucket, requests waiting their turn are taken
+     * in proportion to their priority: four interactive requests and
+     * two normal ones for each background one.  Background requests also
+     * leave the last request of each rate limit window to more urgent
+     * requests, so that those never wait for a window to reset behind
+     * bulk work.
+     *
+     * WebSocket requests are passed through unchanged.
+     *
+     * Only requests made through a Rest are held to these limits.
+     * Gateways, and the GatewayEndpointCache, look up the gateway URL
+     * through whatever connections they're given, so give them a Rest
+     * if that request should be limited as well.
+     *
+     * All methods are safe to call from any thread.  Each bucket has its
+     * own lock, so that requests in different buckets don't wait on each
+     * other, and no lock is held while requests are handed to the
+     * underlying connections.
+     */
+    class Rest
+        : public Connections
+    {
+        // Types
+    public:
+        /**
+         * These describe how long requests of one priority waited in
+         * their queues before being made.
+         */
+        struct QueueDelayStatistics {
+            size_t numRequests = 0;
+            double totalDelay = 0.0;
+            double maxDelay = 0.0;
+        };
+
+        // Lifecycle management
+    public:
+        ~Rest() noexcept;
+        Rest(const Rest& other) = delete;
+        Rest(Rest&&) noexcept;
+        Rest& operator=(const Rest& other) = delete;
+        Rest& operator=(Rest&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the REST client.
+         *
+         * @param[in] connections
+         *     This is used to actually make the requests.
+         */
+        explicit Rest(const std::shared_ptr< Connections >& connections);
+
+        /**
+         * Set the scheduler used to tell the time and to make requests
+         * once rate limits reset.  This must be set before requests are
+         * queued.  Without one, requests which would be held back by
+         * a rate limit are instead answered with a "429 Too Many Requests"
+         * response.
+         */
+        void SetScheduler(const std::shared_ptr< Timekeeping::Scheduler >& scheduler);
+
+        /**
+         * Set the limiter used to keep all requests made on behalf of
+         * the bot under Discord's global rate limit.  Give the same
+         * limiter to every REST client using the same bot token.
+         * By default, each REST client has its own limiter allowing
+         * 50 requests per second.
+         */
+        void SetGlobalRateLimiter(const std::shared_ptr< GlobalRateLimiter >& globalRateLimiter);
+
+        /**
+         * Set the cache in which to remember responses to GET requests,
+         * so that requests for remembered responses are answered without
+         * asking Discord, or asking only whether the response is still
+         * current.  If no cache is set, every request is made of Discord.
+         */
+        void SetResponseCache(const std::shared_ptr< ResponseCache >& responseCache);
+
+        /**
+         * Return how long requests of the given priority have waited
+         * in their queues before being made.  The figures are counted
+         * without a lock, so one taken while requests are being made
+         * may be a request behind another.
+         */
+        QueueDelayStatistics GetQueueDelayStatistics(Priority priority) const;
+
+        /**
+         * Return the route of the given request, which is its method and
+         * path with all parameters other than the major parameter
+         * replaced by placeholders, for example
+         * "GET /channels/1234/messages/{id}".
+         */
+        static std::string GetRoute(const ResourceRequest& request);
+
+        // Connections
+    public:
+        virtual ResourceRequestTransaction QueueResourceRequest(
+            const ResourceRequest& request
+        ) override;
+
+        virtual ResourceRequestTransaction QueueResourceRequest(
+            ResourceRequest&& request
+        ) override;
+
+        virtual CancelDelegate QueueResourceRequest(
+            ResourceRequest&& request,
+            ResponseDelegate&& onResponse
+        ) override;
+
+        virtual WebSocketRequestTransaction QueueWebSocketRequest(
+            const WebSocketRequest& request
+        ) override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+/**
+ * @file SimdJsonDecoder.hpp
+ *
+ * This module declares the Discord::SimdJsonDecoder class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "JsonDecoder.hpp"
+
+#include <Json/Value.hpp>
+#include <memory>
+#include <string>
+
+namespace Discord {
+
+    /**
+     * This decodes JSON text in two passes.  The first pass scans the
+     * text 64 bytes at a time, finding where its strings are and indexing
+     * the characters which give it structure (braces, brackets, colons,
+     * commas, and the starts of values), while checking that the text is
+     * valid UTF-8 without control characters in its strings.  The second
+     * pass walks the index to build the document, without having to look
+     * at most of the text again.
+     *
+     * The first pass uses SSE2 on x86-64 and NEON on AArch64, which every
+     * processor of those kinds has.  Elsewhere, or if asked to, it looks
+     * at one byte at a time instead.
+     *
+     * Decode is safe to call from any thread.
+     */
+    class SimdJsonDecoder
+        : public JsonDecoder
+    {
+        // Types
+    public:
+        /**
+         * These are the ways the first pass can be made.
+         */
+        enum class Kernel {
+            /**
+             * Use the processor's vector instructions, if the library
+             * was built for a processor which has any it can use, or
+             * else fall back to Scalar.
+             */
+            Vector,
+
+            /**
+             * Look at one byte at a time.
+             */
+            Scalar,
+        };
+
+        // Lifecycle management
+    public:
+        ~SimdJsonDecoder() noexcept;
+        SimdJsonDecoder(const SimdJsonDecoder& other) = delete;
+        SimdJsonDecoder(SimdJsonDecoder&&) noexcept;
+        SimdJsonDecoder& operator=(const SimdJsonDecoder& other) = delete;
+        SimdJsonDecoder& operator=(SimdJsonDecoder&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the decoder.
+         *
+         * @param[in] kernel
+         *     This selects how to make the first pass.
+         */
+        explicit SimdJsonDecoder(Kernel kernel = Kernel::Vector);
+
+        /**
+         * Return the way the decoder actually makes its first pass,
+         * which is Scalar if Vector was asked for but isn't available.
+         */
+        Kernel GetKernel() const;
+
+        /**
+         * Return an indication of whether or not the library was built
+         * with a Vector kernel for this processor.
+         */
+        static bool IsVectorKernelAvailable();
+
+        // JsonDecoder
+    public:
+        virtual Json::Value Decode(const std::string& encoding) override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+/**
+ * @file SocketConnections.hpp
+ *
+ * This module declares the Discord::SocketConnections class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Connections.hpp"
+
+#include <memory>
+#include <stddef.h>
+
+namespace Discord {
+
+    /**
+     * This is a reference implementation of the networking dependencies
+     * of the library, made directly on operating system sockets, with
+     * a single thread waiting on all of them through epoll.  It's only
+     * available on Linux.
+     *
+     * HTTP/1.1 connections are kept open after each response and reused
+     * for later requests to the same host and port, up to a limit on
+     * the number of connections per host.  Once that limit is reached,
+     * GET and HEAD requests are pipelined onto connections which have
+     * already shown they stay open, behind other GET and HEAD requests
+     * only.  Other requests wait for a connection to become free.
+     * A request which was lost because the server closed a reused
+     * connection is made again once, if its method is idempotent.
+     *
+     * Connections are plain TCP, so only "http" and "ws" URIs are
+     * supported; reach Discord through a local TLS-terminating proxy.
+     * Requests which get no response, because of an unsupported URI
+     * or a lost connection, are answered with status 502.
+     *
+     * All methods are safe to call from any thread.  WebSocket callbacks
+     * are called from the thread waiting on the sockets.
+     */
+    class SocketConnections
+        : public Connections
+    {
+        // Types
+    public:
+        struct Configuration {
+            size_t maxConnectionsPerHost = 4;
+
+            /**
+             * This is the most requests which may be waiting for
+             * responses on one connection at once.
+             */
+            size_t maxPipelineDepth = 4;
+
+            /**
+             * This is how long, in seconds, an HTTP connection may sit
+             * unused before it's closed.
+             */
+            double idleTimeout = 60.0;
+        };
+
+        struct Statistics {
+            size_t connectionsOpened = 0;
+
+            /**
+             * This is the number of requests sent on a connection which
+             * had already carried an earlier request.
+             */
+            size_t connectionsReused = 0;
+
+            /**
+             * This is the number of requests sent on a connection while
+             * another request was still waiting for its response there.
+             */
+            size_t requestsPipelined = 0;
+        };
+
+        // Lifecycle management
+    public:
+        ~SocketConnections() noexcept;
+        SocketConnections(const SocketConnections& other) = delete;
+        SocketConnections(SocketConnections&&) noexcept;
+        SocketConnections& operator=(const SocketConnections& other) = delete;
+        SocketConnections& operator=(SocketConnections&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the connections, starting the thread
+         * which waits on the sockets.
+         */
+        SocketConnections();
+
+        void Configure(const Configuration& configuration);
+
+        Statistics GetStatistics() const;
+
+        // Connections
+    public:
+        virtual ResourceRequestTransaction QueueResourceRequest(
+            const ResourceRequest& request
+        ) override;
+
+        virtual ResourceRequestTransaction QueueResourceRequest(
+            ResourceRequest&& request
+        ) override;
+
+        virtual CancelDelegate QueueResourceRequest(
+            ResourceRequest&& request,
+            ResponseDelegate&& onResponse
+        ) override;
+
+        virtual WebSocketRequestTransaction QueueWebSocketRequest(
+            const WebSocketRequest& request
+        ) override;
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
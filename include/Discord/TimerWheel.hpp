@@ -0,0 +1,112 @@
+#pragma once
+
+/**
+ * @file TimerWheel.hpp
+ *
+ * This module declares the Discord::TimerWheel class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <functional>
+#include <memory>
+#include <Timekeeping/Clock.hpp>
+
+namespace Discord {
+
+    /**
+     * This calls functions at scheduled times, like Timekeeping::Scheduler,
+     * but keeps the scheduled calls in a hierarchical timer wheel rather
+     * than an ordered structure, so that scheduling and canceling a call
+     * take constant time no matter how many calls are scheduled.  This
+     * makes it suitable for sharing between a large number of gateways.
+     *
+     * Due times are rounded up to the next tick of the wheel, so calls
+     * may be made up to one tick late, but never early.
+     */
+    class TimerWheel {
+        // Types
+    public:
+        using Callback = std::function< void() >;
+
+        // Lifecycle management
+    public:
+        ~TimerWheel() noexcept;
+        TimerWheel(const TimerWheel& other) = delete;
+        TimerWheel(TimerWheel&&) noexcept;
+        TimerWheel& operator=(const TimerWheel& other) = delete;
+        TimerWheel& operator=(TimerWheel&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the timer wheel and starts its thread.
+         *
+         * @param[in] tickSeconds
+         *     This is the number of seconds between ticks of the wheel.
+         *
+         * @param[in] ownThread
+         *     If this is false, the wheel has no thread of its own,
+         *     and calls are only made when Advance is called.
+         */
+        explicit TimerWheel(
+            double tickSeconds = 0.01,
+            bool ownThread = true
+        );
+
+        std::shared_ptr< Timekeeping::Clock > GetClock();
+
+        void SetClock(const std::shared_ptr< Timekeeping::Clock >& clock);
+
+        /**
+         * Arrange for the given function to be called from the thread
+         * of the timer wheel once the clock reaches the given time.
+         *
+         * @param[in] callback
+         *     This is the function to call.
+         *
+         * @param[in] due
+         *     This is the time, according to the clock, at which
+         *     to call the function.
+         *
+         * @return
+         *     A token which can be passed to Cancel is returned.
+         */
+        int Schedule(
+            Callback&& callback,
+            double due
+        );
+
+        void Cancel(int token);
+
+        /**
+         * Check the clock now, rather than waiting for the next tick,
+         * and make any calls which are due.  This is useful when the clock
+         * is not a real one.
+         */
+        void WakeUp();
+
+        /**
+         * Make any calls which are due, according to the clock, on the
+         * calling thread.  This is meant for wheels without a thread of
+         * their own, driven one tick at a time by a simulation, so that
+         * each call sees the clock at the time the call was due.
+         */
+        void Advance();
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
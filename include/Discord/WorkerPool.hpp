@@ -0,0 +1,72 @@
+#pragma once
+
+/**
+ * @file WorkerPool.hpp
+ *
+ * This module declares the Discord::WorkerPool class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <functional>
+#include <memory>
+#include <stddef.h>
+
+namespace Discord {
+
+    /**
+     * This is a fixed set of worker threads which carry out jobs
+     * given to the pool.  A pool may be shared by any number of gateways.
+     */
+    class WorkerPool {
+        // Types
+    public:
+        using Job = std::function< void() >;
+
+        // Lifecycle management
+    public:
+        /**
+         * Any jobs still waiting to be carried out are completed
+         * before the pool is destroyed.
+         */
+        ~WorkerPool() noexcept;
+        WorkerPool(const WorkerPool& other) = delete;
+        WorkerPool(WorkerPool&&) noexcept;
+        WorkerPool& operator=(const WorkerPool& other) = delete;
+        WorkerPool& operator=(WorkerPool&&) noexcept;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the pool and starts its worker threads.
+         *
+         * @param[in] numWorkers
+         *     This is the number of worker threads to start.
+         *     At least one is always started.
+         */
+        explicit WorkerPool(size_t numWorkers);
+
+        size_t GetNumWorkers() const;
+
+        /**
+         * Queue the given job to be carried out by the next available
+         * worker thread.
+         */
+        void Post(Job&& job);
+
+        // Private properties
+    private:
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance.  It is defined in the implementation
+         * and declared here to ensure that it is scoped inside the class.
+         */
+        struct Impl;
+
+        /**
+         * This contains the private properties of the instance.
+         */
+        std::shared_ptr< Impl > impl_;
+    };
+
+}
@@ -0,0 +1,64 @@
+/**
+ * @file AllocationCounter.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::AllocationCounter class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <atomic>
+#include <Discord/AllocationCounter.hpp>
+
+namespace {
+
+    /**
+     * These are the allocations made by each thread.  They're plain
+     * values, rather than anything needing construction, so that they can
+     * be counted at any point in the life of a thread, even while
+     * it's being torn down.
+     */
+    thread_local size_t threadAllocations = 0;
+    thread_local size_t threadBytes = 0;
+
+    /**
+     * This is set once the first allocation is counted.
+     */
+    std::atomic< bool > enabled(false);
+
+}
+
+namespace Discord {
+
+    AllocationCounter::AllocationCounter()
+        : start_(GetThreadCounts())
+    {
+    }
+
+    auto AllocationCounter::GetCounts() const -> Counts {
+        auto counts = GetThreadCounts();
+        counts.allocations -= start_.allocations;
+        counts.bytes -= start_.bytes;
+        return counts;
+    }
+
+    bool AllocationCounter::IsEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    auto AllocationCounter::GetThreadCounts() -> Counts {
+        Counts counts;
+        counts.allocations = threadAllocations;
+        counts.bytes = threadBytes;
+        return counts;
+    }
+
+    void AllocationCounter::CountAllocation(size_t size) {
+        ++threadAllocations;
+        threadBytes += size;
+        if (!enabled.load(std::memory_order_relaxed)) {
+            enabled.store(true, std::memory_order_relaxed);
+        }
+    }
+
+}
@@ -0,0 +1,165 @@
+/**
+ * @file AllocationHooks.cpp
+ *
+ * This module replaces the global allocation functions with ones which
+ * count each allocation with Discord::AllocationCounter before handing
+ * it off to malloc.
+ *
+ * The sized and (where the language has them) aligned forms are
+ * replaced as well, so that no allocation goes uncounted, and memory is
+ * always freed the way it was allocated.
+ *
+ * It's only built into the library if DISCORD_TRACK_ALLOCATIONS is
+ * turned on, since it replaces the allocation functions of the whole
+ * program.  The tests and benchmarks build it in directly otherwise.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <Discord/AllocationCounter.hpp>
+#include <new>
+#include <stddef.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+void* operator new(size_t size) {
+    Discord::AllocationCounter::CountAllocation(size);
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+        const auto memory = malloc(size);
+        if (memory != nullptr) {
+            return memory;
+        }
+        const auto newHandler = std::get_new_handler();
+        if (newHandler == nullptr) {
+            throw std::bad_alloc();
+        }
+        newHandler();
+    }
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    free(memory);
+}
+
+#ifdef __cpp_aligned_new
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    Discord::AllocationCounter::CountAllocation(size);
+    if (size == 0) {
+        size = 1;
+    }
+    for (;;) {
+#ifdef _WIN32
+        const auto memory = _aligned_malloc(size, (size_t)alignment);
+#else
+        void* memory = nullptr;
+        if (posix_memalign(&memory, (size_t)alignment, size) != 0) {
+            memory = nullptr;
+        }
+#endif
+        if (memory != nullptr) {
+            return memory;
+        }
+        const auto newHandler = std::get_new_handler();
+        if (newHandler == nullptr) {
+            throw std::bad_alloc();
+        }
+        newHandler();
+    }
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return operator new(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    free(memory);
+#endif
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t alignment) noexcept {
+    operator delete(memory, alignment);
+}
+
+void operator delete(void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    operator delete(memory, alignment);
+}
+
+void operator delete[](void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    operator delete(memory, alignment);
+}
+
+#endif /* __cpp_aligned_new */
@@ -0,0 +1,83 @@
+/**
+ * @file Arena.cpp
+ *
+ * This module contains the implementation of the Discord::Arena class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Arena.hpp"
+
+#include <algorithm>
+
+namespace Discord {
+
+    Arena::~Arena() noexcept = default;
+
+    Arena::Arena(size_t chunkSize)
+        : chunkSize_(std::max(chunkSize, (size_t)64))
+    {
+    }
+
+    void* Arena::Allocate(
+        size_t size,
+        size_t alignment
+    ) {
+        if (!chunks_.empty()) {
+            auto& chunk = chunks_.back();
+            const auto address = (uintptr_t)chunk.memory.get() + used_;
+            const auto padding = (alignment - (address & (alignment - 1))) & (alignment - 1);
+            if (used_ + padding + size <= chunk.size) {
+                used_ += padding;
+                const auto memory = chunk.memory.get() + used_;
+                used_ += size;
+                return memory;
+            }
+            usedInEarlierChunks_ += used_;
+        }
+
+        // Take a new chunk, at least twice as large as the last one,
+        // and large enough for the allocation.  Memory from operator new
+        // is aligned well enough for anything.
+        const auto lastChunkSize = (
+            chunks_.empty()
+            ? chunkSize_ / 2
+            : chunks_.back().size
+        );
+        Chunk chunk;
+        chunk.size = std::max(lastChunkSize * 2, size);
+        chunk.memory.reset(new char[chunk.size]);
+        chunks_.push_back(std::move(chunk));
+        used_ = size;
+        return chunks_.back().memory.get();
+    }
+
+    void Arena::Reset() {
+        if (chunks_.size() > 1) {
+            size_t totalSize = 0;
+            for (const auto& chunk: chunks_) {
+                totalSize += chunk.size;
+            }
+            chunks_.clear();
+            Chunk chunk;
+            chunk.size = totalSize;
+            chunk.memory.reset(new char[totalSize]);
+            chunks_.push_back(std::move(chunk));
+        }
+        used_ = 0;
+        usedInEarlierChunks_ = 0;
+    }
+
+    size_t Arena::GetBytesUsed() const {
+        return usedInEarlierChunks_ + used_;
+    }
+
+    size_t Arena::GetCapacity() const {
+        size_t capacity = 0;
+        for (const auto& chunk: chunks_) {
+            capacity += chunk.size;
+        }
+        return capacity;
+    }
+
+}
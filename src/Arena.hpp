@@ -0,0 +1,165 @@
+#pragma once
+
+/**
+ * @file Arena.hpp
+ *
+ * This module declares the Discord::Arena class and the allocator and
+ * containers which draw their memory from it.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace Discord {
+
+    /**
+     * This hands out memory for things which all go away together, such as
+     * the scratch structures used to decode one frame.  Memory is taken in
+     * order from a chunk, and never given back piecemeal; instead the whole
+     * arena is reset at once, which takes constant time once the arena
+     * has grown large enough for what's put in it.
+     *
+     * Nothing allocated from an arena may be used after the arena is reset.
+     * To keep something, copy it out onto the heap first; see Promote.
+     */
+    class Arena {
+        // Lifecycle management
+    public:
+        ~Arena() noexcept;
+        Arena(const Arena& other) = delete;
+        Arena(Arena&&) = delete;
+        Arena& operator=(const Arena& other) = delete;
+        Arena& operator=(Arena&&) = delete;
+
+        // Public methods
+    public:
+        /**
+         * This constructs the arena.
+         *
+         * @param[in] chunkSize
+         *     This is the number of bytes to set aside when the arena
+         *     first needs memory.
+         */
+        explicit Arena(size_t chunkSize = 4096);
+
+        /**
+         * Return memory for the given number of bytes, aligned as given,
+         * which must be a power of two.
+         */
+        void* Allocate(
+            size_t size,
+            size_t alignment
+        );
+
+        /**
+         * Forget everything allocated from the arena, so that its memory
+         * can be handed out again.  If the arena had to take more than
+         * one chunk since it was last reset, the chunks are replaced with
+         * one chunk large enough to hold them all, so that from then on
+         * resetting only rewinds.
+         */
+        void Reset();
+
+        /**
+         * Return the number of bytes handed out since the arena was
+         * last reset.
+         */
+        size_t GetBytesUsed() const;
+
+        /**
+         * Return the number of bytes the arena has set aside.
+         */
+        size_t GetCapacity() const;
+
+        // Private properties
+    private:
+        struct Chunk {
+            std::unique_ptr< char[] > memory;
+            size_t size = 0;
+        };
+
+        /**
+         * These are the chunks taken since the arena was last reset.
+         * The last one is the one memory is being handed out from.
+         */
+        std::vector< Chunk > chunks_;
+
+        /**
+         * This is the number of bytes handed out from the current chunk.
+         */
+        size_t used_ = 0;
+
+        /**
+         * This is the number of bytes handed out from chunks before
+         * the current one.
+         */
+        size_t usedInEarlierChunks_ = 0;
+
+        size_t chunkSize_;
+    };
+
+    /**
+     * This is an allocator which takes memory from an arena, for use
+     * with the standard containers.  Deallocating does nothing; the memory
+     * comes back when the arena is reset.
+     */
+    template< typename T > class ArenaAllocator {
+    public:
+        using value_type = T;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+
+        template< typename U > struct rebind {
+            using other = ArenaAllocator< U >;
+        };
+
+        explicit ArenaAllocator(Arena& arena)
+            : arena(&arena)
+        {
+        }
+
+        template< typename U > ArenaAllocator(const ArenaAllocator< U >& other)
+            : arena(other.arena)
+        {
+        }
+
+        T* allocate(size_t n) {
+            return (T*)arena->Allocate(n * sizeof(T), alignof(T));
+        }
+
+        void deallocate(T*, size_t) {
+        }
+
+        template< typename U > bool operator==(const ArenaAllocator< U >& other) const {
+            return (arena == other.arena);
+        }
+
+        template< typename U > bool operator!=(const ArenaAllocator< U >& other) const {
+            return (arena != other.arena);
+        }
+
+        Arena* arena;
+    };
+
+    using ArenaString = std::basic_string< char, std::char_traits< char >, ArenaAllocator< char > >;
+
+    template< typename T > using ArenaVector = std::vector< T, ArenaAllocator< T > >;
+
+    /**
+     * Return a copy, on the heap, of the given string from an arena,
+     * which may be kept after the arena is reset.
+     */
+    inline std::string Promote(const ArenaString& s) {
+        return std::string(s.data(), s.length());
+    }
+
+}
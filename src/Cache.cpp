@@ -0,0 +1,123 @@
+/**
+ * @file Cache.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::Cache class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <Discord/Cache.hpp>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    constexpr size_t NUM_ENTITY_KINDS = 4;
+
+    /**
+     * This holds all the entities of one guild, organized by kind
+     * and then by ID.
+     */
+    struct Guild {
+        std::unordered_map< std::string, std::string > entities[NUM_ENTITY_KINDS];
+    };
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a Cache instance.
+     */
+    struct Cache::Impl {
+        // Properties
+
+        std::unordered_map< std::string, Guild > guilds;
+        mutable std::mutex mutex;
+    };
+
+    Cache::~Cache() noexcept = default;
+    Cache::Cache(Cache&&) noexcept = default;
+    Cache& Cache::operator=(Cache&&) noexcept = default;
+
+    Cache::Cache()
+        : impl_(new Impl())
+    {
+    }
+
+    void Cache::SetEntity(
+        const std::string& guildId,
+        EntityKind kind,
+        const std::string& id,
+        std::string&& encoding
+    ) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->guilds[guildId].entities[(size_t)kind][id] = std::move(encoding);
+    }
+
+    std::string Cache::GetEntity(
+        const std::string& guildId,
+        EntityKind kind,
+        const std::string& id
+    ) const {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        const auto guildsEntry = impl_->guilds.find(guildId);
+        if (guildsEntry == impl_->guilds.end()) {
+            return "";
+        }
+        const auto& entities = guildsEntry->second.entities[(size_t)kind];
+        const auto entitiesEntry = entities.find(id);
+        if (entitiesEntry == entities.end()) {
+            return "";
+        }
+        return entitiesEntry->second;
+    }
+
+    std::vector< std::string > Cache::GetEntityIds(
+        const std::string& guildId,
+        EntityKind kind
+    ) const {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        std::vector< std::string > ids;
+        const auto guildsEntry = impl_->guilds.find(guildId);
+        if (guildsEntry != impl_->guilds.end()) {
+            const auto& entities = guildsEntry->second.entities[(size_t)kind];
+            ids.reserve(entities.size());
+            for (const auto& entity: entities) {
+                ids.push_back(entity.first);
+            }
+        }
+        return ids;
+    }
+
+    std::vector< std::string > Cache::GetGuildIds() const {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        std::vector< std::string > ids;
+        ids.reserve(impl_->guilds.size());
+        for (const auto& guild: impl_->guilds) {
+            ids.push_back(guild.first);
+        }
+        return ids;
+    }
+
+    void Cache::RemoveEntity(
+        const std::string& guildId,
+        EntityKind kind,
+        const std::string& id
+    ) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        const auto guildsEntry = impl_->guilds.find(guildId);
+        if (guildsEntry != impl_->guilds.end()) {
+            (void)guildsEntry->second.entities[(size_t)kind].erase(id);
+        }
+    }
+
+    void Cache::RemoveGuild(const std::string& guildId) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        (void)impl_->guilds.erase(guildId);
+    }
+
+}
@@ -0,0 +1,173 @@
+/**
+ * @file Capture.cpp
+ *
+ * This module contains the implementation of the Discord::Capture
+ * structure.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <Discord/Capture.hpp>
+#include <math.h>
+#include <stdint.h>
+#include <utility>
+
+namespace {
+
+    /**
+     * This begins every encoding of a capture, identifying its format
+     * and version.
+     */
+    const std::string MAGIC = "DCAP\x01";
+
+    void EncodeNumber(
+        uint64_t value,
+        std::string& encoding
+    ) {
+        while (value >= 0x80) {
+            encoding.push_back((char)((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        encoding.push_back((char)value);
+    }
+
+    void EncodeString(
+        const std::string& value,
+        std::string& encoding
+    ) {
+        EncodeNumber(value.length(), encoding);
+        encoding += value;
+    }
+
+    bool DecodeNumber(
+        const std::string& encoding,
+        size_t& offset,
+        uint64_t& value
+    ) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (offset >= encoding.length()) {
+                return false;
+            }
+            const auto byte = (uint8_t)encoding[offset++];
+            value |= ((uint64_t)(byte & 0x7F) << shift);
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool DecodeString(
+        const std::string& encoding,
+        size_t& offset,
+        std::string& value
+    ) {
+        uint64_t length;
+        if (
+            !DecodeNumber(encoding, offset, length)
+            || (length > encoding.length() - offset)
+        ) {
+            return false;
+        }
+        value = encoding.substr(offset, (size_t)length);
+        offset += (size_t)length;
+        return true;
+    }
+
+    /**
+     * Decode the frame at the given offset of the given encoding,
+     * advancing the offset past it, and advancing the given time
+     * (in microseconds) to the frame's time.
+     */
+    bool DecodeFrame(
+        const std::string& encoding,
+        size_t& offset,
+        uint64_t& time,
+        Discord::Capture::Frame& frame
+    ) {
+        uint64_t delay, connection;
+        if (
+            !DecodeNumber(encoding, offset, delay)
+            || !DecodeNumber(encoding, offset, connection)
+            || (offset >= encoding.length())
+            || ((uint8_t)encoding[offset] > (uint8_t)Discord::Capture::FrameKind::Close)
+        ) {
+            return false;
+        }
+        frame.kind = (Discord::Capture::FrameKind)encoding[offset++];
+        if (!DecodeString(encoding, offset, frame.data)) {
+            return false;
+        }
+        time += delay;
+        frame.time = (double)time / 1000000.0;
+        frame.connection = (size_t)connection;
+        return true;
+    }
+
+}
+
+namespace Discord {
+
+    std::string Capture::ToEncoding() const {
+        std::string encoding = MAGIC;
+        EncodeNumber(metadata.size(), encoding);
+        for (const auto& entry: metadata) {
+            EncodeString(entry.first, encoding);
+            EncodeString(entry.second, encoding);
+        }
+
+        // Each frame's time is given in microseconds since the frame
+        // before it, which keeps the numbers (and so their encodings)
+        // small.
+        uint64_t lastTime = 0;
+        for (const auto& frame: frames) {
+            auto time = (uint64_t)llround(fmax(frame.time, 0.0) * 1000000.0);
+            if (time < lastTime) {
+                time = lastTime;
+            }
+            EncodeNumber(time - lastTime, encoding);
+            lastTime = time;
+            EncodeNumber(frame.connection, encoding);
+            encoding.push_back((char)frame.kind);
+            EncodeString(frame.data, encoding);
+        }
+        return encoding;
+    }
+
+    bool Capture::FromEncoding(const std::string& encoding) {
+        metadata.clear();
+        frames.clear();
+        if (encoding.compare(0, MAGIC.length(), MAGIC) != 0) {
+            return false;
+        }
+        size_t offset = MAGIC.length();
+        uint64_t numMetadata;
+        if (!DecodeNumber(encoding, offset, numMetadata)) {
+            return false;
+        }
+        for (uint64_t i = 0; i < numMetadata; ++i) {
+            std::string key, value;
+            if (
+                !DecodeString(encoding, offset, key)
+                || !DecodeString(encoding, offset, value)
+            ) {
+                metadata.clear();
+                return false;
+            }
+            metadata[key] = std::move(value);
+        }
+        uint64_t time = 0;
+        while (offset < encoding.length()) {
+            Frame frame;
+            if (!DecodeFrame(encoding, offset, time, frame)) {
+                metadata.clear();
+                frames.clear();
+                return false;
+            }
+            frames.push_back(std::move(frame));
+        }
+        return true;
+    }
+
+}
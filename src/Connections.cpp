@@ -0,0 +1,50 @@
+/**
+ * @file Connections.cpp
+ *
+ * This module contains the implementation of the default methods of
+ * the Discord::Connections interface.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <Discord/Connections.hpp>
+#include <memory>
+#include <thread>
+
+namespace Discord {
+
+    auto Connections::QueueResourceRequest(
+        ResourceRequest&& request
+    ) -> ResourceRequestTransaction {
+        if (request.sharedBody != nullptr) {
+            request.body = *request.sharedBody;
+            request.sharedBody = nullptr;
+        }
+        return QueueResourceRequest(
+            static_cast< const ResourceRequest& >(request)
+        );
+    }
+
+    auto Connections::QueueResourceRequest(
+        ResourceRequest&& request,
+        ResponseDelegate&& onResponse
+    ) -> CancelDelegate {
+        auto transaction = QueueResourceRequest(std::move(request));
+        const auto response = std::make_shared< std::future< Response > >(
+            std::move(transaction.response)
+        );
+        std::thread(
+            [response, onResponse]{
+                Response handedOver;
+                try {
+                    handedOver = response->get();
+                } catch (const std::future_error&) {
+                    handedOver.status = 499;
+                }
+                onResponse(std::move(handedOver));
+            }
+        ).detach();
+        return std::move(transaction.cancel);
+    }
+
+}
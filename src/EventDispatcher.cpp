@@ -0,0 +1,188 @@
+/**
+ * @file EventDispatcher.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::EventDispatcher class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "EventKinds.hpp"
+
+#include <deque>
+#include <Discord/EventDispatcher.hpp>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+    /**
+     * This holds the events of one partition which are waiting
+     * to be handled.
+     */
+    struct Partition {
+        std::deque< Discord::Gateway::Event > events;
+
+        /**
+         * This indicates whether or not a job to handle the partition's
+         * next event has been posted to the worker pool.
+         */
+        bool scheduled = false;
+    };
+
+    std::string GetStringProperty(
+        const Json::Value& data,
+        const std::string& key
+    ) {
+        if (
+            (data.GetType() != Json::Value::Type::Object)
+            || !data.Has(key)
+        ) {
+            return "";
+        }
+        const auto& value = data[key];
+        if (value.GetType() != Json::Value::Type::String) {
+            return "";
+        }
+        return value;
+    }
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of an EventDispatcher instance.
+     */
+    struct EventDispatcher::Impl
+        : public std::enable_shared_from_this< EventDispatcher::Impl >
+    {
+        // Properties
+
+        std::mutex mutex;
+        Gateway::EventCallback onEvent;
+        std::unordered_map< std::string, Partition > partitions;
+        std::shared_ptr< WorkerPool > workerPool;
+
+        // Methods
+
+        /**
+         * Handle the next event of the given partition, and then either
+         * schedule the handling of the partition's following event, or
+         * forget the partition if it has no more events.
+         *
+         * Only one event of a partition is handled per job, so that a
+         * partition with many events waiting doesn't keep other partitions
+         * from getting a turn on the worker threads.
+         */
+        void HandleNextEvent(const std::string& partitionName) {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            auto& partition = partitions[partitionName];
+            auto event = std::move(partition.events.front());
+            partition.events.pop_front();
+            auto onEventCopy = onEvent;
+            lock.unlock();
+            const auto trace = event.trace;
+            if (trace != nullptr) {
+                trace->Stamp(EventTracer::Stage::Started);
+            }
+            if (onEventCopy != nullptr) {
+                onEventCopy(std::move(event));
+            }
+            if (trace != nullptr) {
+                trace->Stamp(EventTracer::Stage::Handled);
+            }
+            lock.lock();
+            auto partitionsEntry = partitions.find(partitionName);
+            if (partitionsEntry->second.events.empty()) {
+                (void)partitions.erase(partitionsEntry);
+            } else {
+                ScheduleNextEvent(partitionName);
+            }
+        }
+
+        void ScheduleNextEvent(const std::string& partitionName) {
+            const auto self = shared_from_this();
+            workerPool->Post(
+                [self, partitionName]{
+                    self->HandleNextEvent(partitionName);
+                }
+            );
+        }
+    };
+
+    EventDispatcher::~EventDispatcher() noexcept = default;
+    EventDispatcher::EventDispatcher(EventDispatcher&&) noexcept = default;
+    EventDispatcher& EventDispatcher::operator=(EventDispatcher&&) noexcept = default;
+
+    EventDispatcher::EventDispatcher(const std::shared_ptr< WorkerPool >& workerPool)
+        : impl_(std::make_shared< Impl >())
+    {
+        impl_->workerPool = workerPool;
+    }
+
+    std::string EventDispatcher::GetPartition(const Gateway::Event& event) {
+        const auto guildId = GetStringProperty(event.data, "guild_id");
+        if (!guildId.empty()) {
+            return "guild:" + guildId;
+        }
+
+        // Guild events which are about the guild itself carry
+        // the guild's ID as their "id".
+        const auto kind = GetEventKind(event.name);
+        switch (kind) {
+            case EventKind::GuildCreate:
+            case EventKind::GuildUpdate:
+            case EventKind::GuildDelete: {
+                const auto id = GetStringProperty(event.data, "id");
+                if (!id.empty()) {
+                    return "guild:" + id;
+                }
+            } break;
+
+            default: break;
+        }
+
+        // Anything else which isn't part of a guild might be
+        // part of a direct message channel.
+        const auto channelId = GetStringProperty(event.data, "channel_id");
+        if (!channelId.empty()) {
+            return "channel:" + channelId;
+        }
+        switch (kind) {
+            case EventKind::ChannelCreate:
+            case EventKind::ChannelUpdate:
+            case EventKind::ChannelDelete:
+            case EventKind::ChannelPinsUpdate: {
+                const auto id = GetStringProperty(event.data, "id");
+                if (!id.empty()) {
+                    return "channel:" + id;
+                }
+            } break;
+
+            default: break;
+        }
+        return "";
+    }
+
+    void EventDispatcher::RegisterEventCallback(Gateway::EventCallback&& onEvent) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->onEvent = std::move(onEvent);
+    }
+
+    void EventDispatcher::Dispatch(Gateway::Event&& event) {
+        if (event.trace != nullptr) {
+            event.trace->Stamp(EventTracer::Stage::Queued);
+        }
+        auto partitionName = GetPartition(event);
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        auto& partition = impl_->partitions[partitionName];
+        partition.events.push_back(std::move(event));
+        if (!partition.scheduled) {
+            partition.scheduled = true;
+            impl_->ScheduleNextEvent(partitionName);
+        }
+    }
+
+}
@@ -0,0 +1,250 @@
+/**
+ * @file EventKinds.cpp
+ *
+ * This module contains the implementation of the functions which
+ * look up the kinds of gateway events by name.
+ *
+ * The names are hashed with 32-bit FNV-1a, starting from a seed picked
+ * so that the top bits of the hashes of the known names all differ.
+ * The table of kinds by hash is worked out by the compiler, which also
+ * checks that the hash is still perfect.  If the known names change and
+ * it isn't, search for a new seed.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "EventKinds.hpp"
+
+#include <string.h>
+
+namespace {
+
+    /**
+     * These are the names of the known kinds of events, in the order
+     * of the Discord::EventKind enumeration.
+     */
+    constexpr const char* EVENT_NAMES[] = {
+        "READY",
+        "RESUMED",
+        "CHANNEL_CREATE",
+        "CHANNEL_UPDATE",
+        "CHANNEL_DELETE",
+        "CHANNEL_PINS_UPDATE",
+        "GUILD_CREATE",
+        "GUILD_UPDATE",
+        "GUILD_DELETE",
+        "GUILD_BAN_ADD",
+        "GUILD_BAN_REMOVE",
+        "GUILD_EMOJIS_UPDATE",
+        "GUILD_INTEGRATIONS_UPDATE",
+        "GUILD_MEMBER_ADD",
+        "GUILD_MEMBER_REMOVE",
+        "GUILD_MEMBER_UPDATE",
+        "GUILD_MEMBERS_CHUNK",
+        "GUILD_ROLE_CREATE",
+        "GUILD_ROLE_UPDATE",
+        "GUILD_ROLE_DELETE",
+        "INVITE_CREATE",
+        "INVITE_DELETE",
+        "MESSAGE_CREATE",
+        "MESSAGE_UPDATE",
+        "MESSAGE_DELETE",
+        "MESSAGE_DELETE_BULK",
+        "MESSAGE_REACTION_ADD",
+        "MESSAGE_REACTION_REMOVE",
+        "MESSAGE_REACTION_REMOVE_ALL",
+        "MESSAGE_REACTION_REMOVE_EMOJI",
+        "PRESENCE_UPDATE",
+        "TYPING_START",
+        "USER_UPDATE",
+        "VOICE_STATE_UPDATE",
+        "VOICE_SERVER_UPDATE",
+        "WEBHOOKS_UPDATE",
+    };
+    static_assert(
+        sizeof(EVENT_NAMES) / sizeof(EVENT_NAMES[0]) == Discord::NUM_KNOWN_EVENT_KINDS,
+        "there should be a name for every known kind of event"
+    );
+
+    /**
+     * This is where the hash of each name starts.
+     */
+    constexpr uint32_t HASH_SEED = 641812;
+
+    /**
+     * This is the FNV-1a multiplier for 32-bit hashes.
+     */
+    constexpr uint32_t HASH_PRIME = 16777619;
+
+    /**
+     * This is how many of the top bits of a hash pick its slot.
+     */
+    constexpr size_t SLOT_BITS = 6;
+
+    /**
+     * This is how many slots there are in the table of kinds by hash.
+     */
+    constexpr size_t NUM_SLOTS = (size_t)1 << SLOT_BITS;
+
+    constexpr uint32_t Hash(
+        const char* name,
+        size_t length,
+        uint32_t hash = HASH_SEED
+    ) {
+        return (
+            (length == 0)
+            ? hash
+            : Hash(
+                name + 1,
+                length - 1,
+                (hash ^ (uint8_t)*name) * HASH_PRIME
+            )
+        );
+    }
+
+    constexpr size_t Length(const char* name) {
+        return (*name == '\0') ? 0 : 1 + Length(name + 1);
+    }
+
+    constexpr size_t Slot(size_t kindIndex) {
+        return (size_t)(
+            Hash(
+                EVENT_NAMES[kindIndex],
+                Length(EVENT_NAMES[kindIndex])
+            ) >> (32 - SLOT_BITS)
+        );
+    }
+
+    constexpr bool CollidesWithLater(size_t kindIndex, size_t laterKindIndex) {
+        return (
+            (laterKindIndex < Discord::NUM_KNOWN_EVENT_KINDS)
+            && (
+                (Slot(kindIndex) == Slot(laterKindIndex))
+                || CollidesWithLater(kindIndex, laterKindIndex + 1)
+            )
+        );
+    }
+
+    constexpr bool IsPerfect(size_t kindIndex = 0) {
+        return (
+            (kindIndex >= Discord::NUM_KNOWN_EVENT_KINDS)
+            || (
+                !CollidesWithLater(kindIndex, kindIndex + 1)
+                && IsPerfect(kindIndex + 1)
+            )
+        );
+    }
+    static_assert(
+        IsPerfect(),
+        "the hash of event names should map each known name to its own slot"
+    );
+
+    constexpr Discord::EventKind KindForSlot(size_t slot, size_t kindIndex = 0) {
+        return (
+            (kindIndex >= Discord::NUM_KNOWN_EVENT_KINDS)
+            ? Discord::EventKind::Unknown
+            : (
+                (Slot(kindIndex) == slot)
+                ? (Discord::EventKind)kindIndex
+                : KindForSlot(slot, kindIndex + 1)
+            )
+        );
+    }
+
+    constexpr size_t MaxLength(size_t kindIndex = 0, size_t longest = 0) {
+        return (
+            (kindIndex >= Discord::NUM_KNOWN_EVENT_KINDS)
+            ? longest
+            : MaxLength(
+                kindIndex + 1,
+                (Length(EVENT_NAMES[kindIndex]) > longest)
+                ? Length(EVENT_NAMES[kindIndex])
+                : longest
+            )
+        );
+    }
+
+    /**
+     * This is the length of the longest known event name.
+     */
+    constexpr size_t MAX_EVENT_NAME_LENGTH = MaxLength();
+
+    /**
+     * These are used to have the compiler fill in tables
+     * one entry per index.
+     */
+    template< size_t... Indexes > struct IndexList {};
+    template< size_t N, size_t... Indexes > struct MakeIndexList
+        : MakeIndexList< N - 1, N - 1, Indexes... >
+    {
+    };
+    template< size_t... Indexes > struct MakeIndexList< 0, Indexes... > {
+        using Type = IndexList< Indexes... >;
+    };
+
+    /**
+     * This holds the kind of event for each slot, or Unknown
+     * for slots no known name hashes to.
+     */
+    struct SlotTable {
+        Discord::EventKind kinds[NUM_SLOTS];
+    };
+
+    template< size_t... Slots > constexpr SlotTable MakeSlotTable(IndexList< Slots... >) {
+        return SlotTable{{KindForSlot(Slots)...}};
+    }
+
+    constexpr SlotTable SLOT_TABLE = MakeSlotTable(MakeIndexList< NUM_SLOTS >::Type());
+
+    /**
+     * This holds the length of the name of each known kind of event.
+     */
+    struct LengthTable {
+        uint8_t lengths[Discord::NUM_KNOWN_EVENT_KINDS];
+    };
+
+    template< size_t... KindIndexes > constexpr LengthTable MakeLengthTable(IndexList< KindIndexes... >) {
+        return LengthTable{{(uint8_t)Length(EVENT_NAMES[KindIndexes])...}};
+    }
+
+    constexpr LengthTable LENGTH_TABLE = MakeLengthTable(
+        MakeIndexList< Discord::NUM_KNOWN_EVENT_KINDS >::Type()
+    );
+
+}
+
+namespace Discord {
+
+    EventKind GetEventKind(
+        const char* name,
+        size_t length
+    ) {
+        if (length > MAX_EVENT_NAME_LENGTH) {
+            return EventKind::Unknown;
+        }
+        const auto kind = SLOT_TABLE.kinds[Hash(name, length) >> (32 - SLOT_BITS)];
+        if (kind == EventKind::Unknown) {
+            return EventKind::Unknown;
+        }
+        const auto kindIndex = (size_t)kind;
+        if (
+            (LENGTH_TABLE.lengths[kindIndex] != length)
+            || (memcmp(EVENT_NAMES[kindIndex], name, length) != 0)
+        ) {
+            return EventKind::Unknown;
+        }
+        return kind;
+    }
+
+    EventKind GetEventKind(const std::string& name) {
+        return GetEventKind(name.data(), name.length());
+    }
+
+    const char* GetEventName(EventKind kind) {
+        if (kind >= EventKind::Unknown) {
+            return "";
+        }
+        return EVENT_NAMES[(size_t)kind];
+    }
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+/**
+ * @file EventKinds.hpp
+ *
+ * This module declares the Discord::EventKind enumeration and the
+ * functions which look up the kinds of gateway events by name.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Discord {
+
+    /**
+     * These are the kinds of dispatch events the library knows by name.
+     * Events with other names are of the Unknown kind, and are told apart
+     * by comparing their names.
+     */
+    enum class EventKind : uint8_t {
+        Ready,
+        Resumed,
+        ChannelCreate,
+        ChannelUpdate,
+        ChannelDelete,
+        ChannelPinsUpdate,
+        GuildCreate,
+        GuildUpdate,
+        GuildDelete,
+        GuildBanAdd,
+        GuildBanRemove,
+        GuildEmojisUpdate,
+        GuildIntegrationsUpdate,
+        GuildMemberAdd,
+        GuildMemberRemove,
+        GuildMemberUpdate,
+        GuildMembersChunk,
+        GuildRoleCreate,
+        GuildRoleUpdate,
+        GuildRoleDelete,
+        InviteCreate,
+        InviteDelete,
+        MessageCreate,
+        MessageUpdate,
+        MessageDelete,
+        MessageDeleteBulk,
+        MessageReactionAdd,
+        MessageReactionRemove,
+        MessageReactionRemoveAll,
+        MessageReactionRemoveEmoji,
+        PresenceUpdate,
+        TypingStart,
+        UserUpdate,
+        VoiceStateUpdate,
+        VoiceServerUpdate,
+        WebhooksUpdate,
+
+        Unknown,
+    };
+
+    /**
+     * This is the number of known kinds of events.
+     */
+    constexpr size_t NUM_KNOWN_EVENT_KINDS = (size_t)EventKind::Unknown;
+
+    /**
+     * Return the kind of event with the given name.
+     *
+     * This takes a few instructions to hash the name, with a hash
+     * which is perfect over the known names, and one comparison to
+     * make sure it's the name found.
+     */
+    EventKind GetEventKind(
+        const char* name,
+        size_t length
+    );
+
+    /**
+     * Return the kind of event with the given name.
+     */
+    EventKind GetEventKind(const std::string& name);
+
+    /**
+     * Return the name of the given kind of event, or an empty string
+     * for the Unknown kind.
+     */
+    const char* GetEventName(EventKind kind);
+
+}
@@ -0,0 +1,330 @@
+/**
+ * @file EventTracer.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::EventTracer class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <algorithm>
+#include <deque>
+#include <Discord/EventTracer.hpp>
+#include <math.h>
+#include <mutex>
+
+namespace {
+
+    using Stage = Discord::EventTracer::Stage;
+
+    constexpr size_t NUM_STAGES = (size_t)Stage::NumStages;
+
+    /**
+     * Durations are counted in buckets whose bounds are powers of two
+     * nanoseconds, each split into this many sub-buckets.
+     */
+    constexpr size_t SUB_BUCKETS = 4;
+
+    /**
+     * Durations of this many powers of two nanoseconds or more
+     * (about 18 minutes) are all counted in the last bucket.
+     */
+    constexpr size_t MAX_POWER = 40;
+
+    constexpr size_t NUM_BUCKETS = SUB_BUCKETS + (MAX_POWER - 2) * SUB_BUCKETS;
+
+    size_t GetBucket(uint64_t nanoseconds) {
+        if (nanoseconds < SUB_BUCKETS) {
+            return (size_t)nanoseconds;
+        }
+        size_t power = 2;
+        while (
+            (power < MAX_POWER)
+            && (nanoseconds >> (power + 1)) != 0
+        ) {
+            ++power;
+        }
+        if (power >= MAX_POWER) {
+            return NUM_BUCKETS - 1;
+        }
+        const auto subBucket = (size_t)((nanoseconds >> (power - 2)) & (SUB_BUCKETS - 1));
+        return SUB_BUCKETS + (power - 2) * SUB_BUCKETS + subBucket;
+    }
+
+    double ToSeconds(uint64_t nanoseconds) {
+        return (double)nanoseconds / 1000000000.0;
+    }
+
+    /**
+     * This counts durations without taking a lock, so that tracing
+     * doesn't make the threads handling events wait on each other.
+     */
+    struct AtomicHistogram {
+        std::atomic< size_t > count;
+        std::atomic< uint64_t > totalNanoseconds;
+        std::atomic< uint64_t > maxNanoseconds;
+        std::atomic< size_t > buckets[NUM_BUCKETS];
+
+        AtomicHistogram()
+            : count(0)
+            , totalNanoseconds(0)
+            , maxNanoseconds(0)
+        {
+            for (auto& bucket: buckets) {
+                bucket = 0;
+            }
+        }
+
+        void Add(uint64_t nanoseconds) {
+            ++count;
+            totalNanoseconds += nanoseconds;
+            ++buckets[GetBucket(nanoseconds)];
+            auto max = maxNanoseconds.load();
+            while (
+                (nanoseconds > max)
+                && !maxNanoseconds.compare_exchange_weak(max, nanoseconds)
+            ) {
+            }
+        }
+
+        Discord::EventTracer::Histogram Get() const {
+            Discord::EventTracer::Histogram histogram;
+            histogram.count = count;
+            histogram.totalSeconds = ToSeconds(totalNanoseconds);
+            histogram.maxSeconds = ToSeconds(maxNanoseconds);
+            histogram.buckets.reserve(NUM_BUCKETS);
+            for (const auto& bucket: buckets) {
+                histogram.buckets.push_back(bucket);
+            }
+            return histogram;
+        }
+    };
+
+    Json::Value GetHistogramReport(const Discord::EventTracer::Histogram& histogram) {
+        return Json::Object({
+            {"count", histogram.count},
+            {"mean", (
+                (histogram.count == 0)
+                ? 0.0
+                : histogram.totalSeconds / (double)histogram.count
+            )},
+            {"p50", histogram.GetPercentile(0.5)},
+            {"p99", histogram.GetPercentile(0.99)},
+            {"max", histogram.maxSeconds},
+        });
+    }
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of an EventTracer instance.
+     */
+    struct EventTracer::Impl {
+        // Properties
+
+        AtomicHistogram histograms[NUM_STAGES];
+        AtomicHistogram totalHistogram;
+        std::atomic< uint64_t > nextId{0};
+        std::atomic< size_t > sampleInterval{0};
+
+        /**
+         * This is used to synchronize access to the sampled traces.
+         */
+        std::mutex mutex;
+
+        size_t maxSampledTraces = 1000;
+        std::deque< SampledTrace > sampledTraces;
+
+        // Methods
+
+        /**
+         * Add the given finished trace to the histograms, and keep
+         * a copy of it if it was sampled.
+         */
+        void Record(const Trace& trace) {
+            const auto stagesStamped = trace.stagesStamped.load();
+            const auto isStamped = [stagesStamped](size_t stage){
+                return ((stagesStamped & (1u << stage)) != 0);
+            };
+            const auto getNanoseconds = [&trace](size_t from, size_t to){
+                const auto duration = trace.stamps[to] - trace.stamps[from];
+                if (duration.count() < 0) {
+                    return (uint64_t)0;
+                }
+                return (uint64_t)std::chrono::duration_cast< std::chrono::nanoseconds >(duration).count();
+            };
+            const auto received = (size_t)Stage::Received;
+            size_t previous = received;
+            for (size_t stage = received + 1; stage < NUM_STAGES; ++stage) {
+                if (!isStamped(stage)) {
+                    continue;
+                }
+                histograms[stage].Add(getNanoseconds(previous, stage));
+                previous = stage;
+            }
+            totalHistogram.Add(getNanoseconds(received, (size_t)Stage::Handled));
+            if (!trace.sampled) {
+                return;
+            }
+            SampledTrace sampledTrace;
+            sampledTrace.id = trace.id;
+            sampledTrace.eventName = trace.eventName;
+            sampledTrace.sequenceNumber = trace.sequenceNumber;
+            for (size_t stage = 0; stage < NUM_STAGES; ++stage) {
+                sampledTrace.secondsSinceReceived[stage] = trace.GetSecondsSinceReceived((Stage)stage);
+            }
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            if (maxSampledTraces == 0) {
+                return;
+            }
+            while (sampledTraces.size() >= maxSampledTraces) {
+                sampledTraces.pop_front();
+            }
+            sampledTraces.push_back(std::move(sampledTrace));
+        }
+    };
+
+    void EventTracer::Trace::Stamp(Stage stage) {
+        const auto bit = (1u << (unsigned int)stage);
+        if ((stagesStamped & bit) != 0) {
+            return;
+        }
+        stamps[(size_t)stage] = Clock::now();
+        stagesStamped |= bit;
+        if (stage != Stage::Handled) {
+            return;
+        }
+        const auto impl = tracer.lock();
+        if (impl != nullptr) {
+            impl->Record(*this);
+        }
+    }
+
+    bool EventTracer::Trace::IsStamped(Stage stage) const {
+        return ((stagesStamped & (1u << (unsigned int)stage)) != 0);
+    }
+
+    double EventTracer::Trace::GetSecondsSinceReceived(Stage stage) const {
+        if (
+            !IsStamped(stage)
+            || !IsStamped(Stage::Received)
+        ) {
+            return -1.0;
+        }
+        return std::chrono::duration< double >(
+            stamps[(size_t)stage] - stamps[(size_t)Stage::Received]
+        ).count();
+    }
+
+    double EventTracer::Histogram::GetPercentile(double fraction) const {
+        if (count == 0) {
+            return 0.0;
+        }
+        const auto rank = std::max(
+            (size_t)1,
+            (size_t)ceil(fraction * (double)count)
+        );
+        size_t countSoFar = 0;
+        for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+            countSoFar += buckets[bucket];
+            if (countSoFar >= rank) {
+                return std::min(GetBucketUpperBound(bucket), maxSeconds);
+            }
+        }
+        return maxSeconds;
+    }
+
+    double EventTracer::Histogram::GetBucketUpperBound(size_t bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return ToSeconds(bucket + 1);
+        }
+        if (bucket >= NUM_BUCKETS - 1) {
+            return INFINITY;
+        }
+        const auto power = (bucket - SUB_BUCKETS) / SUB_BUCKETS + 2;
+        const auto subBucket = (bucket - SUB_BUCKETS) % SUB_BUCKETS;
+        return ToSeconds((uint64_t)(SUB_BUCKETS + subBucket + 1) << (power - 2));
+    }
+
+    EventTracer::~EventTracer() noexcept = default;
+    EventTracer::EventTracer(EventTracer&&) noexcept = default;
+    EventTracer& EventTracer::operator=(EventTracer&&) noexcept = default;
+
+    EventTracer::EventTracer()
+        : impl_(std::make_shared< Impl >())
+    {
+    }
+
+    void EventTracer::SetSampling(
+        size_t sampleInterval,
+        size_t maxSampledTraces
+    ) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->sampleInterval = sampleInterval;
+        impl_->maxSampledTraces = maxSampledTraces;
+        while (impl_->sampledTraces.size() > maxSampledTraces) {
+            impl_->sampledTraces.pop_front();
+        }
+    }
+
+    auto EventTracer::StartTrace() -> std::shared_ptr< Trace > {
+        const auto trace = std::make_shared< Trace >();
+        trace->id = ++impl_->nextId;
+        const size_t sampleInterval = impl_->sampleInterval;
+        trace->sampled = (
+            (sampleInterval != 0)
+            && (trace->id % sampleInterval == 0)
+        );
+        trace->tracer = impl_;
+        trace->Stamp(Stage::Received);
+        return trace;
+    }
+
+    auto EventTracer::GetHistogram(Stage stage) const -> Histogram {
+        return impl_->histograms[(size_t)stage].Get();
+    }
+
+    auto EventTracer::GetTotalHistogram() const -> Histogram {
+        return impl_->totalHistogram.Get();
+    }
+
+    auto EventTracer::TakeSampledTraces() -> std::vector< SampledTrace > {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        std::vector< SampledTrace > sampledTraces(
+            std::make_move_iterator(impl_->sampledTraces.begin()),
+            std::make_move_iterator(impl_->sampledTraces.end())
+        );
+        impl_->sampledTraces.clear();
+        return sampledTraces;
+    }
+
+    Json::Value EventTracer::GetReport() const {
+        auto stages = Json::Object({});
+        for (size_t stage = (size_t)Stage::Received + 1; stage < NUM_STAGES; ++stage) {
+            stages.Set(
+                GetStageName((Stage)stage),
+                GetHistogramReport(GetHistogram((Stage)stage))
+            );
+        }
+        return Json::Object({
+            {"stages", std::move(stages)},
+            {"total", GetHistogramReport(GetTotalHistogram())},
+        });
+    }
+
+    std::string EventTracer::GetStageName(Stage stage) {
+        switch (stage) {
+            case Stage::Received: return "received";
+            case Stage::Locked: return "locked";
+            case Stage::Decoded: return "decoded";
+            case Stage::Applied: return "applied";
+            case Stage::Queued: return "queued";
+            case Stage::Started: return "started";
+            case Stage::Handled: return "handled";
+            default: return "";
+        }
+    }
+
+}
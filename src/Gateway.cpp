@@ -7,16 +7,430 @@
  * © 2020 by Richard Walters
  */
 
+#include "EventKinds.hpp"
+#include "GuildEntities.hpp"
+#include "JsonStream.hpp"
+#include "ProcessMemory.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <Discord/AllocationCounter.hpp>
 #include <Discord/Gateway.hpp>
+#include <functional>
 #include <future>
 #include <Json/Value.hpp>
+#include <map>
+#include <math.h>
 #include <memory>
 #include <mutex>
+#include <random>
+#include <set>
+#include <stdint.h>
+#include <stdlib.h>
 #include <StringExtensions/StringExtensions.hpp>
 #include <Timekeeping/Scheduler.hpp>
-#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+namespace {
+
+    /**
+     * This is the fractional part of the golden ratio.  Repeatedly adding
+     * it to a number and keeping only the fractional part yields numbers
+     * which are spread evenly between zero and one, however many are taken.
+     */
+    constexpr double GOLDEN_RATIO_FRACTION = 0.6180339887498949;
+
+    /**
+     * This is used to give each gateway in the process which connects with
+     * the Spread heartbeat phase a different place in the sequence of
+     * evenly spread phases.
+     */
+    std::atomic< uint64_t > nextSpreadHeartbeatPhaseIndex(1);
+
+    /**
+     * These are the lowest and highest numbers of members Discord
+     * accepts as the threshold above which it leaves offline members
+     * out of the guilds it sends.
+     */
+    constexpr size_t MIN_LARGE_THRESHOLD = 50;
+    constexpr size_t MAX_LARGE_THRESHOLD = 250;
+
+    /**
+     * This is appended to the gateway URL to form the URL
+     * of the WebSocket to open.
+     */
+    const std::string WEB_SOCKET_ENDPOINT_SUFFIX = "/?v=6&encoding=json";
+
+    double SecondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration< double >(
+            std::chrono::steady_clock::now() - start
+        ).count();
+    }
+
+    /**
+     * This is the most characters into a gateway message which
+     * SniffEventName will look for the event name.
+     */
+    constexpr size_t MAX_EVENT_NAME_SNIFF_DISTANCE = 256;
+
+    /**
+     * Quickly look for the event name near the start of the given
+     * gateway message, without parsing or copying the message.  This
+     * relies on Discord putting the event name first, so it can give up
+     * early and return false if it isn't found.
+     */
+    bool SniffEventName(
+        const std::string& message,
+        const char*& eventName,
+        size_t& eventNameLength
+    ) {
+        static const std::string eventNamePrefix = "\"t\":\"";
+        const auto sniffEnd = message.begin() + std::min(
+            message.length(),
+            MAX_EVENT_NAME_SNIFF_DISTANCE
+        );
+        const auto eventNameBegin = std::search(
+            message.begin(),
+            sniffEnd,
+            eventNamePrefix.begin(),
+            eventNamePrefix.end()
+        );
+        if (eventNameBegin == sniffEnd) {
+            return false;
+        }
+        const auto eventNameEnd = std::find(
+            eventNameBegin + eventNamePrefix.length(),
+            sniffEnd,
+            '"'
+        );
+        if (eventNameEnd == sniffEnd) {
+            return false;
+        }
+        eventName = &*eventNameBegin + eventNamePrefix.length();
+        eventNameLength = (size_t)(eventNameEnd - eventNameBegin) - eventNamePrefix.length();
+        return true;
+    }
+
+    static_assert(
+        Discord::NUM_KNOWN_EVENT_KINDS <= 64,
+        "HeavyEventFilter should have a bit for every known kind of event"
+    );
+
+    /**
+     * This tells whether or not events are among the heavy events,
+     * by kind for the known kinds of events, and by name for the rest.
+     */
+    struct HeavyEventFilter {
+        // Properties
+
+        uint64_t heavyKinds = 0;
+        std::set< std::string > heavyUnknownEvents;
+
+        // Methods
+
+        HeavyEventFilter() = default;
+
+        explicit HeavyEventFilter(const std::set< std::string >& heavyEvents) {
+            for (const auto& eventName: heavyEvents) {
+                const auto kind = Discord::GetEventKind(eventName);
+                if (kind == Discord::EventKind::Unknown) {
+                    (void)heavyUnknownEvents.insert(eventName);
+                } else {
+                    heavyKinds |= ((uint64_t)1 << (size_t)kind);
+                }
+            }
+        }
+
+        bool IsEmpty() const {
+            return (
+                (heavyKinds == 0)
+                && heavyUnknownEvents.empty()
+            );
+        }
+
+        bool Contains(
+            const char* eventName,
+            size_t eventNameLength
+        ) const {
+            const auto kind = Discord::GetEventKind(eventName, eventNameLength);
+            if (kind != Discord::EventKind::Unknown) {
+                return ((heavyKinds & ((uint64_t)1 << (size_t)kind)) != 0);
+            }
+            return (
+                !heavyUnknownEvents.empty()
+                && (
+                    heavyUnknownEvents.find(std::string(eventName, eventNameLength))
+                    != heavyUnknownEvents.end()
+                )
+            );
+        }
+
+        bool Contains(const std::string& eventName) const {
+            return Contains(eventName.data(), eventName.length());
+        }
+    };
+
+    /**
+     * Return the intents under which Discord sends events of the given
+     * kind.  Some events, such as MESSAGE_CREATE, come under one intent
+     * in guilds and another in direct messages, so both are returned.
+     */
+    uint32_t GetIntentsForEventKind(Discord::EventKind kind) {
+        using Discord::EventKind;
+        using Intent = Discord::Gateway::Intent;
+        switch (kind) {
+            case EventKind::GuildCreate:
+            case EventKind::GuildUpdate:
+            case EventKind::GuildDelete:
+            case EventKind::GuildRoleCreate:
+            case EventKind::GuildRoleUpdate:
+            case EventKind::GuildRoleDelete:
+            case EventKind::ChannelCreate:
+            case EventKind::ChannelUpdate:
+            case EventKind::ChannelDelete: {
+                return Intent::Guilds;
+            }
+
+            case EventKind::ChannelPinsUpdate: {
+                return Intent::Guilds | Intent::DirectMessages;
+            }
+
+            case EventKind::GuildMemberAdd:
+            case EventKind::GuildMemberUpdate:
+            case EventKind::GuildMemberRemove: {
+                return Intent::GuildMembers;
+            }
+
+            case EventKind::GuildBanAdd:
+            case EventKind::GuildBanRemove: {
+                return Intent::GuildBans;
+            }
+
+            case EventKind::GuildEmojisUpdate: {
+                return Intent::GuildEmojis;
+            }
+
+            case EventKind::GuildIntegrationsUpdate: {
+                return Intent::GuildIntegrations;
+            }
+
+            case EventKind::WebhooksUpdate: {
+                return Intent::GuildWebhooks;
+            }
+
+            case EventKind::InviteCreate:
+            case EventKind::InviteDelete: {
+                return Intent::GuildInvites;
+            }
+
+            case EventKind::VoiceStateUpdate: {
+                return Intent::GuildVoiceStates;
+            }
+
+            case EventKind::PresenceUpdate: {
+                return Intent::GuildPresences;
+            }
+
+            case EventKind::MessageCreate:
+            case EventKind::MessageUpdate:
+            case EventKind::MessageDelete: {
+                return Intent::GuildMessages | Intent::DirectMessages;
+            }
+
+            case EventKind::MessageDeleteBulk: {
+                return Intent::GuildMessages;
+            }
+
+            case EventKind::MessageReactionAdd:
+            case EventKind::MessageReactionRemove:
+            case EventKind::MessageReactionRemoveAll:
+            case EventKind::MessageReactionRemoveEmoji: {
+                return Intent::GuildMessageReactions | Intent::DirectMessageReactions;
+            }
+
+            case EventKind::TypingStart: {
+                return Intent::GuildMessageTyping | Intent::DirectMessageTyping;
+            }
+
+            default: {
+                return 0;
+            }
+        }
+    }
+
+    /**
+     * Return the arena in which the calling thread keeps the scratch
+     * memory it uses to decode messages.
+     */
+    Discord::Arena& GetDecodingArena() {
+        static thread_local Discord::Arena arena;
+        return arena;
+    }
+
+    /**
+     * This resets an arena when it goes out of scope.  Declare it before
+     * anything which takes memory from the arena, so that it's reset
+     * after they're gone.
+     */
+    struct ArenaResetter {
+        Discord::Arena& arena;
+
+        explicit ArenaResetter(Discord::Arena& arena)
+            : arena(arena)
+        {
+        }
+
+        ~ArenaResetter() {
+            arena.Reset();
+        }
+    };
+
+    /**
+     * This receives the parse events for a whole gateway message,
+     * picking out the opcode, sequence number, and event name, and
+     * locating the payload.  If the event name is found before the
+     * payload, and names one of the streamed events, the events for
+     * the payload are passed along to the given payload handler
+     * as the payload is parsed.
+     */
+    struct EnvelopeHandler
+        : public Discord::JsonStream::Handler
+    {
+        // Properties
+
+        size_t depth = 0;
+        std::string eventName;
+        std::string key;
+        int opcode = -1;
+        size_t payloadBegin = 0;
+        size_t payloadEnd = 0;
+        Discord::JsonStream::Handler& payloadHandler;
+        bool payloadStreamed = false;
+        bool receivedSequenceNumber = false;
+        int sequenceNumber = 0;
+        const HeavyEventFilter& streamedEvents;
+        bool streaming = false;
+
+        // Methods
+
+        EnvelopeHandler(
+            const HeavyEventFilter& streamedEvents,
+            Discord::JsonStream::Handler& payloadHandler
+        )
+            : payloadHandler(payloadHandler)
+            , streamedEvents(streamedEvents)
+        {
+        }
+
+        void BeginPayload(size_t offset) {
+            payloadBegin = offset;
+            streaming = streamedEvents.Contains(eventName);
+            payloadStreamed = streaming;
+        }
+
+        void EndPayload(size_t offset) {
+            payloadEnd = offset;
+            streaming = false;
+        }
+
+        // Discord::JsonStream::Handler
+
+        virtual void BeginObject(size_t offset) override {
+            if (
+                (depth == 1)
+                && (key == "d")
+            ) {
+                BeginPayload(offset);
+            }
+            ++depth;
+            if (streaming) {
+                payloadHandler.BeginObject(offset);
+            }
+        }
+
+        virtual void EndObject(size_t offset) override {
+            if (streaming) {
+                payloadHandler.EndObject(offset);
+            }
+            if (
+                (--depth == 1)
+                && (key == "d")
+            ) {
+                EndPayload(offset);
+            }
+        }
+
+        virtual void BeginArray(size_t offset) override {
+            if (
+                (depth == 1)
+                && (key == "d")
+            ) {
+                BeginPayload(offset);
+            }
+            ++depth;
+            if (streaming) {
+                payloadHandler.BeginArray(offset);
+            }
+        }
+
+        virtual void EndArray(size_t offset) override {
+            if (streaming) {
+                payloadHandler.EndArray(offset);
+            }
+            if (
+                (--depth == 1)
+                && (key == "d")
+            ) {
+                EndPayload(offset);
+            }
+        }
+
+        virtual void Key(const Discord::ArenaString& key) override {
+            if (streaming) {
+                payloadHandler.Key(key);
+            } else if (depth == 1) {
+                this->key.assign(key.data(), key.length());
+            }
+        }
+
+        virtual void Scalar(
+            Discord::JsonStream::ScalarType type,
+            const Discord::ArenaString& text,
+            size_t begin,
+            size_t end
+        ) override {
+            if (streaming) {
+                payloadHandler.Scalar(type, text, begin, end);
+                return;
+            }
+            if (depth != 1) {
+                return;
+            }
+            if (key == "op") {
+                if (type == Discord::JsonStream::ScalarType::Number) {
+                    opcode = (int)strtol(text.c_str(), NULL, 10);
+                }
+            } else if (key == "s") {
+                if (type == Discord::JsonStream::ScalarType::Number) {
+                    sequenceNumber = (int)strtol(text.c_str(), NULL, 10);
+                    receivedSequenceNumber = true;
+                }
+            } else if (key == "t") {
+                if (type == Discord::JsonStream::ScalarType::String) {
+                    eventName.assign(text.data(), text.length());
+                }
+            } else if (key == "d") {
+                payloadBegin = begin;
+                payloadEnd = end;
+            }
+        }
+    };
+
+}
+
 namespace Discord {
 
     /**
@@ -27,10 +441,160 @@ namespace Discord {
     {
         // Types
 
+        /**
+         * This holds a message received from the gateway, once it has been
+         * decoded, while it waits to be applied.
+         */
+        struct DecodedMessage {
+            /**
+             * This is the message as decoded, unless it is a heavy event
+             * streamed into entities for the cache.
+             */
+            Json::Value message;
+
+            /**
+             * This is the original text of the message, unless it is a heavy
+             * event streamed into entities for the cache.
+             */
+            std::string text;
+
+            /**
+             * The rest of the properties are only used for heavy events
+             * streamed into entities for the cache.
+             */
+            bool streamed = false;
+            Json::Value data;
+            std::vector< GuildEntities::Entity > entities;
+            std::string eventName;
+            std::string guildId;
+            size_t length = 0;
+            bool receivedSequenceNumber = false;
+            int sequenceNumber = 0;
+
+            std::shared_ptr< EventTracer::Trace > trace;
+        };
+
         struct DiagnosticMessage {
             size_t level = 0;
             std::string message;
         };
+
+        /**
+         * This is shared by the two attempts raced against each other
+         * during a hedged connect: one opening a WebSocket using the
+         * cached gateway URL, and the other looking up the gateway URL
+         * afresh and then opening a WebSocket using it.
+         */
+        struct HedgedConnect {
+            // Types
+
+            enum Path {
+                Cached,
+                Fresh,
+                NumPaths
+            };
+
+            struct Attempt {
+                Connections::CancelDelegate cancel;
+                bool finished = false;
+            };
+
+            // Properties
+
+            Attempt attempts[NumPaths];
+            bool cachedFailed = false;
+            bool canceled = false;
+            std::condition_variable condition;
+            std::string freshEndpoint;
+            double freshEndpointSeconds = 0.0;
+            std::mutex mutex;
+            std::shared_ptr< WebSocket > webSocket;
+            Path winner = Cached;
+
+            // Methods
+
+            /**
+             * Cancel whichever attempts have not yet finished.
+             */
+            void Cancel() {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                canceled = true;
+                for (auto& attempt: attempts) {
+                    if (
+                        !attempt.finished
+                        && (attempt.cancel != nullptr)
+                    ) {
+                        attempt.cancel();
+                    }
+                }
+                condition.notify_all();
+            }
+
+            void Finish(
+                Path path,
+                std::shared_ptr< WebSocket >&& webSocket
+            ) {
+                std::unique_lock< decltype(mutex) > lock(mutex);
+                attempts[path].finished = true;
+                if (
+                    (path == Cached)
+                    && (webSocket == nullptr)
+                    && !canceled
+                ) {
+                    cachedFailed = true;
+                }
+                if (webSocket != nullptr) {
+                    if (
+                        (this->webSocket == nullptr)
+                        && !canceled
+                    ) {
+                        this->webSocket = std::move(webSocket);
+                        winner = path;
+                    } else {
+                        // Both attempts opened a WebSocket;
+                        // we only need one.
+                        lock.unlock();
+                        webSocket->Close(1000);
+                        lock.lock();
+                    }
+                }
+                condition.notify_all();
+            }
+
+            size_t GetNumFinished() const {
+                size_t numFinished = 0;
+                for (const auto& attempt: attempts) {
+                    if (attempt.finished) {
+                        ++numFinished;
+                    }
+                }
+                return numFinished;
+            }
+
+            /**
+             * Queue a request using the given function, and make the
+             * request's cancel delegate the way to cancel the given
+             * attempt.  If the race is already over, cancel the request
+             * right away.
+             */
+            template< typename T > T Queue(
+                Path path,
+                std::function< T() > queueRequest
+            ) {
+                auto transaction = queueRequest();
+                std::unique_lock< decltype(mutex) > lock(mutex);
+                if (
+                    canceled
+                    || (webSocket != nullptr)
+                ) {
+                    lock.unlock();
+                    transaction.cancel();
+                } else {
+                    attempts[path].cancel = transaction.cancel;
+                }
+                return transaction;
+            }
+        };
         using MessageHandler = void (Impl::*)(
             Json::Value&& message,
             std::unique_lock< std::recursive_mutex >& lock
@@ -38,30 +602,177 @@ namespace Discord {
 
         // Properties
 
+        AllocationStatistics allocationStatistics;
+        bool applyingMessages = false;
+        bool awaitingGuilds = false;
         bool awaitingHello = false;
         bool disconnect = false;
+        std::shared_ptr< Cache > cache;
         Connections::CancelDelegate cancelCurrentOperation;
         bool closed = false;
         std::promise< void > closePromise;
+        Configuration configuration;
         bool connecting = false;
+
+        /**
+         * This is the trace of the message being applied, if any.
+         */
+        std::shared_ptr< EventTracer::Trace > currentTrace;
+
+        std::map< uint64_t, DecodedMessage > decodedMessages;
+        std::shared_ptr< WorkerPool > decodeWorkerPool;
+        std::shared_ptr< GatewayEndpointCache > endpointCache;
+
+        /**
+         * This is loaded and stored atomically, rather than under the
+         * mutex, so that frames can be stamped as received before the
+         * mutex is taken.
+         */
+        std::shared_ptr< EventTracer > eventTracer;
+
+        std::unordered_set< std::string > guildsAwaited;
         bool heartbeatAckReceived = false;
         double heartbeatInterval = 0.0;
         int heartbeatSchedulerToken = 0;
+
+        /**
+         * This is made from the heavy events in the configuration
+         * when connecting, and shared with the decode worker pool.
+         */
+        std::shared_ptr< const HeavyEventFilter > heavyEventFilter = std::make_shared< const HeavyEventFilter >();
+
         std::promise< void > helloPromise;
+        std::shared_ptr< JsonDecoder > jsonDecoder;
         std::recursive_mutex mutex;
+        uint64_t nextMessageNumber = 0;
+        uint64_t nextMessageNumberToApply = 0;
         CloseCallback onClose;
         DiagnosticCallback onDiagnosticMessage;
+        EventCallback onEvent;
         std::unique_ptr< std::future< void > > proceedWithConnect;
+        std::mt19937 randomGenerator = std::mt19937(std::random_device()());
         int lastSequenceNumber = 0;
         double nextHeartbeatTime = 0.0;
         bool receivedSequenceNumber = false;
+        std::shared_ptr< ResponseCache > responseCache;
         std::shared_ptr< Timekeeping::Scheduler > scheduler;
         std::vector< DiagnosticMessage > storedDiagnosticMessages;
+        std::shared_ptr< TimerWheel > timerWheel;
         std::shared_ptr< WebSocket > webSocket;
         std::string webSocketEndpoint;
 
         // Methods
 
+        void ApplyMessage(
+            DecodedMessage&& decodedMessage,
+            std::unique_lock< decltype(mutex) >& lock
+        ) {
+            // Hold on to the trace of the message, if any, for
+            // NotifyEvent to hand along with the event, if the message
+            // turns out to be one.
+            currentTrace = std::move(decodedMessage.trace);
+
+            // Heavy events were streamed straight into entities,
+            // so all that's left is to store them.
+            if (decodedMessage.streamed) {
+                if (decodedMessage.receivedSequenceNumber) {
+                    lastSequenceNumber = decodedMessage.sequenceNumber;
+                    receivedSequenceNumber = true;
+                }
+                const auto numEntities = decodedMessage.entities.size();
+                if (cache != nullptr) {
+                    GuildEntities::Store(
+                        decodedMessage.guildId,
+                        std::move(decodedMessage.entities),
+                        *cache
+                    );
+                }
+                NotifyDiagnosticMessage(
+                    0,
+                    StringExtensions::sprintf(
+                        "Streamed %s event (%zu bytes, %zu entities cached)",
+                        decodedMessage.eventName.c_str(),
+                        decodedMessage.length,
+                        numEntities
+                    ),
+                    lock
+                );
+                if (GetEventKind(decodedMessage.eventName) == EventKind::GuildCreate) {
+                    OnGuildAvailable(decodedMessage.guildId, lock);
+                }
+                Event event;
+                event.name = std::move(decodedMessage.eventName);
+                event.sequenceNumber = decodedMessage.sequenceNumber;
+                event.data = std::move(decodedMessage.data);
+                NotifyEvent(std::move(event), lock);
+                return;
+            }
+
+            // Check message JSON
+            auto& message = decodedMessage.text;
+            auto& messageJson = decodedMessage.message;
+            if (messageJson.GetType() != Json::Value::Type::Object) {
+                NotifyDiagnosticMessage(
+                    10,
+                    StringExtensions::sprintf(
+                        "Invalid text received: \"%s\"",
+                        message.c_str()
+                    ),
+                    lock
+                );
+                return;
+            }
+
+            // Report the raw message via the diagnostic message hook.
+            NotifyDiagnosticMessage(
+                0,
+                StringExtensions::sprintf(
+                    "Received text: \"%s\"",
+                    message.c_str()
+                ),
+                lock
+            );
+
+            // Dispatch based on opcode.  Opcodes are small and dense,
+            // so the handlers are simply indexed by opcode.
+            static constexpr MessageHandler messageHandlersByOpcode[] = {
+                &Impl::OnDispatch,      // 0
+                &Impl::OnHeartbeat,     // 1
+                nullptr,                // 2
+                nullptr,                // 3
+                nullptr,                // 4
+                nullptr,                // 5
+                nullptr,                // 6
+                nullptr,                // 7
+                nullptr,                // 8
+                nullptr,                // 9
+                &Impl::OnHello,         // 10
+                &Impl::OnHeartbeatAck,  // 11
+            };
+            constexpr size_t numOpcodes = (
+                sizeof(messageHandlersByOpcode)
+                / sizeof(messageHandlersByOpcode[0])
+            );
+            const int opcode = messageJson["op"];
+            const auto messageHandler = (
+                ((opcode >= 0) && ((size_t)opcode < numOpcodes))
+                ? messageHandlersByOpcode[opcode]
+                : nullptr
+            );
+            if (messageHandler == nullptr) {
+                NotifyDiagnosticMessage(
+                    5,
+                    StringExtensions::sprintf(
+                        "Received message with unknown opcode %d",
+                        opcode
+                    ),
+                    lock
+                );
+            } else {
+                (this->*messageHandler)(std::move(messageJson), lock);
+            }
+        }
+
         void AwaitHelloPromise(std::unique_lock< decltype(mutex) >& lock) {
             cancelCurrentOperation = [&]{
                 helloPromise.set_value();
@@ -112,11 +823,205 @@ namespace Discord {
             return webSocket;
         }
 
+        /**
+         * Open a WebSocket using the cached gateway URL.  If it doesn't
+         * open within the hedged connect delay, or fails, look up the
+         * gateway URL afresh and open another WebSocket using it, racing
+         * the two attempts and canceling the loser.  If the gateway has
+         * a shared cache of the gateway URL, the fresh lookup is made
+         * through it, so that hedging gateways share one lookup, and
+         * the fresh URL is shared with the rest.
+         */
+        std::shared_ptr< WebSocket > AwaitHedgedWebSocketRequest(
+            const std::shared_ptr< Connections >& connections,
+            const Configuration& configuration,
+            double& endpointSeconds,
+            std::unique_lock< decltype(mutex) >& lock
+        ) {
+            if (disconnect) {
+                return nullptr;
+            }
+            const auto hedge = std::make_shared< HedgedConnect >();
+            cancelCurrentOperation = [hedge]{ hedge->Cancel(); };
+            const auto cachedEndpoint = webSocketEndpoint;
+            const auto cachedUri = cachedEndpoint + WEB_SOCKET_ENDPOINT_SUFFIX;
+            const auto userAgent = configuration.userAgent;
+            const auto endpointCache = this->endpointCache;
+            lock.unlock();
+            auto cachedAttempt = std::async(
+                std::launch::async,
+                [hedge, connections, cachedUri]{
+                    auto transaction = hedge->Queue< Connections::WebSocketRequestTransaction >(
+                        HedgedConnect::Cached,
+                        [connections, cachedUri]{
+                            return connections->QueueWebSocketRequest({cachedUri});
+                        }
+                    );
+                    hedge->Finish(HedgedConnect::Cached, transaction.webSocket.get());
+                }
+            );
+            std::future< void > freshAttempt;
+            std::unique_lock< decltype(hedge->mutex) > hedgeLock(hedge->mutex);
+            (void)hedge->condition.wait_for(
+                hedgeLock,
+                std::chrono::duration< double >(configuration.hedgedConnectDelay),
+                [hedge]{
+                    return (
+                        hedge->canceled
+                        || hedge->attempts[HedgedConnect::Cached].finished
+                    );
+                }
+            );
+            if (
+                !hedge->canceled
+                && (hedge->webSocket == nullptr)
+            ) {
+                freshAttempt = std::async(
+                    std::launch::async,
+                    [hedge, connections, userAgent, endpointCache]{
+                        const auto start = std::chrono::steady_clock::now();
+                        std::string endpoint;
+                        if (endpointCache != nullptr) {
+                            // The cached URL may only be slow, so leave it
+                            // for others until the fresh one replaces it.
+                            auto lookup = hedge->Queue< GatewayEndpointCache::Lookup >(
+                                HedgedConnect::Fresh,
+                                [endpointCache, connections, userAgent]{
+                                    return endpointCache->GetEndpoint(connections, userAgent, true);
+                                }
+                            );
+                            endpoint = lookup.endpoint.get();
+                        } else {
+                            auto resourceTransaction = hedge->Queue< Connections::ResourceRequestTransaction >(
+                                HedgedConnect::Fresh,
+                                [connections, userAgent]{
+                                    return connections->QueueResourceRequest({
+                                        "GET",
+                                        "https://discordapp.com/api/v6/gateway",
+                                        {
+                                            {"User-Agent", userAgent},
+                                        },
+                                    });
+                                }
+                            );
+                            const auto response = resourceTransaction.response.get();
+                            if (response.status == 200) {
+                                endpoint = (std::string)Json::Value::FromEncoding(response.body)["url"];
+                            }
+                        }
+                        {
+                            std::lock_guard< decltype(hedge->mutex) > hedgeLock(hedge->mutex);
+                            hedge->attempts[HedgedConnect::Fresh].cancel = nullptr;
+                            hedge->freshEndpoint = endpoint;
+                            hedge->freshEndpointSeconds = SecondsSince(start);
+                        }
+                        if (endpoint.empty()) {
+                            hedge->Finish(HedgedConnect::Fresh, nullptr);
+                            return;
+                        }
+                        auto webSocketTransaction = hedge->Queue< Connections::WebSocketRequestTransaction >(
+                            HedgedConnect::Fresh,
+                            [connections, endpoint]{
+                                return connections->QueueWebSocketRequest({
+                                    endpoint + WEB_SOCKET_ENDPOINT_SUFFIX
+                                });
+                            }
+                        );
+                        hedge->Finish(HedgedConnect::Fresh, webSocketTransaction.webSocket.get());
+                    }
+                );
+                hedge->condition.wait(
+                    hedgeLock,
+                    [hedge]{
+                        return (
+                            hedge->canceled
+                            || (hedge->webSocket != nullptr)
+                            || (hedge->GetNumFinished() == HedgedConnect::NumPaths)
+                        );
+                    }
+                );
+            }
+            hedgeLock.unlock();
+
+            // Cancel the loser, if there is one still running,
+            // and wait for both attempts to wrap up.
+            hedge->Cancel();
+            cachedAttempt.wait();
+            if (freshAttempt.valid()) {
+                freshAttempt.wait();
+            }
+            lock.lock();
+            cancelCurrentOperation = nullptr;
+            endpointSeconds = hedge->freshEndpointSeconds;
+            // Only forget the cached URL if it actually failed, and
+            // wasn't just learned again by the fresh lookup.
+            if (
+                hedge->cachedFailed
+                && hedge->freshEndpoint.empty()
+                && (endpointCache != nullptr)
+            ) {
+                endpointCache->Invalidate(cachedEndpoint);
+            }
+            if (!hedge->freshEndpoint.empty()) {
+                webSocketEndpoint = hedge->freshEndpoint;
+            }
+            if (
+                disconnect
+                || (hedge->webSocket == nullptr)
+            ) {
+                return nullptr;
+            }
+            NotifyDiagnosticMessage(
+                1,
+                (
+                    (hedge->winner == HedgedConnect::Cached)
+                    ? "Cached gateway URL won hedged connect"
+                    : "Fresh gateway URL won hedged connect"
+                ),
+                lock
+            );
+            return hedge->webSocket;
+        }
+
+        void CancelTimer(int token) {
+            if (timerWheel != nullptr) {
+                timerWheel->Cancel(token);
+            } else {
+                scheduler->Cancel(token);
+            }
+        }
+
+        double GetCurrentTime() {
+            if (timerWheel != nullptr) {
+                return timerWheel->GetClock()->GetCurrentTime();
+            } else {
+                return scheduler->GetClock()->GetCurrentTime();
+            }
+        }
+
         std::string GetGateway(
             const std::shared_ptr< Connections >& connections,
             const std::string& userAgent,
             std::unique_lock< decltype(mutex) >& lock
         ) {
+            // If we share a cache of the WebSocket URL with other gateways,
+            // look it up through the cache, which combines our lookup with
+            // any others in progress.
+            if (endpointCache != nullptr) {
+                if (disconnect) {
+                    return "";
+                }
+                auto lookup = endpointCache->GetEndpoint(connections, userAgent);
+                cancelCurrentOperation = lookup.cancel;
+                lock.unlock();
+                const auto endpoint = lookup.endpoint.get();
+                lock.lock();
+                cancelCurrentOperation = nullptr;
+                if (disconnect) {
+                    return "";
+                }
+                return endpoint;
+            }
             const auto response = AwaitResourceRequest(
                 connections,
                 {
@@ -134,12 +1039,20 @@ namespace Discord {
             return Json::Value::FromEncoding(response.body)["url"];
         }
 
+        bool HasTimekeeping() const {
+            return (
+                (timerWheel != nullptr)
+                || (scheduler != nullptr)
+            );
+        }
+
         bool CompleteConnect(
             const std::shared_ptr< Connections >& connections,
             const Configuration& configuration,
             std::unique_lock< decltype(mutex) >& lock
         ) {
             // If told to wait before connecting, wait now.
+            const auto waitStart = std::chrono::steady_clock::now();
             if (proceedWithConnect != nullptr) {
                 decltype(proceedWithConnect) lastProceedWithConnect;
                 lastProceedWithConnect.swap(proceedWithConnect);
@@ -147,28 +1060,64 @@ namespace Discord {
                 lastProceedWithConnect.get();
                 lock.lock();
             }
+            const auto waitSeconds = SecondsSince(waitStart);
+
+            // If we share a cache of the WebSocket URL with other gateways,
+            // and it has the URL, use that rather than our own.
+            if (endpointCache != nullptr) {
+                const auto sharedEndpoint = endpointCache->GetCachedEndpoint();
+                if (!sharedEndpoint.empty()) {
+                    webSocketEndpoint = sharedEndpoint;
+                }
+            }
 
             // If we have a cache of the WebSocket URL, try to
-            // use it now to open a WebSocket.
-            static const std::string webSocketEndpointSuffix = "/?v=6&encoding=json";
+            // use it now to open a WebSocket.  In a hedged connect,
+            // this also looks up the WebSocket URL again if the cached
+            // one is slow to open.
+            const auto connectStart = std::chrono::steady_clock::now();
+            double endpointSeconds = 0.0;
+            bool hedged = false;
             if (!webSocketEndpoint.empty()) {
-                webSocket = AwaitWebSocketRequest(
-                    connections,
-                    {webSocketEndpoint + webSocketEndpointSuffix},
-                    lock
-                );
+                if (configuration.hedgedConnectDelay > 0.0) {
+                    hedged = true;
+                    webSocket = AwaitHedgedWebSocketRequest(
+                        connections,
+                        configuration,
+                        endpointSeconds,
+                        lock
+                    );
+                } else {
+                    webSocket = AwaitWebSocketRequest(
+                        connections,
+                        {webSocketEndpoint + WEB_SOCKET_ENDPOINT_SUFFIX},
+                        lock
+                    );
+                    if (
+                        !webSocket
+                        && !disconnect
+                        && (endpointCache != nullptr)
+                    ) {
+                        endpointCache->Invalidate(webSocketEndpoint);
+                    }
+                }
             }
 
             // If we don't have a WebSocket (either we didn't know the
             // URL, or the attempt to open one using a cached URL failed)
-            if (!webSocket) {
+            if (
+                !webSocket
+                && !hedged
+            ) {
                 // Use the GetGateway API to find out
                 // what the WebSocket URL is.
+                const auto endpointStart = std::chrono::steady_clock::now();
                 webSocketEndpoint = GetGateway(
                     connections,
                     configuration.userAgent,
                     lock
                 );
+                endpointSeconds = SecondsSince(endpointStart);
                 if (webSocketEndpoint.empty()) {
                     return false;
                 }
@@ -176,7 +1125,7 @@ namespace Discord {
                 // Now try to open a WebSocket.
                 webSocket = AwaitWebSocketRequest(
                     connections,
-                    {webSocketEndpoint + webSocketEndpointSuffix},
+                    {webSocketEndpoint + WEB_SOCKET_ENDPOINT_SUFFIX},
                     lock
                 );
             }
@@ -185,17 +1134,20 @@ namespace Discord {
             if (!webSocket) {
                 return false;
             }
+            const auto webSocketSeconds = SecondsSince(connectStart);
 
             // Set up to receive close events as well as text and binary
             // messages from the gateway, expecting a "hello" message from the
             // gateway immediately afterward.
             awaitingHello = true;
             helloPromise = std::promise< void >();
+            const auto helloStart = std::chrono::steady_clock::now();
             RegisterWebSocketCallbacks();
             AwaitHelloPromise(lock);
             if (disconnect) {
                 return false;
             }
+            const auto helloSeconds = SecondsSince(helloStart);
 
             // Send identify or resume message.
             SendIdentify(configuration, lock);
@@ -213,6 +1165,18 @@ namespace Discord {
                 "Connected to Discord",
                 lock
             );
+            NotifyDiagnosticMessage(
+                1,
+                StringExtensions::sprintf(
+                    "Connect timing: wait %.3lf s, WebSocket %.3lf s (gateway URL lookup %.3lf s), hello %.3lf s, total %.3lf s",
+                    waitSeconds,
+                    webSocketSeconds,
+                    endpointSeconds,
+                    helloSeconds,
+                    SecondsSince(waitStart)
+                ),
+                lock
+            );
             return true;
         }
 
@@ -220,10 +1184,10 @@ namespace Discord {
             const std::shared_ptr< Connections >& connections,
             const Configuration& configuration
         ) {
-            // Fail if no scheduler is set, or if we have a WebSocket or are in
-            // the process of connecting.
+            // Fail if no scheduler or timer wheel is set, or if we have a
+            // WebSocket or are in the process of connecting.
             if (
-                (scheduler == nullptr)
+                !HasTimekeeping()
                 || webSocket
                 || connecting
             ) {
@@ -231,6 +1195,8 @@ namespace Discord {
                 alreadyConnecting.set_value(false);
                 return alreadyConnecting.get_future();
             }
+            this->configuration = configuration;
+            heavyEventFilter = std::make_shared< const HeavyEventFilter >(configuration.heavyEvents);
             closed = false;
             closePromise = std::promise< void >();
             connecting = true;
@@ -261,6 +1227,103 @@ namespace Discord {
             return connected;
         }
 
+        /**
+         * Decode the given JSON text through the given decoder, or
+         * Json::Value::FromEncoding if there is no decoder.
+         */
+        static Json::Value DecodeJson(
+            const std::string& encoding,
+            const std::shared_ptr< JsonDecoder >& jsonDecoder
+        ) {
+            if (jsonDecoder == nullptr) {
+                return Json::Value::FromEncoding(encoding);
+            } else {
+                return jsonDecoder->Decode(encoding);
+            }
+        }
+
+        /**
+         * Decode the given message received from the gateway.  This
+         * doesn't depend on or change the state of the gateway, so that
+         * it can be done on any thread.
+         */
+        static DecodedMessage Decode(
+            std::string&& message,
+            const HeavyEventFilter& heavyEvents,
+            bool streamEntities,
+            const std::shared_ptr< JsonDecoder >& jsonDecoder
+        ) {
+            DecodedMessage decodedMessage;
+
+            // Stream heavy events straight into entities for the cache,
+            // rather than decoding them in full.  Messages whose event
+            // name can be sniffed, and isn't one of the heavy events,
+            // are left for the decoder right away, so that they aren't
+            // parsed twice.
+            const char* sniffedEventName = nullptr;
+            size_t sniffedEventNameLength = 0;
+            if (
+                streamEntities
+                && !heavyEvents.IsEmpty()
+                && (
+                    !SniffEventName(message, sniffedEventName, sniffedEventNameLength)
+                    || heavyEvents.Contains(sniffedEventName, sniffedEventNameLength)
+                )
+            ) {
+                // Parse the message, picking out the parts we need to know in
+                // order to tell what the message is.  If the event name is
+                // found before the payload, the payload will be streamed at
+                // the same time.  The parsers and handlers keep their scratch
+                // in this thread's decoding arena, which is reset once the
+                // message is decoded.
+                auto& arena = GetDecodingArena();
+                const ArenaResetter arenaResetter(arena);
+                GuildEntities::StreamHandler payloadHandler(message, arena);
+                EnvelopeHandler envelopeHandler(heavyEvents, payloadHandler);
+                if (
+                    JsonStream::Parse(
+                        message,
+                        0,
+                        message.length(),
+                        envelopeHandler,
+                        arena
+                    )
+                    && (envelopeHandler.opcode == 0)
+                    && heavyEvents.Contains(envelopeHandler.eventName)
+                    && (
+                        // If the payload came before the event name, we have
+                        // to go back and stream the payload now.
+                        envelopeHandler.payloadStreamed
+                        || JsonStream::Parse(
+                            message,
+                            envelopeHandler.payloadBegin,
+                            envelopeHandler.payloadEnd,
+                            payloadHandler,
+                            arena
+                        )
+                    )
+                ) {
+                    decodedMessage.streamed = true;
+                    decodedMessage.data = DecodeJson(
+                        payloadHandler.GetRemainder(),
+                        jsonDecoder
+                    );
+                    decodedMessage.entities = std::move(payloadHandler.GetEntities());
+                    decodedMessage.eventName = std::move(envelopeHandler.eventName);
+                    decodedMessage.guildId = payloadHandler.GetGuildId();
+                    decodedMessage.length = message.length();
+                    decodedMessage.receivedSequenceNumber = envelopeHandler.receivedSequenceNumber;
+                    decodedMessage.sequenceNumber = envelopeHandler.sequenceNumber;
+                    return decodedMessage;
+                }
+            }
+
+            // Interpret message JSON
+            decodedMessage.message = DecodeJson(message, jsonDecoder);
+            decodedMessage.text = std::move(message);
+            return decodedMessage;
+        }
+
         void Disconnect(std::unique_lock< decltype(mutex) >& lock) {
             disconnect = true;
             if (cancelCurrentOperation != nullptr) {
@@ -299,6 +1362,32 @@ namespace Discord {
             }
         }
 
+        void NotifyEvent(
+            Event&& event,
+            std::unique_lock< decltype(mutex) >& lock
+        ) {
+            const auto trace = std::move(currentTrace);
+            currentTrace = nullptr;
+            if (trace != nullptr) {
+                trace->eventName = event.name;
+                trace->sequenceNumber = event.sequenceNumber;
+                trace->Stamp(EventTracer::Stage::Applied);
+                event.trace = trace;
+            }
+            EventCallback onEvent = this->onEvent;
+            if (onEvent != nullptr) {
+                lock.unlock();
+                onEvent(std::move(event));
+                lock.lock();
+            }
+            if (
+                (trace != nullptr)
+                && !trace->IsStamped(EventTracer::Stage::Queued)
+            ) {
+                trace->Stamp(EventTracer::Stage::Handled);
+            }
+        }
+
         void NotifyDiagnosticMessage(
             size_t level,
             std::string&& message,
@@ -335,6 +1424,142 @@ namespace Discord {
             closePromise.set_value();
         }
 
+        void OnDecoded(
+            uint64_t messageNumber,
+            DecodedMessage&& decodedMessage,
+            std::unique_lock< decltype(mutex) >& lock
+        ) {
+            // In the usual case, where nothing is waiting to be applied,
+            // apply the message right away.
+            if (
+                !applyingMessages
+                && (messageNumber == nextMessageNumberToApply)
+            ) {
+                applyingMessages = true;
+                ++nextMessageNumberToApply;
+                ApplyMessage(std::move(decodedMessage), lock);
+            } else {
+                decodedMessages[messageNumber] = std::move(decodedMessage);
+                if (applyingMessages) {
+                    return;
+                }
+                applyingMessages = true;
+            }
+
+            // Apply any messages that were decoded out of order, up to the
+            // next one we're still waiting on.  The lock may be released
+            // while a message is applied, in which case more messages may be
+            // added here, so check again after each one.
+            for (;;) {
+                const auto decodedMessagesEntry = decodedMessages.begin();
+                if (
+                    (decodedMessagesEntry == decodedMessages.end())
+                    || (decodedMessagesEntry->first != nextMessageNumberToApply)
+                ) {
+                    break;
+                }
+                auto nextDecodedMessage = std::move(decodedMessagesEntry->second);
+                (void)decodedMessages.erase(decodedMessagesEntry);
+                ++nextMessageNumberToApply;
+                ApplyMessage(std::move(nextDecodedMessage), lock);
+            }
+            applyingMessages = false;
+        }
+
+        void OnDispatch(
+            Json::Value&& message,
+            std::unique_lock< decltype(mutex) >& lock
+        ) {
+            const auto& sequenceNumber = message["s"];
+            if (sequenceNumber.GetType() == Json::Value::Type::Integer) {
+                lastSequenceNumber = sequenceNumber;
+                receivedSequenceNumber = true;
+            }
+            const std::string eventName = message["t"];
+            auto& data = message["d"];
+            switch (GetEventKind(eventName)) {
+                case EventKind::Ready: {
+                    OnReady(data, lock);
+                } break;
+
+                case EventKind::GuildCreate: {
+                    if (cache != nullptr) {
+                        (void)GuildEntities::Store(data, *cache);
+                    }
+                    OnGuildAvailable(data["id"], lock);
+                } break;
+
+                case EventKind::GuildMembersChunk: {
+                    if (cache != nullptr) {
+                        (void)GuildEntities::Store(data, *cache);
+                    }
+                } break;
+
+                case EventKind::GuildDelete: {
+                    if (
+                        (cache != nullptr)
+                        && !data["unavailable"]
+                    ) {
+                        cache->RemoveGuild(data["id"]);
+                    }
+                } break;
+
+                default: break;
+            }
+            if (responseCache != nullptr) {
+                responseCache->InvalidateForEvent(eventName, data);
+            }
+            Event event;
+            event.name = eventName;
+            event.sequenceNumber = sequenceNumber;
+            event.data = std::move(data);
+            NotifyEvent(std::move(event), lock);
+        }
+
+        void OnGuildAvailable(
+            const std::string& guildId,
+            std::unique_lock< decltype(mutex) >& lock
+        ) {
+            if (!awaitingGuilds) {
+                return;
+            }
+            (void)guildsAwaited.erase(guildId);
+            if (guildsAwaited.empty()) {
+                OnReadyComplete(lock);
+            }
+        }
+
+        void OnReady(
+            const Json::Value& data,
+            std::unique_lock< decltype(mutex) >& lock
+        ) {
+            // The ready event lists the guilds which will be sent to us
+            // shortly afterwards, one guild create event per guild.
+            // Keep track of which ones we haven't received yet, so we
+            // can tell when the ready burst is complete.
+            guildsAwaited.clear();
+            const auto& guilds = data["guilds"];
+            for (size_t i = 0; i < guilds.GetSize(); ++i) {
+                (void)guildsAwaited.insert(guilds[i]["id"]);
+            }
+            awaitingGuilds = true;
+            if (guildsAwaited.empty()) {
+                OnReadyComplete(lock);
+            }
+        }
+
+        void OnReadyComplete(std::unique_lock< decltype(mutex) >& lock) {
+            awaitingGuilds = false;
+            NotifyDiagnosticMessage(
+                1,
+                StringExtensions::sprintf(
+                    "All guilds received; peak resident set size is %zu KiB",
+                    ProcessMemory::GetPeakResidentSetSize() / 1024
+                ),
+                lock
+            );
+        }
+
         void OnHeartbeat(
             Json::Value&& message,
             std::unique_lock< decltype(mutex) >& lock
@@ -406,8 +1631,43 @@ namespace Discord {
                 lock
             );
 
-            // Begin sending regular heartbeats.
-            SendHeartbeat(lock);
+            // Begin sending regular heartbeats, either now or after
+            // waiting for part of the interval, depending on the
+            // configuration.  Spread phases are anchored to the epoch of
+            // the clock, rather than to now, so that gateways which
+            // connect at the same time, such as after an outage, still
+            // beat at different times.
+            const auto phase = PickHeartbeatPhase();
+            if (phase == 0.0) {
+                // Count the interval from now, rather than from whenever
+                // the last heartbeat of any earlier connection was due.
+                nextHeartbeatTime = GetCurrentTime();
+                SendHeartbeat(lock);
+            } else {
+                UnscheduleHeartbeat();
+                heartbeatAckReceived = true;
+                const auto now = GetCurrentTime();
+                if (configuration.heartbeatPhase == HeartbeatPhase::Spread) {
+                    nextHeartbeatTime = (
+                        floor(now / heartbeatInterval) * heartbeatInterval
+                        + heartbeatInterval * phase
+                    );
+                    if (nextHeartbeatTime <= now) {
+                        nextHeartbeatTime += heartbeatInterval;
+                    }
+                } else {
+                    nextHeartbeatTime = now + heartbeatInterval * phase;
+                }
+                NotifyDiagnosticMessage(
+                    0,
+                    StringExtensions::sprintf(
+                        "First heartbeat in %lg seconds",
+                        nextHeartbeatTime - now
+                    ),
+                    lock
+                );
+                ScheduleHeartbeat();
+            }
 
             // Unblock CompleteConnect to proceed to the next step in the
             // connection process now that a hello message has been received.
@@ -416,52 +1676,102 @@ namespace Discord {
 
         void OnText(
             std::string&& message,
+            std::shared_ptr< EventTracer::Trace >&& trace,
             std::unique_lock< decltype(mutex) >& lock
         ) {
-            // Interpret message JSON
-            auto messageJson = Json::Value::FromEncoding(message);
-            if (messageJson.GetType() != Json::Value::Type::Object) {
-                NotifyDiagnosticMessage(
-                    10,
-                    StringExtensions::sprintf(
-                        "Invalid text received: \"%s\"",
-                        message.c_str()
-                    ),
-                    lock
+            // Number each message as it's received, so that messages are
+            // applied in the order received, no matter the order in which
+            // they finish being decoded.
+            const auto messageNumber = nextMessageNumber++;
+            const auto streamEntities = (cache != nullptr);
+
+            // Hand heavy events off to the decode worker pool, if any.
+            const char* eventName = nullptr;
+            size_t eventNameLength = 0;
+            if (
+                (decodeWorkerPool != nullptr)
+                && SniffEventName(message, eventName, eventNameLength)
+                && heavyEventFilter->Contains(eventName, eventNameLength)
+            ) {
+                std::weak_ptr< Impl > weakSelf(shared_from_this());
+                const auto sharedMessage = std::make_shared< std::string >(std::move(message));
+                const auto heavyEventFilter = this->heavyEventFilter;
+                const auto jsonDecoder = this->jsonDecoder;
+                decodeWorkerPool->Post(
+                    [
+                        weakSelf,
+                        messageNumber,
+                        sharedMessage,
+                        heavyEventFilter,
+                        streamEntities,
+                        jsonDecoder,
+                        trace
+                    ]{
+                        auto decodedMessage = Decode(
+                            std::move(*sharedMessage),
+                            *heavyEventFilter,
+                            streamEntities,
+                            jsonDecoder
+                        );
+                        if (trace != nullptr) {
+                            trace->Stamp(EventTracer::Stage::Decoded);
+                            decodedMessage.trace = trace;
+                        }
+                        const auto self = weakSelf.lock();
+                        if (self == nullptr) {
+                            return;
+                        }
+                        std::unique_lock< decltype(self->mutex) > lock(self->mutex);
+                        self->OnDecoded(
+                            messageNumber,
+                            std::move(decodedMessage),
+                            lock
+                        );
+                    }
                 );
                 return;
             }
 
-            // Report the raw message via the diagnostic message hook.
-            NotifyDiagnosticMessage(
-                0,
-                StringExtensions::sprintf(
-                    "Received text: \"%s\"",
-                    message.c_str()
-                ),
+            // Decode everything else right here.
+            auto decodedMessage = Decode(
+                std::move(message),
+                *heavyEventFilter,
+                streamEntities,
+                jsonDecoder
+            );
+            if (trace != nullptr) {
+                trace->Stamp(EventTracer::Stage::Decoded);
+                decodedMessage.trace = std::move(trace);
+            }
+            OnDecoded(
+                messageNumber,
+                std::move(decodedMessage),
                 lock
             );
+        }
 
-            // Dispatch based on opcode.
-            static const std::unordered_map< int, MessageHandler > messageHandlersByOpcode = {
-                {1, &Impl::OnHeartbeat},
-                {10, &Impl::OnHello},
-                {11, &Impl::OnHeartbeatAck},
-            };
-            const int opcode = messageJson["op"];
-            const auto messageHandlersByOpcodeEntry = messageHandlersByOpcode.find(opcode);
-            if (messageHandlersByOpcodeEntry == messageHandlersByOpcode.end()) {
-                NotifyDiagnosticMessage(
-                    5,
-                    StringExtensions::sprintf(
-                        "Received message with unknown opcode %d",
-                        opcode
-                    ),
-                    lock
-                );
-            } else {
-                const auto messageHandler = messageHandlersByOpcodeEntry->second;
-                (this->*messageHandler)(std::move(messageJson), lock);
+        /**
+         * Return the fraction of the heartbeat interval to wait
+         * before sending the first heartbeat.
+         */
+        double PickHeartbeatPhase() {
+            switch (configuration.heartbeatPhase) {
+                case HeartbeatPhase::Random: {
+                    return std::uniform_real_distribution< double >(0.0, 1.0)(randomGenerator);
+                }
+
+                case HeartbeatPhase::Spread: {
+                    double wholePart;
+                    return modf(
+                        (double)nextSpreadHeartbeatPhaseIndex++ * GOLDEN_RATIO_FRACTION,
+                        &wholePart
+                    );
+                }
+
+                case HeartbeatPhase::Immediate:
+                default: {
+                    return 0.0;
+                }
             }
         }
 
@@ -483,8 +1793,22 @@ namespace Discord {
                     if (self == nullptr) {
                         return;
                     }
+                    const AllocationCounter allocationCounter;
+                    std::shared_ptr< EventTracer::Trace > trace;
+                    const auto eventTracer = std::atomic_load(&self->eventTracer);
+                    if (eventTracer != nullptr) {
+                        trace = eventTracer->StartTrace();
+                    }
                     std::unique_lock< decltype(self->mutex) > lock(self->mutex);
-                    self->OnText(std::move(message), lock);
+                    if (trace != nullptr) {
+                        trace->Stamp(EventTracer::Stage::Locked);
+                    }
+                    self->OnText(std::move(message), std::move(trace), lock);
+                    const auto allocations = allocationCounter.GetCounts();
+                    auto& allocationStatistics = self->allocationStatistics;
+                    ++allocationStatistics.messages;
+                    allocationStatistics.messageAllocations += allocations.allocations;
+                    allocationStatistics.messageBytes += allocations.bytes;
                 }
             );
         }
@@ -499,6 +1823,10 @@ namespace Discord {
             }
         }
 
+        void RegisterEventCallback(EventCallback&& onEvent) {
+            this->onEvent = std::move(onEvent);
+        }
+
         void RegisterDiagnosticMessageCallback(
             DiagnosticCallback&& onDiagnosticMessage,
             std::unique_lock< decltype(mutex) >& lock
@@ -528,7 +1856,7 @@ namespace Discord {
 
         void ScheduleHeartbeat() {
             if (
-                (scheduler == nullptr)
+                !HasTimekeeping()
                 || (webSocket == nullptr)
                 || closed
                 || (heartbeatSchedulerToken != 0)
@@ -536,7 +1864,7 @@ namespace Discord {
                 return;
             }
             std::weak_ptr< Impl > weakSelf(shared_from_this());
-            heartbeatSchedulerToken = scheduler->Schedule(
+            heartbeatSchedulerToken = ScheduleTimer(
                 [weakSelf]{
                     const auto self = weakSelf.lock();
                     if (self == nullptr) {
@@ -549,6 +1877,17 @@ namespace Discord {
             );
         }
 
+        int ScheduleTimer(
+            std::function< void() >&& callback,
+            double due
+        ) {
+            if (timerWheel != nullptr) {
+                return timerWheel->Schedule(std::move(callback), due);
+            } else {
+                return scheduler->Schedule(std::move(callback), due);
+            }
+        }
+
         void SendHeartbeat(std::unique_lock< decltype(mutex) >& lock) {
             // Cancel any currently-scheduled heartbeat.
             UnscheduleHeartbeat();
@@ -562,6 +1901,8 @@ namespace Discord {
                 return;
             }
 
+            const AllocationCounter allocationCounter;
+
             // Make it clear that we have not yet received the acknowlegment
             // for this heartbeat.
             heartbeatAckReceived = false;
@@ -582,12 +1923,16 @@ namespace Discord {
             // If a heartbeat interval is set, schedule the next heartbeat.
             if (heartbeatInterval != 0.0) {
                 nextHeartbeatTime += heartbeatInterval;
-                const auto now = scheduler->GetClock()->GetCurrentTime();
+                const auto now = GetCurrentTime();
                 if (nextHeartbeatTime <= now) {
                     nextHeartbeatTime = now + heartbeatInterval;
                 }
                 ScheduleHeartbeat();
             }
+            const auto allocations = allocationCounter.GetCounts();
+            ++allocationStatistics.heartbeats;
+            allocationStatistics.heartbeatAllocations += allocations.allocations;
+            allocationStatistics.heartbeatBytes += allocations.bytes;
         }
 
         void SendIdentify(
@@ -595,17 +1940,49 @@ namespace Discord {
             std::unique_lock< decltype(mutex) >& lock
         ) {
             NotifyDiagnosticMessage(0, "Sending identify", lock);
+            auto identify = Json::Object({
+                {"token", configuration.token},
+                {"properties", Json::Object({
+                    {"$os", configuration.os},
+                    {"$browser", configuration.browser},
+                    {"$device", configuration.device},
+                })},
+            });
+            if (
+                (configuration.intents != 0)
+                || !configuration.subscribedEvents.empty()
+            ) {
+                auto intents = configuration.intents;
+                if (!configuration.subscribedEvents.empty()) {
+                    intents |= GetIntentsForEvents(configuration.subscribedEvents);
+                }
+                identify.Set("intents", (intmax_t)intents);
+            }
+            if (configuration.largeThreshold != 0) {
+                const auto largeThreshold = std::min(
+                    std::max(configuration.largeThreshold, MIN_LARGE_THRESHOLD),
+                    MAX_LARGE_THRESHOLD
+                );
+                if (largeThreshold != configuration.largeThreshold) {
+                    NotifyDiagnosticMessage(
+                        5,
+                        StringExtensions::sprintf(
+                            "Large threshold %zu is out of range; sending %zu instead",
+                            configuration.largeThreshold,
+                            largeThreshold
+                        ),
+                        lock
+                    );
+                }
+                identify.Set("large_threshold", (intmax_t)largeThreshold);
+            }
+            if (!configuration.guildSubscriptions) {
+                identify.Set("guild_subscriptions", false);
+            }
             webSocket->Text(
                 Json::Object({
                     {"op", 2},
-                    {"d", Json::Object({
-                        {"token", configuration.token},
-                        {"properties", Json::Object({
-                            {"$os", configuration.os},
-                            {"$browser", configuration.browser},
-                            {"$device", configuration.device},
-                        })},
-                    })},
+                    {"d", std::move(identify)},
                 }).ToEncoding()
             );
         }
@@ -616,12 +1993,12 @@ namespace Discord {
 
         void UnscheduleHeartbeat() {
             if (
-                (scheduler == nullptr)
+                !HasTimekeeping()
                 || (heartbeatSchedulerToken == 0)
             ) {
                 return;
             }
-            scheduler->Cancel(heartbeatSchedulerToken);
+            CancelTimer(heartbeatSchedulerToken);
             heartbeatSchedulerToken = 0;
         }
 
@@ -648,6 +2025,42 @@ namespace Discord {
         impl_->ScheduleAll();
     }
 
+    void Gateway::SetTimerWheel(const std::shared_ptr< TimerWheel >& timerWheel) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->UnscheduleAll();
+        impl_->timerWheel = timerWheel;
+        impl_->ScheduleAll();
+    }
+
+    void Gateway::SetGatewayEndpointCache(const std::shared_ptr< GatewayEndpointCache >& endpointCache) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->endpointCache = endpointCache;
+    }
+
+    void Gateway::SetEventTracer(const std::shared_ptr< EventTracer >& eventTracer) {
+        std::atomic_store(&impl_->eventTracer, eventTracer);
+    }
+
+    void Gateway::SetCache(const std::shared_ptr< Cache >& cache) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->cache = cache;
+    }
+
+    void Gateway::SetResponseCache(const std::shared_ptr< ResponseCache >& responseCache) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->responseCache = responseCache;
+    }
+
+    void Gateway::SetDecodeWorkerPool(const std::shared_ptr< WorkerPool >& decodeWorkerPool) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->decodeWorkerPool = decodeWorkerPool;
+    }
+
+    void Gateway::SetJsonDecoder(const std::shared_ptr< JsonDecoder >& jsonDecoder) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->jsonDecoder = jsonDecoder;
+    }
+
     void Gateway::WaitBeforeConnect(std::future< void >&& proceedWithConnect) {
         std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
         impl_->WaitBeforeConnect(std::move(proceedWithConnect));
@@ -666,6 +2079,11 @@ namespace Discord {
         impl_->RegisterCloseCallback(std::move(onClose), lock);
     }
 
+    void Gateway::RegisterEventCallback(EventCallback&& onEvent) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->RegisterEventCallback(std::move(onEvent));
+    }
+
     void Gateway::RegisterDiagnosticMessageCallback(DiagnosticCallback&& onDiagnosticMessage) {
         std::unique_lock< decltype(impl_->mutex) > lock(impl_->mutex);
         impl_->RegisterDiagnosticMessageCallback(std::move(onDiagnosticMessage), lock);
@@ -676,4 +2094,36 @@ namespace Discord {
         impl_->Disconnect(lock);
     }
 
+    auto Gateway::GetAllocationStatistics() const -> AllocationStatistics {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        return impl_->allocationStatistics;
+    }
+
+    uint32_t Gateway::GetIntentsForEvents(const std::set< std::string >& eventNames) {
+        uint32_t intents = Intent::Guilds;
+        for (const auto& eventName: eventNames) {
+            const auto kind = GetEventKind(eventName);
+            if (kind == EventKind::Unknown) {
+                intents |= (
+                    Intent::Guilds
+                    | Intent::GuildBans
+                    | Intent::GuildEmojis
+                    | Intent::GuildIntegrations
+                    | Intent::GuildWebhooks
+                    | Intent::GuildInvites
+                    | Intent::GuildVoiceStates
+                    | Intent::GuildMessages
+                    | Intent::GuildMessageReactions
+                    | Intent::GuildMessageTyping
+                    | Intent::DirectMessages
+                    | Intent::DirectMessageReactions
+                    | Intent::DirectMessageTyping
+                );
+            } else {
+                intents |= GetIntentsForEventKind(kind);
+            }
+        }
+        return intents;
+    }
+
 }
@@ -0,0 +1,234 @@
+/**
+ * @file GatewayEndpointCache.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::GatewayEndpointCache class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <Discord/GatewayEndpointCache.hpp>
+#include <Json/Value.hpp>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+    /**
+     * This holds the promise made to one caller waiting for
+     * a lookup in progress.
+     */
+    struct Waiter {
+        std::promise< std::string > endpoint;
+        bool done = false;
+    };
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a GatewayEndpointCache
+     * instance.
+     */
+    struct GatewayEndpointCache::Impl
+        : public std::enable_shared_from_this< GatewayEndpointCache::Impl >
+    {
+        // Properties
+
+        Connections::CancelDelegate cancelRequest;
+        std::shared_ptr< Timekeeping::Clock > clock;
+
+        /**
+         * This identifies the most recent lookup started, so that
+         * the response to one abandoned since can be told apart.
+         */
+        unsigned int currentLookupId = 0;
+
+        std::string endpoint;
+        double expiration = 0.0;
+        bool lookupInProgress = false;
+        std::mutex mutex;
+        double timeToLive = 600.0;
+        std::vector< std::shared_ptr< Waiter > > waiters;
+
+        // Methods
+
+        void CancelWaiter(const std::shared_ptr< Waiter >& waiter) {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            if (waiter->done) {
+                return;
+            }
+            waiter->done = true;
+            waiter->endpoint.set_value("");
+            waiters.erase(
+                std::remove(waiters.begin(), waiters.end(), waiter),
+                waiters.end()
+            );
+
+            // Once nobody is waiting for the lookup, abandon it, so that
+            // the next caller starts a new one rather than joining
+            // one whose result nobody will see.
+            if (
+                waiters.empty()
+                && lookupInProgress
+            ) {
+                lookupInProgress = false;
+                auto cancelRequestCopy = std::move(cancelRequest);
+                cancelRequest = nullptr;
+                lock.unlock();
+                if (cancelRequestCopy != nullptr) {
+                    cancelRequestCopy();
+                }
+            }
+        }
+
+        void CompleteLookup(
+            unsigned int lookupId,
+            const Connections::Response& response
+        ) {
+            std::string newEndpoint;
+            if (response.status == 200) {
+                newEndpoint = (std::string)Json::Value::FromEncoding(response.body)["url"];
+            }
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            if (
+                !lookupInProgress
+                || (lookupId != currentLookupId)
+            ) {
+                return;
+            }
+            lookupInProgress = false;
+            cancelRequest = nullptr;
+            if (!newEndpoint.empty()) {
+                endpoint = newEndpoint;
+                expiration = GetCurrentTime() + timeToLive;
+            }
+            for (const auto& waiter: waiters) {
+                waiter->done = true;
+                waiter->endpoint.set_value(newEndpoint);
+            }
+            waiters.clear();
+        }
+
+        double GetCurrentTime() {
+            if (clock == nullptr) {
+                return std::chrono::duration< double >(
+                    std::chrono::steady_clock::now().time_since_epoch()
+                ).count();
+            } else {
+                return clock->GetCurrentTime();
+            }
+        }
+
+        std::string GetCachedEndpoint() {
+            if (
+                !endpoint.empty()
+                && (GetCurrentTime() >= expiration)
+            ) {
+                endpoint.clear();
+            }
+            return endpoint;
+        }
+    };
+
+    GatewayEndpointCache::~GatewayEndpointCache() noexcept = default;
+    GatewayEndpointCache::GatewayEndpointCache(GatewayEndpointCache&&) noexcept = default;
+    GatewayEndpointCache& GatewayEndpointCache::operator=(GatewayEndpointCache&&) noexcept = default;
+
+    GatewayEndpointCache::GatewayEndpointCache(double timeToLive)
+        : impl_(std::make_shared< Impl >())
+    {
+        impl_->timeToLive = timeToLive;
+    }
+
+    void GatewayEndpointCache::SetClock(const std::shared_ptr< Timekeeping::Clock >& clock) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->clock = clock;
+    }
+
+    std::string GatewayEndpointCache::GetCachedEndpoint() {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        return impl_->GetCachedEndpoint();
+    }
+
+    auto GatewayEndpointCache::GetEndpoint(
+        const std::shared_ptr< Connections >& connections,
+        const std::string& userAgent,
+        bool refresh
+    ) -> Lookup {
+        std::unique_lock< decltype(impl_->mutex) > lock(impl_->mutex);
+        Lookup lookup;
+        const auto cachedEndpoint = impl_->GetCachedEndpoint();
+        if (
+            !refresh
+            && !cachedEndpoint.empty()
+        ) {
+            std::promise< std::string > endpoint;
+            endpoint.set_value(cachedEndpoint);
+            lookup.endpoint = endpoint.get_future();
+            lookup.cancel = []{};
+            return lookup;
+        }
+        const auto waiter = std::make_shared< Waiter >();
+        impl_->waiters.push_back(waiter);
+        lookup.endpoint = waiter->endpoint.get_future();
+        std::weak_ptr< Impl > weakImpl(impl_);
+        lookup.cancel = [weakImpl, waiter]{
+            const auto impl = weakImpl.lock();
+            if (impl != nullptr) {
+                impl->CancelWaiter(waiter);
+            }
+        };
+        if (impl_->lookupInProgress) {
+            return lookup;
+        }
+        impl_->lookupInProgress = true;
+        const auto lookupId = ++impl_->currentLookupId;
+
+        // Make the request without holding our lock, since the
+        // connections belong to the user, who may call back into us,
+        // and the response may even arrive before the request is queued.
+        lock.unlock();
+        const auto impl = impl_;
+        auto cancel = connections->QueueResourceRequest(
+            {
+                "GET",
+                "https://discordapp.com/api/v6/gateway",
+                {
+                    {"User-Agent", userAgent},
+                },
+            },
+            [impl, lookupId](Connections::Response&& response){
+                impl->CompleteLookup(lookupId, response);
+            }
+        );
+        lock.lock();
+        const auto abandoned = (
+            !impl_->lookupInProgress
+            || (impl_->currentLookupId != lookupId)
+        );
+        if (!abandoned) {
+            impl_->cancelRequest = cancel;
+        }
+        lock.unlock();
+
+        // If everyone waiting gave up while the request was being made,
+        // the request was abandoned before it could be canceled.
+        if (abandoned) {
+            cancel();
+        }
+        return lookup;
+    }
+
+    void GatewayEndpointCache::Invalidate(const std::string& endpoint) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        if (impl_->endpoint == endpoint) {
+            impl_->endpoint.clear();
+        }
+    }
+
+}
@@ -0,0 +1,102 @@
+/**
+ * @file GlobalRateLimiter.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::GlobalRateLimiter class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <Discord/GlobalRateLimiter.hpp>
+#include <limits>
+#include <math.h>
+#include <stdint.h>
+
+namespace {
+
+    int64_t ToMicroseconds(double seconds) {
+        return (int64_t)llround(seconds * 1e6);
+    }
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a GlobalRateLimiter instance.
+     *
+     * The limiter uses the generic cell rate algorithm: rather than
+     * counting tokens, it keeps the "theoretical arrival time", which is
+     * when the next request would be allowed if requests were spaced
+     * evenly at the sustained rate.  A request is allowed if that time
+     * is no further ahead of the present than the burst allows, and
+     * allowing it pushes that time one interval further out.  The whole
+     * state is one number, so it can be updated with a single
+     * compare-and-swap.  A pause is kept separately, so that
+     * the full burst is allowed again once it ends.
+     */
+    struct GlobalRateLimiter::Impl {
+        // Properties
+
+        int64_t interval = 20000;
+        std::atomic< int64_t > pausedUntil{std::numeric_limits< int64_t >::min()};
+        int64_t tolerance = 0;
+        std::atomic< int64_t > theoreticalArrivalTime{std::numeric_limits< int64_t >::min()};
+    };
+
+    GlobalRateLimiter::~GlobalRateLimiter() noexcept = default;
+    GlobalRateLimiter::GlobalRateLimiter(GlobalRateLimiter&&) noexcept = default;
+    GlobalRateLimiter& GlobalRateLimiter::operator=(GlobalRateLimiter&&) noexcept = default;
+
+    GlobalRateLimiter::GlobalRateLimiter(
+        double requestsPerSecond,
+        size_t burst
+    )
+        : impl_(new Impl())
+    {
+        impl_->interval = ToMicroseconds(1.0 / requestsPerSecond);
+        if (burst > 1) {
+            impl_->tolerance = impl_->interval * (int64_t)(burst - 1);
+        }
+    }
+
+    double GlobalRateLimiter::TryAcquire(double now) {
+        const auto nowMicroseconds = ToMicroseconds(now);
+        const auto pausedUntil = impl_->pausedUntil.load();
+        if (nowMicroseconds < pausedUntil) {
+            return (double)(pausedUntil - nowMicroseconds) / 1e6;
+        }
+        auto theoreticalArrivalTime = impl_->theoreticalArrivalTime.load();
+        for (;;) {
+            const auto earliest = std::max(theoreticalArrivalTime, nowMicroseconds);
+            const auto wait = earliest - impl_->tolerance - nowMicroseconds;
+            if (wait > 0) {
+                return (double)wait / 1e6;
+            }
+            if (
+                impl_->theoreticalArrivalTime.compare_exchange_weak(
+                    theoreticalArrivalTime,
+                    earliest + impl_->interval
+                )
+            ) {
+                return 0.0;
+            }
+        }
+    }
+
+    void GlobalRateLimiter::Pause(double until) {
+        const auto untilMicroseconds = ToMicroseconds(until);
+        auto pausedUntil = impl_->pausedUntil.load();
+        while (
+            (pausedUntil < untilMicroseconds)
+            && !impl_->pausedUntil.compare_exchange_weak(
+                pausedUntil,
+                untilMicroseconds
+            )
+        ) {
+        }
+    }
+
+}
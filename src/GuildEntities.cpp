@@ -0,0 +1,253 @@
+/**
+ * @file GuildEntities.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::GuildEntities functions and classes.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "GuildEntities.hpp"
+
+#include <string>
+
+namespace {
+
+    /**
+     * These are the depths, counting the payload object itself as depth 1,
+     * at which interesting parts of the payload are found.
+     */
+    constexpr size_t PAYLOAD_DEPTH = 1;
+    constexpr size_t ENTITY_ARRAY_DEPTH = 2;
+    constexpr size_t ENTITY_DEPTH = 3;
+    constexpr size_t ENTITY_USER_DEPTH = 4;
+
+    /**
+     * This describes one of the arrays of entities in the payload.
+     */
+    struct EntityArray {
+        const char* key;
+        Discord::Cache::EntityKind kind;
+        bool idInUser;
+    };
+
+    const EntityArray entityArrays[] = {
+        {"channels", Discord::Cache::EntityKind::Channel, false},
+        {"members", Discord::Cache::EntityKind::Member, true},
+        {"presences", Discord::Cache::EntityKind::Presence, true},
+        {"roles", Discord::Cache::EntityKind::Role, false},
+    };
+
+    const EntityArray* FindEntityArray(const Discord::ArenaString& key) {
+        for (const auto& entityArray: entityArrays) {
+            if (key == entityArray.key) {
+                return &entityArray;
+            }
+        }
+        return nullptr;
+    }
+
+}
+
+namespace Discord {
+
+    namespace GuildEntities {
+
+        StreamHandler::StreamHandler(
+            const std::string& encoding,
+            Arena& arena
+        )
+            : encoding_(encoding)
+            , entityArrays_(ArenaAllocator< std::pair< size_t, size_t > >(arena))
+            , entityId_(ArenaAllocator< char >(arena))
+            , keys_(ArenaAllocator< ArenaString >(arena))
+            , noKey_(ArenaAllocator< char >(arena))
+        {
+        }
+
+        std::vector< Entity >& StreamHandler::GetEntities() {
+            return entities_;
+        }
+
+        const std::string& StreamHandler::GetGuildId() const {
+            return guildId_;
+        }
+
+        std::string StreamHandler::GetRemainder() const {
+            std::string remainder;
+            auto next = payloadBegin_;
+            for (const auto& entityArray: entityArrays_) {
+                remainder.append(encoding_, next, entityArray.first - next);
+                next = entityArray.second;
+            }
+            remainder.append(encoding_, next, payloadEnd_ - next);
+            return remainder;
+        }
+
+        void StreamHandler::BeginObject(size_t offset) {
+            if (depth_++ == 0) {
+                payloadBegin_ = offset;
+            }
+            if (
+                inEntityArray_
+                && (depth_ == ENTITY_DEPTH)
+            ) {
+                entityBegin_ = offset;
+                entityId_.clear();
+            }
+        }
+
+        void StreamHandler::EndObject(size_t offset) {
+            if (
+                inEntityArray_
+                && (depth_ == ENTITY_DEPTH)
+                && !entityId_.empty()
+            ) {
+                Entity entity;
+                entity.kind = entityKind_;
+                entity.id = Promote(entityId_);
+                entity.encoding = encoding_.substr(entityBegin_, offset - entityBegin_);
+                entities_.push_back(std::move(entity));
+            }
+            if (--depth_ == 0) {
+                payloadEnd_ = offset;
+            }
+        }
+
+        void StreamHandler::BeginArray(size_t offset) {
+            if (depth_++ == 0) {
+                payloadBegin_ = offset;
+            }
+            if (depth_ == ENTITY_ARRAY_DEPTH) {
+                const auto entityArray = FindEntityArray(GetKey(PAYLOAD_DEPTH));
+                if (entityArray != nullptr) {
+                    inEntityArray_ = true;
+                    entityKind_ = entityArray->kind;
+                    entityIdInUser_ = entityArray->idInUser;
+                    entityArrays_.push_back(
+                        std::make_pair(offset + 1, offset + 1)
+                    );
+                }
+            }
+        }
+
+        void StreamHandler::EndArray(size_t offset) {
+            if (
+                inEntityArray_
+                && (depth_ == ENTITY_ARRAY_DEPTH)
+            ) {
+                inEntityArray_ = false;
+                entityArrays_.back().second = offset - 1;
+            }
+            if (--depth_ == 0) {
+                payloadEnd_ = offset;
+            }
+        }
+
+        void StreamHandler::Key(const ArenaString& key) {
+            if (keys_.size() <= depth_) {
+                keys_.resize(depth_ + 1, noKey_);
+            }
+            keys_[depth_] = key;
+        }
+
+        void StreamHandler::Scalar(
+            JsonStream::ScalarType type,
+            const ArenaString& text,
+            size_t /* begin */,
+            size_t /* end */
+        ) {
+            if (type != JsonStream::ScalarType::String) {
+                return;
+            }
+            if (depth_ == PAYLOAD_DEPTH) {
+                const auto& key = GetKey(PAYLOAD_DEPTH);
+                if (
+                    (key == "guild_id")
+                    || (
+                        (key == "id")
+                        && guildId_.empty()
+                    )
+                ) {
+                    guildId_ = Promote(text);
+                }
+            } else if (inEntityArray_) {
+                if (
+                    (
+                        !entityIdInUser_
+                        && (depth_ == ENTITY_DEPTH)
+                        && (GetKey(ENTITY_DEPTH) == "id")
+                    )
+                    || (
+                        entityIdInUser_
+                        && (depth_ == ENTITY_USER_DEPTH)
+                        && (GetKey(ENTITY_DEPTH) == "user")
+                        && (GetKey(ENTITY_USER_DEPTH) == "id")
+                    )
+                ) {
+                    entityId_ = text;
+                }
+            }
+        }
+
+        const ArenaString& StreamHandler::GetKey(size_t depth) const {
+            if (depth >= keys_.size()) {
+                return noKey_;
+            }
+            return keys_[depth];
+        }
+
+        void Store(
+            const std::string& guildId,
+            std::vector< Entity >&& entities,
+            Cache& cache
+        ) {
+            if (guildId.empty()) {
+                return;
+            }
+            for (auto& entity: entities) {
+                cache.SetEntity(
+                    guildId,
+                    entity.kind,
+                    entity.id,
+                    std::move(entity.encoding)
+                );
+            }
+        }
+
+        std::string Store(
+            const Json::Value& data,
+            Cache& cache
+        ) {
+            std::string guildId = data["guild_id"];
+            if (guildId.empty()) {
+                guildId = (std::string)data["id"];
+            }
+            if (guildId.empty()) {
+                return guildId;
+            }
+            for (const auto& entityArray: entityArrays) {
+                const auto& entities = data[entityArray.key];
+                for (size_t i = 0; i < entities.GetSize(); ++i) {
+                    const auto& entity = entities[i];
+                    const std::string id = (
+                        entityArray.idInUser
+                        ? entity["user"]["id"]
+                        : entity["id"]
+                    );
+                    if (!id.empty()) {
+                        cache.SetEntity(
+                            guildId,
+                            entityArray.kind,
+                            id,
+                            entity.ToEncoding()
+                        );
+                    }
+                }
+            }
+            return guildId;
+        }
+
+    }
+
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+/**
+ * @file GuildEntities.hpp
+ *
+ * This module declares the Discord::GuildEntities functions and classes,
+ * which are used to store the entities carried by guild-related gateway
+ * events into a Discord::Cache.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "JsonStream.hpp"
+
+#include <Discord/Cache.hpp>
+#include <Json/Value.hpp>
+#include <stddef.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Discord {
+
+    namespace GuildEntities {
+
+        /**
+         * This holds one entity picked out of an event payload,
+         * ready to be stored in a cache.
+         */
+        struct Entity {
+            Cache::EntityKind kind;
+            std::string id;
+            std::string encoding;
+        };
+
+        /**
+         * This receives the parse events for the payload of a guild
+         * create or guild members chunk event, and picks out the members,
+         * channels, roles, and presences it finds, copying each one's
+         * encoding directly from the payload, without decoding the payload
+         * into a Json::Value.
+         */
+        class StreamHandler
+            : public JsonStream::Handler
+        {
+            // Lifecycle management
+        public:
+            /**
+             * This constructs the handler.
+             *
+             * @param[in] encoding
+             *     This is the encoding of the whole message being parsed.
+             *
+             * @param[in,out] arena
+             *     This is where to put the handler's scratch memory.
+             *     The entities found are copied out of it.
+             */
+            StreamHandler(
+                const std::string& encoding,
+                Arena& arena
+            );
+
+            // Public methods
+        public:
+            /**
+             * Return the entities found.
+             */
+            std::vector< Entity >& GetEntities();
+
+            /**
+             * Return the ID of the guild whose entities were found,
+             * or an empty string if no guild ID was found.
+             */
+            const std::string& GetGuildId() const;
+
+            /**
+             * Return the encoding of the payload, with the contents of
+             * the arrays of entities removed.
+             */
+            std::string GetRemainder() const;
+
+            // JsonStream::Handler
+        public:
+            virtual void BeginObject(size_t offset) override;
+            virtual void EndObject(size_t offset) override;
+            virtual void BeginArray(size_t offset) override;
+            virtual void EndArray(size_t offset) override;
+            virtual void Key(const ArenaString& key) override;
+            virtual void Scalar(
+                JsonStream::ScalarType type,
+                const ArenaString& text,
+                size_t begin,
+                size_t end
+            ) override;
+
+            // Private methods
+        private:
+            /**
+             * Return the key most recently seen at the given depth,
+             * or an empty string if no key has been seen at that depth.
+             */
+            const ArenaString& GetKey(size_t depth) const;
+
+            // Private properties
+        private:
+            size_t depth_ = 0;
+            const std::string& encoding_;
+            std::vector< Entity > entities_;
+            ArenaVector< std::pair< size_t, size_t > > entityArrays_;
+            size_t entityBegin_ = 0;
+            ArenaString entityId_;
+            bool entityIdInUser_ = false;
+            Cache::EntityKind entityKind_ = Cache::EntityKind::Member;
+            std::string guildId_;
+            bool inEntityArray_ = false;
+            ArenaVector< ArenaString > keys_;
+
+            /**
+             * This is returned by GetKey for depths at which no key
+             * has been seen.
+             */
+            ArenaString noKey_;
+            size_t payloadBegin_ = 0;
+            size_t payloadEnd_ = 0;
+        };
+
+        /**
+         * Store the given entities of the given guild into the given cache.
+         */
+        void Store(
+            const std::string& guildId,
+            std::vector< Entity >&& entities,
+            Cache& cache
+        );
+
+        /**
+         * Store the members, channels, roles, and presences found in
+         * the given already-decoded payload of a guild create or guild
+         * members chunk event into the given cache.
+         *
+         * @return
+         *     The ID of the guild whose entities were stored is returned.
+         */
+        std::string Store(
+            const Json::Value& data,
+            Cache& cache
+        );
+
+    }
+
+}
@@ -0,0 +1,358 @@
+/**
+ * @file Headers.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::Headers class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <Discord/Headers.hpp>
+#include <utility>
+
+namespace {
+
+    /**
+     * This holds the name of a header commonly used with Discord,
+     * in lower case, along with its length.
+     */
+    struct CommonName {
+        const char* name;
+        size_t length;
+    };
+
+    template< size_t N > constexpr CommonName MakeCommonName(const char (&name)[N]) {
+        return {name, N - 1};
+    }
+
+    /**
+     * These are the names of headers commonly used with Discord,
+     * in the order of the Discord::HeaderName values identifying them.
+     */
+    constexpr CommonName COMMON_NAMES[] = {
+        MakeCommonName(""),
+        MakeCommonName("accept"),
+        MakeCommonName("accept-encoding"),
+        MakeCommonName("authorization"),
+        MakeCommonName("cache-control"),
+        MakeCommonName("connection"),
+        MakeCommonName("content-encoding"),
+        MakeCommonName("content-length"),
+        MakeCommonName("content-type"),
+        MakeCommonName("date"),
+        MakeCommonName("etag"),
+        MakeCommonName("if-modified-since"),
+        MakeCommonName("if-none-match"),
+        MakeCommonName("retry-after"),
+        MakeCommonName("transfer-encoding"),
+        MakeCommonName("user-agent"),
+        MakeCommonName("x-audit-log-reason"),
+        MakeCommonName("x-ratelimit-bucket"),
+        MakeCommonName("x-ratelimit-global"),
+        MakeCommonName("x-ratelimit-limit"),
+        MakeCommonName("x-ratelimit-remaining"),
+        MakeCommonName("x-ratelimit-reset"),
+        MakeCommonName("x-ratelimit-reset-after"),
+        MakeCommonName("x-ratelimit-scope"),
+    };
+    static_assert(
+        sizeof(COMMON_NAMES) / sizeof(COMMON_NAMES[0])
+        == (size_t)Discord::HeaderName::XRateLimitScope + 1,
+        "every HeaderName needs a common name"
+    );
+
+    /**
+     * These are used to have the compiler fill in tables
+     * one entry per index.
+     */
+    template< size_t... Indexes > struct IndexList {};
+    template< size_t N, size_t... Indexes > struct MakeIndexList
+        : MakeIndexList< N - 1, N - 1, Indexes... >
+    {
+    };
+    template< size_t... Indexes > struct MakeIndexList< 0, Indexes... > {
+        using Type = IndexList< Indexes... >;
+    };
+
+    /**
+     * This holds the lower case form of every character.  Looking
+     * characters up in it is quicker than checking whether they're
+     * upper case letters, which matters because header names are
+     * compared one character at a time.
+     */
+    struct LowerCaseTable {
+        char characters[256];
+    };
+
+    template< size_t... Characters > constexpr LowerCaseTable MakeLowerCaseTable(IndexList< Characters... >) {
+        return {{
+            (char)(
+                ((Characters >= 'A') && (Characters <= 'Z'))
+                ? (Characters - 'A' + 'a')
+                : Characters
+            )...
+        }};
+    }
+
+    constexpr LowerCaseTable LOWER_CASE = MakeLowerCaseTable(MakeIndexList< 256 >::Type());
+
+    char ToLower(char c) {
+        return LOWER_CASE.characters[(unsigned char)c];
+    }
+
+    bool EqualIgnoringCase(
+        const std::string& lhs,
+        const char* rhs,
+        size_t rhsLength
+    ) {
+        if (lhs.length() != rhsLength) {
+            return false;
+        }
+        for (size_t i = 0; i < rhsLength; ++i) {
+            if (ToLower(lhs[i]) != ToLower(rhs[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Tell whether the given header name is the given common name,
+     * which is already in lower case, so that only the header name's
+     * characters need converting.
+     */
+    bool IsCommonName(
+        const std::string& name,
+        const CommonName& commonName
+    ) {
+        if (name.length() != commonName.length) {
+            return false;
+        }
+        for (size_t i = 0; i < commonName.length; ++i) {
+            if (ToLower(name[i]) != commonName.name[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}
+
+namespace Discord {
+
+    Headers::Headers(Headers&& other) noexcept
+        : spilledHeaders_(std::move(other.spilledHeaders_))
+        , size_(other.size_)
+    {
+        for (size_t i = 0; i < INLINE_CAPACITY; ++i) {
+            inlineHeaders_[i] = std::move(other.inlineHeaders_[i]);
+        }
+        other.spilledHeaders_.clear();
+        other.size_ = 0;
+    }
+
+    Headers& Headers::operator=(Headers&& other) noexcept {
+        if (this != &other) {
+            for (size_t i = 0; i < INLINE_CAPACITY; ++i) {
+                inlineHeaders_[i] = std::move(other.inlineHeaders_[i]);
+            }
+            spilledHeaders_ = std::move(other.spilledHeaders_);
+            size_ = other.size_;
+            other.spilledHeaders_.clear();
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    Headers::Headers(std::initializer_list< Header > headers) {
+        for (const auto& header: headers) {
+            push_back(header);
+        }
+    }
+
+    Headers::Headers(const std::vector< Header >& headers) {
+        for (const auto& header: headers) {
+            push_back(header);
+        }
+    }
+
+    Headers::Headers(std::vector< Header >&& headers) {
+        for (auto& header: headers) {
+            push_back(std::move(header));
+        }
+    }
+
+    Headers::operator std::vector< Header >() const {
+        return std::vector< Header >(begin(), end());
+    }
+
+    auto Headers::begin() const -> const_iterator {
+        return GetHeaders();
+    }
+
+    auto Headers::end() const -> const_iterator {
+        return GetHeaders() + size_;
+    }
+
+    size_t Headers::size() const {
+        return size_;
+    }
+
+    bool Headers::empty() const {
+        return (size_ == 0);
+    }
+
+    const Header& Headers::operator[](size_t index) const {
+        return GetHeaders()[index];
+    }
+
+    void Headers::push_back(const Header& header) {
+        push_back(Header(header));
+    }
+
+    void Headers::push_back(Header&& header) {
+        if (size_ < INLINE_CAPACITY) {
+            inlineHeaders_[size_] = std::move(header);
+        } else {
+            if (size_ == INLINE_CAPACITY) {
+                spilledHeaders_.reserve(INLINE_CAPACITY * 2);
+                for (size_t i = 0; i < INLINE_CAPACITY; ++i) {
+                    spilledHeaders_.push_back(std::move(inlineHeaders_[i]));
+                }
+            }
+            spilledHeaders_.push_back(std::move(header));
+        }
+        ++size_;
+    }
+
+    const std::string* Headers::Find(const std::string& name) const {
+        const auto index = IndexOf(name);
+        if (index == size_) {
+            return nullptr;
+        }
+        return &GetHeaders()[index].value;
+    }
+
+    const std::string* Headers::Find(HeaderName name) const {
+        const auto index = IndexOf(name);
+        if (index == size_) {
+            return nullptr;
+        }
+        return &GetHeaders()[index].value;
+    }
+
+    std::string Headers::Get(const std::string& name) const {
+        const auto value = Find(name);
+        if (value == nullptr) {
+            return "";
+        }
+        return *value;
+    }
+
+    std::string Headers::Get(HeaderName name) const {
+        const auto value = Find(name);
+        if (value == nullptr) {
+            return "";
+        }
+        return *value;
+    }
+
+    bool Headers::Has(const std::string& name) const {
+        return (IndexOf(name) != size_);
+    }
+
+    bool Headers::Has(HeaderName name) const {
+        return (IndexOf(name) != size_);
+    }
+
+    void Headers::Set(
+        const std::string& name,
+        std::string&& value
+    ) {
+        const auto index = IndexOf(name);
+        if (index == size_) {
+            push_back({name, std::move(value)});
+            return;
+        }
+        GetHeaders()[index].value = std::move(value);
+        (void)Remove(name, index + 1);
+    }
+
+    size_t Headers::Remove(const std::string& name) {
+        return Remove(name, 0);
+    }
+
+    Header* Headers::GetHeaders() {
+        return (size_ > INLINE_CAPACITY) ? spilledHeaders_.data() : inlineHeaders_;
+    }
+
+    const Header* Headers::GetHeaders() const {
+        return (size_ > INLINE_CAPACITY) ? spilledHeaders_.data() : inlineHeaders_;
+    }
+
+    bool Headers::Matches(
+        size_t index,
+        const std::string& name
+    ) const {
+        const auto& key = GetHeaders()[index].key;
+        return EqualIgnoringCase(name, key.data(), key.length());
+    }
+
+    size_t Headers::IndexOf(
+        const std::string& name,
+        size_t start
+    ) const {
+        for (size_t i = start; i < size_; ++i) {
+            if (Matches(i, name)) {
+                return i;
+            }
+        }
+        return size_;
+    }
+
+    size_t Headers::IndexOf(HeaderName name) const {
+        if (name == HeaderName::Other) {
+            return size_;
+        }
+        const auto& commonName = COMMON_NAMES[(size_t)name];
+        const auto headers = GetHeaders();
+        for (size_t i = 0; i < size_; ++i) {
+            if (IsCommonName(headers[i].key, commonName)) {
+                return i;
+            }
+        }
+        return size_;
+    }
+
+    size_t Headers::Remove(
+        const std::string& name,
+        size_t start
+    ) {
+        const auto oldSize = size_;
+        auto headers = GetHeaders();
+        size_t newSize = start;
+        for (size_t i = start; i < oldSize; ++i) {
+            if (Matches(i, name)) {
+                continue;
+            }
+            if (newSize != i) {
+                headers[newSize] = std::move(headers[i]);
+            }
+            ++newSize;
+        }
+        if (
+            (oldSize > INLINE_CAPACITY)
+            && (newSize <= INLINE_CAPACITY)
+        ) {
+            for (size_t i = 0; i < newSize; ++i) {
+                inlineHeaders_[i] = std::move(spilledHeaders_[i]);
+            }
+            spilledHeaders_.clear();
+        } else if (newSize > INLINE_CAPACITY) {
+            spilledHeaders_.resize(newSize);
+        }
+        size_ = newSize;
+        return oldSize - newSize;
+    }
+
+}
@@ -0,0 +1,376 @@
+/**
+ * @file JsonStream.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::JsonStream functions.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "JsonStream.hpp"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * These are the things the parser can expect to find next
+     * in the JSON text.
+     */
+    enum class Expect {
+        Value,
+        FirstValueOrEnd,
+        FirstKeyOrEnd,
+        Key,
+        Colon,
+        CommaOrEnd,
+        Nothing,
+    };
+
+    bool IsWhitespace(char c) {
+        return (
+            (c == ' ')
+            || (c == '\t')
+            || (c == '\r')
+            || (c == '\n')
+        );
+    }
+
+    bool IsDigit(char c) {
+        return ((c >= '0') && (c <= '9'));
+    }
+
+    bool DecodeHexQuad(
+        const std::string& encoding,
+        size_t& p,
+        size_t end,
+        uint32_t& value
+    ) {
+        if (end - p < 4) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            const auto c = encoding[p++];
+            value <<= 4;
+            if ((c >= '0') && (c <= '9')) {
+                value += (uint32_t)(c - '0');
+            } else if ((c >= 'A') && (c <= 'F')) {
+                value += (uint32_t)(c - 'A' + 10);
+            } else if ((c >= 'a') && (c <= 'f')) {
+                value += (uint32_t)(c - 'a' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void EncodeUtf8(uint32_t codePoint, Discord::ArenaString& output) {
+        if (codePoint < 0x80) {
+            output.push_back((char)codePoint);
+        } else if (codePoint < 0x800) {
+            output.push_back((char)(0xC0 | (codePoint >> 6)));
+            output.push_back((char)(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            output.push_back((char)(0xE0 | (codePoint >> 12)));
+            output.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+            output.push_back((char)(0x80 | (codePoint & 0x3F)));
+        } else {
+            output.push_back((char)(0xF0 | (codePoint >> 18)));
+            output.push_back((char)(0x80 | ((codePoint >> 12) & 0x3F)));
+            output.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+            output.push_back((char)(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    /**
+     * Parse the JSON string starting at the given position (which must
+     * be the opening quotation mark), storing the unescaped string in
+     * the given output and advancing the position past the closing
+     * quotation mark.
+     */
+    bool ParseString(
+        const std::string& encoding,
+        size_t& p,
+        size_t end,
+        Discord::ArenaString& output
+    ) {
+        output.clear();
+        ++p;
+        while (p < end) {
+            const auto c = encoding[p++];
+            if (c == '"') {
+                return true;
+            } else if ((unsigned char)c < 0x20) {
+                return false;
+            } else if (c != '\\') {
+                output.push_back(c);
+                continue;
+            }
+            if (p >= end) {
+                return false;
+            }
+            switch (encoding[p++]) {
+                case '"': output.push_back('"'); break;
+                case '\\': output.push_back('\\'); break;
+                case '/': output.push_back('/'); break;
+                case 'b': output.push_back('\b'); break;
+                case 'f': output.push_back('\f'); break;
+                case 'n': output.push_back('\n'); break;
+                case 'r': output.push_back('\r'); break;
+                case 't': output.push_back('\t'); break;
+                case 'u': {
+                    uint32_t codePoint;
+                    if (!DecodeHexQuad(encoding, p, end, codePoint)) {
+                        return false;
+                    }
+                    if (
+                        (codePoint >= 0xD800)
+                        && (codePoint <= 0xDBFF)
+                        && (end - p >= 6)
+                        && (encoding[p] == '\\')
+                        && (encoding[p + 1] == 'u')
+                    ) {
+                        auto q = p + 2;
+                        uint32_t lowSurrogate;
+                        if (
+                            DecodeHexQuad(encoding, q, end, lowSurrogate)
+                            && (lowSurrogate >= 0xDC00)
+                            && (lowSurrogate <= 0xDFFF)
+                        ) {
+                            codePoint = (
+                                0x10000
+                                + ((codePoint - 0xD800) << 10)
+                                + (lowSurrogate - 0xDC00)
+                            );
+                            p = q;
+                        }
+                    }
+                    EncodeUtf8(codePoint, output);
+                } break;
+                default: return false;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Parse the JSON number starting at the given position,
+     * advancing the position past the end of the number.
+     */
+    bool ParseNumber(
+        const std::string& encoding,
+        size_t& p,
+        size_t end
+    ) {
+        if ((p < end) && (encoding[p] == '-')) {
+            ++p;
+        }
+        if ((p >= end) || !IsDigit(encoding[p])) {
+            return false;
+        }
+        if (encoding[p] == '0') {
+            ++p;
+        } else {
+            while ((p < end) && IsDigit(encoding[p])) {
+                ++p;
+            }
+        }
+        if ((p < end) && (encoding[p] == '.')) {
+            ++p;
+            if ((p >= end) || !IsDigit(encoding[p])) {
+                return false;
+            }
+            while ((p < end) && IsDigit(encoding[p])) {
+                ++p;
+            }
+        }
+        if (
+            (p < end)
+            && (
+                (encoding[p] == 'e')
+                || (encoding[p] == 'E')
+            )
+        ) {
+            ++p;
+            if (
+                (p < end)
+                && (
+                    (encoding[p] == '+')
+                    || (encoding[p] == '-')
+                )
+            ) {
+                ++p;
+            }
+            if ((p >= end) || !IsDigit(encoding[p])) {
+                return false;
+            }
+            while ((p < end) && IsDigit(encoding[p])) {
+                ++p;
+            }
+        }
+        return true;
+    }
+
+    bool MatchLiteral(
+        const std::string& encoding,
+        size_t& p,
+        size_t end,
+        const std::string& literal
+    ) {
+        if (
+            (end - p < literal.length())
+            || (encoding.compare(p, literal.length(), literal) != 0)
+        ) {
+            return false;
+        }
+        p += literal.length();
+        return true;
+    }
+
+}
+
+namespace Discord {
+
+    namespace JsonStream {
+
+        bool Parse(
+            const std::string& encoding,
+            size_t begin,
+            size_t end,
+            Handler& handler,
+            Arena& arena
+        ) {
+            if (end > encoding.length()) {
+                end = encoding.length();
+            }
+            ArenaVector< char > containers{ArenaAllocator< char >(arena)};
+            ArenaString text{ArenaAllocator< char >(arena)};
+            auto expect = Expect::Value;
+            const auto afterValue = [&containers]{
+                return (
+                    containers.empty()
+                    ? Expect::Nothing
+                    : Expect::CommaOrEnd
+                );
+            };
+            auto p = begin;
+            while (p < end) {
+                const auto c = encoding[p];
+                if (IsWhitespace(c)) {
+                    ++p;
+                    continue;
+                }
+                switch (expect) {
+                    case Expect::FirstKeyOrEnd: {
+                        if (c == '}') {
+                            containers.pop_back();
+                            handler.EndObject(++p);
+                            expect = afterValue();
+                            break;
+                        }
+                    }   // fall through
+                    case Expect::Key: {
+                        if (
+                            (c != '"')
+                            || !ParseString(encoding, p, end, text)
+                        ) {
+                            return false;
+                        }
+                        handler.Key(text);
+                        expect = Expect::Colon;
+                    } break;
+
+                    case Expect::Colon: {
+                        if (c != ':') {
+                            return false;
+                        }
+                        ++p;
+                        expect = Expect::Value;
+                    } break;
+
+                    case Expect::CommaOrEnd: {
+                        const auto container = containers.back();
+                        if (c == ',') {
+                            ++p;
+                            expect = (
+                                (container == '{')
+                                ? Expect::Key
+                                : Expect::Value
+                            );
+                        } else if (
+                            ((container == '{') && (c == '}'))
+                            || ((container == '[') && (c == ']'))
+                        ) {
+                            containers.pop_back();
+                            if (c == '}') {
+                                handler.EndObject(++p);
+                            } else {
+                                handler.EndArray(++p);
+                            }
+                            expect = afterValue();
+                        } else {
+                            return false;
+                        }
+                    } break;
+
+                    case Expect::FirstValueOrEnd: {
+                        if (c == ']') {
+                            containers.pop_back();
+                            handler.EndArray(++p);
+                            expect = afterValue();
+                            break;
+                        }
+                    }   // fall through
+                    case Expect::Value: {
+                        const auto valueBegin = p;
+                        if (c == '{') {
+                            containers.push_back(c);
+                            handler.BeginObject(p++);
+                            expect = Expect::FirstKeyOrEnd;
+                            break;
+                        } else if (c == '[') {
+                            containers.push_back(c);
+                            handler.BeginArray(p++);
+                            expect = Expect::FirstValueOrEnd;
+                            break;
+                        } else if (c == '"') {
+                            if (!ParseString(encoding, p, end, text)) {
+                                return false;
+                            }
+                            handler.Scalar(ScalarType::String, text, valueBegin, p);
+                        } else {
+                            ScalarType type;
+                            if (
+                                MatchLiteral(encoding, p, end, "true")
+                                || MatchLiteral(encoding, p, end, "false")
+                            ) {
+                                type = ScalarType::Boolean;
+                            } else if (MatchLiteral(encoding, p, end, "null")) {
+                                type = ScalarType::Null;
+                            } else if (ParseNumber(encoding, p, end)) {
+                                type = ScalarType::Number;
+                            } else {
+                                return false;
+                            }
+                            text.assign(encoding.data() + valueBegin, p - valueBegin);
+                            handler.Scalar(type, text, valueBegin, p);
+                        }
+                        expect = afterValue();
+                    } break;
+
+                    case Expect::Nothing:
+                    default: {
+                        return false;
+                    }
+                }
+            }
+            return (expect == Expect::Nothing);
+        }
+
+    }
+
+}
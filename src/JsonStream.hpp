@@ -0,0 +1,127 @@
+#pragma once
+
+/**
+ * @file JsonStream.hpp
+ *
+ * This module declares the Discord::JsonStream functions, which parse
+ * JSON text as a stream of events, without building a document object
+ * model of the whole text.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Arena.hpp"
+
+#include <stddef.h>
+#include <string>
+
+namespace Discord {
+
+    namespace JsonStream {
+
+        /**
+         * These are the kinds of scalar values which can be found
+         * in JSON text.
+         */
+        enum class ScalarType {
+            Null,
+            Boolean,
+            Number,
+            String,
+        };
+
+        /**
+         * This is the interface implemented by users of the Parse
+         * function in order to receive the events generated as the
+         * JSON text is parsed.
+         *
+         * All offsets are positions in the encoding passed to Parse.
+         */
+        class Handler {
+        public:
+            virtual ~Handler() = default;
+
+            /**
+             * This is called at the start of an object, with the offset
+             * of its opening brace.
+             */
+            virtual void BeginObject(size_t /* offset */) {}
+
+            /**
+             * This is called at the end of an object, with the offset
+             * just past its closing brace.
+             */
+            virtual void EndObject(size_t /* offset */) {}
+
+            /**
+             * This is called at the start of an array, with the offset
+             * of its opening bracket.
+             */
+            virtual void BeginArray(size_t /* offset */) {}
+
+            /**
+             * This is called at the end of an array, with the offset
+             * just past its closing bracket.
+             */
+            virtual void EndArray(size_t /* offset */) {}
+
+            /**
+             * This is called with the (unescaped) key of each member
+             * of an object, before the events for the member's value.
+             *
+             * The string given is only valid for the duration of the call.
+             */
+            virtual void Key(const ArenaString& /* key */) {}
+
+            /**
+             * This is called for each scalar value.  For strings, the
+             * text given is the unescaped string.  For other scalars, it
+             * is the literal text of the value.  The offsets delimit the
+             * encoding of the value, including any quotation marks.
+             *
+             * The string given is only valid for the duration of the call.
+             */
+            virtual void Scalar(
+                ScalarType /* type */,
+                const ArenaString& /* text */,
+                size_t /* begin */,
+                size_t /* end */
+            ) {}
+        };
+
+        /**
+         * Parse the single JSON value encoded in the given range of the given
+         * string, delivering events to the given handler.
+         *
+         * @param[in] encoding
+         *     This is the string containing the JSON text to parse.
+         *
+         * @param[in] begin
+         *     This is the offset of the first character to parse.
+         *
+         * @param[in] end
+         *     This is the offset just past the last character to parse.
+         *
+         * @param[in,out] handler
+         *     This is the object which receives the parse events.
+         *
+         * @param[in,out] arena
+         *     This is where to put the scratch memory used to parse,
+         *     including the strings passed to the handler.
+         *
+         * @return
+         *     An indication of whether or not the text contained exactly
+         *     one valid JSON value is returned.  Note that events may have
+         *     been delivered for part of the text before any error is found.
+         */
+        bool Parse(
+            const std::string& encoding,
+            size_t begin,
+            size_t end,
+            Handler& handler,
+            Arena& arena
+        );
+
+    }
+
+}
@@ -0,0 +1,321 @@
+/**
+ * @file Paginator.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::Paginator class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Routes.hpp"
+
+#include <deque>
+#include <Discord/Paginator.hpp>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+    /**
+     * Return true if the first given ID comes before the second.
+     * IDs are snowflakes: decimal numbers too big for some languages,
+     * so Discord gives them as strings.
+     */
+    bool IsEarlierId(
+        const std::string& first,
+        const std::string& second
+    ) {
+        if (first.length() != second.length()) {
+            return first.length() < second.length();
+        }
+        return first < second;
+    }
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a Paginator instance.
+     */
+    struct Paginator::Impl
+        : public std::enable_shared_from_this< Paginator::Impl >
+    {
+        // Types
+
+        /**
+         * This is a request for a page, worked out while the mutex
+         * is held, to be made once it's released.
+         */
+        struct Fetch {
+            Connections::ResourceRequest request;
+            size_t generation = 0;
+            bool wanted = false;
+        };
+
+        // Properties
+
+        std::vector< Connections::CancelDelegate > cancels;
+        Configuration configuration;
+        std::shared_ptr< Connections > connections;
+        std::string cursor;
+        bool fetching = false;
+        bool finished = false;
+
+        /**
+         * This is incremented with each page fetched, so that a response
+         * to a request for an earlier page can be recognized.
+         */
+        size_t generation = 0;
+
+        /**
+         * These are the pages which have arrived but which the consumer
+         * hasn't asked for yet.
+         */
+        std::deque< Page > held;
+
+        std::mutex mutex;
+        bool promoted = false;
+        Connections::ResourceRequest request;
+        std::shared_ptr< std::promise< Page > > waiting;
+
+        // Methods
+
+        /**
+         * Begin fetching the next page.  The mutex must be held, and
+         * the returned request made once it's released.
+         */
+        Fetch StartFetch(Connections::Priority priority) {
+            fetching = true;
+            promoted = (priority != Connections::Priority::Background);
+            ++generation;
+            return PrepareFetch(priority);
+        }
+
+        /**
+         * Return the request for the page being fetched.  The mutex
+         * must be held.
+         */
+        Fetch PrepareFetch(Connections::Priority priority) {
+            Fetch fetch;
+            fetch.request = request;
+            auto& uri = fetch.request.uri;
+            uri += ((uri.find('?') == std::string::npos) ? "?" : "&");
+            if (!cursor.empty()) {
+                uri += (
+                    (configuration.direction == Direction::Before)
+                    ? "before="
+                    : "after="
+                );
+                uri += cursor;
+                uri += "&";
+            }
+            uri += "limit=" + std::to_string(configuration.limit);
+            fetch.request.priority = priority;
+            fetch.generation = generation;
+            fetch.wanted = true;
+            return fetch;
+        }
+
+        /**
+         * Make the given request for a page, if one is wanted.
+         * The mutex must not be held, since the connections belong
+         * to the user, and the response may arrive before the request
+         * is even queued.
+         */
+        void Send(Fetch&& fetch) {
+            if (!fetch.wanted) {
+                return;
+            }
+            std::weak_ptr< Impl > weakSelf(shared_from_this());
+            const auto pageGeneration = fetch.generation;
+            auto cancel = connections->QueueResourceRequest(
+                std::move(fetch.request),
+                [weakSelf, pageGeneration](Connections::Response&& response){
+                    const auto self = weakSelf.lock();
+                    if (self != nullptr) {
+                        self->OnResponse(pageGeneration, std::move(response));
+                    }
+                }
+            );
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            if (
+                fetching
+                && (pageGeneration == generation)
+            ) {
+                cancels.push_back(std::move(cancel));
+                return;
+            }
+            lock.unlock();
+            cancel();
+        }
+
+        void OnResponse(
+            size_t pageGeneration,
+            Connections::Response&& response
+        ) {
+            std::vector< Connections::CancelDelegate > duplicateCancels;
+            Fetch nextFetch;
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            if (
+                !fetching
+                || (pageGeneration != generation)
+            ) {
+                return;
+            }
+            fetching = false;
+            duplicateCancels.swap(cancels);
+            Page page;
+            page.status = response.status;
+            if (response.status == 200) {
+                page.items = Json::Value::FromEncoding(response.body);
+            }
+            if (page.items.GetType() != Json::Value::Type::Array) {
+                page.items = Json::Array();
+                page.last = true;
+            }
+            if (page.items.GetSize() < configuration.limit) {
+                page.last = true;
+            }
+            if (!page.last) {
+                std::string nextCursor;
+                for (size_t i = 0; i < page.items.GetSize(); ++i) {
+                    const auto id = Routes::GetField(page.items[i], configuration.idField);
+                    if (
+                        nextCursor.empty()
+                        || (
+                            (configuration.direction == Direction::Before)
+                            ? IsEarlierId(id, nextCursor)
+                            : IsEarlierId(nextCursor, id)
+                        )
+                    ) {
+                        nextCursor = id;
+                    }
+                }
+                if (
+                    nextCursor.empty()
+                    || (nextCursor == cursor)
+                ) {
+                    page.last = true;
+                } else {
+                    cursor = nextCursor;
+                }
+            }
+            finished = page.last;
+            if (waiting == nullptr) {
+                held.push_back(std::move(page));
+            } else {
+                const auto consumer = std::move(waiting);
+                waiting = nullptr;
+                if (!finished) {
+                    nextFetch = StartFetch(Connections::Priority::Background);
+                }
+                consumer->set_value(std::move(page));
+            }
+            lock.unlock();
+            Send(std::move(nextFetch));
+
+            // With connections which don't share identical requests, the
+            // duplicate made when a read-ahead page was asked for
+            // is no longer needed.
+            for (const auto& cancel: duplicateCancels) {
+                if (cancel != nullptr) {
+                    cancel();
+                }
+            }
+        }
+
+        void Cancel() {
+            std::vector< Connections::CancelDelegate > cancelsToCall;
+            std::shared_ptr< std::promise< Page > > consumer;
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                ++generation;
+                fetching = false;
+                finished = true;
+                cancelsToCall.swap(cancels);
+                consumer = std::move(waiting);
+                waiting = nullptr;
+            }
+            for (const auto& cancel: cancelsToCall) {
+                if (cancel != nullptr) {
+                    cancel();
+                }
+            }
+            if (consumer != nullptr) {
+                Page page;
+                page.status = 499;
+                page.items = Json::Array();
+                page.last = true;
+                consumer->set_value(std::move(page));
+            }
+        }
+    };
+
+    Paginator::~Paginator() noexcept {
+        if (impl_ != nullptr) {
+            impl_->Cancel();
+        }
+    }
+    Paginator::Paginator(Paginator&&) noexcept = default;
+    Paginator& Paginator::operator=(Paginator&& other) noexcept {
+        if (this != &other) {
+            if (impl_ != nullptr) {
+                impl_->Cancel();
+            }
+            impl_ = std::move(other.impl_);
+        }
+        return *this;
+    }
+
+    Paginator::Paginator(
+        const std::shared_ptr< Connections >& connections,
+        const Connections::ResourceRequest& request,
+        const Configuration& configuration
+    )
+        : impl_(std::make_shared< Impl >())
+    {
+        impl_->connections = connections;
+        impl_->request = request;
+        impl_->configuration = configuration;
+        impl_->cursor = configuration.start;
+    }
+
+    auto Paginator::NextPage() -> std::future< Page > {
+        const auto consumer = std::make_shared< std::promise< Page > >();
+        auto page = consumer->get_future();
+        Impl::Fetch fetch;
+        std::unique_lock< decltype(impl_->mutex) > lock(impl_->mutex);
+        if (!impl_->held.empty()) {
+            consumer->set_value(std::move(impl_->held.front()));
+            impl_->held.pop_front();
+            if (
+                !impl_->finished
+                && !impl_->fetching
+            ) {
+                fetch = impl_->StartFetch(Connections::Priority::Background);
+            }
+        } else if (impl_->fetching) {
+            impl_->waiting = consumer;
+            if (
+                !impl_->promoted
+                && (impl_->request.priority != Connections::Priority::Background)
+            ) {
+                impl_->promoted = true;
+                fetch = impl_->PrepareFetch(impl_->request.priority);
+            }
+        } else if (impl_->finished) {
+            Page lastPage;
+            lastPage.items = Json::Array();
+            lastPage.last = true;
+            consumer->set_value(std::move(lastPage));
+        } else {
+            impl_->waiting = consumer;
+            fetch = impl_->StartFetch(impl_->request.priority);
+        }
+        lock.unlock();
+        impl_->Send(std::move(fetch));
+        return page;
+    }
+
+}
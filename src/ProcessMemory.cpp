@@ -0,0 +1,46 @@
+/**
+ * @file ProcessMemory.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::ProcessMemory functions.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "ProcessMemory.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace Discord {
+
+    namespace ProcessMemory {
+
+        size_t GetPeakResidentSetSize() {
+#ifdef _WIN32
+            PROCESS_MEMORY_COUNTERS counters;
+            if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+                return 0;
+            }
+            return (size_t)counters.PeakWorkingSetSize;
+#else
+            struct rusage usage;
+            if (getrusage(RUSAGE_SELF, &usage) != 0) {
+                return 0;
+            }
+#ifdef __APPLE__
+            return (size_t)usage.ru_maxrss;
+#else
+            return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+        }
+
+    }
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+/**
+ * @file ProcessMemory.hpp
+ *
+ * This module declares the Discord::ProcessMemory functions.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <stddef.h>
+
+namespace Discord {
+
+    namespace ProcessMemory {
+
+        /**
+         * Return the largest amount of physical memory, in bytes, that the
+         * current process has occupied at any one time since it started,
+         * or zero if this cannot be determined on the current platform.
+         */
+        size_t GetPeakResidentSetSize();
+
+    }
+
+}
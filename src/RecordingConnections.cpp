@@ -0,0 +1,284 @@
+/**
+ * @file RecordingConnections.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::RecordingConnections class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <chrono>
+#include <Discord/RecordingConnections.hpp>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace {
+
+    /**
+     * This is called with each frame received on a WebSocket.
+     */
+    using RecordDelegate = std::function<
+        void(
+            Discord::Capture::FrameKind kind,
+            const std::string& data
+        )
+    >;
+
+    /**
+     * This wraps a WebSocket, recording the frames it receives before
+     * handing them to the callbacks registered with it.
+     */
+    class RecordingWebSocket
+        : public Discord::WebSocket
+    {
+        // Public methods
+    public:
+        RecordingWebSocket(
+            const std::shared_ptr< Discord::WebSocket >& webSocket,
+            RecordDelegate&& record
+        )
+            : webSocket_(webSocket)
+            , record_(std::move(record))
+        {
+        }
+
+        // Discord::WebSocket
+    public:
+        virtual void Binary(std::string&& message) override {
+            webSocket_->Binary(std::move(message));
+        }
+
+        virtual void Close(unsigned int code) override {
+            webSocket_->Close(code);
+        }
+
+        virtual void Text(std::string&& message) override {
+            webSocket_->Text(std::move(message));
+        }
+
+        virtual void RegisterBinaryCallback(ReceiveCallback&& onBinary) override {
+            webSocket_->RegisterBinaryCallback(
+                WrapReceiveCallback(
+                    Discord::Capture::FrameKind::Binary,
+                    std::move(onBinary)
+                )
+            );
+        }
+
+        virtual void RegisterCloseCallback(CloseCallback&& onClose) override {
+            const auto record = record_;
+            const auto onCloseShared = std::make_shared< CloseCallback >(std::move(onClose));
+            webSocket_->RegisterCloseCallback(
+                [record, onCloseShared]{
+                    record(Discord::Capture::FrameKind::Close, "");
+                    if (*onCloseShared != nullptr) {
+                        (*onCloseShared)();
+                    }
+                }
+            );
+        }
+
+        virtual void RegisterTextCallback(ReceiveCallback&& onText) override {
+            webSocket_->RegisterTextCallback(
+                WrapReceiveCallback(
+                    Discord::Capture::FrameKind::Text,
+                    std::move(onText)
+                )
+            );
+        }
+
+        // Private methods
+    private:
+        ReceiveCallback WrapReceiveCallback(
+            Discord::Capture::FrameKind kind,
+            ReceiveCallback&& onReceive
+        ) {
+            const auto record = record_;
+            const auto onReceiveShared = std::make_shared< ReceiveCallback >(std::move(onReceive));
+            return [kind, record, onReceiveShared](std::string&& message){
+                record(kind, message);
+                if (*onReceiveShared != nullptr) {
+                    (*onReceiveShared)(std::move(message));
+                }
+            };
+        }
+
+        // Private properties
+    private:
+        std::shared_ptr< Discord::WebSocket > webSocket_;
+        RecordDelegate record_;
+    };
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a RecordingConnections
+     * instance.
+     */
+    struct RecordingConnections::Impl
+        : public std::enable_shared_from_this< RecordingConnections::Impl >
+    {
+        // Properties
+
+        Capture capture;
+        std::shared_ptr< Timekeeping::Clock > clock;
+        std::shared_ptr< Connections > connections;
+        mutable std::mutex mutex;
+        size_t numConnections = 0;
+
+        /**
+         * This is the time at which the first frame of the current
+         * capture was received, or a negative number if no frames
+         * have been received yet.
+         */
+        double startTime = -1.0;
+
+        // Methods
+
+        double GetCurrentTime() {
+            if (clock == nullptr) {
+                return std::chrono::duration< double >(
+                    std::chrono::steady_clock::now().time_since_epoch()
+                ).count();
+            } else {
+                return clock->GetCurrentTime();
+            }
+        }
+
+        void Record(
+            size_t connection,
+            Capture::FrameKind kind,
+            const std::string& data
+        ) {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            const auto now = GetCurrentTime();
+            if (startTime < 0.0) {
+                startTime = now;
+            }
+            Capture::Frame frame;
+            frame.time = now - startTime;
+            frame.connection = connection;
+            frame.kind = kind;
+            frame.data = data;
+            capture.frames.push_back(std::move(frame));
+        }
+
+        std::shared_ptr< WebSocket > WrapWebSocket(
+            const std::shared_ptr< WebSocket >& webSocket,
+            const std::string& uri
+        ) {
+            if (webSocket == nullptr) {
+                return nullptr;
+            }
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            const auto connection = numConnections++;
+            capture.metadata["connection." + std::to_string(connection) + ".uri"] = uri;
+            lock.unlock();
+            std::weak_ptr< Impl > weakSelf(shared_from_this());
+            return std::make_shared< RecordingWebSocket >(
+                webSocket,
+                [weakSelf, connection](
+                    Capture::FrameKind kind,
+                    const std::string& data
+                ){
+                    const auto self = weakSelf.lock();
+                    if (self == nullptr) {
+                        return;
+                    }
+                    self->Record(connection, kind, data);
+                }
+            );
+        }
+    };
+
+    RecordingConnections::~RecordingConnections() noexcept = default;
+    RecordingConnections::RecordingConnections(RecordingConnections&&) noexcept = default;
+    RecordingConnections& RecordingConnections::operator=(RecordingConnections&&) noexcept = default;
+
+    RecordingConnections::RecordingConnections(const std::shared_ptr< Connections >& connections)
+        : impl_(std::make_shared< Impl >())
+    {
+        impl_->connections = connections;
+    }
+
+    void RecordingConnections::SetClock(const std::shared_ptr< Timekeeping::Clock >& clock) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->clock = clock;
+    }
+
+    void RecordingConnections::SetMetadata(
+        const std::string& key,
+        const std::string& value
+    ) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->capture.metadata[key] = value;
+    }
+
+    Capture RecordingConnections::GetCapture() const {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        return impl_->capture;
+    }
+
+    Capture RecordingConnections::TakeCapture() {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        Capture capture;
+        capture.metadata = impl_->capture.metadata;
+        std::swap(capture, impl_->capture);
+        impl_->startTime = -1.0;
+        return capture;
+    }
+
+    auto RecordingConnections::QueueResourceRequest(
+        const ResourceRequest& request
+    ) -> ResourceRequestTransaction {
+        return impl_->connections->QueueResourceRequest(request);
+    }
+
+    auto RecordingConnections::QueueResourceRequest(
+        ResourceRequest&& request
+    ) -> ResourceRequestTransaction {
+        return impl_->connections->QueueResourceRequest(std::move(request));
+    }
+
+    auto RecordingConnections::QueueResourceRequest(
+        ResourceRequest&& request,
+        ResponseDelegate&& onResponse
+    ) -> CancelDelegate {
+        return impl_->connections->QueueResourceRequest(
+            std::move(request),
+            std::move(onResponse)
+        );
+    }
+
+    auto RecordingConnections::QueueWebSocketRequest(
+        const WebSocketRequest& request
+    ) -> WebSocketRequestTransaction {
+        auto transaction = impl_->connections->QueueWebSocketRequest(request);
+
+        // Wait for the WebSocket on a thread of its own, so that
+        // the future handed back behaves like the one it wraps.
+        const auto webSocket = std::make_shared< std::future< std::shared_ptr< WebSocket > > >(
+            std::move(transaction.webSocket)
+        );
+        std::weak_ptr< Impl > weakImpl(impl_);
+        const auto uri = request.uri;
+        transaction.webSocket = std::async(
+            std::launch::async,
+            [weakImpl, webSocket, uri]() -> std::shared_ptr< WebSocket > {
+                auto opened = webSocket->get();
+                const auto impl = weakImpl.lock();
+                if (impl == nullptr) {
+                    return opened;
+                }
+                return impl->WrapWebSocket(opened, uri);
+            }
+        );
+        return transaction;
+    }
+
+}
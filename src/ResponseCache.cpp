@@ -0,0 +1,346 @@
+/**
+ * @file ResponseCache.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::ResponseCache class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Routes.hpp"
+
+#include <Discord/ResponseCache.hpp>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string.h>
+#include <StringExtensions/StringExtensions.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    /**
+     * This holds one remembered response.
+     */
+    struct Entry {
+        std::string path;
+        Discord::Connections::Response response;
+        std::string entityTag;
+        double expiration = 0.0;
+        std::list< std::string >::iterator recentUse;
+    };
+
+    /**
+     * This describes a path to invalidate when a gateway event arrives.
+     * Each part of the path template is either literal text or,
+     * if it begins with a colon, the name of a field of the event's
+     * data (a dot separates the names of nested fields).
+     */
+    struct EventInvalidation {
+        const char* eventNamePrefix;
+        std::vector< const char* > pathTemplate;
+        bool includeSubpaths;
+    };
+
+    const std::vector< EventInvalidation > EVENT_INVALIDATIONS = {
+        {"GUILD_UPDATE", {"guilds", ":id"}, false},
+        {"GUILD_DELETE", {"guilds", ":id"}, true},
+        {"GUILD_ROLE_", {"guilds", ":guild_id", "roles"}, true},
+        {"GUILD_EMOJIS_UPDATE", {"guilds", ":guild_id", "emojis"}, true},
+        {"GUILD_BAN_", {"guilds", ":guild_id", "bans"}, true},
+        {"GUILD_MEMBER_", {"guilds", ":guild_id", "members", ":user.id"}, false},
+        {"GUILD_MEMBER_", {"guilds", ":guild_id", "members"}, false},
+        {"CHANNEL_UPDATE", {"channels", ":id"}, false},
+        {"CHANNEL_DELETE", {"channels", ":id"}, true},
+        {"CHANNEL_", {"guilds", ":guild_id", "channels"}, false},
+        {"CHANNEL_PINS_UPDATE", {"channels", ":channel_id", "pins"}, false},
+        {"MESSAGE_", {"channels", ":channel_id", "messages"}, false},
+        {"MESSAGE_UPDATE", {"channels", ":channel_id", "messages", ":id"}, true},
+        {"MESSAGE_DELETE", {"channels", ":channel_id", "messages", ":id"}, true},
+        {"MESSAGE_REACTION_", {"channels", ":channel_id", "messages", ":message_id"}, true},
+        {"WEBHOOKS_UPDATE", {"channels", ":channel_id", "webhooks"}, false},
+        {"WEBHOOKS_UPDATE", {"guilds", ":guild_id", "webhooks"}, false},
+        {"APPLICATION_COMMAND_", {"applications", ":application_id", "commands"}, true},
+        {"APPLICATION_COMMAND_", {"applications", ":application_id", "guilds", ":guild_id", "commands"}, true},
+    };
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a ResponseCache instance.
+     */
+    struct ResponseCache::Impl {
+        // Properties
+
+        std::unordered_map< std::string, Entry > entries;
+
+        /**
+         * These are the keys of the entries, by the paths of their
+         * resources.  The paths are kept in order, so that the entries
+         * for the paths beneath a path are found without looking
+         * at any others.
+         */
+        std::map< std::string, std::set< std::string > > keysByPath;
+
+        size_t maxEntries = 1024;
+        mutable std::mutex mutex;
+        std::list< std::string > recentUses;
+        Statistics statistics;
+        std::unordered_map< std::string, double > timesToLive;
+
+        // Methods
+
+        double GetTimeToLive(const Connections::ResourceRequest& request) const {
+            const auto timesToLiveEntry = timesToLive.find(Routes::GetRoute(request, false));
+            if (timesToLiveEntry == timesToLive.end()) {
+                return 0.0;
+            }
+            return timesToLiveEntry->second;
+        }
+
+        /**
+         * Add an entry with the given key, for the resource
+         * at the given path.
+         */
+        std::unordered_map< std::string, Entry >::iterator Add(
+            const std::string& key,
+            const std::string& path
+        ) {
+            const auto entriesEntry = entries.insert({key, Entry()}).first;
+            entriesEntry->second.path = path;
+            entriesEntry->second.recentUse = recentUses.insert(recentUses.end(), key);
+            (void)keysByPath[path].insert(key);
+            return entriesEntry;
+        }
+
+        void Remove(std::unordered_map< std::string, Entry >::iterator entriesEntry) {
+            const auto& entry = entriesEntry->second;
+            recentUses.erase(entry.recentUse);
+            const auto keysByPathEntry = keysByPath.find(entry.path);
+            if (keysByPathEntry != keysByPath.end()) {
+                (void)keysByPathEntry->second.erase(entriesEntry->first);
+                if (keysByPathEntry->second.empty()) {
+                    (void)keysByPath.erase(keysByPathEntry);
+                }
+            }
+            (void)entries.erase(entriesEntry);
+        }
+
+        void Invalidate(
+            const std::string& path,
+            bool includeSubpaths
+        ) {
+            std::vector< std::string > keys;
+            const auto keysByPathEntry = keysByPath.find(path);
+            if (keysByPathEntry != keysByPath.end()) {
+                keys.insert(keys.end(), keysByPathEntry->second.begin(), keysByPathEntry->second.end());
+            }
+            if (includeSubpaths) {
+                const auto subpathPrefix = path + "/";
+                for (
+                    auto subpathsEntry = keysByPath.lower_bound(subpathPrefix);
+                    (
+                        (subpathsEntry != keysByPath.end())
+                        && (subpathsEntry->first.compare(0, subpathPrefix.length(), subpathPrefix) == 0)
+                    );
+                    ++subpathsEntry
+                ) {
+                    keys.insert(keys.end(), subpathsEntry->second.begin(), subpathsEntry->second.end());
+                }
+            }
+            for (const auto& key: keys) {
+                const auto entriesEntry = entries.find(key);
+                if (entriesEntry != entries.end()) {
+                    Remove(entriesEntry);
+                    ++statistics.invalidations;
+                }
+            }
+        }
+
+        void Touch(Entry& entry) {
+            recentUses.splice(recentUses.end(), recentUses, entry.recentUse);
+        }
+    };
+
+    ResponseCache::~ResponseCache() noexcept = default;
+    ResponseCache::ResponseCache(ResponseCache&&) noexcept = default;
+    ResponseCache& ResponseCache::operator=(ResponseCache&&) noexcept = default;
+
+    ResponseCache::ResponseCache(size_t maxEntries)
+        : impl_(new Impl())
+    {
+        impl_->maxEntries = maxEntries;
+    }
+
+    void ResponseCache::SetTimeToLive(
+        const std::string& route,
+        double timeToLive
+    ) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->timesToLive[route] = timeToLive;
+    }
+
+    auto ResponseCache::Find(
+        const Connections::ResourceRequest& request,
+        double now
+    ) -> Lookup {
+        Lookup lookup;
+        if (request.method != "GET") {
+            return lookup;
+        }
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        if (impl_->GetTimeToLive(request) <= 0.0) {
+            return lookup;
+        }
+        const auto entriesEntry = impl_->entries.find(Routes::GetRequestKey(request));
+        if (entriesEntry == impl_->entries.end()) {
+            ++impl_->statistics.misses;
+            return lookup;
+        }
+        auto& entry = entriesEntry->second;
+        if (now < entry.expiration) {
+            ++impl_->statistics.hits;
+            impl_->Touch(entry);
+            lookup.freshness = Freshness::Fresh;
+            lookup.response = entry.response;
+        } else if (!entry.entityTag.empty()) {
+            impl_->Touch(entry);
+            lookup.freshness = Freshness::Stale;
+            lookup.entityTag = entry.entityTag;
+        } else {
+            ++impl_->statistics.misses;
+            impl_->Remove(entriesEntry);
+        }
+        return lookup;
+    }
+
+    auto ResponseCache::Update(
+        const Connections::ResourceRequest& request,
+        Connections::Response&& response,
+        double now
+    ) -> Connections::Response {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+
+        // A successful request which isn't a GET probably changed
+        // the resource, and the collection to which it belongs.
+        if (request.method != "GET") {
+            if (
+                (response.status >= 200)
+                && (response.status < 300)
+            ) {
+                auto segments = Routes::GetPathSegments(request.uri);
+                impl_->Invalidate(Routes::JoinPath(segments), true);
+                if (!segments.empty()) {
+                    segments.pop_back();
+                    impl_->Invalidate(Routes::JoinPath(segments), false);
+                }
+            }
+            return std::move(response);
+        }
+        const auto timeToLive = impl_->GetTimeToLive(request);
+        if (timeToLive <= 0.0) {
+            return std::move(response);
+        }
+        const auto key = Routes::GetRequestKey(request);
+        auto entriesEntry = impl_->entries.find(key);
+        if (response.status == 304) {
+            if (entriesEntry == impl_->entries.end()) {
+                return std::move(response);
+            }
+            ++impl_->statistics.revalidations;
+            auto& entry = entriesEntry->second;
+            entry.expiration = now + timeToLive;
+            const auto entityTag = Routes::GetHeader(response.headers, HeaderName::ETag);
+            if (!entityTag.empty()) {
+                entry.entityTag = entityTag;
+            }
+            return entry.response;
+        }
+        if (response.status != 200) {
+            return std::move(response);
+        }
+        const auto cacheControl = StringExtensions::ToLower(
+            Routes::GetHeader(response.headers, HeaderName::CacheControl)
+        );
+        if (cacheControl.find("no-store") != std::string::npos) {
+            return std::move(response);
+        }
+        if (entriesEntry == impl_->entries.end()) {
+            if (impl_->maxEntries == 0) {
+                return std::move(response);
+            }
+            while (impl_->entries.size() >= impl_->maxEntries) {
+                impl_->Remove(impl_->entries.find(impl_->recentUses.front()));
+                ++impl_->statistics.evictions;
+            }
+            entriesEntry = impl_->Add(
+                key,
+                Routes::JoinPath(Routes::GetPathSegments(request.uri))
+            );
+        } else {
+            if (now >= entriesEntry->second.expiration) {
+                ++impl_->statistics.misses;
+            }
+            impl_->Touch(entriesEntry->second);
+        }
+        auto& entry = entriesEntry->second;
+        entry.response = response;
+        entry.entityTag = Routes::GetHeader(response.headers, HeaderName::ETag);
+        entry.expiration = now + timeToLive;
+        return std::move(response);
+    }
+
+    void ResponseCache::Invalidate(
+        const std::string& path,
+        bool includeSubpaths
+    ) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->Invalidate(
+            Routes::JoinPath(Routes::GetPathSegments(path)),
+            includeSubpaths
+        );
+    }
+
+    void ResponseCache::InvalidateForEvent(
+        const std::string& eventName,
+        const Json::Value& data
+    ) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        if (impl_->entries.empty()) {
+            return;
+        }
+        for (const auto& invalidation: EVENT_INVALIDATIONS) {
+            if (eventName.compare(0, strlen(invalidation.eventNamePrefix), invalidation.eventNamePrefix) != 0) {
+                continue;
+            }
+            std::string path;
+            for (const auto* part: invalidation.pathTemplate) {
+                std::string segment;
+                if (part[0] == ':') {
+                    segment = Routes::GetField(data, part + 1);
+                    if (segment.empty()) {
+                        path.clear();
+                        break;
+                    }
+                } else {
+                    segment = part;
+                }
+                path += "/";
+                path += segment;
+            }
+            if (!path.empty()) {
+                impl_->Invalidate(path, invalidation.includeSubpaths);
+            }
+        }
+    }
+
+    auto ResponseCache::GetStatistics() const -> Statistics {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        return impl_->statistics;
+    }
+
+}
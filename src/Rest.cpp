@@ -0,0 +1,1030 @@
+/**
+ * @file Rest.cpp
+ *
+ * This module contains the implementation of the Discord::Rest class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Routes.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <Discord/Rest.hpp>
+#include <limits>
+#include <mutex>
+#include <stdlib.h>
+#include <StringExtensions/StringExtensions.hpp>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of times a request which is rate limited
+     * anyway is made again before giving up and returning the
+     * "429 Too Many Requests" response.
+     */
+    constexpr size_t MAX_RATE_LIMITED_RETRIES = 3;
+
+    /**
+     * This is how long to wait before trying again after a
+     * "429 Too Many Requests" response which doesn't say how long
+     * to wait.
+     */
+    constexpr double DEFAULT_RETRY_AFTER = 1.0;
+
+    /**
+     * Request bodies at least this large are held in shared strings,
+     * so that they're handed to the transport, and again whenever the
+     * request is made again, without being copied.
+     */
+    constexpr size_t MIN_SHARED_BODY_SIZE = 64 * 1024;
+
+    constexpr size_t NUM_PRIORITIES = 3;
+
+    /**
+     * These are the shares of each bucket's requests given to each
+     * priority when requests of every priority are waiting, indexed
+     * by priority.
+     */
+    constexpr double PRIORITY_WEIGHTS[NUM_PRIORITIES] = {
+        2.0,    // Normal
+        4.0,    // Interactive
+        1.0,    // Background
+    };
+
+    /**
+     * This is the number of requests left in a bucket's rate limit
+     * window which background requests may not use, so that more
+     * urgent requests arriving later don't have to wait for
+     * the window to reset.
+     */
+    constexpr int BACKGROUND_RESERVE = 1;
+
+    /**
+     * Return true if the first given priority is more urgent than
+     * the second.
+     */
+    bool IsMoreUrgent(
+        Discord::Connections::Priority first,
+        Discord::Connections::Priority second
+    ) {
+        const auto rank = [](Discord::Connections::Priority priority){
+            switch (priority) {
+                case Discord::Connections::Priority::Interactive: return 2;
+                case Discord::Connections::Priority::Normal: return 1;
+                default: return 0;
+            }
+        };
+        return rank(first) > rank(second);
+    }
+
+    /**
+     * This holds the promise of a response made to one caller,
+     * or the delegate to hand the response to, if the caller gave one.
+     */
+    struct Waiter {
+        std::promise< Discord::Connections::Response > response;
+        Discord::Connections::ResponseDelegate onResponse;
+        bool done = false;
+    };
+
+    /**
+     * This holds a request which has been queued, along with the callers
+     * waiting for its response.  More than one caller may be waiting
+     * if identical GET requests were queued while it was in progress.
+     */
+    struct PendingRequest {
+        Discord::Connections::ResourceRequest request;
+        std::string route;
+        std::string majorParameter;
+        std::string coalescingKey;
+        std::vector< std::shared_ptr< Waiter > > waiters;
+        Discord::Connections::CancelDelegate cancel;
+        double queuedTime = 0.0;
+        size_t retries = 0;
+
+        /**
+         * This counts the times the request has been handed to the
+         * underlying connections, so that the delegate canceling an
+         * earlier attempt isn't mistaken for the current one.
+         */
+        unsigned int attempts = 0;
+
+        bool revalidating = false;
+        bool sent = false;
+        std::atomic< bool > done{false};
+    };
+
+    /**
+     * Return the key used to recognize requests which would get the same
+     * response, or an empty string if the given request should never
+     * share its response with another.
+     */
+    std::string GetCoalescingKey(const Discord::Connections::ResourceRequest& request) {
+        if (request.method != "GET") {
+            return "";
+        }
+        return Discord::Routes::GetRequestKey(request);
+    }
+
+    /**
+     * This holds what is known about one of Discord's rate limits,
+     * along with the requests waiting for it.
+     *
+     * Requests wait in a separate queue for each priority.  The queues
+     * take turns using stride scheduling: each queue has a "pass" which
+     * advances by the inverse of its weight each time a request is taken
+     * from it, and the next request is taken from the waiting queue with
+     * the lowest pass.
+     *
+     * Each bucket has its own lock, which guards everything in it.
+     * A bucket is retired once Discord reports that its route shares
+     * a bucket with others, and anything queued in it is moved
+     * to the shared one.
+     */
+    struct Bucket {
+        std::mutex mutex;
+        bool retired = false;
+        std::deque< std::shared_ptr< PendingRequest > > queues[NUM_PRIORITIES];
+        double passes[NUM_PRIORITIES] = {0.0};
+        double currentPass = 0.0;
+        bool limitsKnown = false;
+        int limit = 1;
+        int remaining = 1;
+        double resetTime = 0.0;
+        size_t inFlight = 0;
+        int timerToken = 0;
+        double timerDue = 0.0;
+
+        bool IsEmpty() const {
+            for (const auto& queue: queues) {
+                if (!queue.empty()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void Push(
+            std::shared_ptr< PendingRequest >&& pending,
+            bool atFront = false
+        ) {
+            const auto priority = (size_t)pending->request.priority;
+            auto& queue = queues[priority];
+
+            // A queue which has been idle doesn't get to make up for
+            // the turns it didn't need.
+            if (queue.empty()) {
+                passes[priority] = std::max(passes[priority], currentPass);
+            }
+            if (atFront) {
+                queue.push_front(std::move(pending));
+            } else {
+                queue.push_back(std::move(pending));
+            }
+        }
+
+        /**
+         * Return the index of the queue whose turn it is, or NUM_PRIORITIES
+         * if no request may be taken.
+         */
+        size_t PickQueue(bool backgroundAllowed) {
+            auto picked = NUM_PRIORITIES;
+            for (size_t priority = 0; priority < NUM_PRIORITIES; ++priority) {
+                auto& queue = queues[priority];
+                while (
+                    !queue.empty()
+                    && queue.front()->done
+                ) {
+                    queue.pop_front();
+                }
+                if (
+                    queue.empty()
+                    || (
+                        !backgroundAllowed
+                        && (priority == (size_t)Discord::Connections::Priority::Background)
+                    )
+                ) {
+                    continue;
+                }
+                if (
+                    (picked == NUM_PRIORITIES)
+                    || (passes[priority] < passes[picked])
+                ) {
+                    picked = priority;
+                }
+            }
+            return picked;
+        }
+
+        std::shared_ptr< PendingRequest > Pop(size_t priority) {
+            auto pending = std::move(queues[priority].front());
+            queues[priority].pop_front();
+            currentPass = passes[priority];
+            passes[priority] += 1.0 / PRIORITY_WEIGHTS[priority];
+            return pending;
+        }
+
+        /**
+         * Move the given request, if it's still waiting, to the queue
+         * of the given priority, if that's more urgent.
+         */
+        void Promote(
+            const std::shared_ptr< PendingRequest >& pending,
+            Discord::Connections::Priority priority
+        ) {
+            if (!IsMoreUrgent(priority, pending->request.priority)) {
+                return;
+            }
+            auto& queue = queues[(size_t)pending->request.priority];
+            const auto queueEntry = std::find(queue.begin(), queue.end(), pending);
+            if (queueEntry == queue.end()) {
+                return;
+            }
+            auto promoted = std::move(*queueEntry);
+            queue.erase(queueEntry);
+            promoted->request.priority = priority;
+            Push(std::move(promoted));
+        }
+    };
+
+    /**
+     * This holds the settings of a Rest instance.  The settings are
+     * replaced as a whole rather than changed, so that each request
+     * can take them all at once, without a lock.
+     */
+    struct Settings {
+        std::shared_ptr< Discord::GlobalRateLimiter > globalRateLimiter = std::make_shared< Discord::GlobalRateLimiter >();
+        std::shared_ptr< Discord::ResponseCache > responseCache;
+        std::shared_ptr< Timekeeping::Scheduler > scheduler;
+    };
+
+    /**
+     * This holds the queue delay statistics of one priority, kept in
+     * atomics so that requests can be counted without a lock.
+     */
+    struct QueueDelays {
+        std::atomic< size_t > numRequests{0};
+        std::atomic< double > totalDelay{0.0};
+        std::atomic< double > maxDelay{0.0};
+
+        void Record(double delay) {
+            ++numRequests;
+            auto total = totalDelay.load();
+            while (!totalDelay.compare_exchange_weak(total, total + delay)) {
+            }
+            auto max = maxDelay.load();
+            while (
+                (delay > max)
+                && !maxDelay.compare_exchange_weak(max, delay)
+            ) {
+            }
+        }
+    };
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a Rest instance.
+     *
+     * The lock of a bucket may be held while taking either of the locks
+     * here, but neither of those may be held while taking the lock of
+     * a bucket.  No lock is held while requests are handed to the
+     * underlying connections.
+     */
+    struct Rest::Impl
+        : public std::enable_shared_from_this< Rest::Impl >
+    {
+        // Properties
+
+        std::unordered_map< std::string, std::shared_ptr< Bucket > > buckets;
+        std::shared_ptr< Connections > connections;
+        std::unordered_map< std::string, std::shared_ptr< PendingRequest > > inProgressGets;
+
+        /**
+         * This guards the map of buckets and what's known about the
+         * buckets of routes, and keeps changes to the settings from
+         * overlapping.  It's only held long enough to look at or
+         * change these.
+         */
+        std::mutex mutex;
+
+        QueueDelays queueDelays[NUM_PRIORITIES];
+        std::unordered_map< std::string, std::string > routeBucketHashes;
+
+        /**
+         * This is only read or replaced with std::atomic_load and
+         * std::atomic_store.
+         */
+        std::shared_ptr< const Settings > settings = std::make_shared< Settings >();
+
+        /**
+         * These are the calls to make, once no lock is held, to hand
+         * responses to the delegates given by callers.  They're guarded
+         * by the waiters mutex.
+         */
+        std::vector< std::function< void() > > responses;
+
+        /**
+         * This guards the requests in progress which callers may share,
+         * the callers waiting for each request, and the responses
+         * waiting to be handed to delegates.
+         */
+        std::mutex waitersMutex;
+
+        // Methods
+
+        std::shared_ptr< const Settings > GetSettings() const {
+            return std::atomic_load(&settings);
+        }
+
+        /**
+         * Replace the settings with a copy changed by the given function.
+         */
+        void ChangeSettings(const std::function< void(Settings& settings) >& change) {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            const auto newSettings = std::make_shared< Settings >(*GetSettings());
+            change(*newSettings);
+            std::atomic_store(&settings, std::shared_ptr< const Settings >(newSettings));
+        }
+
+        /**
+         * Give the given response to every caller still waiting for
+         * the given request.  The waiters mutex must be held.
+         */
+        void Complete(
+            const std::shared_ptr< PendingRequest >& pending,
+            Response&& response
+        ) {
+            if (pending->done) {
+                return;
+            }
+            pending->done = true;
+            if (!pending->coalescingKey.empty()) {
+                (void)inProgressGets.erase(pending->coalescingKey);
+            }
+            for (size_t i = 0; i < pending->waiters.size(); ++i) {
+                const auto& waiter = pending->waiters[i];
+                if (i + 1 == pending->waiters.size()) {
+                    Respond(*waiter, std::move(response));
+                } else {
+                    Respond(*waiter, Response(response));
+                }
+            }
+            pending->waiters.clear();
+        }
+
+        /**
+         * Give the given response to the given caller.  If the caller
+         * gave a delegate, it's called later by DeliverResponses.
+         * The waiters mutex must be held.
+         */
+        void Respond(
+            Waiter& waiter,
+            Response&& response
+        ) {
+            waiter.done = true;
+            if (waiter.onResponse == nullptr) {
+                waiter.response.set_value(std::move(response));
+                return;
+            }
+            const auto onResponse = std::move(waiter.onResponse);
+            waiter.onResponse = nullptr;
+            const auto handedOver = std::make_shared< Response >(std::move(response));
+            responses.push_back(
+                [onResponse, handedOver]{
+                    onResponse(std::move(*handedOver));
+                }
+            );
+        }
+
+        /**
+         * Call the delegates waiting to be given responses.  No locks
+         * may be held, since the delegates may make more requests.
+         */
+        void DeliverResponses() {
+            std::vector< std::function< void() > > deliveries;
+            {
+                std::lock_guard< decltype(waitersMutex) > lock(waitersMutex);
+                deliveries.swap(responses);
+            }
+            for (const auto& delivery: deliveries) {
+                delivery();
+            }
+        }
+
+        /**
+         * Stop the given caller waiting for the given request.  The request
+         * itself is only canceled once no callers are waiting for it.
+         */
+        void CancelWaiter(
+            const std::shared_ptr< PendingRequest >& pending,
+            const std::shared_ptr< Waiter >& waiter,
+            std::unique_lock< decltype(waitersMutex) >& lock
+        ) {
+            if (waiter->done) {
+                return;
+            }
+            Respond(*waiter, {499});
+            pending->waiters.erase(
+                std::remove(pending->waiters.begin(), pending->waiters.end(), waiter),
+                pending->waiters.end()
+            );
+            if (!pending->waiters.empty()) {
+                return;
+            }
+            Complete(pending, {499});
+            auto cancel = std::move(pending->cancel);
+            pending->cancel = nullptr;
+            lock.unlock();
+            if (cancel != nullptr) {
+                cancel();
+            }
+        }
+
+        static double GetCurrentTime(const Settings& settings) {
+            if (settings.scheduler == nullptr) {
+                return std::chrono::duration< double >(
+                    std::chrono::steady_clock::now().time_since_epoch()
+                ).count();
+            } else {
+                return settings.scheduler->GetClock()->GetCurrentTime();
+            }
+        }
+
+        /**
+         * Return the key of the bucket for the given request.
+         * The mutex must be held.
+         */
+        std::string GetBucketKey(const PendingRequest& pending) {
+            const auto routeBucketHashesEntry = routeBucketHashes.find(pending.route);
+            if (routeBucketHashesEntry == routeBucketHashes.end()) {
+                return pending.route;
+            } else {
+                return routeBucketHashesEntry->second + " " + pending.majorParameter;
+            }
+        }
+
+        /**
+         * Return the bucket for the given request, making it if need be.
+         * The mutex must be held.
+         */
+        std::shared_ptr< Bucket > GetBucket(const PendingRequest& pending) {
+            auto& bucket = buckets[GetBucketKey(pending)];
+            if (bucket == nullptr) {
+                bucket = std::make_shared< Bucket >();
+            }
+            return bucket;
+        }
+
+        /**
+         * Return the bucket for the given request, locked with the given
+         * lock.  A bucket retired while we waited for its lock is passed
+         * over for the one which took its place.
+         */
+        std::shared_ptr< Bucket > LockBucket(
+            const PendingRequest& pending,
+            std::unique_lock< std::mutex >& bucketLock
+        ) {
+            for (;;) {
+                std::shared_ptr< Bucket > bucket;
+                {
+                    std::lock_guard< decltype(mutex) > lock(mutex);
+                    bucket = GetBucket(pending);
+                }
+                bucketLock = std::unique_lock< std::mutex >(bucket->mutex);
+                if (!bucket->retired) {
+                    return bucket;
+                }
+                bucketLock.unlock();
+            }
+        }
+
+        /**
+         * Record that the given route is limited by the bucket with
+         * the given hash, moving anything queued for the route
+         * into that bucket.
+         *
+         * @return
+         *     The requests which the bucket now allows to be made
+         *     are returned.
+         */
+        std::vector< std::shared_ptr< PendingRequest > > LearnBucketHash(
+            const PendingRequest& pending,
+            const std::string& bucketHash,
+            const Settings& settings,
+            double now
+        ) {
+            std::shared_ptr< Bucket > oldBucket;
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                const auto oldKey = GetBucketKey(pending);
+                routeBucketHashes[pending.route] = bucketHash;
+                const auto newKey = GetBucketKey(pending);
+                if (oldKey == newKey) {
+                    return {};
+                }
+                const auto oldBucketsEntry = buckets.find(oldKey);
+                if (oldBucketsEntry == buckets.end()) {
+                    return {};
+                }
+                oldBucket = std::move(oldBucketsEntry->second);
+                buckets.erase(oldBucketsEntry);
+            }
+            for (;;) {
+                std::shared_ptr< Bucket > newBucket;
+                {
+                    std::lock_guard< decltype(mutex) > lock(mutex);
+                    newBucket = GetBucket(pending);
+                }
+                std::unique_lock< std::mutex > oldBucketLock(oldBucket->mutex, std::defer_lock);
+                std::unique_lock< std::mutex > newBucketLock(newBucket->mutex, std::defer_lock);
+                std::lock(oldBucketLock, newBucketLock);
+                if (newBucket->retired) {
+                    continue;
+                }
+                oldBucket->retired = true;
+                for (auto& queue: oldBucket->queues) {
+                    for (auto& queued: queue) {
+                        newBucket->Push(std::move(queued));
+                    }
+                    queue.clear();
+                }
+                newBucket->inFlight += oldBucket->inFlight;
+                oldBucket->inFlight = 0;
+                if (oldBucket->timerToken != 0) {
+                    if (settings.scheduler != nullptr) {
+                        settings.scheduler->Cancel(oldBucket->timerToken);
+                    }
+                    oldBucket->timerToken = 0;
+                }
+                oldBucketLock.unlock();
+                return Dispatch(newBucket, settings, now);
+            }
+        }
+
+        /**
+         * Take as many of the requests queued in the given bucket as its
+         * rate limit allows, and arrange to take the rest once it resets.
+         * The bucket's lock must be held.
+         *
+         * @return
+         *     The requests to make are returned.
+         */
+        std::vector< std::shared_ptr< PendingRequest > > Dispatch(
+            const std::shared_ptr< Bucket >& bucket,
+            const Settings& settings,
+            double now
+        ) {
+            std::vector< std::shared_ptr< PendingRequest > > sends;
+            if (
+                bucket->limitsKnown
+                && (now >= bucket->resetTime)
+            ) {
+                bucket->remaining = bucket->limit;
+            }
+            for (;;) {
+                // Until we know the bucket's limits, make only one
+                // request at a time, so that we learn them without
+                // risking being rate limited.
+                if (
+                    !bucket->limitsKnown
+                    && (bucket->inFlight > 0)
+                ) {
+                    break;
+                }
+                const auto backgroundAllowed = (
+                    !bucket->limitsKnown
+                    || (bucket->limit <= BACKGROUND_RESERVE)
+                    || (bucket->remaining > BACKGROUND_RESERVE)
+                );
+                const auto priority = bucket->PickQueue(backgroundAllowed);
+                if (priority == NUM_PRIORITIES) {
+                    if (!bucket->IsEmpty()) {
+                        ScheduleDispatch(bucket, bucket->resetTime, settings);
+                    }
+                    break;
+                }
+                if (
+                    bucket->limitsKnown
+                    && (bucket->remaining <= 0)
+                ) {
+                    ScheduleDispatch(bucket, bucket->resetTime, settings);
+                    break;
+                }
+                const auto globalWait = settings.globalRateLimiter->TryAcquire(now);
+                if (globalWait > 0.0) {
+                    ScheduleDispatch(bucket, now + globalWait, settings);
+                    break;
+                }
+                auto pending = bucket->Pop(priority);
+                if (bucket->limitsKnown) {
+                    --bucket->remaining;
+                }
+                ++bucket->inFlight;
+                if (!pending->sent) {
+                    pending->sent = true;
+                    queueDelays[priority].Record(now - pending->queuedTime);
+                }
+                sends.push_back(std::move(pending));
+            }
+            return sends;
+        }
+
+        /**
+         * Handle the response to a request made on behalf of a caller.
+         */
+        void OnResponse(
+            const std::shared_ptr< PendingRequest >& pending,
+            Response&& response
+        ) {
+            {
+                std::lock_guard< decltype(waitersMutex) > lock(waitersMutex);
+                pending->cancel = nullptr;
+            }
+            const auto settings = GetSettings();
+            const auto now = GetCurrentTime(*settings);
+            std::vector< std::shared_ptr< PendingRequest > > sends;
+            const auto bucketHash = Routes::GetHeader(response.headers, HeaderName::XRateLimitBucket);
+            if (!bucketHash.empty()) {
+                sends = LearnBucketHash(*pending, bucketHash, *settings, now);
+            }
+
+            // Only rate limited responses might be set aside and the
+            // request made again; the cache ignores those anyway.
+            if (response.status != 429) {
+                const auto& responseCache = settings->responseCache;
+                if (responseCache != nullptr) {
+                    response = responseCache->Update(
+                        pending->request,
+                        std::move(response),
+                        now
+                    );
+                }
+            }
+            std::unique_lock< std::mutex > bucketLock;
+            const auto bucket = LockBucket(*pending, bucketLock);
+            if (bucket->inFlight > 0) {
+                --bucket->inFlight;
+            }
+            const auto remaining = Routes::GetHeader(response.headers, HeaderName::XRateLimitRemaining);
+            const auto resetAfter = Routes::GetHeader(response.headers, HeaderName::XRateLimitResetAfter);
+            if (
+                !remaining.empty()
+                && !resetAfter.empty()
+            ) {
+                const auto remainingCount = atoi(remaining.c_str());
+                if (
+                    !bucket->limitsKnown
+                    || (now >= bucket->resetTime)
+                ) {
+                    bucket->remaining = remainingCount;
+                } else {
+                    bucket->remaining = std::min(bucket->remaining, remainingCount);
+                }
+                bucket->resetTime = now + atof(resetAfter.c_str());
+                const auto limit = Routes::GetHeader(response.headers, HeaderName::XRateLimitLimit);
+                if (limit.empty()) {
+                    bucket->limit = std::max(bucket->limit, remainingCount + 1);
+                } else {
+                    bucket->limit = atoi(limit.c_str());
+                }
+                bucket->limitsKnown = true;
+            } else if (
+                (response.status >= 200)
+                && (response.status != 429)
+                && (response.status != 499)
+                && !bucket->limitsKnown
+            ) {
+                // Discord doesn't report rate limits for routes which
+                // don't have any.
+                bucket->limitsKnown = true;
+                bucket->limit = bucket->remaining = std::numeric_limits< int >::max();
+            }
+            if (
+                (response.status == 429)
+                && !pending->done
+                && (pending->retries < MAX_RATE_LIMITED_RETRIES)
+            ) {
+                ++pending->retries;
+                auto retryAfter = Routes::GetHeader(response.headers, HeaderName::RetryAfter);
+                if (retryAfter.empty()) {
+                    retryAfter = resetAfter;
+                }
+                const auto retryTime = now + (
+                    retryAfter.empty()
+                    ? DEFAULT_RETRY_AFTER
+                    : atof(retryAfter.c_str())
+                );
+                if (
+                    StringExtensions::ToLower(
+                        Routes::GetHeader(response.headers, HeaderName::XRateLimitGlobal)
+                    ) == "true"
+                ) {
+                    settings->globalRateLimiter->Pause(retryTime);
+                } else {
+                    bucket->remaining = 0;
+                    bucket->resetTime = std::max(bucket->resetTime, retryTime);
+                    bucket->limitsKnown = true;
+                }
+                auto retry = pending;
+                bucket->Push(std::move(retry), true);
+            } else if (
+                (response.status == 304)
+                && pending->revalidating
+                && !pending->done
+            ) {
+                // The response we were revalidating is gone from the
+                // cache, and no caller asked for "304 Not Modified",
+                // so ask again for the whole thing.
+                pending->revalidating = false;
+                (void)pending->request.headers.Remove("If-None-Match");
+                auto retry = pending;
+                bucket->Push(std::move(retry), true);
+            } else {
+                std::lock_guard< decltype(waitersMutex) > lock(waitersMutex);
+                Complete(pending, std::move(response));
+            }
+            auto dispatched = Dispatch(bucket, *settings, now);
+            bucketLock.unlock();
+            Send(sends);
+            Send(dispatched);
+            DeliverResponses();
+        }
+
+        /**
+         * Arrange for the requests queued in the given bucket to be made
+         * at the given time, once the rate limits holding them back
+         * have reset.  The bucket's lock must be held.
+         */
+        void ScheduleDispatch(
+            const std::shared_ptr< Bucket >& bucket,
+            double due,
+            const Settings& settings
+        ) {
+            const auto& scheduler = settings.scheduler;
+            if (scheduler == nullptr) {
+                std::lock_guard< decltype(waitersMutex) > lock(waitersMutex);
+                for (auto& queue: bucket->queues) {
+                    for (auto& pending: queue) {
+                        Complete(pending, {429});
+                    }
+                    queue.clear();
+                }
+                return;
+            }
+            if (bucket->timerToken != 0) {
+                if (bucket->timerDue <= due) {
+                    return;
+                }
+                scheduler->Cancel(bucket->timerToken);
+            }
+            std::weak_ptr< Impl > weakSelf(shared_from_this());
+            std::weak_ptr< Bucket > weakBucket(bucket);
+            bucket->timerToken = scheduler->Schedule(
+                [weakSelf, weakBucket]{
+                    const auto self = weakSelf.lock();
+                    const auto bucket = weakBucket.lock();
+                    if (
+                        (self == nullptr)
+                        || (bucket == nullptr)
+                    ) {
+                        return;
+                    }
+                    std::unique_lock< std::mutex > bucketLock(bucket->mutex);
+                    bucket->timerToken = 0;
+                    if (bucket->retired) {
+                        return;
+                    }
+                    const auto settings = self->GetSettings();
+                    const auto sends = self->Dispatch(
+                        bucket,
+                        *settings,
+                        GetCurrentTime(*settings)
+                    );
+                    bucketLock.unlock();
+                    self->Send(sends);
+                    self->DeliverResponses();
+                },
+                due
+            );
+            bucket->timerDue = due;
+        }
+
+        /**
+         * Make the given request, and arrange for its response to be
+         * handled once it arrives.  No locks may be held.
+         */
+        void Send(const std::shared_ptr< PendingRequest >& pending) {
+            unsigned int attempt;
+            {
+                std::lock_guard< decltype(waitersMutex) > lock(waitersMutex);
+                attempt = ++pending->attempts;
+            }
+            auto request = pending->request;
+            const auto self = shared_from_this();
+            auto cancel = connections->QueueResourceRequest(
+                std::move(request),
+                [self, pending](Response&& response){
+                    self->OnResponse(pending, std::move(response));
+                }
+            );
+            {
+                // If every caller canceled while the request was being
+                // handed off, it's up to us to cancel it.  The response
+                // may also have arrived already, and the request even
+                // been made again.
+                std::lock_guard< decltype(waitersMutex) > lock(waitersMutex);
+                if (pending->attempts != attempt) {
+                    return;
+                }
+                if (!pending->done) {
+                    pending->cancel = std::move(cancel);
+                    cancel = nullptr;
+                }
+            }
+            if (cancel != nullptr) {
+                cancel();
+            }
+        }
+
+        void Send(const std::vector< std::shared_ptr< PendingRequest > >& sends) {
+            for (const auto& pending: sends) {
+                Send(pending);
+            }
+        }
+
+        /**
+         * Queue the given request for the given caller, returning
+         * the delegate which stops the caller waiting for it.
+         * No locks may be held.
+         */
+        CancelDelegate Queue(
+            const std::shared_ptr< Waiter >& waiter,
+            ResourceRequest&& request
+        ) {
+            const auto coalescingKey = GetCoalescingKey(request);
+            const auto settings = GetSettings();
+            const auto now = GetCurrentTime(*settings);
+            ResponseCache::Lookup cached;
+            const auto& responseCache = settings->responseCache;
+            if (responseCache != nullptr) {
+                cached = responseCache->Find(request, now);
+                if (cached.freshness == ResponseCache::Freshness::Fresh) {
+                    {
+                        std::lock_guard< decltype(waitersMutex) > lock(waitersMutex);
+                        Respond(*waiter, std::move(cached.response));
+                    }
+                    DeliverResponses();
+                    return []{};
+                }
+            }
+            const auto priority = request.priority;
+            std::shared_ptr< PendingRequest > pending;
+            bool coalesced = false;
+            {
+                std::lock_guard< decltype(waitersMutex) > lock(waitersMutex);
+                if (!coalescingKey.empty()) {
+                    const auto inProgressGetsEntry = inProgressGets.find(coalescingKey);
+                    if (inProgressGetsEntry != inProgressGets.end()) {
+                        pending = inProgressGetsEntry->second;
+                        coalesced = true;
+                    }
+                }
+                if (!coalesced) {
+                    pending = std::make_shared< PendingRequest >();
+                    pending->route = GetRoute(request);
+                    pending->majorParameter = Routes::GetMajorParameter(Routes::GetPathSegments(request.uri));
+                    pending->request = std::move(request);
+                    if (pending->request.body.length() >= MIN_SHARED_BODY_SIZE) {
+                        pending->request.sharedBody = std::make_shared< const std::string >(
+                            std::move(pending->request.body)
+                        );
+                        pending->request.body.clear();
+                    }
+                    if (cached.freshness == ResponseCache::Freshness::Stale) {
+                        pending->request.headers.push_back({"If-None-Match", std::move(cached.entityTag)});
+                        pending->revalidating = true;
+                    }
+                    pending->coalescingKey = coalescingKey;
+                    if (!coalescingKey.empty()) {
+                        inProgressGets[coalescingKey] = pending;
+                    }
+                }
+                pending->waiters.push_back(waiter);
+            }
+            std::weak_ptr< Impl > weakSelf(shared_from_this());
+            CancelDelegate cancel = [weakSelf, pending, waiter]{
+                const auto self = weakSelf.lock();
+                if (self == nullptr) {
+                    return;
+                }
+                {
+                    std::unique_lock< decltype(self->waitersMutex) > lock(self->waitersMutex);
+                    self->CancelWaiter(pending, waiter, lock);
+                }
+                self->DeliverResponses();
+            };
+            std::unique_lock< std::mutex > bucketLock;
+            const auto bucket = LockBucket(*pending, bucketLock);
+            if (coalesced) {
+                bucket->Promote(pending, priority);
+            } else {
+                pending->queuedTime = now;
+                auto queued = pending;
+                bucket->Push(std::move(queued));
+            }
+            const auto sends = Dispatch(bucket, *settings, now);
+            bucketLock.unlock();
+            Send(sends);
+            DeliverResponses();
+            return cancel;
+        }
+    };
+
+    Rest::~Rest() noexcept = default;
+    Rest::Rest(Rest&&) noexcept = default;
+    Rest& Rest::operator=(Rest&&) noexcept = default;
+
+    Rest::Rest(const std::shared_ptr< Connections >& connections)
+        : impl_(std::make_shared< Impl >())
+    {
+        impl_->connections = connections;
+    }
+
+    void Rest::SetScheduler(const std::shared_ptr< Timekeeping::Scheduler >& scheduler) {
+        impl_->ChangeSettings(
+            [scheduler](Settings& settings){
+                settings.scheduler = scheduler;
+            }
+        );
+    }
+
+    void Rest::SetGlobalRateLimiter(const std::shared_ptr< GlobalRateLimiter >& globalRateLimiter) {
+        impl_->ChangeSettings(
+            [globalRateLimiter](Settings& settings){
+                settings.globalRateLimiter = globalRateLimiter;
+            }
+        );
+    }
+
+    void Rest::SetResponseCache(const std::shared_ptr< ResponseCache >& responseCache) {
+        impl_->ChangeSettings(
+            [responseCache](Settings& settings){
+                settings.responseCache = responseCache;
+            }
+        );
+    }
+
+    auto Rest::GetQueueDelayStatistics(Priority priority) const -> QueueDelayStatistics {
+        const auto& queueDelays = impl_->queueDelays[(size_t)priority];
+        QueueDelayStatistics statistics;
+        statistics.numRequests = queueDelays.numRequests;
+        statistics.totalDelay = queueDelays.totalDelay;
+        statistics.maxDelay = queueDelays.maxDelay;
+        return statistics;
+    }
+
+    std::string Rest::GetRoute(const ResourceRequest& request) {
+        return Routes::GetRoute(request, true);
+    }
+
+    auto Rest::QueueResourceRequest(
+        const ResourceRequest& request
+    ) -> ResourceRequestTransaction {
+        return QueueResourceRequest(ResourceRequest(request));
+    }
+
+    auto Rest::QueueResourceRequest(
+        ResourceRequest&& request
+    ) -> ResourceRequestTransaction {
+        const auto waiter = std::make_shared< Waiter >();
+        ResourceRequestTransaction transaction;
+        transaction.response = waiter->response.get_future();
+        transaction.cancel = impl_->Queue(waiter, std::move(request));
+        return transaction;
+    }
+
+    auto Rest::QueueResourceRequest(
+        ResourceRequest&& request,
+        ResponseDelegate&& onResponse
+    ) -> CancelDelegate {
+        const auto waiter = std::make_shared< Waiter >();
+        waiter->onResponse = std::move(onResponse);
+        return impl_->Queue(waiter, std::move(request));
+    }
+
+    auto Rest::QueueWebSocketRequest(
+        const WebSocketRequest& request
+    ) -> WebSocketRequestTransaction {
+        return impl_->connections->QueueWebSocketRequest(request);
+    }
+
+}
@@ -0,0 +1,185 @@
+/**
+ * @file Routes.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::Routes functions.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Routes.hpp"
+
+#include <algorithm>
+#include <StringExtensions/StringExtensions.hpp>
+
+namespace Discord {
+
+    namespace Routes {
+
+        std::string GetHeader(
+            const Connections::Headers& headers,
+            const std::string& name
+        ) {
+            const auto value = headers.Find(name);
+            if (value == nullptr) {
+                return "";
+            }
+            return StringExtensions::Trim(*value);
+        }
+
+        std::string GetHeader(
+            const Connections::Headers& headers,
+            HeaderName name
+        ) {
+            const auto value = headers.Find(name);
+            if (value == nullptr) {
+                return "";
+            }
+            return StringExtensions::Trim(*value);
+        }
+
+        bool IsNumeric(const std::string& s) {
+            return (
+                !s.empty()
+                && (s.find_first_not_of("0123456789") == std::string::npos)
+            );
+        }
+
+        std::string GetField(
+            const Json::Value& data,
+            const std::string& name
+        ) {
+            const auto* value = &data;
+            for (const auto& key: StringExtensions::Split(name, '.')) {
+                if (
+                    (value->GetType() != Json::Value::Type::Object)
+                    || !value->Has(key)
+                ) {
+                    return "";
+                }
+                value = &(*value)[key];
+            }
+            if (value->GetType() != Json::Value::Type::String) {
+                return "";
+            }
+            return (std::string)*value;
+        }
+
+        std::vector< std::string > GetPathSegments(const std::string& uri) {
+            auto path = uri;
+            const auto schemeDelimiter = path.find("://");
+            if (schemeDelimiter != std::string::npos) {
+                const auto pathStart = path.find('/', schemeDelimiter + 3);
+                if (pathStart == std::string::npos) {
+                    path.clear();
+                } else {
+                    path = path.substr(pathStart);
+                }
+            }
+            const auto queryDelimiter = path.find_first_of("?#");
+            if (queryDelimiter != std::string::npos) {
+                path = path.substr(0, queryDelimiter);
+            }
+            std::vector< std::string > segments;
+            for (const auto& segment: StringExtensions::Split(path, '/')) {
+                if (!segment.empty()) {
+                    segments.push_back(segment);
+                }
+            }
+            if (
+                !segments.empty()
+                && (segments[0] == "api")
+            ) {
+                segments.erase(segments.begin());
+                if (
+                    !segments.empty()
+                    && (segments[0].length() > 1)
+                    && (segments[0][0] == 'v')
+                    && IsNumeric(segments[0].substr(1))
+                ) {
+                    segments.erase(segments.begin());
+                }
+            }
+            return segments;
+        }
+
+        std::string JoinPath(const std::vector< std::string >& segments) {
+            std::string path;
+            for (const auto& segment: segments) {
+                path += "/";
+                path += segment;
+            }
+            return path;
+        }
+
+        std::string GetMajorParameter(const std::vector< std::string >& segments) {
+            if (segments.size() < 2) {
+                return "";
+            }
+            if (
+                (segments[0] == "channels")
+                || (segments[0] == "guilds")
+            ) {
+                return segments[0] + "/" + segments[1];
+            } else if (segments[0] == "webhooks") {
+                auto majorParameter = segments[0] + "/" + segments[1];
+                if (segments.size() >= 3) {
+                    majorParameter += "/" + segments[2];
+                }
+                return majorParameter;
+            } else {
+                return "";
+            }
+        }
+
+        std::string GetRoute(
+            const Connections::ResourceRequest& request,
+            bool keepMajorParameter
+        ) {
+            const auto segments = GetPathSegments(request.uri);
+            const auto majorParameter = GetMajorParameter(segments);
+            const auto numMajorParameterSegments = (
+                (majorParameter.empty() || !keepMajorParameter)
+                ? 0
+                : std::count(majorParameter.begin(), majorParameter.end(), '/') + 1
+            );
+            std::string route = request.method + " ";
+            for (size_t i = 0; i < segments.size(); ++i) {
+                route += "/";
+                if ((ptrdiff_t)i < numMajorParameterSegments) {
+                    route += segments[i];
+                } else if (
+                    (i > 0)
+                    && (segments[i - 1] == "reactions")
+                ) {
+                    route += "{emoji}";
+                } else if (IsNumeric(segments[i])) {
+                    route += "{id}";
+                } else {
+                    route += segments[i];
+                }
+            }
+            return route;
+        }
+
+        std::string GetRequestKey(const Connections::ResourceRequest& request) {
+            auto key = request.method + " " + request.uri;
+            for (const auto& header: request.headers) {
+                const auto name = StringExtensions::ToLower(header.key);
+                if (
+                    (name == "if-none-match")
+                    || (name == "if-modified-since")
+                ) {
+                    continue;
+                }
+                key += '\n';
+                key += name;
+                key += ':';
+                key += header.value;
+            }
+            return key;
+        }
+
+    }
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * @file Routes.hpp
+ *
+ * This module declares the Discord::Routes functions, which are used
+ * to pick apart requests of Discord's REST API.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <Discord/Connections.hpp>
+#include <Json/Value.hpp>
+#include <string>
+#include <vector>
+
+namespace Discord {
+
+    namespace Routes {
+
+        /**
+         * Return the value of the header with the given name (in lower case)
+         * from the given headers, or an empty string if there is no such
+         * header.
+         */
+        std::string GetHeader(
+            const Connections::Headers& headers,
+            const std::string& name
+        );
+        std::string GetHeader(
+            const Connections::Headers& headers,
+            HeaderName name
+        );
+
+        bool IsNumeric(const std::string& s);
+
+        /**
+         * Return the value of the string field of the given data with
+         * the given name, where a dot separates the names of nested
+         * fields, or an empty string if there is no such field.
+         */
+        std::string GetField(
+            const Json::Value& data,
+            const std::string& name
+        );
+
+        /**
+         * Break down the path of the given URI into its segments, leaving out
+         * the scheme, host, query, and the API prefix ("/api" or "/api/vN").
+         */
+        std::vector< std::string > GetPathSegments(const std::string& uri);
+
+        /**
+         * Return the given path segments joined into a path,
+         * such as "/channels/1234/messages".
+         */
+        std::string JoinPath(const std::vector< std::string >& segments);
+
+        /**
+         * Return the major parameter of the request with the given path
+         * segments, in the form "channels/1234", or an empty string
+         * if the request has no major parameter.
+         */
+        std::string GetMajorParameter(const std::vector< std::string >& segments);
+
+        /**
+         * Return the route of the given request, which is its method and
+         * path with all parameters other than the major parameter
+         * replaced by placeholders.  If the major parameter isn't kept,
+         * it's replaced by a placeholder as well.
+         */
+        std::string GetRoute(
+            const Connections::ResourceRequest& request,
+            bool keepMajorParameter
+        );
+
+        /**
+         * Return a key which is the same for any two requests which would
+         * get the same response: the same method, URI, and headers, other
+         * than headers which make the request conditional.
+         */
+        std::string GetRequestKey(const Connections::ResourceRequest& request);
+
+    }
+
+}
@@ -0,0 +1,992 @@
+/**
+ * @file SimdJsonDecoder.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::SimdJsonDecoder class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <algorithm>
+#include <Discord/SimdJsonDecoder.hpp>
+#include <Json/Value.hpp>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define DISCORD_JSON_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DISCORD_JSON_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+    /**
+     * This is the number of bytes of JSON text classified at a time
+     * by the first pass, one for each bit of a 64-bit mask.
+     */
+    constexpr size_t BLOCK_SIZE = 64;
+
+    /**
+     * This is how deeply arrays and objects may be nested in the
+     * JSON text decoded.
+     */
+    constexpr size_t MAX_DEPTH = 1024;
+
+    /**
+     * These are bitmasks of where certain kinds of characters are in one
+     * block of JSON text, with the lowest bit standing for the first
+     * character of the block.
+     */
+    struct BlockMasks {
+        uint64_t backslashes = 0;
+        uint64_t quotes = 0;
+
+        /**
+         * These are the braces, brackets, colons, and commas.
+         */
+        uint64_t operators = 0;
+
+        uint64_t whitespace = 0;
+
+        /**
+         * These are the characters which may not appear in strings
+         * without being escaped (below U+0020).
+         */
+        uint64_t controls = 0;
+
+        uint64_t nonAscii = 0;
+    };
+
+    /**
+     * This is the type of function used to classify the characters
+     * of one block of JSON text.
+     */
+    using Classifier = void (*)(const uint8_t* block, BlockMasks& masks);
+
+    void ClassifyScalar(const uint8_t* block, BlockMasks& masks) {
+        masks = BlockMasks();
+        for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+            const auto c = block[i];
+            const auto bit = (uint64_t)1 << i;
+            switch (c) {
+                case '\\': {
+                    masks.backslashes |= bit;
+                } break;
+
+                case '"': {
+                    masks.quotes |= bit;
+                } break;
+
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',': {
+                    masks.operators |= bit;
+                } break;
+
+                case ' ':
+                case '\t':
+                case '\r':
+                case '\n': {
+                    masks.whitespace |= bit;
+                } break;
+
+                default: break;
+            }
+            if (c < 0x20) {
+                masks.controls |= bit;
+            } else if (c >= 0x80) {
+                masks.nonAscii |= bit;
+            }
+        }
+    }
+
+#if defined(DISCORD_JSON_SSE2)
+
+    /**
+     * Apply the given comparison to each 16-byte chunk of a block,
+     * gathering the results into one 64-bit mask.
+     */
+    template< typename Compare > uint64_t Gather(
+        const __m128i (&chunks)[4],
+        Compare compare
+    ) {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            mask |= (
+                (uint64_t)(uint32_t)_mm_movemask_epi8(compare(chunks[i]))
+                << (16 * i)
+            );
+        }
+        return mask;
+    }
+
+    void ClassifyVector(const uint8_t* block, BlockMasks& masks) {
+        __m128i chunks[4];
+        for (size_t i = 0; i < 4; ++i) {
+            chunks[i] = _mm_loadu_si128((const __m128i*)(block + 16 * i));
+        }
+        const auto backslash = _mm_set1_epi8('\\');
+        const auto quote = _mm_set1_epi8('"');
+        const auto openBrace = _mm_set1_epi8('{');
+        const auto closeBrace = _mm_set1_epi8('}');
+        const auto openBracket = _mm_set1_epi8('[');
+        const auto closeBracket = _mm_set1_epi8(']');
+        const auto colon = _mm_set1_epi8(':');
+        const auto comma = _mm_set1_epi8(',');
+        const auto space = _mm_set1_epi8(' ');
+        const auto tab = _mm_set1_epi8('\t');
+        const auto carriageReturn = _mm_set1_epi8('\r');
+        const auto lineFeed = _mm_set1_epi8('\n');
+        const auto lastControl = _mm_set1_epi8(0x1F);
+        masks.backslashes = Gather(
+            chunks,
+            [&](__m128i c){ return _mm_cmpeq_epi8(c, backslash); }
+        );
+        masks.quotes = Gather(
+            chunks,
+            [&](__m128i c){ return _mm_cmpeq_epi8(c, quote); }
+        );
+        masks.operators = Gather(
+            chunks,
+            [&](__m128i c){
+                return _mm_or_si128(
+                    _mm_or_si128(
+                        _mm_or_si128(
+                            _mm_cmpeq_epi8(c, openBrace),
+                            _mm_cmpeq_epi8(c, closeBrace)
+                        ),
+                        _mm_or_si128(
+                            _mm_cmpeq_epi8(c, openBracket),
+                            _mm_cmpeq_epi8(c, closeBracket)
+                        )
+                    ),
+                    _mm_or_si128(
+                        _mm_cmpeq_epi8(c, colon),
+                        _mm_cmpeq_epi8(c, comma)
+                    )
+                );
+            }
+        );
+        masks.whitespace = Gather(
+            chunks,
+            [&](__m128i c){
+                return _mm_or_si128(
+                    _mm_or_si128(
+                        _mm_cmpeq_epi8(c, space),
+                        _mm_cmpeq_epi8(c, tab)
+                    ),
+                    _mm_or_si128(
+                        _mm_cmpeq_epi8(c, carriageReturn),
+                        _mm_cmpeq_epi8(c, lineFeed)
+                    )
+                );
+            }
+        );
+        masks.controls = Gather(
+            chunks,
+            [&](__m128i c){
+                return _mm_cmpeq_epi8(_mm_max_epu8(c, lastControl), lastControl);
+            }
+        );
+        masks.nonAscii = Gather(
+            chunks,
+            [](__m128i c){ return c; }
+        );
+    }
+
+#elif defined(DISCORD_JSON_NEON)
+
+    /**
+     * Return a 16-bit mask with a bit set for each byte of the given
+     * comparison result which is set.
+     */
+    uint16_t MoveMask(uint8x16_t matches) {
+        static const uint8_t bitValues[16] = {
+            1, 2, 4, 8, 16, 32, 64, 128,
+            1, 2, 4, 8, 16, 32, 64, 128,
+        };
+        auto bits = vandq_u8(matches, vld1q_u8(bitValues));
+        bits = vpaddq_u8(bits, bits);
+        bits = vpaddq_u8(bits, bits);
+        bits = vpaddq_u8(bits, bits);
+        return vgetq_lane_u16(vreinterpretq_u16_u8(bits), 0);
+    }
+
+    /**
+     * Apply the given comparison to each 16-byte chunk of a block,
+     * gathering the results into one 64-bit mask.
+     */
+    template< typename Compare > uint64_t Gather(
+        const uint8x16_t (&chunks)[4],
+        Compare compare
+    ) {
+        uint64_t mask = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            mask |= (uint64_t)MoveMask(compare(chunks[i])) << (16 * i);
+        }
+        return mask;
+    }
+
+    void ClassifyVector(const uint8_t* block, BlockMasks& masks) {
+        uint8x16_t chunks[4];
+        for (size_t i = 0; i < 4; ++i) {
+            chunks[i] = vld1q_u8(block + 16 * i);
+        }
+        const auto backslash = vdupq_n_u8('\\');
+        const auto quote = vdupq_n_u8('"');
+        const auto openBrace = vdupq_n_u8('{');
+        const auto closeBrace = vdupq_n_u8('}');
+        const auto openBracket = vdupq_n_u8('[');
+        const auto closeBracket = vdupq_n_u8(']');
+        const auto colon = vdupq_n_u8(':');
+        const auto comma = vdupq_n_u8(',');
+        const auto space = vdupq_n_u8(' ');
+        const auto tab = vdupq_n_u8('\t');
+        const auto carriageReturn = vdupq_n_u8('\r');
+        const auto lineFeed = vdupq_n_u8('\n');
+        const auto firstPrintable = vdupq_n_u8(0x20);
+        const auto firstNonAscii = vdupq_n_u8(0x80);
+        masks.backslashes = Gather(
+            chunks,
+            [&](uint8x16_t c){ return vceqq_u8(c, backslash); }
+        );
+        masks.quotes = Gather(
+            chunks,
+            [&](uint8x16_t c){ return vceqq_u8(c, quote); }
+        );
+        masks.operators = Gather(
+            chunks,
+            [&](uint8x16_t c){
+                return vorrq_u8(
+                    vorrq_u8(
+                        vorrq_u8(vceqq_u8(c, openBrace), vceqq_u8(c, closeBrace)),
+                        vorrq_u8(vceqq_u8(c, openBracket), vceqq_u8(c, closeBracket))
+                    ),
+                    vorrq_u8(vceqq_u8(c, colon), vceqq_u8(c, comma))
+                );
+            }
+        );
+        masks.whitespace = Gather(
+            chunks,
+            [&](uint8x16_t c){
+                return vorrq_u8(
+                    vorrq_u8(vceqq_u8(c, space), vceqq_u8(c, tab)),
+                    vorrq_u8(vceqq_u8(c, carriageReturn), vceqq_u8(c, lineFeed))
+                );
+            }
+        );
+        masks.controls = Gather(
+            chunks,
+            [&](uint8x16_t c){ return vcltq_u8(c, firstPrintable); }
+        );
+        masks.nonAscii = Gather(
+            chunks,
+            [&](uint8x16_t c){ return vcgeq_u8(c, firstNonAscii); }
+        );
+    }
+
+#endif
+
+    size_t CountTrailingZeros(uint64_t bits) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        (void)_BitScanForward64(&index, bits);
+        return (size_t)index;
+#else
+        return (size_t)__builtin_ctzll(bits);
+#endif
+    }
+
+    /**
+     * Return a mask of the characters of a block which are escaped by
+     * backslashes, given the mask of the block's backslashes.  The
+     * given carry is set if the first character of the block is escaped
+     * by a backslash at the end of the block before, and is updated
+     * for the block after.
+     */
+    uint64_t FindEscaped(
+        uint64_t backslashes,
+        uint64_t& previousEscaped
+    ) {
+        if (backslashes == 0) {
+            const auto escaped = previousEscaped;
+            previousEscaped = 0;
+            return escaped;
+        }
+
+        // A run of backslashes escapes every other character after its
+        // start.  Adding the starts of the runs which start on odd bits
+        // to the backslashes carries each of those runs off its end, which
+        // leaves behind the runs which start on even bits.  Runs ending
+        // on an even bit escape the odd character after them, and the
+        // other way around.
+        constexpr uint64_t evenBits = 0x5555555555555555ULL;
+        backslashes &= ~previousEscaped;
+        const auto followsEscape = (backslashes << 1) | previousEscaped;
+        const auto oddSequenceStarts = backslashes & ~evenBits & ~followsEscape;
+        const auto sequencesStartingOnEvenBits = oddSequenceStarts + backslashes;
+        previousEscaped = (
+            (sequencesStartingOnEvenBits < backslashes)
+            ? 1
+            : 0
+        );
+        const auto invertMask = sequencesStartingOnEvenBits << 1;
+        return (evenBits ^ invertMask) & followsEscape;
+    }
+
+    /**
+     * Return a mask with each bit set if an odd number of bits are set
+     * in the given mask at or below it.
+     */
+    uint64_t PrefixXor(uint64_t bits) {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+    /**
+     * Check that the bytes of the given text, from the given position up
+     * to the given end, are well-formed UTF-8, advancing the position
+     * past the last sequence checked (which may run past the end).
+     */
+    bool ValidateUtf8(
+        const uint8_t* data,
+        size_t length,
+        size_t& p,
+        size_t end
+    ) {
+        while (p < end) {
+            const auto c = data[p];
+            if (c < 0x80) {
+                ++p;
+                continue;
+            }
+            size_t numContinuationBytes;
+            uint32_t codePoint;
+            uint32_t minCodePoint;
+            if ((c & 0xE0) == 0xC0) {
+                numContinuationBytes = 1;
+                codePoint = c & 0x1F;
+                minCodePoint = 0x80;
+            } else if ((c & 0xF0) == 0xE0) {
+                numContinuationBytes = 2;
+                codePoint = c & 0x0F;
+                minCodePoint = 0x800;
+            } else if ((c & 0xF8) == 0xF0) {
+                numContinuationBytes = 3;
+                codePoint = c & 0x07;
+                minCodePoint = 0x10000;
+            } else {
+                return false;
+            }
+            if (length - p <= numContinuationBytes) {
+                return false;
+            }
+            for (size_t i = 1; i <= numContinuationBytes; ++i) {
+                const auto continuation = data[p + i];
+                if ((continuation & 0xC0) != 0x80) {
+                    return false;
+                }
+                codePoint = (codePoint << 6) | (continuation & 0x3F);
+            }
+            if (
+                (codePoint < minCodePoint)
+                || (codePoint > 0x10FFFF)
+                || (
+                    (codePoint >= 0xD800)
+                    && (codePoint <= 0xDFFF)
+                )
+            ) {
+                return false;
+            }
+            p += numContinuationBytes + 1;
+        }
+        return true;
+    }
+
+    /**
+     * Find the structural characters of the given JSON text (the braces,
+     * brackets, colons, and commas outside of strings, the opening
+     * quotation marks of strings, and the first characters of other
+     * values), storing their positions in the given index.
+     *
+     * Return false if the text isn't valid UTF-8, has control characters
+     * in its strings, or ends inside a string.
+     */
+    bool IndexStructure(
+        const std::string& encoding,
+        Classifier classify,
+        std::vector< uint32_t >& index,
+        size_t& indexLength
+    ) {
+        const auto length = encoding.length();
+        if (index.size() < length) {
+            index.resize(length);
+        }
+        indexLength = 0;
+        const auto data = (const uint8_t*)encoding.data();
+        uint64_t previousEscaped = 0;
+        uint64_t previousInString = 0;
+        uint64_t previousScalar = 0;
+        size_t utf8CheckedEnd = 0;
+        uint8_t lastBlock[BLOCK_SIZE];
+        for (size_t blockStart = 0; blockStart < length; blockStart += BLOCK_SIZE) {
+            // Pad the last block with whitespace.
+            auto block = data + blockStart;
+            const auto blockLength = std::min(BLOCK_SIZE, length - blockStart);
+            if (blockLength < BLOCK_SIZE) {
+                (void)memset(lastBlock, ' ', BLOCK_SIZE);
+                (void)memcpy(lastBlock, block, blockLength);
+                block = lastBlock;
+            }
+            BlockMasks masks;
+            classify(block, masks);
+
+            // Only blocks with bytes that aren't ASCII need to be checked
+            // for UTF-8 one byte at a time.
+            if (masks.nonAscii != 0) {
+                auto p = std::max(utf8CheckedEnd, blockStart);
+                if (!ValidateUtf8(data, length, p, blockStart + blockLength)) {
+                    return false;
+                }
+                utf8CheckedEnd = p;
+            }
+
+            // Find the strings.  The mask of what's in strings includes
+            // their opening quotation marks but not their closing ones.
+            const auto quotes = masks.quotes & ~FindEscaped(
+                masks.backslashes,
+                previousEscaped
+            );
+            const auto inString = PrefixXor(quotes) ^ previousInString;
+            previousInString = (uint64_t)((int64_t)inString >> 63);
+            if ((masks.controls & inString) != 0) {
+                return false;
+            }
+
+            // Index everything else which isn't whitespace, but only the
+            // first character of each run of characters making up
+            // a number or literal.
+            const auto operators = masks.operators & ~inString;
+            const auto scalars = ~(operators | masks.whitespace | quotes | inString);
+            const auto scalarStarts = scalars & ~((scalars << 1) | previousScalar);
+            previousScalar = scalars >> 63;
+            auto structurals = operators | (quotes & inString) | scalarStarts;
+            while (structurals != 0) {
+                index[indexLength++] = (uint32_t)(
+                    blockStart + CountTrailingZeros(structurals)
+                );
+                structurals &= structurals - 1;
+            }
+        }
+        return (previousInString == 0);
+    }
+
+    bool IsWhitespace(char c) {
+        return (
+            (c == ' ')
+            || (c == '\t')
+            || (c == '\r')
+            || (c == '\n')
+        );
+    }
+
+    bool IsDigit(char c) {
+        return ((c >= '0') && (c <= '9'));
+    }
+
+    bool DecodeHexQuad(
+        const std::string& encoding,
+        size_t& p,
+        uint32_t& value
+    ) {
+        if (encoding.length() - p < 4) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < 4; ++i) {
+            const auto c = encoding[p++];
+            value <<= 4;
+            if ((c >= '0') && (c <= '9')) {
+                value += (uint32_t)(c - '0');
+            } else if ((c >= 'A') && (c <= 'F')) {
+                value += (uint32_t)(c - 'A' + 10);
+            } else if ((c >= 'a') && (c <= 'f')) {
+                value += (uint32_t)(c - 'a' + 10);
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void EncodeUtf8(uint32_t codePoint, std::string& output) {
+        if (codePoint < 0x80) {
+            output.push_back((char)codePoint);
+        } else if (codePoint < 0x800) {
+            output.push_back((char)(0xC0 | (codePoint >> 6)));
+            output.push_back((char)(0x80 | (codePoint & 0x3F)));
+        } else if (codePoint < 0x10000) {
+            output.push_back((char)(0xE0 | (codePoint >> 12)));
+            output.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+            output.push_back((char)(0x80 | (codePoint & 0x3F)));
+        } else {
+            output.push_back((char)(0xF0 | (codePoint >> 18)));
+            output.push_back((char)(0x80 | ((codePoint >> 12) & 0x3F)));
+            output.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+            output.push_back((char)(0x80 | (codePoint & 0x3F)));
+        }
+    }
+
+    /**
+     * This builds the document for JSON text by walking the index
+     * of its structure made by IndexStructure.
+     */
+    struct Builder {
+        // Properties
+
+        const std::string& encoding;
+        const uint32_t* index;
+        size_t indexLength;
+
+        /**
+         * This is the position in the index of the next
+         * structural character to look at.
+         */
+        size_t next = 0;
+
+        /**
+         * This is where keys and strings are unescaped, kept from one
+         * to the next so that it only has to grow as long as the
+         * longest of them.
+         */
+        std::string text;
+
+        // Methods
+
+        Builder(
+            const std::string& encoding,
+            const uint32_t* index,
+            size_t indexLength
+        )
+            : encoding(encoding)
+            , index(index)
+            , indexLength(indexLength)
+        {
+        }
+
+        /**
+         * Move past the next structural character if it's
+         * the given operator.
+         */
+        bool TakeOperator(char op) {
+            if (
+                (next < indexLength)
+                && (encoding[index[next]] == op)
+            ) {
+                ++next;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * Tell whether the given position is just past the end of a number
+         * or literal, which is the case at anything other than another
+         * character which could be part of one.
+         */
+        bool IsScalarEnd(size_t p) const {
+            if (p >= encoding.length()) {
+                return true;
+            }
+            switch (encoding[p]) {
+                case '{':
+                case '}':
+                case '[':
+                case ']':
+                case ':':
+                case ',':
+                case '"': {
+                    return true;
+                }
+
+                default: {
+                    return IsWhitespace(encoding[p]);
+                }
+            }
+        }
+
+        /**
+         * Parse the string with the opening quotation mark at the given
+         * position.  The first pass has already made sure the string is
+         * closed, with no control characters in it.
+         */
+        bool ParseString(
+            size_t p,
+            std::string& output
+        ) {
+            output.clear();
+            ++p;
+            for (;;) {
+                const auto runBegin = p;
+                while (
+                    (encoding[p] != '"')
+                    && (encoding[p] != '\\')
+                ) {
+                    ++p;
+                }
+                output.append(encoding, runBegin, p - runBegin);
+                if (encoding[p++] == '"') {
+                    return true;
+                }
+                switch (encoding[p++]) {
+                    case '"': output.push_back('"'); break;
+                    case '\\': output.push_back('\\'); break;
+                    case '/': output.push_back('/'); break;
+                    case 'b': output.push_back('\b'); break;
+                    case 'f': output.push_back('\f'); break;
+                    case 'n': output.push_back('\n'); break;
+                    case 'r': output.push_back('\r'); break;
+                    case 't': output.push_back('\t'); break;
+                    case 'u': {
+                        uint32_t codePoint;
+                        if (!DecodeHexQuad(encoding, p, codePoint)) {
+                            return false;
+                        }
+                        if (
+                            (codePoint >= 0xD800)
+                            && (codePoint <= 0xDBFF)
+                            && (encoding.length() - p >= 6)
+                            && (encoding[p] == '\\')
+                            && (encoding[p + 1] == 'u')
+                        ) {
+                            auto q = p + 2;
+                            uint32_t lowSurrogate;
+                            if (
+                                DecodeHexQuad(encoding, q, lowSurrogate)
+                                && (lowSurrogate >= 0xDC00)
+                                && (lowSurrogate <= 0xDFFF)
+                            ) {
+                                codePoint = (
+                                    0x10000
+                                    + ((codePoint - 0xD800) << 10)
+                                    + (lowSurrogate - 0xDC00)
+                                );
+                                p = q;
+                            }
+                        }
+                        EncodeUtf8(codePoint, output);
+                    } break;
+                    default: return false;
+                }
+            }
+        }
+
+        bool ParseLiteral(
+            size_t p,
+            const char* literal,
+            size_t literalLength
+        ) const {
+            return (
+                (encoding.compare(p, literalLength, literal) == 0)
+                && IsScalarEnd(p + literalLength)
+            );
+        }
+
+        bool ParseNumber(
+            size_t p,
+            Json::Value& value
+        ) const {
+            const auto begin = p;
+            const auto length = encoding.length();
+            const auto negative = (encoding[p] == '-');
+            if (negative) {
+                ++p;
+            }
+            if (
+                (p >= length)
+                || !IsDigit(encoding[p])
+            ) {
+                return false;
+            }
+
+            // Accumulate the integer part, in case that's all there is.
+            uintmax_t magnitude = 0;
+            bool overflow = false;
+            if (encoding[p] == '0') {
+                ++p;
+            } else {
+                while (
+                    (p < length)
+                    && IsDigit(encoding[p])
+                ) {
+                    const auto digit = (uintmax_t)(encoding[p++] - '0');
+                    if (magnitude > (UINTMAX_MAX - digit) / 10) {
+                        overflow = true;
+                    } else {
+                        magnitude = magnitude * 10 + digit;
+                    }
+                }
+            }
+            bool isInteger = true;
+            if (
+                (p < length)
+                && (encoding[p] == '.')
+            ) {
+                isInteger = false;
+                ++p;
+                if (
+                    (p >= length)
+                    || !IsDigit(encoding[p])
+                ) {
+                    return false;
+                }
+                while (
+                    (p < length)
+                    && IsDigit(encoding[p])
+                ) {
+                    ++p;
+                }
+            }
+            if (
+                (p < length)
+                && (
+                    (encoding[p] == 'e')
+                    || (encoding[p] == 'E')
+                )
+            ) {
+                isInteger = false;
+                ++p;
+                if (
+                    (p < length)
+                    && (
+                        (encoding[p] == '+')
+                        || (encoding[p] == '-')
+                    )
+                ) {
+                    ++p;
+                }
+                if (
+                    (p >= length)
+                    || !IsDigit(encoding[p])
+                ) {
+                    return false;
+                }
+                while (
+                    (p < length)
+                    && IsDigit(encoding[p])
+                ) {
+                    ++p;
+                }
+            }
+            if (!IsScalarEnd(p)) {
+                return false;
+            }
+
+            // Numbers which fit are integers; everything else
+            // is floating point.
+            if (
+                isInteger
+                && !overflow
+            ) {
+                if (negative) {
+                    if (magnitude <= (uintmax_t)INTMAX_MAX) {
+                        value = Json::Value(-(intmax_t)magnitude);
+                        return true;
+                    } else if (magnitude == (uintmax_t)INTMAX_MAX + 1) {
+                        value = Json::Value((intmax_t)INTMAX_MIN);
+                        return true;
+                    }
+                } else if (magnitude <= (uintmax_t)INTMAX_MAX) {
+                    value = Json::Value((intmax_t)magnitude);
+                    return true;
+                }
+            }
+            value = Json::Value(
+                strtod(encoding.substr(begin, p - begin).c_str(), nullptr)
+            );
+            return true;
+        }
+
+        /**
+         * Parse the value starting at the next structural character,
+         * which is nested in the given number of arrays and objects.
+         */
+        bool ParseValue(
+            Json::Value& value,
+            size_t depth
+        ) {
+            if (next >= indexLength) {
+                return false;
+            }
+            const auto p = (size_t)index[next++];
+            switch (encoding[p]) {
+                case '{': {
+                    if (depth >= MAX_DEPTH) {
+                        return false;
+                    }
+                    value = Json::Value(Json::Value::Type::Object);
+                    if (TakeOperator('}')) {
+                        return true;
+                    }
+                    for (;;) {
+                        if (
+                            (next >= indexLength)
+                            || (encoding[index[next]] != '"')
+                            || !ParseString(index[next++], text)
+                            || !TakeOperator(':')
+                        ) {
+                            return false;
+                        }
+
+                        // Members and elements are added before they're
+                        // parsed, and parsed in place, so that they aren't
+                        // copied into their parents.
+                        value.Set(text, Json::Value());
+                        if (!ParseValue(value[text], depth + 1)) {
+                            return false;
+                        }
+                        if (!TakeOperator(',')) {
+                            return TakeOperator('}');
+                        }
+                    }
+                } break;
+
+                case '[': {
+                    if (depth >= MAX_DEPTH) {
+                        return false;
+                    }
+                    value = Json::Value(Json::Value::Type::Array);
+                    if (TakeOperator(']')) {
+                        return true;
+                    }
+                    for (;;) {
+                        value.Add(Json::Value());
+                        if (!ParseValue(value[value.GetSize() - 1], depth + 1)) {
+                            return false;
+                        }
+                        if (!TakeOperator(',')) {
+                            return TakeOperator(']');
+                        }
+                    }
+                } break;
+
+                case '"': {
+                    if (!ParseString(p, text)) {
+                        return false;
+                    }
+                    value = Json::Value(text);
+                    return true;
+                } break;
+
+                case 't': {
+                    value = Json::Value(true);
+                    return ParseLiteral(p, "true", 4);
+                } break;
+
+                case 'f': {
+                    value = Json::Value(false);
+                    return ParseLiteral(p, "false", 5);
+                } break;
+
+                case 'n': {
+                    value = Json::Value(nullptr);
+                    return ParseLiteral(p, "null", 4);
+                } break;
+
+                default: {
+                    return ParseNumber(p, value);
+                } break;
+            }
+        }
+    };
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a SimdJsonDecoder instance.
+     */
+    struct SimdJsonDecoder::Impl {
+        /**
+         * This is the way the decoder makes its first pass.
+         */
+        Kernel kernel = Kernel::Scalar;
+
+        /**
+         * This is the function used in the first pass to classify
+         * each block of the text.
+         */
+        Classifier classify = ClassifyScalar;
+    };
+
+    SimdJsonDecoder::~SimdJsonDecoder() noexcept = default;
+    SimdJsonDecoder::SimdJsonDecoder(SimdJsonDecoder&&) noexcept = default;
+    SimdJsonDecoder& SimdJsonDecoder::operator=(SimdJsonDecoder&&) noexcept = default;
+
+    SimdJsonDecoder::SimdJsonDecoder(Kernel kernel)
+        : impl_(std::make_shared< Impl >())
+    {
+#if defined(DISCORD_JSON_SSE2) || defined(DISCORD_JSON_NEON)
+        if (kernel == Kernel::Vector) {
+            impl_->kernel = Kernel::Vector;
+            impl_->classify = ClassifyVector;
+        }
+#endif
+    }
+
+    auto SimdJsonDecoder::GetKernel() const -> Kernel {
+        return impl_->kernel;
+    }
+
+    bool SimdJsonDecoder::IsVectorKernelAvailable() {
+#if defined(DISCORD_JSON_SSE2) || defined(DISCORD_JSON_NEON)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    Json::Value SimdJsonDecoder::Decode(const std::string& encoding) {
+        // The index is kept from one call to the next, so that it only
+        // has to grow when a larger text than any before it is decoded.
+        static thread_local std::vector< uint32_t > index;
+        size_t indexLength;
+        if (
+            (encoding.length() > UINT32_MAX)
+            || !IndexStructure(encoding, impl_->classify, index, indexLength)
+        ) {
+            return Json::Value(Json::Value::Type::Invalid);
+        }
+        Builder builder(encoding, index.data(), indexLength);
+        Json::Value value;
+        if (
+            !builder.ParseValue(value, 0)
+            || (builder.next != indexLength)
+        ) {
+            return Json::Value(Json::Value::Type::Invalid);
+        }
+        return value;
+    }
+
+}
@@ -0,0 +1,1737 @@
+/**
+ * @file SocketConnections.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::SocketConnections class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "WebSocketHandshake.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <Discord/SocketConnections.hpp>
+#include <errno.h>
+#include <mutex>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <random>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <StringExtensions/StringExtensions.hpp>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the status given to requests for which no response could
+     * be obtained, such as when the URI isn't supported, or the
+     * connection couldn't be made or was lost.
+     */
+    constexpr unsigned int STATUS_NO_RESPONSE = 502;
+
+    /**
+     * This is the most bytes to read from a socket at once.
+     */
+    constexpr size_t READ_CHUNK_SIZE = 65536;
+
+    /**
+     * This is the longest response head accepted, in bytes.
+     */
+    constexpr size_t MAX_HEAD_SIZE = 65536;
+
+    /**
+     * This is the close code sent when the other end of a WebSocket
+     * connection breaks the protocol.
+     */
+    constexpr unsigned int CLOSE_PROTOCOL_ERROR = 1002;
+
+    /**
+     * This is the close code sent when the other end of a WebSocket
+     * connection sends a frame or message which is too long.
+     */
+    constexpr unsigned int CLOSE_MESSAGE_TOO_BIG = 1009;
+
+    constexpr int MAX_EVENTS = 64;
+
+    /**
+     * This is the most time, in milliseconds, the socket thread waits
+     * before checking for connections which have sat idle too long.
+     */
+    constexpr int IDLE_CHECK_INTERVAL = 1000;
+
+    /**
+     * This is the identifier given to the event which wakes up
+     * the socket thread; connection identifiers start after it.
+     */
+    constexpr uint64_t WAKE_EVENT_ID = 0;
+
+    double GetCurrentTime() {
+        return std::chrono::duration< double >(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+    /**
+     * These are the parts of a URI needed to make a request.
+     */
+    struct Target {
+        std::string scheme;
+        std::string host;
+        std::string port;
+        std::string hostHeader;
+        std::string pathAndQuery;
+    };
+
+    bool ParseTarget(
+        const std::string& uri,
+        Target& target
+    ) {
+        const auto schemeDelimiter = uri.find("://");
+        if (schemeDelimiter == std::string::npos) {
+            return false;
+        }
+        target.scheme = StringExtensions::ToLower(uri.substr(0, schemeDelimiter));
+        const auto authorityStart = schemeDelimiter + 3;
+        auto pathStart = uri.find_first_of("/?#", authorityStart);
+        if (pathStart == std::string::npos) {
+            pathStart = uri.length();
+        }
+        target.hostHeader = uri.substr(authorityStart, pathStart - authorityStart);
+        const auto fragmentStart = uri.find('#', pathStart);
+        target.pathAndQuery = uri.substr(
+            pathStart,
+            (fragmentStart == std::string::npos) ? std::string::npos : fragmentStart - pathStart
+        );
+        if (target.pathAndQuery.empty() || (target.pathAndQuery[0] != '/')) {
+            target.pathAndQuery = "/" + target.pathAndQuery;
+        }
+        const auto& authority = target.hostHeader;
+        size_t portDelimiter;
+        if (
+            !authority.empty()
+            && (authority[0] == '[')
+        ) {
+            const auto literalEnd = authority.find(']');
+            if (literalEnd == std::string::npos) {
+                return false;
+            }
+            target.host = authority.substr(1, literalEnd - 1);
+            portDelimiter = authority.find(':', literalEnd);
+        } else {
+            portDelimiter = authority.find(':');
+            target.host = authority.substr(0, portDelimiter);
+        }
+        if (portDelimiter == std::string::npos) {
+            target.port = "80";
+        } else {
+            target.port = authority.substr(portDelimiter + 1);
+        }
+        return !target.host.empty();
+    }
+
+    bool IsIdempotent(const std::string& method) {
+        return (
+            (method == "GET")
+            || (method == "HEAD")
+            || (method == "PUT")
+            || (method == "DELETE")
+            || (method == "OPTIONS")
+        );
+    }
+
+    bool IsPipelinable(const std::string& method) {
+        return (
+            (method == "GET")
+            || (method == "HEAD")
+        );
+    }
+
+    /**
+     * This takes apart an HTTP response as it arrives.
+     */
+    struct ResponseParser {
+        // Types
+
+        enum class Framing {
+            None,
+            Length,
+            Chunked,
+            UntilClose,
+        };
+
+        enum class Result {
+            Incomplete,
+            Complete,
+            Error,
+        };
+
+        // Properties
+
+        bool headComplete = false;
+        Discord::Connections::Response response{0};
+        Framing framing = Framing::None;
+        uint64_t remaining = 0;
+        bool inChunk = false;
+        bool awaitingChunkEnd = false;
+        bool inTrailers = false;
+        bool keepAlive = true;
+
+        // Methods
+
+        void Reset() {
+            *this = ResponseParser();
+        }
+
+        /**
+         * Take as much of the response as possible from the front of
+         * the given input.  The body of a response without a length
+         * is only complete once Finish is called.
+         */
+        Result Parse(
+            std::string& input,
+            bool noBody
+        ) {
+            while (!headComplete) {
+                const auto headEnd = input.find("\r\n\r\n");
+                if (headEnd == std::string::npos) {
+                    return (input.length() > MAX_HEAD_SIZE) ? Result::Error : Result::Incomplete;
+                }
+                const auto lines = StringExtensions::Split(input.substr(0, headEnd), '\n');
+                input.erase(0, headEnd + 4);
+                const auto& statusLine = lines[0];
+                if (
+                    (statusLine.length() < 12)
+                    || (statusLine.compare(0, 7, "HTTP/1.") != 0)
+                ) {
+                    return Result::Error;
+                }
+                response.status = (unsigned int)atoi(statusLine.substr(9, 3).c_str());
+                for (size_t i = 1; i < lines.size(); ++i) {
+                    const auto delimiter = lines[i].find(':');
+                    if (delimiter == std::string::npos) {
+                        continue;
+                    }
+                    response.headers.push_back({
+                        lines[i].substr(0, delimiter),
+                        StringExtensions::Trim(lines[i].substr(delimiter + 1))
+                    });
+                }
+
+                // Interim responses, such as "100 Continue", are followed
+                // by the real one.
+                if (
+                    (response.status / 100 == 1)
+                    && (response.status != 101)
+                ) {
+                    Reset();
+                    continue;
+                }
+                keepAlive = (statusLine[7] == '1');
+                const auto connection = StringExtensions::ToLower(response.headers.Get(Discord::HeaderName::Connection));
+                if (connection.find("close") != std::string::npos) {
+                    keepAlive = false;
+                } else if (connection.find("keep-alive") != std::string::npos) {
+                    keepAlive = true;
+                }
+                if (
+                    noBody
+                    || (response.status / 100 == 1)
+                    || (response.status == 204)
+                    || (response.status == 304)
+                ) {
+                    framing = Framing::None;
+                } else if (
+                    StringExtensions::ToLower(
+                        response.headers.Get(Discord::HeaderName::TransferEncoding)
+                    ).find("chunked") != std::string::npos
+                ) {
+                    framing = Framing::Chunked;
+                } else if (response.headers.Has(Discord::HeaderName::ContentLength)) {
+                    framing = Framing::Length;
+                    remaining = strtoull(response.headers.Get(Discord::HeaderName::ContentLength).c_str(), NULL, 10);
+                } else {
+                    framing = Framing::UntilClose;
+                    keepAlive = false;
+                }
+                headComplete = true;
+            }
+            switch (framing) {
+                case Framing::None: {
+                    return Result::Complete;
+                }
+
+                case Framing::Length: {
+                    const auto amount = (size_t)std::min(remaining, (uint64_t)input.length());
+                    response.body.append(input, 0, amount);
+                    input.erase(0, amount);
+                    remaining -= amount;
+                    return (remaining == 0) ? Result::Complete : Result::Incomplete;
+                }
+
+                case Framing::Chunked: {
+                    return ParseChunks(input);
+                }
+
+                case Framing::UntilClose:
+                default: {
+                    response.body += input;
+                    input.clear();
+                    return Result::Incomplete;
+                }
+            }
+        }
+
+        Result ParseChunks(std::string& input) {
+            for (;;) {
+                if (inChunk) {
+                    const auto amount = (size_t)std::min(remaining, (uint64_t)input.length());
+                    response.body.append(input, 0, amount);
+                    input.erase(0, amount);
+                    remaining -= amount;
+                    if (remaining > 0) {
+                        return Result::Incomplete;
+                    }
+                    inChunk = false;
+                    awaitingChunkEnd = true;
+                }
+                if (awaitingChunkEnd) {
+                    if (input.length() < 2) {
+                        return Result::Incomplete;
+                    }
+                    input.erase(0, 2);
+                    awaitingChunkEnd = false;
+                }
+                const auto lineEnd = input.find("\r\n");
+                if (lineEnd == std::string::npos) {
+                    return Result::Incomplete;
+                }
+                if (inTrailers) {
+                    input.erase(0, lineEnd + 2);
+                    if (lineEnd == 0) {
+                        return Result::Complete;
+                    }
+                    continue;
+                }
+                const auto chunkSize = strtoull(input.substr(0, lineEnd).c_str(), NULL, 16);
+                input.erase(0, lineEnd + 2);
+                if (chunkSize == 0) {
+                    inTrailers = true;
+                } else {
+                    remaining = chunkSize;
+                    inChunk = true;
+                }
+            }
+        }
+
+        /**
+         * Handle the connection closing, returning an indication of
+         * whether or not this completes the response.
+         */
+        bool Finish() {
+            return (
+                headComplete
+                && (framing == Framing::UntilClose)
+            );
+        }
+    };
+
+    /**
+     * This holds one request made through HTTP, along with the promise
+     * of its response.
+     */
+    struct Exchange {
+        Discord::Connections::ResourceRequest request;
+        Target target;
+        std::promise< Discord::Connections::Response > response;
+
+        /**
+         * If this is set, the response is handed to it, rather than
+         * set in the promise.
+         */
+        Discord::Connections::ResponseDelegate onResponse;
+
+        size_t attempts = 0;
+        bool done = false;
+    };
+
+    /**
+     * This is the WebSocket handed to the user once the opening handshake
+     * of a WebSocket connection succeeds.
+     *
+     * Messages received before any receive callback is registered are
+     * held until one is.
+     */
+    class WebSocketEndpoint
+        : public Discord::WebSocket
+    {
+        // Types
+    public:
+        using SendDelegate = std::function<
+            void(
+                Discord::WebSocketHandshake::Opcode opcode,
+                std::string&& payload
+            )
+        >;
+
+        using ReleaseDelegate = std::function< void() >;
+
+        // Lifecycle management
+    public:
+        ~WebSocketEndpoint() noexcept {
+            if (release_ != nullptr) {
+                release_();
+            }
+        }
+        WebSocketEndpoint(const WebSocketEndpoint& other) = delete;
+        WebSocketEndpoint(WebSocketEndpoint&&) = delete;
+        WebSocketEndpoint& operator=(const WebSocketEndpoint& other) = delete;
+        WebSocketEndpoint& operator=(WebSocketEndpoint&&) = delete;
+
+        // Public methods
+    public:
+        WebSocketEndpoint(
+            SendDelegate send,
+            ReleaseDelegate release
+        )
+            : release_(release)
+            , send_(send)
+        {
+        }
+
+        void Receive(
+            bool text,
+            std::string&& message
+        ) {
+            std::unique_lock< decltype(mutex_) > lock(mutex_);
+            received_.emplace_back(text, std::move(message));
+            Drain(lock);
+        }
+
+        void RemoteClose() {
+            std::unique_lock< decltype(mutex_) > lock(mutex_);
+            remoteClosed_ = true;
+            Drain(lock);
+        }
+
+        // Discord::WebSocket
+    public:
+        virtual void Binary(std::string&& message) override {
+            send_(Discord::WebSocketHandshake::Opcode::Binary, std::move(message));
+        }
+
+        virtual void Close(unsigned int code) override {
+            std::string payload;
+            payload += (char)((code >> 8) & 0xFF);
+            payload += (char)(code & 0xFF);
+            send_(Discord::WebSocketHandshake::Opcode::Close, std::move(payload));
+        }
+
+        virtual void Text(std::string&& message) override {
+            send_(Discord::WebSocketHandshake::Opcode::Text, std::move(message));
+        }
+
+        virtual void RegisterBinaryCallback(ReceiveCallback&& onBinary) override {
+            std::unique_lock< decltype(mutex_) > lock(mutex_);
+            onBinary_ = std::move(onBinary);
+            Drain(lock);
+        }
+
+        virtual void RegisterCloseCallback(CloseCallback&& onClose) override {
+            std::unique_lock< decltype(mutex_) > lock(mutex_);
+            onClose_ = std::move(onClose);
+            Drain(lock);
+        }
+
+        virtual void RegisterTextCallback(ReceiveCallback&& onText) override {
+            std::unique_lock< decltype(mutex_) > lock(mutex_);
+            onText_ = std::move(onText);
+            Drain(lock);
+        }
+
+        // Private methods
+    private:
+        /**
+         * Deliver whatever has been received and can be delivered.
+         * Only one thread delivers at a time, so that messages are
+         * delivered in the order they arrived.
+         */
+        void Drain(std::unique_lock< std::mutex >& lock) {
+            if (draining_) {
+                return;
+            }
+            draining_ = true;
+            for (;;) {
+                if (!received_.empty()) {
+                    if (
+                        (onText_ == nullptr)
+                        && (onBinary_ == nullptr)
+                    ) {
+                        break;
+                    }
+                    auto message = std::move(received_.front());
+                    received_.pop_front();
+                    const auto callback = (message.first ? onText_ : onBinary_);
+                    if (callback == nullptr) {
+                        continue;
+                    }
+                    lock.unlock();
+                    callback(std::move(message.second));
+                    lock.lock();
+                    continue;
+                }
+                if (
+                    remoteClosed_
+                    && !closeDelivered_
+                    && (onClose_ != nullptr)
+                ) {
+                    closeDelivered_ = true;
+                    const auto callback = onClose_;
+                    lock.unlock();
+                    callback();
+                    lock.lock();
+                    continue;
+                }
+                break;
+            }
+            draining_ = false;
+        }
+
+        // Private properties
+    private:
+        bool closeDelivered_ = false;
+        bool draining_ = false;
+        std::mutex mutex_;
+        ReceiveCallback onBinary_;
+        CloseCallback onClose_;
+        ReceiveCallback onText_;
+        std::deque< std::pair< bool, std::string > > received_;
+        ReleaseDelegate release_;
+        bool remoteClosed_ = false;
+        SendDelegate send_;
+    };
+
+    /**
+     * This holds one connection made to a server, either to make
+     * HTTP requests or to carry a WebSocket.
+     */
+    struct Connection {
+        uint64_t id = 0;
+        int fd = -1;
+        std::string hostKey;
+
+        /**
+         * This is set while the address of the host is being looked up,
+         * before the socket is made.
+         */
+        bool resolving = false;
+
+        bool connecting = true;
+        bool writeWanted = true;
+        std::string input;
+        std::string output;
+        bool closeAfterFlush = false;
+        double lastActive = 0.0;
+
+        // HTTP
+        std::deque< std::shared_ptr< Exchange > > inFlight;
+        ResponseParser parser;
+        bool receivingResponse = false;
+        bool keepAliveProven = false;
+        size_t numRequests = 0;
+
+        // WebSocket
+        bool webSocket = false;
+        std::string expectedAccept;
+        std::promise< std::shared_ptr< Discord::WebSocket > > webSocketPromise;
+        bool webSocketPromiseDone = false;
+        std::weak_ptr< WebSocketEndpoint > endpoint;
+        std::shared_ptr< std::atomic< bool > > released = std::make_shared< std::atomic< bool > >(false);
+        Discord::WebSocketHandshake::Opcode messageOpcode = Discord::WebSocketHandshake::Opcode::Text;
+        std::string message;
+        bool messageInProgress = false;
+        bool closeSent = false;
+        bool closeReceived = false;
+
+        /**
+         * This is set once the other end has broken the protocol, after
+         * which nothing more it sends is looked at.
+         */
+        bool failed = false;
+    };
+
+    /**
+     * This holds the HTTP connections made to one host and port,
+     * along with the requests waiting for one of them.
+     */
+    struct Host {
+        std::vector< std::shared_ptr< Connection > > connections;
+        std::deque< std::shared_ptr< Exchange > > waiting;
+    };
+
+    /**
+     * This is how the address of a host is remembered once it's
+     * been looked up.
+     */
+    struct Address {
+        sockaddr_storage address;
+        socklen_t length = 0;
+    };
+
+    /**
+     * This is a host whose address is waiting to be looked up.
+     */
+    struct Lookup {
+        std::string hostKey;
+        std::string host;
+        std::string port;
+    };
+
+    /**
+     * Look up the address of the given host, returning an indication of
+     * whether or not it was found.  This may take a while, unless only
+     * numeric addresses are allowed, in which case it doesn't ask DNS.
+     */
+    bool LookUpAddress(
+        const std::string& host,
+        const std::string& port,
+        Address& address,
+        bool numericOnly = false
+    ) {
+        addrinfo hints;
+        (void)memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        if (numericOnly) {
+            hints.ai_flags = AI_NUMERICHOST;
+        }
+        addrinfo* results = NULL;
+        if (
+            (getaddrinfo(host.c_str(), port.c_str(), &hints, &results) != 0)
+            || (results == NULL)
+        ) {
+            return false;
+        }
+        (void)memcpy(&address.address, results->ai_addr, results->ai_addrlen);
+        address.length = results->ai_addrlen;
+        freeaddrinfo(results);
+        return true;
+    }
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a SocketConnections instance.
+     */
+    struct SocketConnections::Impl
+        : public std::enable_shared_from_this< SocketConnections::Impl >
+    {
+        // Types
+
+        /**
+         * These are the calls to make once the mutex is released,
+         * such as calls to WebSocket callbacks.
+         */
+        using Deliveries = std::vector< std::function< void() > >;
+
+        // Properties
+
+        std::unordered_map< std::string, Address > addresses;
+        Configuration configuration;
+        std::unordered_map< uint64_t, std::shared_ptr< Connection > > connections;
+        int epollFd = -1;
+        std::mt19937 generator{std::random_device()()};
+        std::unordered_map< std::string, Host > hosts;
+
+        /**
+         * These are the calls to make, once the mutex is released,
+         * to hand responses to the delegates given with their requests.
+         * Whoever takes the mutex and might complete a request takes
+         * these before releasing it.
+         */
+        Deliveries responses;
+
+        /**
+         * These are the hosts whose addresses are waiting to be looked
+         * up by the resolver thread, which does so without the mutex,
+         * so that a slow lookup doesn't hold up anything else.
+         */
+        std::deque< Lookup > lookups;
+        std::unordered_set< std::string > lookupsPending;
+        std::condition_variable lookupsWakeCondition;
+
+        std::mutex mutex;
+        uint64_t nextConnectionId = WAKE_EVENT_ID + 1;
+        Statistics statistics;
+        bool stopping = false;
+        int wakeFd = -1;
+        std::thread resolver;
+        std::thread worker;
+
+        // Methods
+
+        void Start() {
+            epollFd = epoll_create1(EPOLL_CLOEXEC);
+            wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            epoll_event event;
+            event.events = EPOLLIN;
+            event.data.u64 = WAKE_EVENT_ID;
+            (void)epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+            worker = std::thread(&Impl::Run, this);
+            resolver = std::thread(&Impl::RunResolver, this);
+        }
+
+        void Stop() {
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                stopping = true;
+            }
+            WakeUp();
+            lookupsWakeCondition.notify_all();
+            if (worker.joinable()) {
+                worker.join();
+            }
+            if (resolver.joinable()) {
+                resolver.join();
+            }
+            Deliveries deliveries;
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                for (auto& host: hosts) {
+                    for (const auto& exchange: host.second.waiting) {
+                        Fail(*exchange, "shutting down");
+                    }
+                    host.second.waiting.clear();
+                }
+                while (!connections.empty()) {
+                    const auto connection = connections.begin()->second;
+                    CloseConnection(connection, deliveries);
+                }
+                TakeResponses(deliveries);
+            }
+            for (const auto& delivery: deliveries) {
+                delivery();
+            }
+            (void)close(epollFd);
+            (void)close(wakeFd);
+        }
+
+        void WakeUp() {
+            const uint64_t increment = 1;
+            (void)write(wakeFd, &increment, sizeof(increment));
+        }
+
+        /**
+         * This is the body of the thread which waits on the sockets.
+         */
+        void Run() {
+            std::vector< epoll_event > events(MAX_EVENTS);
+            for (;;) {
+                const auto numEvents = epoll_wait(epollFd, events.data(), MAX_EVENTS, IDLE_CHECK_INTERVAL);
+                Deliveries deliveries;
+                {
+                    std::lock_guard< decltype(mutex) > lock(mutex);
+                    if (stopping) {
+                        return;
+                    }
+                    for (int i = 0; i < numEvents; ++i) {
+                        const auto& event = events[i];
+                        if (event.data.u64 == WAKE_EVENT_ID) {
+                            uint64_t count;
+                            (void)read(wakeFd, &count, sizeof(count));
+                            continue;
+                        }
+                        const auto connectionsEntry = connections.find(event.data.u64);
+                        if (connectionsEntry == connections.end()) {
+                            continue;
+                        }
+                        const auto connection = connectionsEntry->second;
+                        if ((event.events & (EPOLLOUT | EPOLLERR)) != 0) {
+                            OnWritable(connection, deliveries);
+                        }
+                        if (
+                            (connection->fd >= 0)
+                            && ((event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0)
+                        ) {
+                            OnReadable(connection, deliveries);
+                        }
+                    }
+                    CloseReleasedAndIdle(deliveries);
+                    TakeResponses(deliveries);
+                }
+                for (const auto& delivery: deliveries) {
+                    delivery();
+                }
+            }
+        }
+
+        /**
+         * This is the body of the thread which looks up the addresses
+         * of hosts.
+         */
+        void RunResolver() {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            for (;;) {
+                lookupsWakeCondition.wait(
+                    lock,
+                    [this]{
+                        return (
+                            stopping
+                            || !lookups.empty()
+                        );
+                    }
+                );
+                if (stopping) {
+                    return;
+                }
+                const auto lookup = std::move(lookups.front());
+                lookups.pop_front();
+                lock.unlock();
+                Address address;
+                const auto found = LookUpAddress(lookup.host, lookup.port, address);
+                lock.lock();
+                if (stopping) {
+                    return;
+                }
+                Deliveries deliveries;
+                OnLookedUp(lookup.hostKey, found, address, deliveries);
+                TakeResponses(deliveries);
+                lock.unlock();
+                for (const auto& delivery: deliveries) {
+                    delivery();
+                }
+                lock.lock();
+            }
+        }
+
+        /**
+         * Carry on connecting the connections which were waiting for
+         * the address of the given host, or fail them if it wasn't found.
+         */
+        void OnLookedUp(
+            const std::string& hostKey,
+            bool found,
+            const Address& address,
+            Deliveries& deliveries
+        ) {
+            (void)lookupsPending.erase(hostKey);
+            if (found) {
+                addresses[hostKey] = address;
+            }
+            std::vector< std::shared_ptr< Connection > > waiting;
+            for (const auto& connectionsEntry: connections) {
+                const auto& connection = connectionsEntry.second;
+                if (
+                    connection->resolving
+                    && (connection->hostKey == hostKey)
+                ) {
+                    waiting.push_back(connection);
+                }
+            }
+            if (!found) {
+                const auto hostsEntry = hosts.find(hostKey);
+                if (hostsEntry != hosts.end()) {
+                    for (const auto& exchange: hostsEntry->second.waiting) {
+                        Fail(*exchange, "unable to connect");
+                    }
+                    hostsEntry->second.waiting.clear();
+                }
+            }
+            for (const auto& connection: waiting) {
+                connection->resolving = false;
+                if (
+                    !found
+                    || !Connect(connection, address)
+                ) {
+                    for (const auto& exchange: connection->inFlight) {
+                        Fail(*exchange, "unable to connect");
+                    }
+                    connection->inFlight.clear();
+                    CloseConnection(connection, deliveries);
+                }
+            }
+        }
+
+        /**
+         * Begin connecting to the given target, returning the connection,
+         * or nullptr if the connection couldn't be started.  If the
+         * host isn't a numeric address, and its address isn't known yet,
+         * the connection waits for it to be looked up by the resolver
+         * thread before its socket is made.
+         */
+        std::shared_ptr< Connection > Open(const Target& target) {
+            const auto connection = std::make_shared< Connection >();
+            connection->id = nextConnectionId++;
+            connection->hostKey = target.host + ":" + target.port;
+            auto addressesEntry = addresses.find(connection->hostKey);
+            if (addressesEntry == addresses.end()) {
+                Address address;
+                if (LookUpAddress(target.host, target.port, address, true)) {
+                    addressesEntry = addresses.insert({connection->hostKey, address}).first;
+                }
+            }
+            if (addressesEntry == addresses.end()) {
+                connection->resolving = true;
+                if (lookupsPending.insert(connection->hostKey).second) {
+                    lookups.push_back({connection->hostKey, target.host, target.port});
+                    lookupsWakeCondition.notify_one();
+                }
+            } else if (!Connect(connection, addressesEntry->second)) {
+                return nullptr;
+            }
+            connection->lastActive = GetCurrentTime();
+            connections[connection->id] = connection;
+            return connection;
+        }
+
+        /**
+         * Make the socket for the given connection and begin connecting
+         * it to the given address, returning an indication of whether
+         * or not connecting could begin.
+         */
+        bool Connect(
+            const std::shared_ptr< Connection >& connection,
+            const Address& address
+        ) {
+            const auto fd = socket(
+                address.address.ss_family,
+                SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                0
+            );
+            if (fd < 0) {
+                return false;
+            }
+            const int noDelay = 1;
+            (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            if (
+                (connect(fd, (const sockaddr*)&address.address, address.length) != 0)
+                && (errno != EINPROGRESS)
+            ) {
+                (void)close(fd);
+                return false;
+            }
+            connection->fd = fd;
+            epoll_event event;
+            event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP;
+            event.data.u64 = connection->id;
+            (void)epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+            ++statistics.connectionsOpened;
+            return true;
+        }
+
+        /**
+         * Ask epoll to report when the given connection can be written,
+         * only while there's something to write to it.
+         */
+        void UpdateInterest(const std::shared_ptr< Connection >& connection) {
+            const auto writeWanted = (
+                connection->connecting
+                || !connection->output.empty()
+            );
+            if (writeWanted == connection->writeWanted) {
+                return;
+            }
+            connection->writeWanted = writeWanted;
+            epoll_event event;
+            event.events = EPOLLIN | EPOLLRDHUP | (writeWanted ? (uint32_t)EPOLLOUT : (uint32_t)0);
+            event.data.u64 = connection->id;
+            (void)epoll_ctl(epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+        }
+
+        /**
+         * Complete the given request with the given response, unless
+         * it's already done.
+         */
+        void Respond(
+            Exchange& exchange,
+            Response&& response
+        ) {
+            if (exchange.done) {
+                return;
+            }
+            exchange.done = true;
+            if (exchange.onResponse == nullptr) {
+                exchange.response.set_value(std::move(response));
+                return;
+            }
+            const auto onResponse = std::move(exchange.onResponse);
+            exchange.onResponse = nullptr;
+            const auto handedOver = std::make_shared< Response >(std::move(response));
+            responses.push_back(
+                [onResponse, handedOver]{
+                    onResponse(std::move(*handedOver));
+                }
+            );
+        }
+
+        void Fail(
+            Exchange& exchange,
+            const std::string& reason
+        ) {
+            Respond(exchange, {STATUS_NO_RESPONSE, {}, reason});
+        }
+
+        /**
+         * Add the responses waiting to be handed to delegates to
+         * the given deliveries.
+         */
+        void TakeResponses(Deliveries& deliveries) {
+            for (auto& response: responses) {
+                deliveries.push_back(std::move(response));
+            }
+            responses.clear();
+        }
+
+        /**
+         * Queue the given request, returning the delegate which cancels
+         * it.  The mutex must not be held.
+         */
+        CancelDelegate Queue(
+            const std::shared_ptr< Exchange >& exchange,
+            ResourceRequest&& request
+        ) {
+            Deliveries deliveries;
+            CancelDelegate cancel;
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                if (
+                    !ParseTarget(request.uri, exchange->target)
+                    || (exchange->target.scheme != "http")
+                ) {
+                    Fail(*exchange, "unsupported URI");
+                    cancel = []{};
+                } else {
+                    exchange->request = std::move(request);
+                    const auto hostKey = exchange->target.host + ":" + exchange->target.port;
+                    hosts[hostKey].waiting.push_back(exchange);
+                    ScheduleHost(hostKey);
+                    std::weak_ptr< Impl > weakSelf(shared_from_this());
+                    cancel = [weakSelf, exchange]{
+                        const auto self = weakSelf.lock();
+                        if (self == nullptr) {
+                            return;
+                        }
+                        Deliveries deliveries;
+                        {
+                            std::lock_guard< decltype(self->mutex) > lock(self->mutex);
+                            self->Respond(*exchange, {499});
+                            self->TakeResponses(deliveries);
+                        }
+                        for (const auto& delivery: deliveries) {
+                            delivery();
+                        }
+                    };
+                }
+                TakeResponses(deliveries);
+            }
+            for (const auto& delivery: deliveries) {
+                delivery();
+            }
+            return cancel;
+        }
+
+        /**
+         * Close the given connection.  Requests lost with it are made
+         * again if that's safe, or failed otherwise.
+         */
+        void CloseConnection(
+            const std::shared_ptr< Connection >& connection,
+            Deliveries& deliveries
+        ) {
+            if (connections.erase(connection->id) == 0) {
+                return;
+            }
+            if (connection->fd >= 0) {
+                (void)epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, NULL);
+                (void)close(connection->fd);
+                connection->fd = -1;
+            }
+            connection->resolving = false;
+            if (connection->webSocket) {
+                if (!connection->webSocketPromiseDone) {
+                    connection->webSocketPromiseDone = true;
+                    connection->webSocketPromise.set_value(nullptr);
+                } else if (!connection->closeReceived) {
+                    const auto endpoint = connection->endpoint.lock();
+                    if (endpoint != nullptr) {
+                        deliveries.push_back(
+                            [endpoint]{
+                                endpoint->RemoteClose();
+                            }
+                        );
+                    }
+                }
+                return;
+            }
+            auto& host = hosts[connection->hostKey];
+            host.connections.erase(
+                std::remove(host.connections.begin(), host.connections.end(), connection),
+                host.connections.end()
+            );
+            for (size_t i = connection->inFlight.size(); i > 0; --i) {
+                const auto& exchange = connection->inFlight[i - 1];
+                if (exchange->done) {
+                    continue;
+                }
+                const auto responseStarted = (
+                    (i == 1)
+                    && connection->receivingResponse
+                );
+                if (
+                    !stopping
+                    && !responseStarted
+                    && connection->keepAliveProven
+                    && IsIdempotent(exchange->request.method)
+                    && (exchange->attempts < 2)
+                ) {
+                    host.waiting.push_front(exchange);
+                } else {
+                    Fail(*exchange, "connection lost");
+                }
+            }
+            connection->inFlight.clear();
+            if (!stopping) {
+                ScheduleHost(connection->hostKey);
+            }
+        }
+
+        /**
+         * Hand requests waiting for a connection to the given host
+         * to whichever connections can take them.
+         */
+        void ScheduleHost(const std::string& hostKey) {
+            auto& host = hosts[hostKey];
+            while (!host.waiting.empty()) {
+                const auto exchange = host.waiting.front();
+                if (exchange->done) {
+                    host.waiting.pop_front();
+                    continue;
+                }
+                std::shared_ptr< Connection > chosen;
+                for (const auto& connection: host.connections) {
+                    if (
+                        connection->inFlight.empty()
+                        && !connection->closeAfterFlush
+                    ) {
+                        chosen = connection;
+                        break;
+                    }
+                }
+                if (
+                    (chosen == nullptr)
+                    && (host.connections.size() < configuration.maxConnectionsPerHost)
+                ) {
+                    chosen = Open(exchange->target);
+                    if (chosen == nullptr) {
+                        host.waiting.pop_front();
+                        Fail(*exchange, "unable to connect");
+                        continue;
+                    }
+                    host.connections.push_back(chosen);
+                }
+                if (
+                    (chosen == nullptr)
+                    && IsPipelinable(exchange->request.method)
+                ) {
+                    for (const auto& connection: host.connections) {
+                        if (
+                            !connection->keepAliveProven
+                            || connection->closeAfterFlush
+                            || (connection->inFlight.size() >= configuration.maxPipelineDepth)
+                            || (
+                                (chosen != nullptr)
+                                && (connection->inFlight.size() >= chosen->inFlight.size())
+                            )
+                        ) {
+                            continue;
+                        }
+                        const auto allPipelinable = std::all_of(
+                            connection->inFlight.begin(),
+                            connection->inFlight.end(),
+                            [](const std::shared_ptr< Exchange >& inFlight){
+                                return IsPipelinable(inFlight->request.method);
+                            }
+                        );
+                        if (allPipelinable) {
+                            chosen = connection;
+                        }
+                    }
+                }
+                if (chosen == nullptr) {
+                    break;
+                }
+                host.waiting.pop_front();
+                Send(chosen, exchange);
+            }
+        }
+
+        void Send(
+            const std::shared_ptr< Connection >& connection,
+            const std::shared_ptr< Exchange >& exchange
+        ) {
+            if (!connection->inFlight.empty()) {
+                ++statistics.requestsPipelined;
+            }
+            if (connection->numRequests > 0) {
+                ++statistics.connectionsReused;
+            }
+            ++connection->numRequests;
+            ++exchange->attempts;
+            const auto& request = exchange->request;
+            const auto& body = request.GetBody();
+            auto& output = connection->output;
+            output += request.method;
+            output += ' ';
+            output += exchange->target.pathAndQuery;
+            output += " HTTP/1.1\r\n";
+            if (!request.headers.Has("Host")) {
+                output += "Host: " + exchange->target.hostHeader + "\r\n";
+            }
+            for (const auto& header: request.headers) {
+                output += header.key;
+                output += ": ";
+                output += header.value;
+                output += "\r\n";
+            }
+            if (
+                !request.headers.Has(HeaderName::ContentLength)
+                && (
+                    !body.empty()
+                    || (request.method == "POST")
+                    || (request.method == "PUT")
+                    || (request.method == "PATCH")
+                )
+            ) {
+                output += "Content-Length: " + std::to_string(body.length()) + "\r\n";
+            }
+            output += "\r\n";
+            output += body;
+            connection->inFlight.push_back(exchange);
+            UpdateInterest(connection);
+        }
+
+        void OnWritable(
+            const std::shared_ptr< Connection >& connection,
+            Deliveries& deliveries
+        ) {
+            if (connection->connecting) {
+                int error = 0;
+                socklen_t errorLength = sizeof(error);
+                (void)getsockopt(connection->fd, SOL_SOCKET, SO_ERROR, &error, &errorLength);
+                if (error != 0) {
+                    CloseConnection(connection, deliveries);
+                    return;
+                }
+                connection->connecting = false;
+            }
+            while (!connection->output.empty()) {
+                const auto amountSent = send(
+                    connection->fd,
+                    connection->output.data(),
+                    connection->output.length(),
+                    MSG_NOSIGNAL
+                );
+                if (amountSent < 0) {
+                    if (
+                        (errno == EAGAIN)
+                        || (errno == EWOULDBLOCK)
+                    ) {
+                        break;
+                    }
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    CloseConnection(connection, deliveries);
+                    return;
+                }
+                connection->output.erase(0, (size_t)amountSent);
+            }
+            if (
+                connection->output.empty()
+                && connection->closeAfterFlush
+            ) {
+                CloseConnection(connection, deliveries);
+                return;
+            }
+            UpdateInterest(connection);
+        }
+
+        void OnReadable(
+            const std::shared_ptr< Connection >& connection,
+            Deliveries& deliveries
+        ) {
+            auto closed = false;
+            char buffer[READ_CHUNK_SIZE];
+            for (;;) {
+                const auto amountReceived = recv(connection->fd, buffer, sizeof(buffer), 0);
+                if (amountReceived > 0) {
+                    connection->input.append(buffer, (size_t)amountReceived);
+                    continue;
+                }
+                if (
+                    (amountReceived < 0)
+                    && (errno == EINTR)
+                ) {
+                    continue;
+                }
+                closed = (
+                    (amountReceived == 0)
+                    || (
+                        (errno != EAGAIN)
+                        && (errno != EWOULDBLOCK)
+                    )
+                );
+                break;
+            }
+            connection->lastActive = GetCurrentTime();
+            if (connection->webSocket) {
+                OnWebSocketInput(connection, deliveries);
+            } else {
+                OnHttpInput(connection, deliveries);
+            }
+            if (
+                closed
+                && (connection->fd >= 0)
+            ) {
+                if (
+                    !connection->webSocket
+                    && !connection->inFlight.empty()
+                    && connection->parser.Finish()
+                ) {
+                    CompleteResponse(connection);
+                }
+                CloseConnection(connection, deliveries);
+            }
+        }
+
+        void OnHttpInput(
+            const std::shared_ptr< Connection >& connection,
+            Deliveries& deliveries
+        ) {
+            while (!connection->input.empty()) {
+                if (connection->inFlight.empty()) {
+                    CloseConnection(connection, deliveries);
+                    return;
+                }
+                connection->receivingResponse = true;
+                const auto result = connection->parser.Parse(
+                    connection->input,
+                    (connection->inFlight.front()->request.method == "HEAD")
+                );
+                if (result == ResponseParser::Result::Error) {
+                    CloseConnection(connection, deliveries);
+                    return;
+                }
+                if (result == ResponseParser::Result::Incomplete) {
+                    return;
+                }
+                if (!CompleteResponse(connection)) {
+                    CloseConnection(connection, deliveries);
+                    return;
+                }
+            }
+        }
+
+        /**
+         * Give the response just parsed to the request at the front
+         * of the given connection, returning an indication of whether
+         * or not the connection may be used again.
+         */
+        bool CompleteResponse(const std::shared_ptr< Connection >& connection) {
+            const auto exchange = connection->inFlight.front();
+            connection->inFlight.pop_front();
+            connection->receivingResponse = false;
+            connection->keepAliveProven = connection->parser.keepAlive;
+            Respond(*exchange, std::move(connection->parser.response));
+            connection->parser.Reset();
+            connection->lastActive = GetCurrentTime();
+            if (!connection->keepAliveProven) {
+                connection->closeAfterFlush = true;
+                return false;
+            }
+            ScheduleHost(connection->hostKey);
+            return true;
+        }
+
+        void OnWebSocketInput(
+            const std::shared_ptr< Connection >& connection,
+            Deliveries& deliveries
+        ) {
+            std::shared_ptr< WebSocketEndpoint > endpoint;
+            if (!connection->webSocketPromiseDone) {
+                const auto result = connection->parser.Parse(connection->input, true);
+                if (result == ResponseParser::Result::Incomplete) {
+                    return;
+                }
+                const auto& response = connection->parser.response;
+                if (
+                    (result == ResponseParser::Result::Error)
+                    || (response.status != 101)
+                    || (StringExtensions::ToLower(response.headers.Get("Upgrade")) != "websocket")
+                    || (response.headers.Get("Sec-WebSocket-Accept") != connection->expectedAccept)
+                ) {
+                    CloseConnection(connection, deliveries);
+                    return;
+                }
+                connection->parser.Reset();
+                std::weak_ptr< Impl > weakSelf(shared_from_this());
+                const auto id = connection->id;
+                const auto released = connection->released;
+                endpoint = std::make_shared< WebSocketEndpoint >(
+                    [weakSelf, id](WebSocketHandshake::Opcode opcode, std::string&& payload){
+                        const auto self = weakSelf.lock();
+                        if (self != nullptr) {
+                            self->SendFrame(id, opcode, std::move(payload));
+                        }
+                    },
+                    [weakSelf, released]{
+                        *released = true;
+                        const auto self = weakSelf.lock();
+                        if (self != nullptr) {
+                            self->WakeUp();
+                        }
+                    }
+                );
+                connection->endpoint = endpoint;
+                connection->webSocketPromiseDone = true;
+                connection->webSocketPromise.set_value(endpoint);
+            } else {
+                endpoint = connection->endpoint.lock();
+            }
+
+            // The endpoint must not be destroyed while the mutex is held,
+            // since it takes the mutex when it's released.
+            deliveries.push_back([endpoint]{});
+            if (endpoint == nullptr) {
+                CloseConnection(connection, deliveries);
+                return;
+            }
+            WebSocketHandshake::Frame frame;
+            size_t offset = 0;
+            while (
+                !connection->closeReceived
+                && !connection->failed
+            ) {
+                const auto result = WebSocketHandshake::DecodeFrame(connection->input, offset, frame);
+                if (result == WebSocketHandshake::DecodeResult::Incomplete) {
+                    break;
+                }
+                if (result == WebSocketHandshake::DecodeResult::ProtocolError) {
+                    FailWebSocket(connection, CLOSE_PROTOCOL_ERROR);
+                    break;
+                }
+                if (result == WebSocketHandshake::DecodeResult::TooBig) {
+                    FailWebSocket(connection, CLOSE_MESSAGE_TOO_BIG);
+                    break;
+                }
+                switch (frame.opcode) {
+                    case WebSocketHandshake::Opcode::Ping: {
+                        QueueFrame(connection, WebSocketHandshake::Opcode::Pong, frame.payload);
+                    } break;
+
+                    case WebSocketHandshake::Opcode::Pong: {
+                    } break;
+
+                    case WebSocketHandshake::Opcode::Close: {
+                        connection->closeReceived = true;
+                        if (!connection->closeSent) {
+                            QueueFrame(
+                                connection,
+                                WebSocketHandshake::Opcode::Close,
+                                frame.payload.substr(0, 2)
+                            );
+                            connection->closeSent = true;
+                        }
+
+                        // Tell the user the other end has closed, even if
+                        // we closed first, since they may be waiting for
+                        // the closing handshake to finish.
+                        deliveries.push_back(
+                            [endpoint]{
+                                endpoint->RemoteClose();
+                            }
+                        );
+                        connection->closeAfterFlush = true;
+                        UpdateInterest(connection);
+                    } break;
+
+                    case WebSocketHandshake::Opcode::Text:
+                    case WebSocketHandshake::Opcode::Binary: {
+                        if (connection->messageInProgress) {
+                            FailWebSocket(connection, CLOSE_PROTOCOL_ERROR);
+                            break;
+                        }
+                        connection->messageOpcode = frame.opcode;
+                        connection->message = std::move(frame.payload);
+                        connection->messageInProgress = true;
+                    } break;
+
+                    case WebSocketHandshake::Opcode::Continuation: {
+                        if (!connection->messageInProgress) {
+                            FailWebSocket(connection, CLOSE_PROTOCOL_ERROR);
+                            break;
+                        }
+                        if (
+                            frame.payload.length()
+                            > WebSocketHandshake::MAX_PAYLOAD_LENGTH - connection->message.length()
+                        ) {
+                            FailWebSocket(connection, CLOSE_MESSAGE_TOO_BIG);
+                            break;
+                        }
+                        connection->message += frame.payload;
+                    } break;
+                }
+                if (
+                    !connection->failed
+                    && frame.final
+                    && (
+                        (frame.opcode == WebSocketHandshake::Opcode::Text)
+                        || (frame.opcode == WebSocketHandshake::Opcode::Binary)
+                        || (frame.opcode == WebSocketHandshake::Opcode::Continuation)
+                    )
+                ) {
+                    const auto text = (connection->messageOpcode == WebSocketHandshake::Opcode::Text);
+                    auto message = std::make_shared< std::string >(std::move(connection->message));
+                    connection->message.clear();
+                    connection->messageInProgress = false;
+                    deliveries.push_back(
+                        [endpoint, text, message]{
+                            endpoint->Receive(text, std::move(*message));
+                        }
+                    );
+                }
+            }
+            if (connection->failed) {
+                connection->input.clear();
+            } else {
+                connection->input.erase(0, offset);
+            }
+            if (
+                connection->output.empty()
+                && connection->closeAfterFlush
+            ) {
+                CloseConnection(connection, deliveries);
+            }
+        }
+
+        /**
+         * Stop looking at what the other end of the given WebSocket
+         * connection sends, tell it why with the given close code,
+         * and close the connection once that's sent.
+         */
+        void FailWebSocket(
+            const std::shared_ptr< Connection >& connection,
+            unsigned int code
+        ) {
+            connection->failed = true;
+            connection->message.clear();
+            connection->messageInProgress = false;
+            if (!connection->closeSent) {
+                std::string payload;
+                payload += (char)((code >> 8) & 0xFF);
+                payload += (char)(code & 0xFF);
+                QueueFrame(connection, WebSocketHandshake::Opcode::Close, payload);
+                connection->closeSent = true;
+            }
+            connection->closeAfterFlush = true;
+            UpdateInterest(connection);
+        }
+
+        void QueueFrame(
+            const std::shared_ptr< Connection >& connection,
+            WebSocketHandshake::Opcode opcode,
+            const std::string& payload
+        ) {
+            connection->output += WebSocketHandshake::EncodeFrame(
+                opcode,
+                payload,
+                true,
+                (uint32_t)generator()
+            );
+            UpdateInterest(connection);
+        }
+
+        void SendFrame(
+            uint64_t id,
+            WebSocketHandshake::Opcode opcode,
+            std::string&& payload
+        ) {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            const auto connectionsEntry = connections.find(id);
+            if (connectionsEntry == connections.end()) {
+                return;
+            }
+            const auto& connection = connectionsEntry->second;
+            if (connection->closeSent) {
+                return;
+            }
+            QueueFrame(connection, opcode, payload);
+            if (opcode == WebSocketHandshake::Opcode::Close) {
+                connection->closeSent = true;
+                connection->closeAfterFlush = true;
+            }
+        }
+
+        /**
+         * Close WebSocket connections whose endpoints are gone, and
+         * HTTP connections which have sat unused too long.
+         */
+        void CloseReleasedAndIdle(Deliveries& deliveries) {
+            const auto now = GetCurrentTime();
+            std::vector< std::shared_ptr< Connection > > closing;
+            for (const auto& connectionsEntry: connections) {
+                const auto& connection = connectionsEntry.second;
+                if (connection->webSocket) {
+                    if (*connection->released) {
+                        closing.push_back(connection);
+                    }
+                } else if (
+                    connection->inFlight.empty()
+                    && (now - connection->lastActive >= configuration.idleTimeout)
+                ) {
+                    closing.push_back(connection);
+                }
+            }
+            for (const auto& connection: closing) {
+                CloseConnection(connection, deliveries);
+            }
+        }
+    };
+
+    SocketConnections::~SocketConnections() noexcept {
+        if (impl_ != nullptr) {
+            impl_->Stop();
+        }
+    }
+    SocketConnections::SocketConnections(SocketConnections&&) noexcept = default;
+    SocketConnections& SocketConnections::operator=(SocketConnections&& other) noexcept {
+        if (this != &other) {
+            if (impl_ != nullptr) {
+                impl_->Stop();
+            }
+            impl_ = std::move(other.impl_);
+        }
+        return *this;
+    }
+
+    SocketConnections::SocketConnections()
+        : impl_(std::make_shared< Impl >())
+    {
+        impl_->Start();
+    }
+
+    void SocketConnections::Configure(const Configuration& configuration) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->configuration = configuration;
+    }
+
+    auto SocketConnections::GetStatistics() const -> Statistics {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        return impl_->statistics;
+    }
+
+    auto SocketConnections::QueueResourceRequest(
+        const ResourceRequest& request
+    ) -> ResourceRequestTransaction {
+        return QueueResourceRequest(ResourceRequest(request));
+    }
+
+    auto SocketConnections::QueueResourceRequest(
+        ResourceRequest&& request
+    ) -> ResourceRequestTransaction {
+        const auto exchange = std::make_shared< Exchange >();
+        ResourceRequestTransaction transaction;
+        transaction.response = exchange->response.get_future();
+        transaction.cancel = impl_->Queue(exchange, std::move(request));
+        return transaction;
+    }
+
+    auto SocketConnections::QueueResourceRequest(
+        ResourceRequest&& request,
+        ResponseDelegate&& onResponse
+    ) -> CancelDelegate {
+        const auto exchange = std::make_shared< Exchange >();
+        exchange->onResponse = std::move(onResponse);
+        return impl_->Queue(exchange, std::move(request));
+    }
+
+    auto SocketConnections::QueueWebSocketRequest(
+        const WebSocketRequest& request
+    ) -> WebSocketRequestTransaction {
+        WebSocketRequestTransaction transaction;
+        Target target;
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        std::shared_ptr< Connection > connection;
+        if (
+            ParseTarget(request.uri, target)
+            && (target.scheme == "ws")
+        ) {
+            connection = impl_->Open(target);
+        }
+        if (connection == nullptr) {
+            std::promise< std::shared_ptr< WebSocket > > failure;
+            failure.set_value(nullptr);
+            transaction.webSocket = failure.get_future();
+            transaction.cancel = []{};
+            return transaction;
+        }
+        connection->webSocket = true;
+        transaction.webSocket = connection->webSocketPromise.get_future();
+        std::string nonce;
+        for (size_t i = 0; i < 16; ++i) {
+            nonce += (char)(impl_->generator() & 0xFF);
+        }
+        const auto key = WebSocketHandshake::Base64Encode(nonce);
+        connection->expectedAccept = WebSocketHandshake::ComputeAccept(key);
+        connection->output = (
+            "GET " + target.pathAndQuery + " HTTP/1.1\r\n"
+            + "Host: " + target.hostHeader + "\r\n"
+            + "Upgrade: websocket\r\n"
+            + "Connection: Upgrade\r\n"
+            + "Sec-WebSocket-Key: " + key + "\r\n"
+            + "Sec-WebSocket-Version: 13\r\n"
+            + "\r\n"
+        );
+        std::weak_ptr< Impl > weakImpl(impl_);
+        const auto id = connection->id;
+        transaction.cancel = [weakImpl, id]{
+            const auto impl = weakImpl.lock();
+            if (impl == nullptr) {
+                return;
+            }
+            Impl::Deliveries deliveries;
+            {
+                std::lock_guard< decltype(impl->mutex) > lock(impl->mutex);
+                const auto connectionsEntry = impl->connections.find(id);
+                if (
+                    (connectionsEntry == impl->connections.end())
+                    || connectionsEntry->second->webSocketPromiseDone
+                ) {
+                    return;
+                }
+                const auto connection = connectionsEntry->second;
+                impl->CloseConnection(connection, deliveries);
+            }
+            for (const auto& delivery: deliveries) {
+                delivery();
+            }
+        };
+        return transaction;
+    }
+
+}
@@ -0,0 +1,364 @@
+/**
+ * @file TimerWheel.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::TimerWheel class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <Discord/TimerWheel.hpp>
+#include <limits>
+#include <list>
+#include <math.h>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+    /**
+     * This is the number of bits of the tick count which select
+     * the slot within each level of the wheel.
+     */
+    constexpr unsigned int SLOT_BITS = 8;
+
+    constexpr size_t NUM_SLOTS = ((size_t)1 << SLOT_BITS);
+
+    constexpr uint64_t SLOT_MASK = (NUM_SLOTS - 1);
+
+    /**
+     * This is the number of levels in the wheel.  Each level covers
+     * NUM_SLOTS times as many ticks as the level below it.
+     */
+    constexpr size_t NUM_LEVELS = 4;
+
+    /**
+     * This is used to keep tick conversions from being thrown off
+     * by rounding errors, so that a call due at a time which is exactly
+     * a multiple of the tick length is made at that time.
+     */
+    constexpr double TICK_ROUNDING_TOLERANCE = 1e-6;
+
+    struct Timer {
+        int token = 0;
+        uint64_t dueTick = 0;
+        Discord::TimerWheel::Callback callback;
+        size_t level = NUM_LEVELS;
+        std::list< Timer >* slot = nullptr;
+    };
+
+}
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a TimerWheel instance.
+     */
+    struct TimerWheel::Impl {
+        // Properties
+
+        std::shared_ptr< Timekeeping::Clock > clock;
+        uint64_t currentTick = 0;
+        size_t levelCounts[NUM_LEVELS] = {0};
+        std::mutex mutex;
+        int nextToken = 1;
+        std::list< Timer > slots[NUM_LEVELS][NUM_SLOTS];
+        bool stop = false;
+        std::thread thread;
+        double tickSeconds = 0.01;
+        std::unordered_map< int, std::list< Timer >::iterator > timers;
+        std::condition_variable wakeCondition;
+        bool wakeUp = false;
+
+        // Methods
+
+        /**
+         * Return a token not used by any scheduled timer.  Tokens are
+         * always positive, and wrap around rather than overflow.
+         */
+        int TakeToken() {
+            for (;;) {
+                const auto token = nextToken;
+                if (nextToken == std::numeric_limits< int >::max()) {
+                    nextToken = 1;
+                } else {
+                    ++nextToken;
+                }
+                if (timers.find(token) == timers.end()) {
+                    return token;
+                }
+            }
+        }
+
+        /**
+         * Move the timers in the given slot of the given level down
+         * to wherever they now belong, given the current tick.
+         */
+        void Cascade(size_t level, size_t slotIndex) {
+            auto& slot = slots[level][slotIndex];
+            while (!slot.empty()) {
+                Place(slot, slot.begin());
+            }
+        }
+
+        /**
+         * Move the given timer from the given slot to the slot
+         * where it belongs, given the current tick and its due tick.
+         * The due tick must not be before the current tick.
+         */
+        void Place(
+            std::list< Timer >& from,
+            std::list< Timer >::iterator timer
+        ) {
+            const auto ticksToGo = timer->dueTick - currentTick;
+            size_t level = 0;
+            while (
+                (level + 1 < NUM_LEVELS)
+                && (ticksToGo >= ((uint64_t)1 << (SLOT_BITS * (level + 1))))
+            ) {
+                ++level;
+            }
+            size_t slotIndex;
+            if (ticksToGo >> (SLOT_BITS * NUM_LEVELS)) {
+                // The timer is further out than the wheel reaches,
+                // so park it in the last slot of the top level to be
+                // reached, and place it again from there.
+                slotIndex = (size_t)(
+                    ((currentTick >> (SLOT_BITS * level)) - 1)
+                    & SLOT_MASK
+                );
+            } else {
+                slotIndex = (size_t)(
+                    (timer->dueTick >> (SLOT_BITS * level))
+                    & SLOT_MASK
+                );
+            }
+            auto& to = slots[level][slotIndex];
+            to.splice(to.end(), from, timer);
+            if (timer->level < NUM_LEVELS) {
+                --levelCounts[timer->level];
+            }
+            ++levelCounts[level];
+            timer->level = level;
+            timer->slot = &to;
+        }
+
+        /**
+         * Advance the wheel to the tick of the current time, cascading
+         * timers down the levels and calling those which are due.
+         */
+        void Advance(std::unique_lock< decltype(mutex) >& lock) {
+            if (clock == nullptr) {
+                return;
+            }
+            const auto now = clock->GetCurrentTime();
+            const auto nowTick = (uint64_t)fmax(
+                floor(now / tickSeconds + TICK_ROUNDING_TOLERANCE),
+                0.0
+            );
+            while (currentTick < nowTick) {
+                if (timers.empty()) {
+                    currentTick = nowTick;
+                    break;
+                }
+
+                // Nothing happens in the lowest levels if they're empty,
+                // so skip ahead to the next cascade out of the lowest
+                // level which isn't empty.
+                size_t emptyLevels = 0;
+                while (
+                    (emptyLevels + 1 < NUM_LEVELS)
+                    && (levelCounts[emptyLevels] == 0)
+                ) {
+                    ++emptyLevels;
+                }
+                if (emptyLevels > 0) {
+                    const auto ticksPerCascade = ((uint64_t)1 << (SLOT_BITS * emptyLevels));
+                    const auto nextCascadeTick = (currentTick | (ticksPerCascade - 1)) + 1;
+                    if (nextCascadeTick > nowTick) {
+                        currentTick = nowTick;
+                        break;
+                    }
+                    currentTick = nextCascadeTick - 1;
+                }
+                ++currentTick;
+                for (size_t level = 1; level < NUM_LEVELS; ++level) {
+                    const auto lowerSlotIndex = (
+                        (currentTick >> (SLOT_BITS * (level - 1)))
+                        & SLOT_MASK
+                    );
+                    if (lowerSlotIndex != 0) {
+                        break;
+                    }
+                    Cascade(
+                        level,
+                        (size_t)(
+                            (currentTick >> (SLOT_BITS * level))
+                            & SLOT_MASK
+                        )
+                    );
+                }
+                auto& slot = slots[0][currentTick & SLOT_MASK];
+                while (!slot.empty()) {
+                    auto callback = std::move(slot.front().callback);
+                    (void)timers.erase(slot.front().token);
+                    --levelCounts[0];
+                    slot.pop_front();
+                    lock.unlock();
+                    callback();
+                    callback = nullptr;
+                    lock.lock();
+                }
+            }
+        }
+
+        void Stop() {
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                stop = true;
+                wakeCondition.notify_all();
+            }
+            if (!thread.joinable()) {
+                return;
+            }
+            if (thread.get_id() == std::this_thread::get_id()) {
+                thread.detach();
+            } else {
+                thread.join();
+            }
+        }
+
+        void Worker() {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            while (!stop) {
+                Advance(lock);
+                const auto woken = [this]{ return stop || wakeUp; };
+                if (timers.empty()) {
+                    wakeCondition.wait(lock, woken);
+                } else {
+                    wakeCondition.wait_for(
+                        lock,
+                        std::chrono::duration< double >(tickSeconds),
+                        woken
+                    );
+                }
+                wakeUp = false;
+            }
+        }
+    };
+
+    TimerWheel::~TimerWheel() noexcept {
+        if (impl_ != nullptr) {
+            impl_->Stop();
+        }
+    }
+
+    TimerWheel::TimerWheel(TimerWheel&&) noexcept = default;
+
+    TimerWheel& TimerWheel::operator=(TimerWheel&& other) noexcept {
+        if (this != &other) {
+            if (impl_ != nullptr) {
+                impl_->Stop();
+            }
+            impl_ = std::move(other.impl_);
+        }
+        return *this;
+    }
+
+    TimerWheel::TimerWheel(
+        double tickSeconds,
+        bool ownThread
+    )
+        : impl_(new Impl())
+    {
+        impl_->tickSeconds = tickSeconds;
+        if (!ownThread) {
+            return;
+        }
+        const auto impl = impl_;
+        impl_->thread = std::thread([impl]{ impl->Worker(); });
+    }
+
+    std::shared_ptr< Timekeeping::Clock > TimerWheel::GetClock() {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        return impl_->clock;
+    }
+
+    void TimerWheel::SetClock(const std::shared_ptr< Timekeeping::Clock >& clock) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->clock = clock;
+        if (impl_->timers.empty() && (clock != nullptr)) {
+            impl_->currentTick = (uint64_t)fmax(
+                floor(clock->GetCurrentTime() / impl_->tickSeconds + TICK_ROUNDING_TOLERANCE),
+                0.0
+            );
+        }
+        impl_->wakeUp = true;
+        impl_->wakeCondition.notify_all();
+    }
+
+    int TimerWheel::Schedule(
+        Callback&& callback,
+        double due
+    ) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        auto dueTick = (uint64_t)fmax(
+            ceil(due / impl_->tickSeconds - TICK_ROUNDING_TOLERANCE),
+            0.0
+        );
+
+        // The slot of the current tick has already been handled,
+        // so calls which are already due are made on the next tick.
+        if (dueTick <= impl_->currentTick) {
+            dueTick = impl_->currentTick + 1;
+        }
+        const auto token = impl_->TakeToken();
+        std::list< Timer > pending;
+        pending.emplace_back();
+        auto timer = pending.begin();
+        timer->token = token;
+        timer->dueTick = dueTick;
+        timer->callback = std::move(callback);
+        impl_->Place(pending, timer);
+        impl_->timers[token] = timer;
+
+        // The thread only needs waking if it's waiting for timers to be
+        // scheduled, or if this call is due before its next regular tick.
+        if (
+            (impl_->timers.size() == 1)
+            || (dueTick == impl_->currentTick + 1)
+        ) {
+            impl_->wakeUp = true;
+            impl_->wakeCondition.notify_all();
+        }
+        return token;
+    }
+
+    void TimerWheel::Cancel(int token) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        const auto timersEntry = impl_->timers.find(token);
+        if (timersEntry == impl_->timers.end()) {
+            return;
+        }
+        const auto timer = timersEntry->second;
+        --impl_->levelCounts[timer->level];
+        timer->slot->erase(timer);
+        impl_->timers.erase(timersEntry);
+    }
+
+    void TimerWheel::WakeUp() {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->wakeUp = true;
+        impl_->wakeCondition.notify_all();
+    }
+
+    void TimerWheel::Advance() {
+        std::unique_lock< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->Advance(lock);
+    }
+
+}
@@ -0,0 +1,251 @@
+/**
+ * @file WebSocketHandshake.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::WebSocketHandshake functions.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "WebSocketHandshake.hpp"
+
+#include <stddef.h>
+
+namespace {
+
+    /**
+     * This is appended to the client's key before hashing it to make
+     * the server's answer, according to RFC 6455.
+     */
+    const std::string ACCEPT_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+    uint32_t RotateLeft(
+        uint32_t value,
+        unsigned int bits
+    ) {
+        return (value << bits) | (value >> (32 - bits));
+    }
+
+    /**
+     * Return the SHA-1 digest (FIPS 180-4) of the given data.
+     */
+    std::string Sha1(const std::string& data) {
+        uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+        auto message = data;
+        const uint64_t numBits = (uint64_t)data.length() * 8;
+        message += (char)0x80;
+        while (message.length() % 64 != 56) {
+            message += (char)0x00;
+        }
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            message += (char)((numBits >> shift) & 0xFF);
+        }
+        for (size_t chunk = 0; chunk < message.length(); chunk += 64) {
+            uint32_t w[80];
+            for (size_t i = 0; i < 16; ++i) {
+                w[i] = (
+                    ((uint32_t)(uint8_t)message[chunk + i * 4] << 24)
+                    | ((uint32_t)(uint8_t)message[chunk + i * 4 + 1] << 16)
+                    | ((uint32_t)(uint8_t)message[chunk + i * 4 + 2] << 8)
+                    | (uint32_t)(uint8_t)message[chunk + i * 4 + 3]
+                );
+            }
+            for (size_t i = 16; i < 80; ++i) {
+                w[i] = RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+            }
+            auto a = h[0];
+            auto b = h[1];
+            auto c = h[2];
+            auto d = h[3];
+            auto e = h[4];
+            for (size_t i = 0; i < 80; ++i) {
+                uint32_t f, k;
+                if (i < 20) {
+                    f = (b & c) | (~b & d);
+                    k = 0x5A827999;
+                } else if (i < 40) {
+                    f = b ^ c ^ d;
+                    k = 0x6ED9EBA1;
+                } else if (i < 60) {
+                    f = (b & c) | (b & d) | (c & d);
+                    k = 0x8F1BBCDC;
+                } else {
+                    f = b ^ c ^ d;
+                    k = 0xCA62C1D6;
+                }
+                const auto temp = RotateLeft(a, 5) + f + e + k + w[i];
+                e = d;
+                d = c;
+                c = RotateLeft(b, 30);
+                b = a;
+                a = temp;
+            }
+            h[0] += a;
+            h[1] += b;
+            h[2] += c;
+            h[3] += d;
+            h[4] += e;
+        }
+        std::string digest;
+        for (const auto word: h) {
+            for (int shift = 24; shift >= 0; shift -= 8) {
+                digest += (char)((word >> shift) & 0xFF);
+            }
+        }
+        return digest;
+    }
+
+}
+
+namespace Discord {
+
+    namespace WebSocketHandshake {
+
+        std::string ComputeAccept(const std::string& key) {
+            return Base64Encode(Sha1(key + ACCEPT_GUID));
+        }
+
+        std::string Base64Encode(const std::string& data) {
+            static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            std::string encoding;
+            encoding.reserve((data.length() + 2) / 3 * 4);
+            for (size_t i = 0; i < data.length(); i += 3) {
+                const auto remaining = data.length() - i;
+                uint32_t group = (uint32_t)(uint8_t)data[i] << 16;
+                if (remaining > 1) {
+                    group |= (uint32_t)(uint8_t)data[i + 1] << 8;
+                }
+                if (remaining > 2) {
+                    group |= (uint32_t)(uint8_t)data[i + 2];
+                }
+                encoding += ALPHABET[(group >> 18) & 0x3F];
+                encoding += ALPHABET[(group >> 12) & 0x3F];
+                encoding += (remaining > 1) ? ALPHABET[(group >> 6) & 0x3F] : '=';
+                encoding += (remaining > 2) ? ALPHABET[group & 0x3F] : '=';
+            }
+            return encoding;
+        }
+
+        std::string EncodeFrame(
+            Opcode opcode,
+            const std::string& payload,
+            bool masked,
+            uint32_t maskingKey
+        ) {
+            std::string frame;
+            frame.reserve(payload.length() + 14);
+            frame += (char)(0x80 | (uint8_t)opcode);
+            const uint8_t maskBit = (masked ? 0x80 : 0x00);
+            const auto length = (uint64_t)payload.length();
+            if (length < 126) {
+                frame += (char)(maskBit | (uint8_t)length);
+            } else if (length <= 0xFFFF) {
+                frame += (char)(maskBit | 126);
+                frame += (char)((length >> 8) & 0xFF);
+                frame += (char)(length & 0xFF);
+            } else {
+                frame += (char)(maskBit | 127);
+                for (int shift = 56; shift >= 0; shift -= 8) {
+                    frame += (char)((length >> shift) & 0xFF);
+                }
+            }
+            if (!masked) {
+                frame += payload;
+                return frame;
+            }
+            uint8_t mask[4];
+            for (size_t i = 0; i < 4; ++i) {
+                mask[i] = (uint8_t)((maskingKey >> (24 - i * 8)) & 0xFF);
+                frame += (char)mask[i];
+            }
+            const auto payloadStart = frame.length();
+            frame += payload;
+            for (size_t i = 0; i < payload.length(); ++i) {
+                frame[payloadStart + i] ^= mask[i % 4];
+            }
+            return frame;
+        }
+
+        DecodeResult DecodeFrame(
+            const std::string& data,
+            size_t& offset,
+            Frame& frame
+        ) {
+            const auto available = data.length() - offset;
+            if (available < 2) {
+                return DecodeResult::Incomplete;
+            }
+            const auto first = (uint8_t)data[offset];
+            const auto second = (uint8_t)data[offset + 1];
+            const auto final = ((first & 0x80) != 0);
+            const auto opcode = (Opcode)(first & 0x0F);
+            if ((first & 0x70) != 0) {
+                return DecodeResult::ProtocolError;
+            }
+            switch (opcode) {
+                case Opcode::Continuation:
+                case Opcode::Text:
+                case Opcode::Binary:
+                case Opcode::Close:
+                case Opcode::Ping:
+                case Opcode::Pong: break;
+
+                default: return DecodeResult::ProtocolError;
+            }
+            const auto control = (((uint8_t)opcode & 0x08) != 0);
+            size_t headerLength = 2;
+            uint64_t length = (second & 0x7F);
+            if (
+                control
+                && (
+                    !final
+                    || (length > 125)
+                )
+            ) {
+                return DecodeResult::ProtocolError;
+            }
+            if (length == 126) {
+                headerLength += 2;
+                if (available < headerLength) {
+                    return DecodeResult::Incomplete;
+                }
+                length = ((uint64_t)(uint8_t)data[offset + 2] << 8) | (uint8_t)data[offset + 3];
+            } else if (length == 127) {
+                headerLength += 8;
+                if (available < headerLength) {
+                    return DecodeResult::Incomplete;
+                }
+                length = 0;
+                for (size_t i = 2; i < 10; ++i) {
+                    length = (length << 8) | (uint8_t)data[offset + i];
+                }
+            }
+            if (length > MAX_PAYLOAD_LENGTH) {
+                return DecodeResult::TooBig;
+            }
+            const auto masked = ((second & 0x80) != 0);
+            const auto maskStart = offset + headerLength;
+            if (masked) {
+                headerLength += 4;
+            }
+            if (
+                (available < headerLength)
+                || (available - headerLength < length)
+            ) {
+                return DecodeResult::Incomplete;
+            }
+            frame.final = final;
+            frame.opcode = opcode;
+            frame.payload.assign(data, offset + headerLength, (size_t)length);
+            if (masked) {
+                for (size_t i = 0; i < frame.payload.length(); ++i) {
+                    frame.payload[i] ^= data[maskStart + i % 4];
+                }
+            }
+            offset += headerLength + (size_t)length;
+            return DecodeResult::Complete;
+        }
+
+    }
+
+}
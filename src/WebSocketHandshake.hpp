@@ -0,0 +1,111 @@
+#pragma once
+
+/**
+ * @file WebSocketHandshake.hpp
+ *
+ * This module declares the Discord::WebSocketHandshake functions, which
+ * are used to open and frame WebSocket connections (RFC 6455).
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+namespace Discord {
+
+    namespace WebSocketHandshake {
+
+        enum class Opcode : uint8_t {
+            Continuation = 0x0,
+            Text = 0x1,
+            Binary = 0x2,
+            Close = 0x8,
+            Ping = 0x9,
+            Pong = 0xA,
+        };
+
+        /**
+         * This is the longest payload a received frame may have, and
+         * the longest message received frames may be put together into.
+         */
+        constexpr size_t MAX_PAYLOAD_LENGTH = 64 * 1024 * 1024;
+
+        /**
+         * These are the possible outcomes of decoding a frame.
+         */
+        enum class DecodeResult {
+            /**
+             * The data doesn't yet hold all of the next frame.
+             */
+            Incomplete,
+
+            /**
+             * A frame was decoded.
+             */
+            Complete,
+
+            /**
+             * The next frame breaks the protocol, such as by having a
+             * reserved opcode or reserved bits set, or by being a
+             * fragmented or long control frame.
+             */
+            ProtocolError,
+
+            /**
+             * The next frame's payload is longer than MAX_PAYLOAD_LENGTH.
+             */
+            TooBig,
+        };
+
+        /**
+         * This is one frame taken from received data.
+         */
+        struct Frame {
+            bool final = false;
+            Opcode opcode = Opcode::Continuation;
+            std::string payload;
+        };
+
+        /**
+         * Return the value the server must give in the
+         * "Sec-WebSocket-Accept" header of its response to an opening
+         * handshake whose "Sec-WebSocket-Key" header had the given value.
+         */
+        std::string ComputeAccept(const std::string& key);
+
+        std::string Base64Encode(const std::string& data);
+
+        /**
+         * Return the given message framed as a single final frame.
+         * Frames sent by a client must be masked with the given key;
+         * frames sent by a server must not be masked.
+         */
+        std::string EncodeFrame(
+            Opcode opcode,
+            const std::string& payload,
+            bool masked,
+            uint32_t maskingKey = 0
+        );
+
+        /**
+         * Decode the frame starting at the given offset of the given
+         * data, advancing the offset past the frame if it's complete.
+         * Data already decoded can then be dropped all at once, rather
+         * than frame by frame.
+         *
+         * @return
+         *     The outcome of decoding the frame is returned.  The offset
+         *     is only advanced, and the frame only filled in, if this
+         *     is DecodeResult::Complete.
+         */
+        DecodeResult DecodeFrame(
+            const std::string& data,
+            size_t& offset,
+            Frame& frame
+        );
+
+    }
+
+}
@@ -0,0 +1,112 @@
+/**
+ * @file WorkerPool.cpp
+ *
+ * This module contains the implementation of the
+ * Discord::WorkerPool class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <condition_variable>
+#include <deque>
+#include <Discord/WorkerPool.hpp>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Discord {
+
+    /**
+     * This contains the private properties of a WorkerPool instance.
+     */
+    struct WorkerPool::Impl {
+        // Properties
+
+        std::deque< Job > jobs;
+        std::mutex mutex;
+        bool stop = false;
+        std::condition_variable wakeCondition;
+        std::vector< std::thread > workers;
+
+        // Methods
+
+        void Stop() {
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                stop = true;
+                wakeCondition.notify_all();
+            }
+            for (auto& worker: workers) {
+                // If the last reference to the pool is released by one
+                // of its own jobs, that worker can't wait for itself.
+                // It holds its own reference to these properties, so
+                // it's safe to let it finish on its own.
+                if (worker.get_id() == std::this_thread::get_id()) {
+                    worker.detach();
+                } else {
+                    worker.join();
+                }
+            }
+        }
+
+        void Worker() {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            for (;;) {
+                wakeCondition.wait(
+                    lock,
+                    [this]{ return stop || !jobs.empty(); }
+                );
+                if (jobs.empty()) {
+                    return;
+                }
+                auto job = std::move(jobs.front());
+                jobs.pop_front();
+                lock.unlock();
+                job();
+                job = nullptr;
+                lock.lock();
+            }
+        }
+    };
+
+    WorkerPool::~WorkerPool() noexcept {
+        if (impl_ != nullptr) {
+            impl_->Stop();
+        }
+    }
+
+    WorkerPool::WorkerPool(WorkerPool&&) noexcept = default;
+
+    WorkerPool& WorkerPool::operator=(WorkerPool&& other) noexcept {
+        if (this != &other) {
+            if (impl_ != nullptr) {
+                impl_->Stop();
+            }
+            impl_ = std::move(other.impl_);
+        }
+        return *this;
+    }
+
+    WorkerPool::WorkerPool(size_t numWorkers)
+        : impl_(new Impl())
+    {
+        if (numWorkers == 0) {
+            numWorkers = 1;
+        }
+        const auto impl = impl_;
+        for (size_t i = 0; i < numWorkers; ++i) {
+            impl_->workers.emplace_back([impl]{ impl->Worker(); });
+        }
+    }
+
+    size_t WorkerPool::GetNumWorkers() const {
+        return impl_->workers.size();
+    }
+
+    void WorkerPool::Post(Job&& job) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->jobs.push_back(std::move(job));
+        impl_->wakeCondition.notify_one();
+    }
+
+}
@@ -0,0 +1,318 @@
+/**
+ * @file AllocationTests.cpp
+ *
+ * This module contains tests of how many heap allocations the busiest
+ * paths of the Discord library make, so that any change which makes them
+ * allocate more than their budget is caught.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+
+#include <Discord/AllocationCounter.hpp>
+#include <Discord/Cache.hpp>
+#include <Discord/EventDispatcher.hpp>
+#include <Discord/WorkerPool.hpp>
+#include <gtest/gtest.h>
+#include <Json/Value.hpp>
+#include <memory>
+#include <stddef.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the number of messages sent before measuring, to let the
+     * gateway reach its steady state.
+     */
+    constexpr size_t WARM_UP_MESSAGES = 16;
+
+    /**
+     * This is the number of messages over which allocations
+     * are measured.
+     */
+    constexpr size_t MEASURED_MESSAGES = 64;
+
+    /**
+     * Memory allocated only to be counted is handed here, so that the
+     * compiler can't tell it's unused and leave out the allocation.
+     */
+    char* volatile allocationSink = nullptr;
+
+    /**
+     * Allocate the given number of bytes, making sure the allocation
+     * isn't optimized away.
+     */
+    std::unique_ptr< char[] > AllocateObservably(size_t size) {
+        std::unique_ptr< char[] > memory(new char[size]);
+        memory[0] = 1;
+        allocationSink = memory.get();
+        return memory;
+    }
+
+    std::string MakeMessageCreate(int sequenceNumber) {
+        return (
+            "{\"t\":\"MESSAGE_CREATE\",\"s\":" + std::to_string(sequenceNumber)
+            + ",\"op\":0,\"d\":"
+            + Json::Object({
+                {"id", std::to_string(sequenceNumber + 700000000)},
+                {"channel_id", "200"},
+                {"guild_id", "100"},
+                {"author", Json::Object({
+                    {"id", "1000"},
+                    {"username", "Frog"},
+                    {"discriminator", "0001"},
+                })},
+                {"content", "Hello, World!"},
+            }).ToEncoding()
+            + "}"
+        );
+    }
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ *
+ * The budgets in these tests are ceilings, with some room to spare,
+ * on what each path allocates today.  Lower them as allocations are
+ * taken out of these paths, so they stay out.
+ */
+struct AllocationTests
+    : public CommonTextFixture
+{
+    // Properties
+
+    size_t numEventsReceived = 0;
+
+    // Methods
+
+    /**
+     * Send the given number of MESSAGE_CREATE events to the gateway,
+     * building them beforehand so that only the gateway's allocations
+     * are counted.
+     */
+    void SendMessages(
+        size_t numMessages,
+        int& sequenceNumber
+    ) {
+        std::vector< std::string > messages;
+        for (size_t i = 0; i < numMessages; ++i) {
+            messages.push_back(MakeMessageCreate(++sequenceNumber));
+        }
+        for (auto& message: messages) {
+            webSocket->onText(std::move(message));
+        }
+    }
+
+    // ::testing::Test
+
+    virtual void SetUp() override {
+        CommonTextFixture::SetUp();
+        if (!Discord::AllocationCounter::IsEnabled()) {
+            FAIL() << "allocations aren't being counted";
+        }
+        gateway.RegisterDiagnosticMessageCallback(
+            [](size_t, std::string&&){}
+        );
+        gateway.RegisterEventCallback(
+            [this](Discord::Gateway::Event&&){
+                ++numEventsReceived;
+            }
+        );
+    }
+};
+
+TEST_F(AllocationTests, Counter_Counts_Allocations_Of_Current_Thread) {
+    // Arrange
+    Discord::AllocationCounter::Counts otherThreadCounts;
+    std::thread otherThread(
+        [&otherThreadCounts]{
+            const Discord::AllocationCounter counter;
+            const auto memory = AllocateObservably(5000);
+            otherThreadCounts = counter.GetCounts();
+        }
+    );
+    const Discord::AllocationCounter counter;
+
+    // Act
+    const auto memory = AllocateObservably(1000);
+    otherThread.join();
+    const auto counts = counter.GetCounts();
+
+    // Assert
+    EXPECT_EQ(1, counts.allocations);
+    EXPECT_EQ(1000, counts.bytes);
+    EXPECT_EQ(1, otherThreadCounts.allocations);
+    EXPECT_EQ(5000, otherThreadCounts.bytes);
+}
+
+TEST_F(AllocationTests, Gateway_Reports_Allocations_Per_Message) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    const auto before = gateway.GetAllocationStatistics();
+    int sequenceNumber = 0;
+
+    // Act
+    SendMessages(MEASURED_MESSAGES, sequenceNumber);
+
+    // Assert
+    const auto after = gateway.GetAllocationStatistics();
+    EXPECT_EQ(MEASURED_MESSAGES, numEventsReceived);
+    EXPECT_EQ(MEASURED_MESSAGES, after.messages - before.messages);
+    EXPECT_GT(after.messageAllocations, before.messageAllocations);
+    EXPECT_GT(after.messageBytes, before.messageBytes);
+}
+
+TEST_F(AllocationTests, Inbound_Message_Within_Budget) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    int sequenceNumber = 0;
+    SendMessages(WARM_UP_MESSAGES, sequenceNumber);
+    const auto before = gateway.GetAllocationStatistics();
+
+    // Act
+    SendMessages(MEASURED_MESSAGES, sequenceNumber);
+
+    // Assert
+    const auto after = gateway.GetAllocationStatistics();
+    const auto allocationsPerMessage = (
+        (after.messageAllocations - before.messageAllocations)
+        / MEASURED_MESSAGES
+    );
+    const auto bytesPerMessage = (
+        (after.messageBytes - before.messageBytes)
+        / MEASURED_MESSAGES
+    );
+    EXPECT_LE(allocationsPerMessage, 64);
+    EXPECT_LE(bytesPerMessage, 8192);
+}
+
+TEST_F(AllocationTests, Inbound_Message_Decoded_For_Cache_Within_Budget) {
+    // Arrange
+    gateway.SetCache(std::make_shared< Discord::Cache >());
+    ASSERT_TRUE(Connect(configuration));
+    int sequenceNumber = 0;
+    SendMessages(WARM_UP_MESSAGES, sequenceNumber);
+    const auto before = gateway.GetAllocationStatistics();
+
+    // Act
+    SendMessages(MEASURED_MESSAGES, sequenceNumber);
+
+    // Assert
+    const auto after = gateway.GetAllocationStatistics();
+    const auto allocationsPerMessage = (
+        (after.messageAllocations - before.messageAllocations)
+        / MEASURED_MESSAGES
+    );
+    const auto bytesPerMessage = (
+        (after.messageBytes - before.messageBytes)
+        / MEASURED_MESSAGES
+    );
+    EXPECT_LE(allocationsPerMessage, 18);
+    EXPECT_LE(bytesPerMessage, 2560);
+}
+
+TEST_F(AllocationTests, Heartbeat_Within_Budget) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    const auto heartbeatRequest = Json::Object({
+        {"op", 1},
+        {"d", nullptr},
+    }).ToEncoding();
+    for (size_t i = 0; i < WARM_UP_MESSAGES; ++i) {
+        webSocket->onText(std::string(heartbeatRequest));
+    }
+    const auto before = gateway.GetAllocationStatistics();
+
+    // Act
+    for (size_t i = 0; i < MEASURED_MESSAGES; ++i) {
+        webSocket->onText(std::string(heartbeatRequest));
+    }
+
+    // Assert
+    const auto after = gateway.GetAllocationStatistics();
+    ASSERT_EQ(MEASURED_MESSAGES, after.heartbeats - before.heartbeats);
+    const auto allocationsPerHeartbeat = (
+        (after.heartbeatAllocations - before.heartbeatAllocations)
+        / MEASURED_MESSAGES
+    );
+    const auto bytesPerHeartbeat = (
+        (after.heartbeatBytes - before.heartbeatBytes)
+        / MEASURED_MESSAGES
+    );
+    EXPECT_LE(allocationsPerHeartbeat, 24);
+    EXPECT_LE(bytesPerHeartbeat, 2048);
+}
+
+TEST_F(AllocationTests, Dispatch_Within_Budget) {
+    // Arrange
+    Discord::EventDispatcher dispatcher(std::make_shared< Discord::WorkerPool >(1));
+    std::vector< Discord::Gateway::Event > events;
+    for (size_t i = 0; i < MEASURED_MESSAGES; ++i) {
+        Discord::Gateway::Event event;
+        event.name = "MESSAGE_CREATE";
+        event.sequenceNumber = (int)i + 1;
+        event.data = Json::Object({
+            {"guild_id", "100"},
+            {"channel_id", "200"},
+        });
+        events.push_back(std::move(event));
+    }
+    const Discord::AllocationCounter counter;
+
+    // Act
+    for (auto& event: events) {
+        dispatcher.Dispatch(std::move(event));
+    }
+
+    // Assert
+    const auto counts = counter.GetCounts();
+    EXPECT_LE(counts.allocations / MEASURED_MESSAGES, 4);
+    EXPECT_LE(counts.bytes / MEASURED_MESSAGES, 512);
+}
+
+TEST_F(AllocationTests, Cache_Update_And_Lookup_Within_Budget) {
+    // Arrange
+    Discord::Cache cache;
+    const std::string guildId = "100";
+    const std::string userId = "1000";
+    std::vector< std::string > encodings;
+    for (size_t i = 0; i <= MEASURED_MESSAGES; ++i) {
+        encodings.push_back(
+            Json::Object({
+                {"user", Json::Object({
+                    {"id", userId},
+                    {"username", "Frog #" + std::to_string(i)},
+                })},
+            }).ToEncoding()
+        );
+    }
+    cache.SetEntity(
+        guildId,
+        Discord::Cache::EntityKind::Member,
+        userId,
+        std::move(encodings[0])
+    );
+    const Discord::AllocationCounter counter;
+
+    // Act
+    for (size_t i = 1; i <= MEASURED_MESSAGES; ++i) {
+        cache.SetEntity(
+            guildId,
+            Discord::Cache::EntityKind::Member,
+            userId,
+            std::move(encodings[i])
+        );
+        (void)cache.GetEntity(guildId, Discord::Cache::EntityKind::Member, userId);
+    }
+
+    // Assert
+    const auto counts = counter.GetCounts();
+    EXPECT_LE(counts.allocations / MEASURED_MESSAGES, 4);
+    EXPECT_LE(counts.bytes / MEASURED_MESSAGES, 256);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file ArenaTests.cpp
+ *
+ * This module contains the unit tests of the Discord::Arena class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "../../src/Arena.hpp"
+
+#include <Discord/AllocationCounter.hpp>
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+TEST(ArenaTests, Allocate_Hands_Out_Aligned_Memory_In_Order) {
+    // Arrange
+    Discord::Arena arena(256);
+
+    // Act
+    const auto first = (char*)arena.Allocate(1, 1);
+    const auto second = (char*)arena.Allocate(8, 8);
+    const auto third = (char*)arena.Allocate(3, 1);
+
+    // Assert
+    EXPECT_EQ(0, (uintptr_t)second % 8);
+    EXPECT_LT(first, second);
+    EXPECT_EQ(second + 8, third);
+    EXPECT_EQ(256, arena.GetCapacity());
+}
+
+TEST(ArenaTests, Grows_When_Chunk_Runs_Out) {
+    // Arrange
+    Discord::Arena arena(64);
+
+    // Act
+    (void)arena.Allocate(48, 1);
+    (void)arena.Allocate(48, 1);
+    (void)arena.Allocate(1000, 1);
+
+    // Assert
+    EXPECT_EQ(1096, arena.GetBytesUsed());
+    EXPECT_EQ(64 + 128 + 1000, arena.GetCapacity());
+}
+
+TEST(ArenaTests, Reset_Coalesces_Chunks_Then_Only_Rewinds) {
+    // Arrange
+    Discord::Arena arena(64);
+    (void)arena.Allocate(48, 1);
+    (void)arena.Allocate(48, 1);
+    arena.Reset();
+    ASSERT_EQ(0, arena.GetBytesUsed());
+    ASSERT_EQ(192, arena.GetCapacity());
+    const Discord::AllocationCounter counter;
+
+    // Act
+    for (size_t i = 0; i < 10; ++i) {
+        (void)arena.Allocate(48, 1);
+        (void)arena.Allocate(48, 1);
+        arena.Reset();
+    }
+
+    // Assert
+    EXPECT_EQ(0, counter.GetCounts().allocations);
+    EXPECT_EQ(192, arena.GetCapacity());
+}
+
+TEST(ArenaTests, Containers_Draw_From_Arena) {
+    // Arrange
+    Discord::Arena arena;
+    (void)arena.Allocate(1, 1);
+    arena.Reset();
+    const Discord::AllocationCounter counter;
+
+    // Act
+    Discord::ArenaString text{Discord::ArenaAllocator< char >(arena)};
+    text.assign("This is long enough not to fit in the string itself");
+    Discord::ArenaVector< int > numbers{Discord::ArenaAllocator< int >(arena)};
+    for (int i = 0; i < 100; ++i) {
+        numbers.push_back(i);
+    }
+
+    // Assert
+    EXPECT_EQ(0, counter.GetCounts().allocations);
+    EXPECT_GT(arena.GetBytesUsed(), text.length() + 100 * sizeof(int));
+    EXPECT_EQ(99, numbers.back());
+}
+
+TEST(ArenaTests, Promote_Copies_String_Out_Of_Arena) {
+    // Arrange
+    Discord::Arena arena;
+    std::string promoted;
+    {
+        Discord::ArenaString text{Discord::ArenaAllocator< char >(arena)};
+        text.assign("Hello, World!");
+
+        // Act
+        promoted = Discord::Promote(text);
+    }
+    arena.Reset();
+    (void)memset(arena.Allocate(64, 1), 'x', 64);
+
+    // Assert
+    EXPECT_EQ("Hello, World!", promoted);
+}
@@ -0,0 +1,306 @@
+/**
+ * @file CacheTests.cpp
+ *
+ * This module contains unit tests of the Discord::Gateway class
+ * in storing the entities of guilds it receives into a Discord::Cache.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+
+#include <algorithm>
+#include <Discord/Cache.hpp>
+#include <gtest/gtest.h>
+#include <Json/Value.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct CacheTests
+    : public CommonTextFixture
+{
+    // Properties
+
+    std::shared_ptr< Discord::Cache > cache = std::make_shared< Discord::Cache >();
+    std::vector< std::string > diagnosticMessages;
+    std::mutex mutex;
+
+    // Methods
+
+    Json::Value GetEntity(
+        const std::string& guildId,
+        Discord::Cache::EntityKind kind,
+        const std::string& id
+    ) {
+        return Json::Value::FromEncoding(cache->GetEntity(guildId, kind, id));
+    }
+
+    std::vector< std::string > GetEntityIds(
+        const std::string& guildId,
+        Discord::Cache::EntityKind kind
+    ) {
+        auto ids = cache->GetEntityIds(guildId, kind);
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    Json::Value MakeGuild(const std::string& guildId) {
+        return Json::Object({
+            {"id", guildId},
+            {"name", "Pepe's Pond"},
+            {"members", Json::Array({
+                Json::Object({
+                    {"user", Json::Object({
+                        {"id", "1"},
+                        {"username", "Pepe"},
+                    })},
+                    {"roles", Json::Array({"10"})},
+                }),
+                Json::Object({
+                    {"user", Json::Object({
+                        {"id", "2"},
+                        {"username", "Freddy \"The Frog\""},
+                    })},
+                    {"roles", Json::Array({})},
+                }),
+            })},
+            {"channels", Json::Array({
+                Json::Object({
+                    {"id", "100"},
+                    {"name", "general"},
+                    {"type", 0},
+                }),
+            })},
+            {"roles", Json::Array({
+                Json::Object({
+                    {"id", "10"},
+                    {"name", "Frogs"},
+                }),
+            })},
+            {"presences", Json::Array({
+                Json::Object({
+                    {"user", Json::Object({
+                        {"id", "1"},
+                    })},
+                    {"status", "online"},
+                }),
+            })},
+        });
+    }
+
+    void ExpectGuildCached(
+        const std::string& guildId,
+        const Json::Value& guild
+    ) {
+        EXPECT_EQ(
+            std::vector< std::string >({"1", "2"}),
+            GetEntityIds(guildId, Discord::Cache::EntityKind::Member)
+        );
+        EXPECT_EQ(
+            guild["members"][0],
+            GetEntity(guildId, Discord::Cache::EntityKind::Member, "1")
+        );
+        EXPECT_EQ(
+            guild["members"][1],
+            GetEntity(guildId, Discord::Cache::EntityKind::Member, "2")
+        );
+        EXPECT_EQ(
+            guild["channels"][0],
+            GetEntity(guildId, Discord::Cache::EntityKind::Channel, "100")
+        );
+        EXPECT_EQ(
+            guild["roles"][0],
+            GetEntity(guildId, Discord::Cache::EntityKind::Role, "10")
+        );
+        EXPECT_EQ(
+            guild["presences"][0],
+            GetEntity(guildId, Discord::Cache::EntityKind::Presence, "1")
+        );
+    }
+
+    // ::testing::Test
+
+    virtual void SetUp() override {
+        CommonTextFixture::SetUp();
+        gateway.SetCache(cache);
+        gateway.RegisterDiagnosticMessageCallback(
+            [this](
+                size_t level,
+                std::string&& message
+            ){
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                diagnosticMessages.push_back(std::move(message));
+            }
+        );
+    }
+};
+
+TEST_F(CacheTests, Guild_Create_Entities_Streamed_Into_Cache) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    const auto guild = MakeGuild("42");
+
+    // Act
+    SendDispatch("GUILD_CREATE", 1, guild);
+
+    // Assert
+    ExpectGuildCached("42", guild);
+}
+
+TEST_F(CacheTests, Guild_Create_Entities_Streamed_Into_Cache_When_Payload_Before_Event_Name) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    const auto guild = MakeGuild("42");
+
+    // Act
+    webSocket->onText(
+        "{\"d\":" + guild.ToEncoding()
+        + ",\"op\":0,\"s\":1,\"t\":\"GUILD_CREATE\"}"
+    );
+
+    // Assert
+    ExpectGuildCached("42", guild);
+}
+
+TEST_F(CacheTests, Guild_Create_Entities_Cached_When_Not_Streamed) {
+    // Arrange
+    configuration.heavyEvents.clear();
+    ASSERT_TRUE(Connect(configuration));
+    const auto guild = MakeGuild("42");
+
+    // Act
+    SendDispatch("GUILD_CREATE", 1, guild);
+
+    // Assert
+    ExpectGuildCached("42", guild);
+}
+
+TEST_F(CacheTests, Guild_Members_Chunk_Entities_Streamed_Into_Cache) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    const auto chunk = Json::Object({
+        {"guild_id", "42"},
+        {"members", Json::Array({
+            Json::Object({
+                {"user", Json::Object({
+                    {"id", "3"},
+                    {"username", "Tad"},
+                })},
+            }),
+        })},
+        {"presences", Json::Array({
+            Json::Object({
+                {"user", Json::Object({
+                    {"id", "3"},
+                })},
+                {"status", "idle"},
+            }),
+        })},
+        {"chunk_index", 0},
+        {"chunk_count", 1},
+    });
+
+    // Act
+    SendDispatch("GUILD_MEMBERS_CHUNK", 2, chunk);
+
+    // Assert
+    EXPECT_EQ(
+        chunk["members"][0],
+        GetEntity("42", Discord::Cache::EntityKind::Member, "3")
+    );
+    EXPECT_EQ(
+        chunk["presences"][0],
+        GetEntity("42", Discord::Cache::EntityKind::Presence, "3")
+    );
+}
+
+TEST_F(CacheTests, Guild_Delete_Removes_Guild_From_Cache) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    SendDispatch("GUILD_CREATE", 1, MakeGuild("42"));
+
+    // Act
+    SendDispatch(
+        "GUILD_DELETE",
+        2,
+        Json::Object({
+            {"id", "42"},
+        })
+    );
+
+    // Assert
+    EXPECT_EQ(
+        std::vector< std::string >({}),
+        cache->GetGuildIds()
+    );
+}
+
+TEST_F(CacheTests, Guild_Kept_In_Cache_When_Guild_Becomes_Unavailable) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    SendDispatch("GUILD_CREATE", 1, MakeGuild("42"));
+
+    // Act
+    SendDispatch(
+        "GUILD_DELETE",
+        2,
+        Json::Object({
+            {"id", "42"},
+            {"unavailable", true},
+        })
+    );
+
+    // Assert
+    EXPECT_EQ(
+        std::vector< std::string >({"42"}),
+        cache->GetGuildIds()
+    );
+}
+
+TEST_F(CacheTests, Peak_Resident_Set_Size_Reported_Once_All_Guilds_Received_After_Ready) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    const auto countReports = [this]{
+        std::lock_guard< decltype(mutex) > lock(mutex);
+        return std::count_if(
+            diagnosticMessages.begin(),
+            diagnosticMessages.end(),
+            [](const std::string& message){
+                return (message.find("peak resident set size") != std::string::npos);
+            }
+        );
+    };
+
+    // Act
+    SendDispatch(
+        "READY",
+        1,
+        Json::Object({
+            {"v", 6},
+            {"guilds", Json::Array({
+                Json::Object({
+                    {"id", "42"},
+                    {"unavailable", true},
+                }),
+                Json::Object({
+                    {"id", "43"},
+                    {"unavailable", true},
+                }),
+            })},
+        })
+    );
+    SendDispatch("GUILD_CREATE", 2, MakeGuild("42"));
+    const auto reportsBeforeLastGuild = countReports();
+    SendDispatch("GUILD_CREATE", 3, MakeGuild("43"));
+    const auto reportsAfterLastGuild = countReports();
+
+    // Assert
+    EXPECT_EQ(0, reportsBeforeLastGuild);
+    EXPECT_EQ(1, reportsAfterLastGuild);
+}
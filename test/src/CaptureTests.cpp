@@ -0,0 +1,291 @@
+/**
+ * @file CaptureTests.cpp
+ *
+ * This module contains unit tests of the Discord::Capture structure
+ * and Discord::RecordingConnections class, and of playing captures
+ * back into a Discord::Gateway.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+#include "Replayer.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <Discord/Capture.hpp>
+#include <Discord/RecordingConnections.hpp>
+#include <gtest/gtest.h>
+#include <Json/Value.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+    Discord::Capture::Frame MakeFrame(
+        double time,
+        size_t connection,
+        Discord::Capture::FrameKind kind,
+        const std::string& data
+    ) {
+        Discord::Capture::Frame frame;
+        frame.time = time;
+        frame.connection = connection;
+        frame.kind = kind;
+        frame.data = data;
+        return frame;
+    }
+
+    std::string MakeDispatch(
+        const std::string& eventName,
+        int sequenceNumber,
+        const Json::Value& data
+    ) {
+        return Json::Object({
+            {"t", eventName},
+            {"s", sequenceNumber},
+            {"op", 0},
+            {"d", data},
+        }).ToEncoding();
+    }
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct CaptureTests
+    : public CommonTextFixture
+{
+    // Properties
+
+    std::condition_variable eventsReceivedCondition;
+    std::mutex mutex;
+    std::vector< Discord::Gateway::Event > receivedEvents;
+
+    // Methods
+
+    bool AwaitEvents(size_t numEvents) {
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        return eventsReceivedCondition.wait_for(
+            lock,
+            std::chrono::milliseconds(1000),
+            [&]{ return receivedEvents.size() >= numEvents; }
+        );
+    }
+
+    /**
+     * Return a capture of a gateway session being greeted and then
+     * receiving a burst of guilds after it's ready.
+     */
+    Discord::Capture MakeReadyBurst(size_t numGuilds) {
+        Discord::Capture capture;
+        capture.metadata["source"] = "test";
+        capture.frames.push_back(
+            MakeFrame(
+                0.0, 0, Discord::Capture::FrameKind::Text,
+                Json::Object({
+                    {"op", 10},
+                    {"d", Json::Object({
+                        {"heartbeat_interval", heartbeatIntervalMilliseconds},
+                    })},
+                }).ToEncoding()
+            )
+        );
+        capture.frames.push_back(
+            MakeFrame(
+                0.01, 0, Discord::Capture::FrameKind::Text,
+                MakeDispatch("READY", 1, Json::Object({
+                    {"v", 6},
+                    {"session_id", "abc"},
+                }))
+            )
+        );
+        for (size_t i = 0; i < numGuilds; ++i) {
+            capture.frames.push_back(
+                MakeFrame(
+                    0.02 + 0.01 * (double)i, 0, Discord::Capture::FrameKind::Text,
+                    MakeDispatch("GUILD_CREATE", (int)i + 2, Json::Object({
+                        {"id", std::to_string(i + 100)},
+                        {"name", "Pepe's Pond"},
+                    }))
+                )
+            );
+        }
+        return capture;
+    }
+
+    // ::testing::Test
+
+    virtual void SetUp() override {
+        CommonTextFixture::SetUp();
+        gateway.RegisterEventCallback(
+            [this](Discord::Gateway::Event&& event){
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                receivedEvents.push_back(std::move(event));
+                eventsReceivedCondition.notify_all();
+            }
+        );
+    }
+};
+
+TEST_F(CaptureTests, Encoding_Round_Trip) {
+    // Arrange
+    Discord::Capture capture;
+    capture.metadata["recorded"] = "2020-05-05T12:34:56Z";
+    capture.metadata["connection.0.uri"] = "wss://gateway.discord.gg";
+    capture.frames.push_back(MakeFrame(0.0, 0, Discord::Capture::FrameKind::Text, "{\"op\":10}"));
+    capture.frames.push_back(MakeFrame(0.000001, 1, Discord::Capture::FrameKind::Binary, std::string("\0\x01\xff", 3)));
+    capture.frames.push_back(MakeFrame(3600.5, 0, Discord::Capture::FrameKind::Text, std::string(300, 'x')));
+    capture.frames.push_back(MakeFrame(3601.0, 1, Discord::Capture::FrameKind::Close, ""));
+
+    // Act
+    const auto encoding = capture.ToEncoding();
+    Discord::Capture decoded;
+    const auto decodedOk = decoded.FromEncoding(encoding);
+
+    // Assert
+    ASSERT_TRUE(decodedOk);
+    EXPECT_EQ(capture.metadata, decoded.metadata);
+    ASSERT_EQ(capture.frames.size(), decoded.frames.size());
+    for (size_t i = 0; i < capture.frames.size(); ++i) {
+        EXPECT_NEAR(capture.frames[i].time, decoded.frames[i].time, 0.0000005) << i;
+        EXPECT_EQ(capture.frames[i].connection, decoded.frames[i].connection) << i;
+        EXPECT_EQ(capture.frames[i].kind, decoded.frames[i].kind) << i;
+        EXPECT_EQ(capture.frames[i].data, decoded.frames[i].data) << i;
+    }
+}
+
+TEST_F(CaptureTests, Invalid_Encodings_Rejected) {
+    // Arrange
+    Discord::Capture capture;
+    capture.metadata["source"] = "test";
+    capture.frames.push_back(MakeFrame(1.0, 0, Discord::Capture::FrameKind::Text, "Hello, World!"));
+    const auto encoding = capture.ToEncoding();
+    auto badKind = encoding;
+    badKind[badKind.length() - 15] = 7;
+
+    // Act
+    Discord::Capture decoded;
+    const auto wrongMagicOk = decoded.FromEncoding("PCAP" + encoding.substr(4));
+    const auto truncatedOk = decoded.FromEncoding(encoding.substr(0, encoding.length() - 1));
+    const auto badKindOk = decoded.FromEncoding(badKind);
+
+    // Assert
+    EXPECT_FALSE(wrongMagicOk);
+    EXPECT_FALSE(truncatedOk);
+    EXPECT_FALSE(badKindOk);
+    EXPECT_TRUE(decoded.metadata.empty());
+    EXPECT_TRUE(decoded.frames.empty());
+}
+
+TEST_F(CaptureTests, Recording_Connections_Record_Frames_Received) {
+    // Arrange
+    Discord::RecordingConnections recorder(connections);
+    recorder.SetClock(clock);
+    recorder.SetMetadata("source", "test");
+    clock->currentTime = 10.0;
+    auto transaction = recorder.QueueWebSocketRequest({"wss://gateway.discord.gg"});
+    ASSERT_TRUE(connections->RequireWebSocketRequests(1));
+    connections->RespondToWebSocketRequest(0, webSocket);
+    ASSERT_EQ(
+        std::future_status::ready,
+        transaction.webSocket.wait_for(std::chrono::seconds(1))
+    );
+    const auto recordedWebSocket = transaction.webSocket.get();
+    ASSERT_FALSE(recordedWebSocket == nullptr);
+    std::vector< std::string > textsReceived;
+    bool closed = false;
+    recordedWebSocket->RegisterTextCallback(
+        [&](std::string&& message){
+            textsReceived.push_back(std::move(message));
+        }
+    );
+    recordedWebSocket->RegisterCloseCallback(
+        [&]{
+            closed = true;
+        }
+    );
+
+    // Act
+    clock->currentTime = 11.0;
+    webSocket->onText("Hello");
+    clock->currentTime = 11.25;
+    webSocket->onText("World");
+    recordedWebSocket->Text("Sent");
+    clock->currentTime = 12.0;
+    webSocket->RemoteClose();
+
+    // Assert
+    EXPECT_EQ(
+        std::vector< std::string >({"Hello", "World"}),
+        textsReceived
+    );
+    EXPECT_TRUE(closed);
+    EXPECT_EQ(std::vector< std::string >({"Sent"}), webSocket->textSent);
+    const auto capture = recorder.GetCapture();
+    EXPECT_EQ(
+        (std::map< std::string, std::string >{
+            {"connection.0.uri", "wss://gateway.discord.gg"},
+            {"source", "test"},
+        }),
+        capture.metadata
+    );
+    ASSERT_EQ(3, capture.frames.size());
+    EXPECT_EQ(0.0, capture.frames[0].time);
+    EXPECT_EQ(Discord::Capture::FrameKind::Text, capture.frames[0].kind);
+    EXPECT_EQ("Hello", capture.frames[0].data);
+    EXPECT_EQ(0.25, capture.frames[1].time);
+    EXPECT_EQ("World", capture.frames[1].data);
+    EXPECT_EQ(1.0, capture.frames[2].time);
+    EXPECT_EQ(Discord::Capture::FrameKind::Close, capture.frames[2].kind);
+    for (const auto& frame: capture.frames) {
+        EXPECT_EQ(0, frame.connection);
+    }
+}
+
+TEST_F(CaptureTests, Ready_Burst_Replayed_Into_Gateway) {
+    // Arrange
+    Discord::Capture capture;
+    ASSERT_TRUE(capture.FromEncoding(MakeReadyBurst(5).ToEncoding()));
+    ASSERT_TRUE(ConnectWebSocket(configuration));
+
+    // Act
+    const auto numFramesReplayed = Replay(capture, 0, *webSocket, false);
+
+    // Assert
+    EXPECT_EQ(7, numFramesReplayed);
+    ASSERT_TRUE(AwaitEvents(6));
+    EXPECT_EQ("READY", receivedEvents[0].name);
+    for (size_t i = 1; i < 6; ++i) {
+        EXPECT_EQ("GUILD_CREATE", receivedEvents[i].name);
+        EXPECT_EQ((int)i + 1, receivedEvents[i].sequenceNumber);
+    }
+    EXPECT_EQ(
+        std::future_status::ready,
+        connected.wait_for(std::chrono::seconds(1))
+    );
+}
+
+TEST_F(CaptureTests, Replay_At_Recorded_Speed_Keeps_Frames_Apart) {
+    // Arrange
+    auto capture = MakeReadyBurst(1);
+    capture.frames[1].time = 0.05;
+    capture.frames[2].time = 0.1;
+    ASSERT_TRUE(ConnectWebSocket(configuration));
+
+    // Act
+    const auto start = std::chrono::steady_clock::now();
+    (void)Replay(capture, 0, *webSocket, true);
+    const auto elapsed = std::chrono::duration< double >(
+        std::chrono::steady_clock::now() - start
+    ).count();
+
+    // Assert
+    ASSERT_TRUE(AwaitEvents(2));
+    EXPECT_GE(elapsed, 0.1);
+}
@@ -12,6 +12,7 @@
 #include <chrono>
 #include <gtest/gtest.h>
 #include <memory>
+#include <string>
 #include <unordered_map>
 
 bool MockWebSocket::AwaitTexts(size_t numTexts) {
@@ -103,18 +104,36 @@ bool MockConnections::RequireWebSocketRequests(size_t numRequests) {
     return ExpectSoon(webSocketRequestsWait.haveRequiredRequests, lock);
 }
 
+void MockConnections::Respond(
+    ResourceRequestWithPromise& request,
+    Response&& response,
+    std::unique_lock< decltype(mutex) >& lock
+) {
+    request.responded = true;
+    if (request.onResponse == nullptr) {
+        request.responsePromise.set_value(std::move(response));
+        return;
+    }
+    const auto onResponse = std::move(request.onResponse);
+    request.onResponse = nullptr;
+    lock.unlock();
+    onResponse(std::move(response));
+}
+
 void MockConnections::RespondToResourceRequest(
     size_t requestIndex,
     Response&& response
 ) {
-    resourceRequests[requestIndex]->responsePromise.set_value(std::move(response));
-    resourceRequests[requestIndex]->responded = true;
+    std::unique_lock< decltype(mutex) > lock(mutex);
+    const auto request = resourceRequests[requestIndex];
+    Respond(*request, std::move(response), lock);
 }
 
 void MockConnections::RespondToWebSocketRequest(
     size_t requestIndex,
     std::shared_ptr< MockWebSocket > webSocket
 ) {
+    std::lock_guard< decltype(mutex) > lock(mutex);
     if (webSocket != nullptr) {
         webSocket->onTextRegistered = std::promise< void >();
     }
@@ -123,16 +142,21 @@ void MockConnections::RespondToWebSocketRequest(
 }
 
 void MockConnections::TearDown() {
-    std::lock_guard< decltype(mutex) > lock(mutex);
+    std::unique_lock< decltype(mutex) > lock(mutex);
     tornDown = true;
-    for (auto& request: resourceRequests) {
+    for (size_t i = 0; i < resourceRequests.size(); ++i) {
+        const auto request = resourceRequests[i];
         if (!request->responded) {
-            request->responsePromise.set_value({500});
+            Respond(*request, {500}, lock);
+            if (!lock.owns_lock()) {
+                lock.lock();
+            }
         }
     }
     for (auto& request: webSocketRequests) {
         if (!request->responded) {
             request->webSocketPromise.set_value(nullptr);
+            request->responded = true;
         }
     }
 }
@@ -149,7 +173,11 @@ auto MockConnections::QueueResourceRequest(
         requestWithPromise->responsePromise.set_value({500});
         transaction.cancel = []{};
     } else {
-        transaction.cancel = [requestWithPromise]{
+        transaction.cancel = [this, requestWithPromise]{
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            if (requestWithPromise->responded) {
+                return;
+            }
             requestWithPromise->responsePromise.set_value({499});
             requestWithPromise->responded = true;
             requestWithPromise->canceled.set_value();
@@ -165,6 +193,36 @@ auto MockConnections::QueueResourceRequest(
     return transaction;
 }
 
+auto MockConnections::QueueResourceRequest(
+    ResourceRequest&& request,
+    ResponseDelegate&& onResponse
+) -> CancelDelegate {
+    std::unique_lock< decltype(mutex) > lock(mutex);
+    auto requestWithPromise = std::make_shared< ResourceRequestWithPromise >();
+    requestWithPromise->request = std::move(request);
+    requestWithPromise->onResponse = std::move(onResponse);
+    if (tornDown) {
+        Respond(*requestWithPromise, {500}, lock);
+        return []{};
+    }
+    CancelDelegate cancel = [this, requestWithPromise]{
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        if (requestWithPromise->responded) {
+            return;
+        }
+        requestWithPromise->canceled.set_value();
+        Respond(*requestWithPromise, {499}, lock);
+    };
+    resourceRequests.push_back(std::move(requestWithPromise));
+    if (
+        (resourceRequestsWait.numRequests > 0)
+        && (resourceRequests.size() == resourceRequestsWait.numRequests)
+    ) {
+        resourceRequestsWait.haveRequiredRequests.set_value();
+    }
+    return cancel;
+}
+
 auto MockConnections::QueueWebSocketRequest(
     const WebSocketRequest& request
 ) -> WebSocketRequestTransaction{
@@ -177,7 +235,11 @@ auto MockConnections::QueueWebSocketRequest(
         requestWithPromise->webSocketPromise.set_value(nullptr);
         transaction.cancel = []{};
     } else {
-        transaction.cancel = [requestWithPromise]{
+        transaction.cancel = [this, requestWithPromise]{
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            if (requestWithPromise->responded) {
+                return;
+            }
             requestWithPromise->webSocketPromise.set_value(nullptr);
             requestWithPromise->responded = true;
             requestWithPromise->canceled.set_value();
@@ -197,6 +259,12 @@ double MockClock::GetCurrentTime() {
     return currentTime;
 }
 
+double SteadyClock::GetCurrentTime() {
+    return std::chrono::duration< double >(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
 bool CommonTextFixture::Connect(
     const Discord::Gateway::Configuration& configuration,
     const std::string webSocketEndpoint
@@ -205,6 +273,7 @@ bool CommonTextFixture::Connect(
         return false;
     }
     SendHello();
+    EXPECT_TRUE(webSocket->AwaitTexts(2));
     EXPECT_EQ(
         std::vector< std::string >({
             Json::Object({
@@ -225,7 +294,14 @@ bool CommonTextFixture::Connect(
         }),
         webSocket->textSent
     );
-    return true;
+    const auto connectedReady = (
+        connected.wait_for(
+            std::chrono::milliseconds(100)
+        )
+        == std::future_status::ready
+    );
+    EXPECT_TRUE(connectedReady);
+    return connectedReady;
 }
 
 bool CommonTextFixture::ConnectExpectingWebSocketEndpointRequestWithResponse(
@@ -305,6 +381,22 @@ void CommonTextFixture::ExpectHeaders(
     );
 }
 
+void CommonTextFixture::SendDispatch(
+    const std::string& eventName,
+    int sequenceNumber,
+    const Json::Value& data
+) {
+    // Build the message by hand, in order to put the event name before the
+    // payload, the way Discord does.
+    webSocket->onText(
+        "{\"t\":" + Json::Value(eventName).ToEncoding()
+        + ",\"s\":" + std::to_string(sequenceNumber)
+        + ",\"op\":0"
+        + ",\"d\":" + data.ToEncoding()
+        + "}"
+    );
+}
+
 void CommonTextFixture::SendHello() {
     webSocket->onText(
         Json::Object({
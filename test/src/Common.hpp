@@ -70,6 +70,7 @@ struct MockConnections
     struct ResourceRequestWithPromise {
         ResourceRequest request;
         std::promise< Response > responsePromise;
+        ResponseDelegate onResponse;
         std::promise< void > canceled;
         bool responded = false;
     };
@@ -103,6 +104,11 @@ struct MockConnections
     );
     bool RequireResourceRequests(size_t numRequests);
     bool RequireWebSocketRequests(size_t numRequests);
+    void Respond(
+        ResourceRequestWithPromise& request,
+        Response&& response,
+        std::unique_lock< decltype(mutex) >& lock
+    );
     void RespondToResourceRequest(
         size_t requestIndex,
         Response&& response
@@ -118,6 +124,10 @@ struct MockConnections
     virtual ResourceRequestTransaction QueueResourceRequest(
         const ResourceRequest& request
     ) override;
+    virtual CancelDelegate QueueResourceRequest(
+        ResourceRequest&& request,
+        ResponseDelegate&& onResponse
+    ) override;
     virtual WebSocketRequestTransaction QueueWebSocketRequest(
         const WebSocketRequest& request
     ) override;
@@ -140,6 +150,18 @@ struct MockClock
     virtual double GetCurrentTime() override;
 };
 
+/**
+ * This is a real clock, telling the time since some fixed point, which is
+ * used to run gateways against servers on the loopback interface.
+ */
+struct SteadyClock
+    : public Timekeeping::Clock
+{
+    // Timekeeping::Clock
+
+    virtual double GetCurrentTime() override;
+};
+
 /**
  * This is the base class for test fixtures used to test the Discord library.
  */
@@ -180,6 +202,11 @@ struct CommonTextFixture
         const std::vector< Discord::Connections::Header >& expected,
         const std::vector< Discord::Connections::Header >& actual
     );
+    void SendDispatch(
+        const std::string& eventName,
+        int sequenceNumber,
+        const Json::Value& data
+    );
     void SendHello();
     void SendHeartbeatAck();
 
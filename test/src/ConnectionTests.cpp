@@ -9,9 +9,13 @@
 
 #include "Common.hpp"
 
+#include <algorithm>
 #include <future>
 #include <gtest/gtest.h>
 #include <Json/Value.hpp>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -223,6 +227,110 @@ TEST_F(ConnectionTests, Connect_Completes_Successfully_Once_Session_Established)
     EXPECT_TRUE(connected);
 }
 
+TEST_F(ConnectionTests, Identify_Sends_Intents_Threshold_And_Subscriptions_If_Configured) {
+    // Arrange
+    configuration.subscribedEvents = {"MESSAGE_CREATE", "GUILD_MEMBER_ADD"};
+    configuration.intents = Discord::Gateway::Intent::GuildVoiceStates;
+    configuration.largeThreshold = 100;
+    configuration.guildSubscriptions = false;
+    ASSERT_TRUE(ConnectWebSocket(configuration));
+
+    // Act
+    SendHello();
+
+    // Assert
+    ASSERT_TRUE(webSocket->AwaitTexts(2));
+    const auto identify = Json::Value::FromEncoding(webSocket->textSent[1]);
+    EXPECT_EQ(2, (int)identify["op"]);
+    EXPECT_EQ(
+        (int)(
+            Discord::Gateway::Intent::Guilds
+            | Discord::Gateway::Intent::GuildMembers
+            | Discord::Gateway::Intent::GuildVoiceStates
+            | Discord::Gateway::Intent::GuildMessages
+            | Discord::Gateway::Intent::DirectMessages
+        ),
+        (int)identify["d"]["intents"]
+    );
+    EXPECT_EQ(100, (int)identify["d"]["large_threshold"]);
+    EXPECT_EQ(Json::Value(false), identify["d"]["guild_subscriptions"]);
+}
+
+TEST_F(ConnectionTests, Identify_Sends_Large_Threshold_Within_Range) {
+    // Arrange
+    configuration.largeThreshold = 1000;
+
+    // The gateway outlives this test's body, and may still publish
+    // diagnostic messages while it's being torn down.
+    struct Diagnostics {
+        std::mutex mutex;
+        std::vector< std::string > messages;
+    };
+    const auto diagnostics = std::make_shared< Diagnostics >();
+    gateway.RegisterDiagnosticMessageCallback(
+        [diagnostics](
+            size_t level,
+            std::string&& message
+        ){
+            std::lock_guard< decltype(diagnostics->mutex) > lock(diagnostics->mutex);
+            diagnostics->messages.push_back(std::move(message));
+        }
+    );
+    ASSERT_TRUE(ConnectWebSocket(configuration));
+
+    // Act
+    SendHello();
+
+    // Assert
+    ASSERT_TRUE(webSocket->AwaitTexts(2));
+    const auto identify = Json::Value::FromEncoding(webSocket->textSent[1]);
+    EXPECT_EQ(250, (int)identify["d"]["large_threshold"]);
+    std::lock_guard< decltype(diagnostics->mutex) > lock(diagnostics->mutex);
+    EXPECT_NE(
+        diagnostics->messages.end(),
+        std::find(
+            diagnostics->messages.begin(),
+            diagnostics->messages.end(),
+            "Large threshold 1000 is out of range; sending 250 instead"
+        )
+    );
+}
+
+TEST_F(ConnectionTests, Intents_For_Events) {
+    // Arrange
+    using Intent = Discord::Gateway::Intent;
+
+    // Act
+    const auto noEvents = Discord::Gateway::GetIntentsForEvents({});
+    const auto eventsWithoutIntents = Discord::Gateway::GetIntentsForEvents({"READY", "USER_UPDATE"});
+    const auto guildEvents = Discord::Gateway::GetIntentsForEvents({"GUILD_CREATE", "CHANNEL_UPDATE"});
+    const auto messageEvents = Discord::Gateway::GetIntentsForEvents({
+        "MESSAGE_DELETE_BULK",
+        "MESSAGE_REACTION_ADD",
+        "TYPING_START",
+        "PRESENCE_UPDATE",
+    });
+    const auto unknownEvents = Discord::Gateway::GetIntentsForEvents({"ALL_NEW", "PRESENCE_UPDATE"});
+
+    // Assert
+    EXPECT_EQ(Intent::Guilds, noEvents);
+    EXPECT_EQ(Intent::Guilds, eventsWithoutIntents);
+    EXPECT_EQ(Intent::Guilds, guildEvents);
+    EXPECT_EQ(
+        (
+            Intent::Guilds
+            | Intent::GuildMessages
+            | Intent::GuildMessageReactions
+            | Intent::DirectMessageReactions
+            | Intent::GuildMessageTyping
+            | Intent::DirectMessageTyping
+            | Intent::GuildPresences
+        ),
+        messageEvents
+    );
+    EXPECT_EQ((uint32_t)0x7FFF & ~(uint32_t)Intent::GuildMembers, unknownEvents);
+}
+
 TEST_F(ConnectionTests, Connect_Already_Connected) {
     // Arrange
     ASSERT_TRUE(Connect(configuration));
@@ -351,6 +459,13 @@ TEST_F(ConnectionTests, Second_Connect_Succeeds_After_Session_Established_When_F
     });
     ASSERT_TRUE(connections->RequireWebSocketRequests(3));
     connections->RespondToWebSocketRequest(2, webSocket);
+    ASSERT_EQ(
+        std::future_status::ready,
+        webSocket->onTextRegistered.get_future().wait_for(
+            std::chrono::milliseconds(100)
+        )
+    );
+    SendHello();
     const auto connectedReady = (
         connected.wait_for(
             std::chrono::milliseconds(100)
@@ -394,6 +509,104 @@ TEST_F(ConnectionTests, Second_Connect_Fails_After_Failed_Second_WebSocket_Attem
     EXPECT_FALSE(connected.get());
 }
 
+TEST_F(ConnectionTests, Hedged_Connect_Does_Not_Request_WebSocket_Endpoint_When_Cached_WebSocket_Opens_In_Time) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    gateway.Disconnect();
+    configuration.hedgedConnectDelay = 1.0;
+    connected = gateway.Connect(connections, configuration);
+
+    // Act
+    ASSERT_TRUE(connections->RequireWebSocketRequests(2));
+    connections->RespondToWebSocketRequest(1, webSocket);
+    ASSERT_EQ(
+        std::future_status::ready,
+        webSocket->onTextRegistered.get_future().wait_for(
+            std::chrono::milliseconds(100)
+        )
+    );
+    SendHello();
+    const auto connectedReady = (
+        connected.wait_for(
+            std::chrono::milliseconds(100)
+        )
+        == std::future_status::ready
+    );
+
+    // Assert
+    ASSERT_TRUE(connectedReady);
+    EXPECT_TRUE(connected.get());
+    EXPECT_EQ(1, connections->resourceRequests.size());
+}
+
+TEST_F(ConnectionTests, Hedged_Connect_Requests_WebSocket_Endpoint_When_Cached_WebSocket_Slow_To_Open) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    gateway.Disconnect();
+    configuration.hedgedConnectDelay = 0.01;
+
+    // Act
+    connected = gateway.Connect(connections, configuration);
+
+    // Assert
+    ASSERT_TRUE(connections->RequireWebSocketRequests(2));
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    auto& requestWithPromise = *connections->resourceRequests[1];
+    EXPECT_EQ("GET", requestWithPromise.request.method);
+    EXPECT_EQ(
+        "https://discordapp.com/api/v6/gateway",
+        requestWithPromise.request.uri
+    );
+}
+
+TEST_F(ConnectionTests, Hedged_Connect_Uses_Fresh_WebSocket_And_Cancels_Cached_WebSocket_When_Fresh_Opens_First) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    gateway.Disconnect();
+    configuration.hedgedConnectDelay = 0.01;
+    connected = gateway.Connect(connections, configuration);
+    ASSERT_TRUE(connections->RequireWebSocketRequests(2));
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    auto cachedWebSocketCanceled = connections->webSocketRequests[1]->canceled.get_future();
+
+    // Act
+    connections->RespondToResourceRequest(1, {
+        200,
+        {},
+        Json::Object({
+            {"url", "wss://gateway2.discord.gg"},
+        }).ToEncoding(),
+    });
+    ASSERT_TRUE(connections->RequireWebSocketRequests(3));
+    webSocket = std::make_shared< MockWebSocket >();
+    connections->RespondToWebSocketRequest(2, webSocket);
+    ASSERT_EQ(
+        std::future_status::ready,
+        webSocket->onTextRegistered.get_future().wait_for(
+            std::chrono::milliseconds(100)
+        )
+    );
+    SendHello();
+    const auto connectedReady = (
+        connected.wait_for(
+            std::chrono::milliseconds(100)
+        )
+        == std::future_status::ready
+    );
+
+    // Assert
+    EXPECT_EQ(
+        "wss://gateway2.discord.gg/?v=6&encoding=json",
+        connections->webSocketRequests[2]->request.uri
+    );
+    EXPECT_EQ(
+        std::future_status::ready,
+        cachedWebSocketCanceled.wait_for(std::chrono::milliseconds(0))
+    );
+    ASSERT_TRUE(connectedReady);
+    EXPECT_TRUE(connected.get());
+}
+
 TEST_F(ConnectionTests, Close_Callback_When_WebSocket_Closed_After_Callback_Registered) {
     // Arrange
     ASSERT_TRUE(Connect(configuration));
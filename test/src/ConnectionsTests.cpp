@@ -0,0 +1,129 @@
+/**
+ * @file ConnectionsTests.cpp
+ *
+ * This module contains the unit tests of the default methods of the
+ * Discord::Connections interface.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <chrono>
+#include <Discord/Connections.hpp>
+#include <future>
+#include <gtest/gtest.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is a transport which only has the future forms of making
+     * requests, leaving the test to give the responses.
+     */
+    struct FutureConnections
+        : public Discord::Connections
+    {
+        // Properties
+
+        std::mutex mutex;
+        std::vector< std::unique_ptr< std::promise< Response > > > responses;
+
+        // Discord::Connections
+
+        virtual ResourceRequestTransaction QueueResourceRequest(
+            const ResourceRequest& /* request */
+        ) override {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            responses.emplace_back(new std::promise< Response >());
+            ResourceRequestTransaction transaction;
+            transaction.response = responses.back()->get_future();
+            transaction.cancel = []{};
+            return transaction;
+        }
+
+        virtual WebSocketRequestTransaction QueueWebSocketRequest(
+            const WebSocketRequest& /* request */
+        ) override {
+            return WebSocketRequestTransaction();
+        }
+    };
+
+    bool IsReady(std::future< Discord::Connections::Response >& response) {
+        return (
+            response.wait_for(std::chrono::milliseconds(1000))
+            == std::future_status::ready
+        );
+    }
+
+    /**
+     * Make a request through the delegate form, returning a future
+     * which receives whatever the delegate is given.
+     */
+    std::future< Discord::Connections::Response > Queue(
+        Discord::Connections& connections
+    ) {
+        const auto handled = std::make_shared< std::promise< Discord::Connections::Response > >();
+        auto handledFuture = handled->get_future();
+        (void)connections.QueueResourceRequest(
+            {"GET", "http://example.com/"},
+            [handled](Discord::Connections::Response&& response){
+                handled->set_value(std::move(response));
+            }
+        );
+        return handledFuture;
+    }
+
+}
+
+TEST(ConnectionsTests, Delegate_Called_With_Response_Once_It_Arrives) {
+    // Arrange
+    FutureConnections connections;
+    auto handled = Queue(connections);
+    EXPECT_EQ(
+        std::future_status::timeout,
+        handled.wait_for(std::chrono::milliseconds(10))
+    );
+
+    // Act
+    connections.responses[0]->set_value({200, {}, "Hello!"});
+
+    // Assert
+    ASSERT_TRUE(IsReady(handled));
+    const auto handledResponse = handled.get();
+    EXPECT_EQ(200, handledResponse.status);
+    EXPECT_EQ("Hello!", handledResponse.body);
+}
+
+TEST(ConnectionsTests, Slow_Response_Does_Not_Hold_Up_Others) {
+    // Arrange
+    FutureConnections connections;
+    auto slowHandled = Queue(connections);
+    auto fastHandled = Queue(connections);
+
+    // Act
+    connections.responses[1]->set_value({204, {}, ""});
+
+    // Assert
+    ASSERT_TRUE(IsReady(fastHandled));
+    EXPECT_EQ(204, fastHandled.get().status);
+    EXPECT_EQ(
+        std::future_status::timeout,
+        slowHandled.wait_for(std::chrono::milliseconds(10))
+    );
+    connections.responses[0]->set_value({200, {}, ""});
+    ASSERT_TRUE(IsReady(slowHandled));
+}
+
+TEST(ConnectionsTests, Abandoned_Response_Handled_As_Client_Closed_Request) {
+    // Arrange
+    FutureConnections connections;
+    auto handled = Queue(connections);
+
+    // Act
+    connections.responses[0].reset();
+
+    // Assert
+    ASSERT_TRUE(IsReady(handled));
+    EXPECT_EQ(499, handled.get().status);
+}
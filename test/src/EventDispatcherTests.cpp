@@ -0,0 +1,233 @@
+/**
+ * @file EventDispatcherTests.cpp
+ *
+ * This module contains unit tests of the Discord::EventDispatcher class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <Discord/EventDispatcher.hpp>
+#include <Discord/WorkerPool.hpp>
+#include <future>
+#include <gtest/gtest.h>
+#include <Json/Value.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct EventDispatcherTests
+    : public ::testing::Test
+{
+    // Properties
+
+    std::condition_variable eventsHandledCondition;
+    std::mutex mutex;
+    std::vector< Discord::Gateway::Event > eventsHandled;
+    std::shared_ptr< Discord::WorkerPool > workerPool = std::make_shared< Discord::WorkerPool >(4);
+    Discord::EventDispatcher dispatcher{workerPool};
+
+    // Methods
+
+    bool AwaitEvents(size_t numEvents) {
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        return eventsHandledCondition.wait_for(
+            lock,
+            std::chrono::milliseconds(1000),
+            [&]{ return eventsHandled.size() >= numEvents; }
+        );
+    }
+
+    static Discord::Gateway::Event MakeEvent(
+        const std::string& name,
+        int sequenceNumber,
+        Json::Value&& data
+    ) {
+        Discord::Gateway::Event event;
+        event.name = name;
+        event.sequenceNumber = sequenceNumber;
+        event.data = std::move(data);
+        return event;
+    }
+
+    void RecordEvent(Discord::Gateway::Event&& event) {
+        std::lock_guard< decltype(mutex) > lock(mutex);
+        eventsHandled.push_back(std::move(event));
+        eventsHandledCondition.notify_all();
+    }
+};
+
+TEST_F(EventDispatcherTests, Partition_Of_Guild_Event) {
+    EXPECT_EQ(
+        "guild:42",
+        Discord::EventDispatcher::GetPartition(
+            MakeEvent(
+                "MESSAGE_CREATE",
+                1,
+                Json::Object({
+                    {"guild_id", "42"},
+                    {"channel_id", "100"},
+                })
+            )
+        )
+    );
+    EXPECT_EQ(
+        "guild:42",
+        Discord::EventDispatcher::GetPartition(
+            MakeEvent(
+                "GUILD_CREATE",
+                1,
+                Json::Object({
+                    {"id", "42"},
+                })
+            )
+        )
+    );
+}
+
+TEST_F(EventDispatcherTests, Partition_Of_Direct_Message_Event) {
+    EXPECT_EQ(
+        "channel:100",
+        Discord::EventDispatcher::GetPartition(
+            MakeEvent(
+                "MESSAGE_CREATE",
+                1,
+                Json::Object({
+                    {"channel_id", "100"},
+                })
+            )
+        )
+    );
+    EXPECT_EQ(
+        "channel:100",
+        Discord::EventDispatcher::GetPartition(
+            MakeEvent(
+                "CHANNEL_CREATE",
+                1,
+                Json::Object({
+                    {"id", "100"},
+                    {"type", 1},
+                })
+            )
+        )
+    );
+}
+
+TEST_F(EventDispatcherTests, Partition_Of_Event_Without_Guild_Or_Channel) {
+    EXPECT_EQ(
+        "",
+        Discord::EventDispatcher::GetPartition(
+            MakeEvent(
+                "READY",
+                1,
+                Json::Object({
+                    {"v", 6},
+                })
+            )
+        )
+    );
+    EXPECT_EQ(
+        "",
+        Discord::EventDispatcher::GetPartition(
+            MakeEvent("RESUMED", 1, nullptr)
+        )
+    );
+}
+
+TEST_F(EventDispatcherTests, Events_Of_Same_Guild_Handled_In_Order) {
+    // Arrange
+    dispatcher.RegisterEventCallback(
+        [this](Discord::Gateway::Event&& event){
+            // Give other workers a chance to get ahead, if they can.
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            RecordEvent(std::move(event));
+        }
+    );
+
+    // Act
+    for (int i = 1; i <= 20; ++i) {
+        dispatcher.Dispatch(
+            MakeEvent(
+                "MESSAGE_CREATE",
+                i,
+                Json::Object({
+                    {"guild_id", (i % 2 == 0) ? "42" : "43"},
+                })
+            )
+        );
+    }
+
+    // Assert
+    ASSERT_TRUE(AwaitEvents(20));
+    std::map< std::string, std::vector< int > > sequenceNumbersByGuild;
+    for (const auto& event: eventsHandled) {
+        sequenceNumbersByGuild[event.data["guild_id"]].push_back(event.sequenceNumber);
+    }
+    EXPECT_EQ(
+        std::vector< int >({2, 4, 6, 8, 10, 12, 14, 16, 18, 20}),
+        sequenceNumbersByGuild["42"]
+    );
+    EXPECT_EQ(
+        std::vector< int >({1, 3, 5, 7, 9, 11, 13, 15, 17, 19}),
+        sequenceNumbersByGuild["43"]
+    );
+}
+
+TEST_F(EventDispatcherTests, Events_Of_Other_Guilds_Not_Held_Up_By_Slow_Handler) {
+    // Arrange
+    std::promise< void > releaseSlowHandler;
+    auto slowHandlerReleased = releaseSlowHandler.get_future().share();
+    dispatcher.RegisterEventCallback(
+        [this, slowHandlerReleased](Discord::Gateway::Event&& event){
+            if (event.data["guild_id"] == "42") {
+                (void)slowHandlerReleased.wait_for(std::chrono::milliseconds(1000));
+            }
+            RecordEvent(std::move(event));
+        }
+    );
+
+    // Act
+    dispatcher.Dispatch(
+        MakeEvent(
+            "MESSAGE_CREATE",
+            1,
+            Json::Object({
+                {"guild_id", "42"},
+            })
+        )
+    );
+    dispatcher.Dispatch(
+        MakeEvent(
+            "MESSAGE_CREATE",
+            2,
+            Json::Object({
+                {"guild_id", "42"},
+            })
+        )
+    );
+    dispatcher.Dispatch(
+        MakeEvent(
+            "MESSAGE_CREATE",
+            3,
+            Json::Object({
+                {"guild_id", "43"},
+            })
+        )
+    );
+
+    // Assert
+    ASSERT_TRUE(AwaitEvents(1));
+    EXPECT_EQ(3, eventsHandled[0].sequenceNumber);
+    releaseSlowHandler.set_value();
+    ASSERT_TRUE(AwaitEvents(3));
+    EXPECT_EQ(1, eventsHandled[1].sequenceNumber);
+    EXPECT_EQ(2, eventsHandled[2].sequenceNumber);
+}
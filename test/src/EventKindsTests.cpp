@@ -0,0 +1,71 @@
+/**
+ * @file EventKindsTests.cpp
+ *
+ * This module contains the unit tests of the functions which
+ * look up the kinds of gateway events by name.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "../../src/EventKinds.hpp"
+
+#include <gtest/gtest.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+TEST(EventKindsTests, Known_Names_Round_Trip) {
+    for (size_t i = 0; i < Discord::NUM_KNOWN_EVENT_KINDS; ++i) {
+        // Arrange
+        const auto kind = (Discord::EventKind)i;
+
+        // Act
+        const std::string name = Discord::GetEventName(kind);
+
+        // Assert
+        EXPECT_FALSE(name.empty());
+        EXPECT_EQ(kind, Discord::GetEventKind(name)) << name;
+    }
+}
+
+TEST(EventKindsTests, Some_Known_Names) {
+    EXPECT_EQ(Discord::EventKind::Ready, Discord::GetEventKind("READY"));
+    EXPECT_EQ(Discord::EventKind::GuildCreate, Discord::GetEventKind("GUILD_CREATE"));
+    EXPECT_EQ(Discord::EventKind::GuildMembersChunk, Discord::GetEventKind("GUILD_MEMBERS_CHUNK"));
+    EXPECT_EQ(Discord::EventKind::MessageReactionRemoveEmoji, Discord::GetEventKind("MESSAGE_REACTION_REMOVE_EMOJI"));
+}
+
+TEST(EventKindsTests, Unknown_Names) {
+    // Arrange
+    std::vector< std::string > names{
+        "",
+        "FOO",
+        "ready",
+        "READY ",
+        "READ",
+        "GUILD_CREATED",
+        "GUILD_CREAT",
+        "APPLICATION_COMMAND_CREATE",
+        "MESSAGE_REACTION_REMOVE_EMOJI_AND_THEN_SOME_MORE",
+    };
+    names.push_back(std::string("READY\0", 6));
+
+    // Also try every known name with one character changed, since
+    // those hash to slots of known names some of the time.
+    for (size_t i = 0; i < Discord::NUM_KNOWN_EVENT_KINDS; ++i) {
+        const std::string name = Discord::GetEventName((Discord::EventKind)i);
+        for (size_t j = 0; j < name.length(); ++j) {
+            auto nearMiss = name;
+            nearMiss[j] = 'X';
+            if (nearMiss != name) {
+                names.push_back(nearMiss);
+            }
+        }
+    }
+
+    // Act & Assert
+    for (const auto& name: names) {
+        EXPECT_EQ(Discord::EventKind::Unknown, Discord::GetEventKind(name)) << name;
+    }
+    EXPECT_EQ(std::string(""), Discord::GetEventName(Discord::EventKind::Unknown));
+}
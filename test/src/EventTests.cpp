@@ -0,0 +1,236 @@
+/**
+ * @file EventTests.cpp
+ *
+ * This module contains unit tests of the Discord::Gateway class
+ * in decoding dispatch events and delivering them to subscribers.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <atomic>
+#include <Discord/Cache.hpp>
+#include <Discord/JsonDecoder.hpp>
+#include <Discord/SimdJsonDecoder.hpp>
+#include <Discord/WorkerPool.hpp>
+#include <gtest/gtest.h>
+#include <Json/Value.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is a JSON decoder which counts the texts it decodes before
+     * handing them to another decoder.
+     */
+    struct CountingJsonDecoder
+        : public Discord::JsonDecoder
+    {
+        // Properties
+
+        std::atomic< size_t > numDecoded{0};
+        Discord::SimdJsonDecoder decoder;
+
+        // Discord::JsonDecoder
+
+        virtual Json::Value Decode(const std::string& encoding) override {
+            ++numDecoded;
+            return decoder.Decode(encoding);
+        }
+    };
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct EventTests
+    : public CommonTextFixture
+{
+    // Types
+
+    struct ReceivedEvent {
+        Discord::Gateway::Event event;
+        std::thread::id threadId;
+    };
+
+    // Properties
+
+    std::shared_ptr< Discord::Cache > cache = std::make_shared< Discord::Cache >();
+    std::condition_variable eventsReceivedCondition;
+    std::mutex mutex;
+    std::vector< ReceivedEvent > receivedEvents;
+
+    // Methods
+
+    bool AwaitEvents(size_t numEvents) {
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        return eventsReceivedCondition.wait_for(
+            lock,
+            std::chrono::milliseconds(1000),
+            [&]{ return receivedEvents.size() >= numEvents; }
+        );
+    }
+
+    Json::Value MakeGuild(
+        const std::string& guildId,
+        size_t numMembers
+    ) {
+        auto members = Json::Array({});
+        for (size_t i = 0; i < numMembers; ++i) {
+            members.Add(
+                Json::Object({
+                    {"user", Json::Object({
+                        {"id", std::to_string(i + 1)},
+                        {"username", "Frog #" + std::to_string(i + 1)},
+                    })},
+                    {"roles", Json::Array({})},
+                })
+            );
+        }
+        return Json::Object({
+            {"id", guildId},
+            {"name", "Pepe's Pond"},
+            {"members", std::move(members)},
+        });
+    }
+
+    // ::testing::Test
+
+    virtual void SetUp() override {
+        CommonTextFixture::SetUp();
+        gateway.RegisterEventCallback(
+            [this](Discord::Gateway::Event&& event){
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                ReceivedEvent receivedEvent;
+                receivedEvent.event = std::move(event);
+                receivedEvent.threadId = std::this_thread::get_id();
+                receivedEvents.push_back(std::move(receivedEvent));
+                eventsReceivedCondition.notify_all();
+            }
+        );
+    }
+};
+
+TEST_F(EventTests, Dispatch_Event_Delivered_To_Event_Callback) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    const auto data = Json::Object({
+        {"channel_id", "100"},
+        {"content", "Hello, World!"},
+    });
+
+    // Act
+    SendDispatch("MESSAGE_CREATE", 7, data);
+
+    // Assert
+    ASSERT_TRUE(AwaitEvents(1));
+    EXPECT_EQ("MESSAGE_CREATE", receivedEvents[0].event.name);
+    EXPECT_EQ(7, receivedEvents[0].event.sequenceNumber);
+    EXPECT_EQ(data, receivedEvents[0].event.data);
+}
+
+TEST_F(EventTests, Streamed_Guild_Create_Event_Delivered_With_Entities_Left_In_Cache) {
+    // Arrange
+    gateway.SetCache(cache);
+    ASSERT_TRUE(Connect(configuration));
+
+    // Act
+    SendDispatch("GUILD_CREATE", 1, MakeGuild("42", 3));
+
+    // Assert
+    ASSERT_TRUE(AwaitEvents(1));
+    EXPECT_EQ("GUILD_CREATE", receivedEvents[0].event.name);
+    EXPECT_EQ(
+        Json::Object({
+            {"id", "42"},
+            {"name", "Pepe's Pond"},
+            {"members", Json::Array({})},
+        }),
+        receivedEvents[0].event.data
+    );
+    EXPECT_EQ(3, cache->GetEntityIds("42", Discord::Cache::EntityKind::Member).size());
+}
+
+TEST_F(EventTests, Heavy_Events_Decoded_On_Decode_Worker_Pool) {
+    // Arrange
+    gateway.SetCache(cache);
+    gateway.SetDecodeWorkerPool(std::make_shared< Discord::WorkerPool >(2));
+    ASSERT_TRUE(Connect(configuration));
+
+    // Act
+    SendDispatch("GUILD_CREATE", 1, MakeGuild("42", 3));
+
+    // Assert
+    ASSERT_TRUE(AwaitEvents(1));
+    EXPECT_NE(std::this_thread::get_id(), receivedEvents[0].threadId);
+    EXPECT_EQ(3, cache->GetEntityIds("42", Discord::Cache::EntityKind::Member).size());
+}
+
+TEST_F(EventTests, Events_Delivered_In_Order_Received_When_Decoded_On_Decode_Worker_Pool) {
+    // Arrange
+    gateway.SetCache(cache);
+    gateway.SetDecodeWorkerPool(std::make_shared< Discord::WorkerPool >(4));
+    ASSERT_TRUE(Connect(configuration));
+
+    // Act
+    SendDispatch("GUILD_CREATE", 1, MakeGuild("42", 5000));
+    SendDispatch("TYPING_START", 2, Json::Object({}));
+    SendDispatch("GUILD_CREATE", 3, MakeGuild("43", 1));
+    SendDispatch("GUILD_DELETE", 4, Json::Object({{"id", "43"}}));
+    SendDispatch("MESSAGE_CREATE", 5, Json::Object({}));
+
+    // Assert
+    ASSERT_TRUE(AwaitEvents(5));
+    std::vector< int > sequenceNumbers;
+    for (const auto& receivedEvent: receivedEvents) {
+        sequenceNumbers.push_back(receivedEvent.event.sequenceNumber);
+    }
+    EXPECT_EQ(
+        std::vector< int >({1, 2, 3, 4, 5}),
+        sequenceNumbers
+    );
+    EXPECT_EQ(
+        std::vector< std::string >({"42"}),
+        cache->GetGuildIds()
+    );
+}
+
+TEST_F(EventTests, Events_Decoded_Through_Json_Decoder_If_Set) {
+    // Arrange
+    const auto jsonDecoder = std::make_shared< CountingJsonDecoder >();
+    gateway.SetCache(cache);
+    gateway.SetJsonDecoder(jsonDecoder);
+    ASSERT_TRUE(Connect(configuration));
+    const auto numDecodedBefore = jsonDecoder->numDecoded.load();
+    const auto data = Json::Object({
+        {"channel_id", "100"},
+        {"content", "Hello, \"World\"! \xE2\x98\xBA"},
+    });
+
+    // Act
+    SendDispatch("MESSAGE_CREATE", 1, data);
+    SendDispatch("GUILD_CREATE", 2, MakeGuild("42", 3));
+
+    // Assert
+    ASSERT_TRUE(AwaitEvents(2));
+    EXPECT_EQ(2, jsonDecoder->numDecoded - numDecodedBefore);
+    EXPECT_EQ(data, receivedEvents[0].event.data);
+    EXPECT_EQ(
+        Json::Object({
+            {"id", "42"},
+            {"name", "Pepe's Pond"},
+            {"members", Json::Array({})},
+        }),
+        receivedEvents[1].event.data
+    );
+    EXPECT_EQ(3, cache->GetEntityIds("42", Discord::Cache::EntityKind::Member).size());
+}
@@ -0,0 +1,245 @@
+/**
+ * @file EventTracerTests.cpp
+ *
+ * This module contains unit tests of the Discord::EventTracer class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <Discord/EventDispatcher.hpp>
+#include <Discord/EventTracer.hpp>
+#include <Discord/WorkerPool.hpp>
+#include <gtest/gtest.h>
+#include <Json/Value.hpp>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+    using Stage = Discord::EventTracer::Stage;
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct EventTracerTests
+    : public CommonTextFixture
+{
+    // Properties
+
+    std::shared_ptr< Discord::EventTracer > tracer = std::make_shared< Discord::EventTracer >();
+    std::condition_variable eventsReceivedCondition;
+    std::mutex mutex;
+    std::vector< Discord::Gateway::Event > receivedEvents;
+
+    // Methods
+
+    bool AwaitEvents(size_t numEvents) {
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        return eventsReceivedCondition.wait_for(
+            lock,
+            std::chrono::milliseconds(1000),
+            [&]{ return receivedEvents.size() >= numEvents; }
+        );
+    }
+
+    bool AwaitTracesFinished(size_t numTraces) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while (tracer->GetTotalHistogram().count < numTraces) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    void RecordEvent(Discord::Gateway::Event&& event) {
+        std::lock_guard< decltype(mutex) > lock(mutex);
+        receivedEvents.push_back(std::move(event));
+        eventsReceivedCondition.notify_all();
+    }
+};
+
+TEST_F(EventTracerTests, Gateway_Stamps_Stages_Of_Event_In_Order) {
+    // Arrange
+    gateway.RegisterEventCallback(
+        [this](Discord::Gateway::Event&& event){
+            RecordEvent(std::move(event));
+        }
+    );
+    ASSERT_TRUE(Connect(configuration));
+    gateway.SetEventTracer(tracer);
+
+    // Act
+    SendDispatch("MESSAGE_CREATE", 7, Json::Object({}));
+
+    // Assert
+    ASSERT_TRUE(AwaitEvents(1));
+    ASSERT_TRUE(AwaitTracesFinished(1));
+    const auto& trace = receivedEvents[0].trace;
+    ASSERT_FALSE(trace == nullptr);
+    EXPECT_EQ("MESSAGE_CREATE", trace->eventName);
+    EXPECT_EQ(7, trace->sequenceNumber);
+    double lastSeconds = 0.0;
+    for (auto stage: {Stage::Received, Stage::Locked, Stage::Decoded, Stage::Applied, Stage::Handled}) {
+        EXPECT_TRUE(trace->IsStamped(stage)) << Discord::EventTracer::GetStageName(stage);
+        const auto seconds = trace->GetSecondsSinceReceived(stage);
+        EXPECT_GE(seconds, lastSeconds) << Discord::EventTracer::GetStageName(stage);
+        lastSeconds = seconds;
+    }
+    EXPECT_FALSE(trace->IsStamped(Stage::Queued));
+    EXPECT_FALSE(trace->IsStamped(Stage::Started));
+    for (auto stage: {Stage::Locked, Stage::Decoded, Stage::Applied, Stage::Handled}) {
+        EXPECT_EQ(1, tracer->GetHistogram(stage).count) << Discord::EventTracer::GetStageName(stage);
+    }
+    EXPECT_EQ(0, tracer->GetHistogram(Stage::Queued).count);
+    EXPECT_EQ(0, tracer->GetHistogram(Stage::Started).count);
+    EXPECT_EQ(1, tracer->GetTotalHistogram().count);
+}
+
+TEST_F(EventTracerTests, Frames_Which_Are_Not_Events_Not_Counted) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    gateway.SetEventTracer(tracer);
+
+    // Act
+    SendHeartbeatAck();
+
+    // Assert
+    EXPECT_EQ(0, tracer->GetTotalHistogram().count);
+}
+
+TEST_F(EventTracerTests, Event_Dispatcher_Stamps_Queued_Started_And_Handled) {
+    // Arrange
+    Discord::EventDispatcher dispatcher(std::make_shared< Discord::WorkerPool >(2));
+    dispatcher.RegisterEventCallback(
+        [this](Discord::Gateway::Event&& event){
+            RecordEvent(std::move(event));
+        }
+    );
+    gateway.RegisterEventCallback(
+        [&dispatcher](Discord::Gateway::Event&& event){
+            dispatcher.Dispatch(std::move(event));
+        }
+    );
+    ASSERT_TRUE(Connect(configuration));
+    gateway.SetEventTracer(tracer);
+
+    // Act
+    SendDispatch("MESSAGE_CREATE", 1, Json::Object({{"guild_id", "42"}}));
+
+    // Assert
+    ASSERT_TRUE(AwaitEvents(1));
+    ASSERT_TRUE(AwaitTracesFinished(1));
+    const auto& trace = receivedEvents[0].trace;
+    ASSERT_FALSE(trace == nullptr);
+    double lastSeconds = 0.0;
+    for (size_t stage = 0; stage < (size_t)Stage::NumStages; ++stage) {
+        EXPECT_TRUE(trace->IsStamped((Stage)stage)) << Discord::EventTracer::GetStageName((Stage)stage);
+        const auto seconds = trace->GetSecondsSinceReceived((Stage)stage);
+        EXPECT_GE(seconds, lastSeconds) << Discord::EventTracer::GetStageName((Stage)stage);
+        lastSeconds = seconds;
+    }
+    EXPECT_EQ(1, tracer->GetHistogram(Stage::Queued).count);
+    EXPECT_EQ(1, tracer->GetHistogram(Stage::Started).count);
+    EXPECT_EQ(1, tracer->GetHistogram(Stage::Handled).count);
+}
+
+TEST_F(EventTracerTests, Sampling_Keeps_One_Trace_Out_Of_Every_Interval) {
+    // Arrange
+    tracer->SetSampling(2);
+
+    // Act
+    for (size_t i = 0; i < 5; ++i) {
+        const auto trace = tracer->StartTrace();
+        trace->eventName = "MESSAGE_CREATE";
+        trace->sequenceNumber = (int)i + 1;
+        trace->Stamp(Stage::Handled);
+    }
+    const auto sampledTraces = tracer->TakeSampledTraces();
+
+    // Assert
+    ASSERT_EQ(2, sampledTraces.size());
+    EXPECT_EQ(2, sampledTraces[0].id);
+    EXPECT_EQ(2, sampledTraces[0].sequenceNumber);
+    EXPECT_EQ("MESSAGE_CREATE", sampledTraces[0].eventName);
+    EXPECT_EQ(0.0, sampledTraces[0].secondsSinceReceived[(size_t)Stage::Received]);
+    EXPECT_GE(sampledTraces[0].secondsSinceReceived[(size_t)Stage::Handled], 0.0);
+    EXPECT_LT(sampledTraces[0].secondsSinceReceived[(size_t)Stage::Decoded], 0.0);
+    EXPECT_EQ(4, sampledTraces[1].id);
+    EXPECT_TRUE(tracer->TakeSampledTraces().empty());
+    EXPECT_EQ(5, tracer->GetTotalHistogram().count);
+}
+
+TEST_F(EventTracerTests, Only_Latest_Sampled_Traces_Kept) {
+    // Arrange
+    tracer->SetSampling(1, 3);
+
+    // Act
+    for (size_t i = 0; i < 5; ++i) {
+        tracer->StartTrace()->Stamp(Stage::Handled);
+    }
+    const auto sampledTraces = tracer->TakeSampledTraces();
+
+    // Assert
+    ASSERT_EQ(3, sampledTraces.size());
+    EXPECT_EQ(3, sampledTraces[0].id);
+    EXPECT_EQ(4, sampledTraces[1].id);
+    EXPECT_EQ(5, sampledTraces[2].id);
+}
+
+TEST_F(EventTracerTests, Histogram_Percentiles_Rounded_Up_To_Bucket_Bounds) {
+    // Arrange
+    Discord::EventTracer::Histogram histogram;
+    histogram.buckets.resize(100);
+    histogram.count = 100;
+    histogram.maxSeconds = 1.0;
+    histogram.buckets[10] = 50;
+    histogram.buckets[20] = 49;
+    histogram.buckets[30] = 1;
+
+    // Act
+    const auto p50 = histogram.GetPercentile(0.5);
+    const auto p99 = histogram.GetPercentile(0.99);
+    const auto p100 = histogram.GetPercentile(1.0);
+
+    // Assert
+    EXPECT_EQ(Discord::EventTracer::Histogram::GetBucketUpperBound(10), p50);
+    EXPECT_EQ(Discord::EventTracer::Histogram::GetBucketUpperBound(20), p99);
+    EXPECT_EQ(Discord::EventTracer::Histogram::GetBucketUpperBound(30), p100);
+    for (size_t bucket = 1; bucket < 100; ++bucket) {
+        EXPECT_GT(
+            Discord::EventTracer::Histogram::GetBucketUpperBound(bucket),
+            Discord::EventTracer::Histogram::GetBucketUpperBound(bucket - 1)
+        );
+    }
+}
+
+TEST_F(EventTracerTests, Report_Summarizes_Each_Stage) {
+    // Arrange
+    const auto trace = tracer->StartTrace();
+    trace->Stamp(Stage::Decoded);
+    trace->Stamp(Stage::Handled);
+
+    // Act
+    const auto report = tracer->GetReport();
+
+    // Assert
+    EXPECT_EQ(1, (int)report["total"]["count"]);
+    EXPECT_EQ(1, (int)report["stages"]["decoded"]["count"]);
+    EXPECT_EQ(1, (int)report["stages"]["handled"]["count"]);
+    EXPECT_EQ(0, (int)report["stages"]["queued"]["count"]);
+    for (const auto key: {"mean", "p50", "p99", "max"}) {
+        EXPECT_TRUE(report["total"].Has(key)) << key;
+    }
+    EXPECT_GE((double)report["total"]["max"], (double)report["total"]["p50"]);
+}
@@ -0,0 +1,1027 @@
+/**
+ * @file FleetSimulator.cpp
+ *
+ * This module contains the implementation of the function used by the
+ * tests and benchmarks of the Discord library to simulate a fleet of
+ * gateway sessions on virtual time.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+#include "FleetSimulator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <Discord/TimerWheel.hpp>
+#include <future>
+#include <Json/Value.hpp>
+#include <map>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is the most times one message is sent again before
+     * it gets through.
+     */
+    constexpr size_t MAX_RETRANSMISSIONS = 6;
+
+    const std::string GATEWAY_URL = "wss://gateway.discord.gg";
+
+    struct Simulator;
+
+    /**
+     * This holds the answer to a request made by a gateway while
+     * connecting, which is given either by the simulation or by the
+     * gateway canceling the request, whichever comes first.
+     */
+    template< typename T > struct PendingAnswer {
+        std::promise< T > promise;
+        bool answered = false;
+    };
+
+    /**
+     * This stands in for a WebSocket opened by one of the sessions,
+     * handing what the session sends to the simulation, and what the
+     * simulation delivers to the session.
+     */
+    struct SimulatedWebSocket
+        : public Discord::WebSocket
+    {
+        // Properties
+
+        Simulator& simulator;
+        size_t session;
+        uint64_t connection;
+        bool closed = false;
+        CloseCallback onClose;
+        ReceiveCallback onText;
+
+        // Methods
+
+        SimulatedWebSocket(
+            Simulator& simulator,
+            size_t session,
+            uint64_t connection
+        )
+            : simulator(simulator)
+            , session(session)
+            , connection(connection)
+        {
+        }
+
+        bool Deliver(std::string&& message);
+
+        // Discord::WebSocket
+
+        virtual void Binary(std::string&& message) override {
+        }
+
+        virtual void Close(unsigned int code) override;
+        virtual void Text(std::string&& message) override;
+
+        virtual void RegisterBinaryCallback(ReceiveCallback&& onBinary) override {
+        }
+
+        virtual void RegisterCloseCallback(CloseCallback&& onClose) override;
+        virtual void RegisterTextCallback(ReceiveCallback&& onText) override;
+    };
+
+    /**
+     * This is what one session uses to reach the simulated REST API
+     * and gateway.
+     */
+    struct SimulatedConnections
+        : public Discord::Connections
+    {
+        // Properties
+
+        Simulator& simulator;
+        size_t session;
+
+        // Methods
+
+        SimulatedConnections(
+            Simulator& simulator,
+            size_t session
+        )
+            : simulator(simulator)
+            , session(session)
+        {
+        }
+
+        // Discord::Connections
+
+        virtual ResourceRequestTransaction QueueResourceRequest(
+            const ResourceRequest& request
+        ) override;
+        virtual WebSocketRequestTransaction QueueWebSocketRequest(
+            const WebSocketRequest& request
+        ) override;
+    };
+
+    enum class Phase {
+        /**
+         * The session isn't connected, and isn't connecting.
+         */
+        Idle,
+
+        /**
+         * The gateway is connecting, waiting on a request.
+         */
+        Connecting,
+
+        /**
+         * The gateway is connecting, waiting for the "hello" message.
+         */
+        AwaitingHello,
+
+        Connected,
+    };
+
+    struct Session {
+        // Properties
+
+        Discord::Gateway gateway;
+        std::shared_ptr< SimulatedConnections > connections;
+        std::future< bool > connected;
+        Phase phase = Phase::Idle;
+
+        /**
+         * This is incremented each time the session starts connecting,
+         * so that events meant for earlier attempts can be told apart.
+         */
+        uint64_t attempt = 0;
+
+        bool reconnectScheduled = false;
+        double wantedSince = 0.0;
+
+        // These are guarded by the simulator's mutex, since
+        // they're set from the threads on which gateways connect.
+        std::shared_ptr< PendingAnswer< Discord::Connections::Response > > newResourceRequest;
+        std::shared_ptr< PendingAnswer< std::shared_ptr< Discord::WebSocket > > > newWebSocketRequest;
+        bool newWebSocket = false;
+
+        std::shared_ptr< PendingAnswer< Discord::Connections::Response > > resourceRequest;
+        std::shared_ptr< PendingAnswer< std::shared_ptr< Discord::WebSocket > > > webSocketRequest;
+
+        // These describe the connection of the session to the gateway,
+        // if any, as the gateway sees it.
+        uint64_t connection = 0;
+        std::shared_ptr< SimulatedWebSocket > webSocket;
+        bool zombie = false;
+        double zombieSince = 0.0;
+        double lastArrivalAtClient = 0.0;
+        double lastArrivalAtServer = 0.0;
+        double lastHeartbeatArrival = -1.0;
+        int sequenceNumber = 0;
+    };
+
+    enum class EventKind {
+        StartConnecting,
+        ResourceResponse,
+        WebSocketOpened,
+        ArriveAtClient,
+        ArriveAtServer,
+        GatewayEvent,
+        Zombie,
+        ConnectTimeout,
+        Reconnect,
+    };
+
+    struct Event {
+        EventKind kind = EventKind::StartConnecting;
+        size_t session = 0;
+
+        /**
+         * This is the connection or connect attempt for which
+         * the event is meant, depending on its kind.
+         */
+        uint64_t tag = 0;
+
+        std::string message;
+    };
+
+    struct OutgoingMessage {
+        size_t session = 0;
+        uint64_t connection = 0;
+        std::string message;
+    };
+
+    /**
+     * This carries out one simulation of a fleet of gateway sessions.
+     */
+    struct Simulator {
+        // Properties
+
+        FleetSimulation simulation;
+        FleetReport report;
+        std::shared_ptr< MockClock > clock = std::make_shared< MockClock >();
+        std::shared_ptr< Discord::TimerWheel > timerWheel;
+        std::mt19937 randomGenerator;
+        std::vector< std::unique_ptr< Session > > sessions;
+
+        /**
+         * These are the events yet to happen, in the order in which
+         * they happen: by time, and then by the order in which they
+         * were scheduled.
+         */
+        std::map< std::pair< double, uint64_t >, Event > events;
+
+        uint64_t nextEventOrder = 0;
+        uint64_t nextConnection = 1;
+
+        /**
+         * These are the sessions waiting for their turn to connect.
+         */
+        std::deque< size_t > connectQueue;
+
+        /**
+         * These are the times at which the last few sessions
+         * were allowed to connect.
+         */
+        std::deque< double > recentConnects;
+
+        bool connectQueueWakeScheduled = false;
+        std::deque< double > recentIdentifies;
+        std::vector< double > heartbeatJitters;
+        double totalIdentifyWait = 0.0;
+        double totalZombieDetection = 0.0;
+
+        /**
+         * This guards what the threads on which gateways connect
+         * share with the simulation.
+         */
+        std::mutex mutex;
+
+        std::condition_variable condition;
+        std::vector< OutgoingMessage > outbox;
+
+        // Methods
+
+        explicit Simulator(const FleetSimulation& simulation)
+            : simulation(simulation)
+            , timerWheel(std::make_shared< Discord::TimerWheel >(simulation.tickSeconds, false))
+            , randomGenerator(simulation.seed)
+        {
+            timerWheel->SetClock(clock);
+            for (size_t i = 0; i < simulation.numSessions; ++i) {
+                sessions.emplace_back(new Session());
+                auto& session = *sessions.back();
+                session.connections = std::make_shared< SimulatedConnections >(*this, i);
+                session.gateway.SetTimerWheel(timerWheel);
+                session.gateway.RegisterDiagnosticMessageCallback(
+                    [](size_t, std::string&&){}
+                );
+                session.gateway.RegisterEventCallback(
+                    [this](Discord::Gateway::Event&& event){
+                        ++report.eventsDelivered;
+                        if (event.name == "READY") {
+                            ++report.readies;
+                        }
+                    }
+                );
+                session.gateway.RegisterCloseCallback(
+                    [this, i]{
+                        OnSessionClosed(i);
+                    }
+                );
+            }
+        }
+
+        double Now() const {
+            return clock->currentTime;
+        }
+
+        void Schedule(
+            double time,
+            Event&& event
+        ) {
+            events[std::make_pair(time, nextEventOrder++)] = std::move(event);
+        }
+
+        void Schedule(
+            double time,
+            EventKind kind,
+            size_t session,
+            uint64_t tag = 0,
+            std::string&& message = ""
+        ) {
+            Event event;
+            event.kind = kind;
+            event.session = session;
+            event.tag = tag;
+            event.message = std::move(message);
+            Schedule(time, std::move(event));
+        }
+
+        double Uniform() {
+            return std::uniform_real_distribution< double >(0.0, 1.0)(randomGenerator);
+        }
+
+        /**
+         * Return how long it takes one message to cross the network,
+         * including any time spent sending it again after losing it.
+         */
+        double PickTransitTime() {
+            auto transitTime = simulation.latency + simulation.latencyJitter * Uniform();
+            auto retransmissionTimeout = simulation.retransmissionTimeout;
+            for (size_t i = 0; i < MAX_RETRANSMISSIONS; ++i) {
+                if (Uniform() >= simulation.lossRate) {
+                    break;
+                }
+                transitTime += retransmissionTimeout;
+                retransmissionTimeout *= 2.0;
+            }
+            return transitTime;
+        }
+
+        /**
+         * Return when a message sent now on a connection arrives,
+         * given when the last message sent the same way arrived,
+         * since messages on a connection arrive in order.
+         */
+        double PickArrival(double& lastArrival) {
+            lastArrival = std::max(Now() + PickTransitTime(), lastArrival);
+            return lastArrival;
+        }
+
+        void SendToClient(
+            Session& session,
+            size_t index,
+            std::string&& message
+        ) {
+            Schedule(
+                PickArrival(session.lastArrivalAtClient),
+                EventKind::ArriveAtClient,
+                index,
+                session.connection,
+                std::move(message)
+            );
+        }
+
+        void ScheduleNextZombie(size_t index) {
+            if (simulation.zombiesPerSessionHour <= 0.0) {
+                return;
+            }
+            Schedule(
+                Now() + std::exponential_distribution< double >(
+                    simulation.zombiesPerSessionHour / 3600.0
+                )(randomGenerator),
+                EventKind::Zombie,
+                index
+            );
+        }
+
+        /**
+         * Put the given session in line to connect, letting sessions
+         * connect as fast as the connect window allows.
+         */
+        void WantToConnect(size_t index) {
+            sessions[index]->wantedSince = Now();
+            connectQueue.push_back(index);
+            ServeConnectQueue();
+        }
+
+        void ServeConnectQueue() {
+            while (!connectQueue.empty()) {
+                if (recentConnects.size() >= simulation.maxConcurrency) {
+                    const auto nextTurn = recentConnects.front() + simulation.connectWindow;
+                    if (nextTurn > Now()) {
+                        if (!connectQueueWakeScheduled) {
+                            connectQueueWakeScheduled = true;
+                            Schedule(nextTurn, EventKind::StartConnecting, 0);
+                        }
+                        return;
+                    }
+                    recentConnects.pop_front();
+                }
+                recentConnects.push_back(Now());
+                const auto index = connectQueue.front();
+                connectQueue.pop_front();
+                StartConnecting(index);
+            }
+        }
+
+        void StartConnecting(size_t index) {
+            auto& session = *sessions[index];
+            ++session.attempt;
+            ++report.connects;
+            session.phase = Phase::Connecting;
+            session.connected = session.gateway.Connect(
+                session.connections,
+                simulation.gatewayConfiguration
+            );
+            Schedule(
+                Now() + simulation.connectTimeout,
+                EventKind::ConnectTimeout,
+                index,
+                session.attempt
+            );
+            Settle(index);
+        }
+
+        /**
+         * Wait for the gateway of the given session to either finish
+         * connecting or get stuck waiting on the simulation, and then
+         * arrange for the simulation to answer it.
+         */
+        void Settle(size_t index) {
+            auto& session = *sessions[index];
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            while (
+                (session.newResourceRequest == nullptr)
+                && (session.newWebSocketRequest == nullptr)
+                && !session.newWebSocket
+                && (
+                    session.connected.wait_for(std::chrono::seconds(0))
+                    != std::future_status::ready
+                )
+            ) {
+                (void)condition.wait_for(lock, std::chrono::microseconds(100));
+            }
+            const auto newResourceRequest = std::move(session.newResourceRequest);
+            const auto newWebSocketRequest = std::move(session.newWebSocketRequest);
+            const auto newWebSocket = session.newWebSocket;
+            session.newResourceRequest = nullptr;
+            session.newWebSocketRequest = nullptr;
+            session.newWebSocket = false;
+            lock.unlock();
+            if (newResourceRequest != nullptr) {
+                session.resourceRequest = newResourceRequest;
+                Schedule(
+                    Now() + PickTransitTime() + PickTransitTime(),
+                    EventKind::ResourceResponse,
+                    index,
+                    session.attempt
+                );
+            } else if (newWebSocketRequest != nullptr) {
+                // Opening a WebSocket takes a round trip to set up the
+                // connection, and then another for the upgrade.
+                session.webSocketRequest = newWebSocketRequest;
+                Schedule(
+                    Now() + PickTransitTime() * 2.0 + PickTransitTime() * 2.0,
+                    EventKind::WebSocketOpened,
+                    index,
+                    session.attempt
+                );
+            } else if (newWebSocket) {
+                // The gateway says hello as soon as the WebSocket
+                // is open.
+                session.phase = Phase::AwaitingHello;
+                SendToClient(
+                    session,
+                    index,
+                    Json::Object({
+                        {"op", 10},
+                        {"d", Json::Object({
+                            {"heartbeat_interval", simulation.heartbeatIntervalMilliseconds},
+                        })},
+                    }).ToEncoding()
+                );
+            } else {
+                FinishConnecting(index);
+            }
+        }
+
+        void FinishConnecting(size_t index) {
+            auto& session = *sessions[index];
+            if (session.connected.get()) {
+                session.phase = Phase::Connected;
+            } else {
+                session.phase = Phase::Idle;
+                ScheduleReconnect(index);
+            }
+        }
+
+        template< typename T > bool Answer(
+            PendingAnswer< T >& pendingAnswer,
+            T&& answer
+        ) {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            if (pendingAnswer.answered) {
+                return false;
+            }
+            pendingAnswer.answered = true;
+            pendingAnswer.promise.set_value(std::move(answer));
+            return true;
+        }
+
+        void ScheduleReconnect(size_t index) {
+            auto& session = *sessions[index];
+            if (session.reconnectScheduled) {
+                return;
+            }
+            session.reconnectScheduled = true;
+            Schedule(
+                Now() + simulation.reconnectDelay,
+                EventKind::Reconnect,
+                index
+            );
+        }
+
+        /**
+         * Abandon whatever the gateway of the given session was doing,
+         * waiting for it to stop connecting, if it was.
+         */
+        void Disconnect(size_t index) {
+            auto& session = *sessions[index];
+            session.gateway.Disconnect();
+            if (
+                (session.phase == Phase::Connecting)
+                || (session.phase == Phase::AwaitingHello)
+            ) {
+                (void)session.connected.get();
+            }
+            session.phase = Phase::Idle;
+        }
+
+        void OnSessionClosed(size_t index) {
+            auto& session = *sessions[index];
+            if (session.zombie) {
+                session.zombie = false;
+                ++report.zombiesDetected;
+                const auto detection = Now() - session.zombieSince;
+                totalZombieDetection += detection;
+                report.zombieDetectionMax = std::max(report.zombieDetectionMax, detection);
+            }
+            ScheduleReconnect(index);
+        }
+
+        void OnWebSocketClosed(
+            size_t index,
+            uint64_t connection
+        ) {
+            auto& session = *sessions[index];
+            if (session.connection == connection) {
+                session.connection = 0;
+                session.webSocket = nullptr;
+            }
+        }
+
+        void OnArriveAtServer(
+            size_t index,
+            std::string&& message
+        ) {
+            auto& session = *sessions[index];
+            const auto messageJson = Json::Value::FromEncoding(message);
+            const int opcode = messageJson["op"];
+            if (opcode == 1) {
+                ++report.heartbeats;
+                const auto now = Now();
+                if (session.lastHeartbeatArrival >= 0.0) {
+                    heartbeatJitters.push_back(
+                        fabs(
+                            now - session.lastHeartbeatArrival
+                            - (double)simulation.heartbeatIntervalMilliseconds / 1000.0
+                        )
+                    );
+                }
+                session.lastHeartbeatArrival = now;
+                SendToClient(session, index, "{\"op\":11}");
+            } else if (opcode == 2) {
+                OnIdentify(index);
+            }
+        }
+
+        void OnIdentify(size_t index) {
+            auto& session = *sessions[index];
+            const auto now = Now();
+            ++report.identifies;
+            while (
+                !recentIdentifies.empty()
+                && (recentIdentifies.front() <= now - simulation.identifyWindow)
+            ) {
+                recentIdentifies.pop_front();
+            }
+            if (recentIdentifies.size() >= simulation.maxConcurrency) {
+                ++report.identifyRateViolations;
+            }
+            recentIdentifies.push_back(now);
+            report.maxIdentifiesPerWindow = std::max(
+                report.maxIdentifiesPerWindow,
+                recentIdentifies.size()
+            );
+            const auto identifyWait = now - session.wantedSince;
+            totalIdentifyWait += identifyWait;
+            report.identifyWaitMax = std::max(report.identifyWaitMax, identifyWait);
+            auto guilds = Json::Array({});
+            for (size_t i = 0; i < simulation.guildsPerSession; ++i) {
+                guilds.Add(
+                    Json::Object({
+                        {"id", std::to_string(i + 100)},
+                        {"unavailable", true},
+                    })
+                );
+            }
+            SendToClient(
+                session,
+                index,
+                Json::Object({
+                    {"t", "READY"},
+                    {"s", ++session.sequenceNumber},
+                    {"op", 0},
+                    {"d", Json::Object({
+                        {"v", 6},
+                        {"session_id", "session" + std::to_string(index)},
+                        {"guilds", std::move(guilds)},
+                    })},
+                }).ToEncoding()
+            );
+            for (size_t i = 0; i < simulation.guildsPerSession; ++i) {
+                SendToClient(
+                    session,
+                    index,
+                    Json::Object({
+                        {"t", "GUILD_CREATE"},
+                        {"s", ++session.sequenceNumber},
+                        {"op", 0},
+                        {"d", Json::Object({
+                            {"id", std::to_string(i + 100)},
+                            {"name", "Pepe's Pond"},
+                        })},
+                    }).ToEncoding()
+                );
+            }
+            if (simulation.eventsPerSecond > 0.0) {
+                Schedule(
+                    now + 1.0 / simulation.eventsPerSecond,
+                    EventKind::GatewayEvent,
+                    index,
+                    session.connection
+                );
+            }
+        }
+
+        /**
+         * Hand everything the sessions have sent since last time
+         * to the network.
+         */
+        void DrainOutbox() {
+            std::vector< OutgoingMessage > outgoingMessages;
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                if (outbox.empty()) {
+                    return;
+                }
+                outgoingMessages.swap(outbox);
+            }
+            for (auto& outgoingMessage: outgoingMessages) {
+                auto& session = *sessions[outgoingMessage.session];
+                Schedule(
+                    PickArrival(session.lastArrivalAtServer),
+                    EventKind::ArriveAtServer,
+                    outgoingMessage.session,
+                    outgoingMessage.connection,
+                    std::move(outgoingMessage.message)
+                );
+            }
+        }
+
+        void Handle(Event&& event) {
+            const auto index = event.session;
+            auto& session = *sessions[index];
+            switch (event.kind) {
+                case EventKind::StartConnecting: {
+                    connectQueueWakeScheduled = false;
+                    ServeConnectQueue();
+                } break;
+
+                case EventKind::ResourceResponse: {
+                    if (
+                        (event.tag != session.attempt)
+                        || (session.resourceRequest == nullptr)
+                    ) {
+                        break;
+                    }
+                    const auto resourceRequest = std::move(session.resourceRequest);
+                    session.resourceRequest = nullptr;
+                    Discord::Connections::Response response;
+                    response.status = 200;
+                    response.body = Json::Object({
+                        {"url", GATEWAY_URL},
+                    }).ToEncoding();
+                    if (Answer(*resourceRequest, std::move(response))) {
+                        Settle(index);
+                    }
+                } break;
+
+                case EventKind::WebSocketOpened: {
+                    if (
+                        (event.tag != session.attempt)
+                        || (session.webSocketRequest == nullptr)
+                    ) {
+                        break;
+                    }
+                    const auto webSocketRequest = std::move(session.webSocketRequest);
+                    session.webSocketRequest = nullptr;
+                    const auto connection = nextConnection++;
+                    const auto webSocket = std::make_shared< SimulatedWebSocket >(
+                        *this,
+                        index,
+                        connection
+                    );
+                    std::shared_ptr< Discord::WebSocket > answer = webSocket;
+                    if (Answer(*webSocketRequest, std::move(answer))) {
+                        session.connection = connection;
+                        session.webSocket = webSocket;
+                        session.zombie = false;
+                        session.lastArrivalAtClient = Now();
+                        session.lastArrivalAtServer = Now();
+                        session.lastHeartbeatArrival = -1.0;
+                        session.sequenceNumber = 0;
+                        Settle(index);
+                    }
+                } break;
+
+                case EventKind::ArriveAtClient: {
+                    if (
+                        (event.tag != session.connection)
+                        || (session.webSocket == nullptr)
+                        || session.zombie
+                    ) {
+                        break;
+                    }
+                    if (
+                        session.webSocket->Deliver(std::move(event.message))
+                        && (session.phase == Phase::AwaitingHello)
+                    ) {
+                        // The first message on every connection is
+                        // "hello", after which the gateway sends
+                        // "identify" and is done connecting.
+                        session.connected.wait();
+                        FinishConnecting(index);
+                    }
+                } break;
+
+                case EventKind::ArriveAtServer: {
+                    if (
+                        (event.tag != session.connection)
+                        || session.zombie
+                    ) {
+                        break;
+                    }
+                    OnArriveAtServer(index, std::move(event.message));
+                } break;
+
+                case EventKind::GatewayEvent: {
+                    if (event.tag != session.connection) {
+                        break;
+                    }
+                    SendToClient(
+                        session,
+                        index,
+                        Json::Object({
+                            {"t", "MESSAGE_CREATE"},
+                            {"s", ++session.sequenceNumber},
+                            {"op", 0},
+                            {"d", Json::Object({
+                                {"id", "700000000000000000"},
+                                {"channel_id", "200"},
+                                {"content", "Hello, World!"},
+                            })},
+                        }).ToEncoding()
+                    );
+                    Schedule(
+                        Now() + 1.0 / simulation.eventsPerSecond,
+                        EventKind::GatewayEvent,
+                        index,
+                        session.connection
+                    );
+                } break;
+
+                case EventKind::Zombie: {
+                    ScheduleNextZombie(index);
+                    if (
+                        (session.connection != 0)
+                        && !session.zombie
+                    ) {
+                        session.zombie = true;
+                        session.zombieSince = Now();
+                        ++report.zombies;
+                    }
+                } break;
+
+                case EventKind::ConnectTimeout: {
+                    if (
+                        (event.tag != session.attempt)
+                        || (session.phase == Phase::Connected)
+                        || (session.phase == Phase::Idle)
+                    ) {
+                        break;
+                    }
+                    ++report.connectTimeouts;
+                    Disconnect(index);
+                    ScheduleReconnect(index);
+                } break;
+
+                case EventKind::Reconnect: {
+                    session.reconnectScheduled = false;
+                    ++report.reconnects;
+                    Disconnect(index);
+                    WantToConnect(index);
+                } break;
+
+                default: break;
+            }
+        }
+
+        FleetReport Run() {
+            for (size_t i = 0; i < sessions.size(); ++i) {
+                ScheduleNextZombie(i);
+            }
+            for (size_t i = 0; i < sessions.size(); ++i) {
+                WantToConnect(i);
+                DrainOutbox();
+            }
+
+            // Handle events in order, moving the clock to the time of each
+            // one, and turning the timer wheel at each tick in between.
+            uint64_t tick = 0;
+            for (;;) {
+                const auto nextTickTime = (double)(tick + 1) * simulation.tickSeconds;
+                const auto eventsEntry = events.begin();
+                if (
+                    (eventsEntry != events.end())
+                    && (eventsEntry->first.first < nextTickTime)
+                ) {
+                    if (eventsEntry->first.first > simulation.duration) {
+                        break;
+                    }
+                    clock->currentTime = eventsEntry->first.first;
+                    auto event = std::move(eventsEntry->second);
+                    (void)events.erase(eventsEntry);
+                    Handle(std::move(event));
+                } else {
+                    if (nextTickTime > simulation.duration) {
+                        break;
+                    }
+                    ++tick;
+                    clock->currentTime = nextTickTime;
+                    timerWheel->Advance();
+                }
+                DrainOutbox();
+            }
+
+            // Wrap up.
+            for (const auto& session: sessions) {
+                if (
+                    (session->phase == Phase::Connected)
+                    && (session->connection != 0)
+                    && !session->zombie
+                ) {
+                    ++report.sessionsReady;
+                }
+            }
+            if (report.identifies > 0) {
+                report.identifyWaitMean = totalIdentifyWait / (double)report.identifies;
+            }
+            if (report.zombiesDetected > 0) {
+                report.zombieDetectionMean = totalZombieDetection / (double)report.zombiesDetected;
+            }
+            if (!heartbeatJitters.empty()) {
+                double totalHeartbeatJitter = 0.0;
+                for (const auto heartbeatJitter: heartbeatJitters) {
+                    totalHeartbeatJitter += heartbeatJitter;
+                }
+                report.heartbeatJitterMean = totalHeartbeatJitter / (double)heartbeatJitters.size();
+                std::sort(heartbeatJitters.begin(), heartbeatJitters.end());
+                report.heartbeatJitterP99 = heartbeatJitters[(heartbeatJitters.size() - 1) * 99 / 100];
+                report.heartbeatJitterMax = heartbeatJitters.back();
+            }
+            const auto finalReport = report;
+            for (size_t i = 0; i < sessions.size(); ++i) {
+                Disconnect(i);
+            }
+            return finalReport;
+        }
+    };
+
+    bool SimulatedWebSocket::Deliver(std::string&& message) {
+        std::unique_lock< decltype(simulator.mutex) > lock(simulator.mutex);
+        if (
+            closed
+            || (onText == nullptr)
+        ) {
+            return false;
+        }
+        const auto onTextSample = onText;
+        lock.unlock();
+        onTextSample(std::move(message));
+        return true;
+    }
+
+    void SimulatedWebSocket::Close(unsigned int code) {
+        std::unique_lock< decltype(simulator.mutex) > lock(simulator.mutex);
+        if (closed) {
+            return;
+        }
+        closed = true;
+        const auto onCloseSample = onClose;
+        lock.unlock();
+
+        // The closing handshake isn't simulated; the WebSocket
+        // is closed as soon as either end closes it.
+        simulator.OnWebSocketClosed(session, connection);
+        if (onCloseSample != nullptr) {
+            onCloseSample();
+        }
+    }
+
+    void SimulatedWebSocket::Text(std::string&& message) {
+        std::lock_guard< decltype(simulator.mutex) > lock(simulator.mutex);
+        if (closed) {
+            return;
+        }
+        OutgoingMessage outgoingMessage;
+        outgoingMessage.session = session;
+        outgoingMessage.connection = connection;
+        outgoingMessage.message = std::move(message);
+        simulator.outbox.push_back(std::move(outgoingMessage));
+    }
+
+    void SimulatedWebSocket::RegisterCloseCallback(CloseCallback&& onClose) {
+        std::lock_guard< decltype(simulator.mutex) > lock(simulator.mutex);
+        this->onClose = std::move(onClose);
+    }
+
+    void SimulatedWebSocket::RegisterTextCallback(ReceiveCallback&& onText) {
+        std::lock_guard< decltype(simulator.mutex) > lock(simulator.mutex);
+        this->onText = std::move(onText);
+        simulator.sessions[session]->newWebSocket = true;
+        simulator.condition.notify_all();
+    }
+
+    auto SimulatedConnections::QueueResourceRequest(
+        const ResourceRequest& request
+    ) -> ResourceRequestTransaction {
+        const auto pendingAnswer = std::make_shared< PendingAnswer< Response > >();
+        ResourceRequestTransaction transaction;
+        transaction.response = pendingAnswer->promise.get_future();
+        auto& simulator = this->simulator;
+        transaction.cancel = [&simulator, pendingAnswer]{
+            Response response;
+            response.status = 499;
+            (void)simulator.Answer(*pendingAnswer, std::move(response));
+        };
+        std::lock_guard< decltype(simulator.mutex) > lock(simulator.mutex);
+        simulator.sessions[session]->newResourceRequest = pendingAnswer;
+        simulator.condition.notify_all();
+        return transaction;
+    }
+
+    auto SimulatedConnections::QueueWebSocketRequest(
+        const WebSocketRequest& request
+    ) -> WebSocketRequestTransaction {
+        const auto pendingAnswer = std::make_shared< PendingAnswer< std::shared_ptr< Discord::WebSocket > > >();
+        WebSocketRequestTransaction transaction;
+        transaction.webSocket = pendingAnswer->promise.get_future();
+        auto& simulator = this->simulator;
+        transaction.cancel = [&simulator, pendingAnswer]{
+            (void)simulator.Answer(*pendingAnswer, std::shared_ptr< Discord::WebSocket >());
+        };
+        std::lock_guard< decltype(simulator.mutex) > lock(simulator.mutex);
+        simulator.sessions[session]->newWebSocketRequest = pendingAnswer;
+        simulator.condition.notify_all();
+        return transaction;
+    }
+
+}
+
+bool FleetReport::operator==(const FleetReport& other) const {
+    return (
+        (connects == other.connects)
+        && (connectTimeouts == other.connectTimeouts)
+        && (reconnects == other.reconnects)
+        && (sessionsReady == other.sessionsReady)
+        && (readies == other.readies)
+        && (eventsDelivered == other.eventsDelivered)
+        && (zombies == other.zombies)
+        && (zombiesDetected == other.zombiesDetected)
+        && (zombieDetectionMean == other.zombieDetectionMean)
+        && (zombieDetectionMax == other.zombieDetectionMax)
+        && (heartbeats == other.heartbeats)
+        && (heartbeatJitterMean == other.heartbeatJitterMean)
+        && (heartbeatJitterP99 == other.heartbeatJitterP99)
+        && (heartbeatJitterMax == other.heartbeatJitterMax)
+        && (identifies == other.identifies)
+        && (maxIdentifiesPerWindow == other.maxIdentifiesPerWindow)
+        && (identifyRateViolations == other.identifyRateViolations)
+        && (identifyWaitMean == other.identifyWaitMean)
+        && (identifyWaitMax == other.identifyWaitMax)
+    );
+}
+
+FleetReport SimulateFleet(const FleetSimulation& simulation) {
+    Simulator simulator(simulation);
+    return simulator.Run();
+}
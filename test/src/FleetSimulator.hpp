@@ -0,0 +1,210 @@
+#pragma once
+
+/**
+ * @file FleetSimulator.hpp
+ *
+ * This module declares the function used by the tests and benchmarks
+ * of the Discord library to simulate a fleet of gateway sessions
+ * on virtual time.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <Discord/Gateway.hpp>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * This describes a simulated fleet of gateway sessions: the network
+ * between it and Discord, how Discord's gateway behaves, and the policies
+ * the fleet follows to connect and reconnect.
+ */
+struct FleetSimulation {
+    /**
+     * This is the number of gateway sessions in the fleet.
+     */
+    size_t numSessions = 100;
+
+    /**
+     * This is how long, in seconds of virtual time, to simulate.
+     */
+    double duration = 3600.0;
+
+    /**
+     * This seeds the random choices made in the simulation.  The same
+     * simulation with the same seed always gives the same report.
+     */
+    uint32_t seed = 1;
+
+    /**
+     * This is the number of seconds between ticks of the timer wheel
+     * on which the sessions schedule their heartbeats.
+     */
+    double tickSeconds = 0.01;
+
+    // Network
+
+    /**
+     * This is the least time, in seconds, it takes a message to cross
+     * the network in either direction.
+     */
+    double latency = 0.05;
+
+    /**
+     * Up to this many seconds, chosen at random, are added to the latency
+     * of each message.  Messages on one connection still arrive in the
+     * order in which they were sent.
+     */
+    double latencyJitter = 0.01;
+
+    /**
+     * This is the chance that each message is lost and has to be sent
+     * again, after a retransmission timeout which doubles each time.
+     */
+    double lossRate = 0.0;
+
+    double retransmissionTimeout = 0.2;
+
+    /**
+     * This is the number of times per hour, on average, each session's
+     * connection becomes a zombie: it stays open, but nothing sent in
+     * either direction arrives any more.
+     */
+    double zombiesPerSessionHour = 0.0;
+
+    // Gateway
+
+    int heartbeatIntervalMilliseconds = 41250;
+
+    /**
+     * This is the number of GUILD_CREATE events sent to each session
+     * right after READY.
+     */
+    size_t guildsPerSession = 0;
+
+    /**
+     * This is the number of events per second sent to each session
+     * once it's ready.  If zero, no events are sent.
+     */
+    double eventsPerSecond = 0.0;
+
+    /**
+     * The gateway allows this many identify messages within each
+     * identify window.
+     */
+    size_t maxConcurrency = 1;
+
+    double identifyWindow = 5.0;
+
+    // Fleet
+
+    /**
+     * The fleet lets up to the gateway's maxConcurrency sessions start
+     * connecting within each of these many seconds.  This should be
+     * a little longer than the identify window, since how long it takes
+     * to connect varies.
+     */
+    double connectWindow = 5.5;
+
+    /**
+     * This is how long, in seconds, a session waits after being closed
+     * before it asks to connect again.
+     */
+    double reconnectDelay = 1.0;
+
+    /**
+     * If a session hasn't finished connecting after this many seconds,
+     * the attempt is abandoned and the session reconnects.
+     */
+    double connectTimeout = 30.0;
+
+    Discord::Gateway::Configuration gatewayConfiguration;
+};
+
+/**
+ * This is what happened in a simulation of a fleet of gateway sessions.
+ * Times are in seconds of virtual time.
+ */
+struct FleetReport {
+    size_t connects = 0;
+    size_t connectTimeouts = 0;
+    size_t reconnects = 0;
+
+    /**
+     * This is the number of sessions connected and ready at the end
+     * of the simulation, on connections which weren't zombies.
+     */
+    size_t sessionsReady = 0;
+
+    size_t readies = 0;
+    size_t eventsDelivered = 0;
+
+    size_t zombies = 0;
+    size_t zombiesDetected = 0;
+
+    /**
+     * These are how long it took sessions to notice their connections
+     * had become zombies and close them.
+     */
+    double zombieDetectionMean = 0.0;
+    double zombieDetectionMax = 0.0;
+
+    /**
+     * This is the number of heartbeats received by the gateway.
+     */
+    size_t heartbeats = 0;
+
+    /**
+     * These are how far the time between consecutive heartbeats
+     * received by the gateway on each connection strayed from
+     * the heartbeat interval.
+     */
+    double heartbeatJitterMean = 0.0;
+    double heartbeatJitterP99 = 0.0;
+    double heartbeatJitterMax = 0.0;
+
+    /**
+     * This is the number of identify messages received by the gateway.
+     */
+    size_t identifies = 0;
+
+    /**
+     * This is the most identify messages received by the gateway within
+     * any one identify window.
+     */
+    size_t maxIdentifiesPerWindow = 0;
+
+    /**
+     * This is the number of identify messages received by the gateway
+     * when it had already received the most allowed within the
+     * identify window.
+     */
+    size_t identifyRateViolations = 0;
+
+    /**
+     * These are how long sessions waited, from wanting to connect,
+     * until the gateway received their identify messages.
+     */
+    double identifyWaitMean = 0.0;
+    double identifyWaitMax = 0.0;
+
+    bool operator==(const FleetReport& other) const;
+};
+
+/**
+ * Run the given fleet of real Discord::Gateway sessions against
+ * a simulated network and gateway on virtual time, and report
+ * what happened.
+ *
+ * Everything happens on the calling thread, one event at a time,
+ * in order of virtual time, so the simulation is deterministic and
+ * runs as fast as the events can be handled.  The connecting done
+ * by each gateway on a thread of its own is waited out at each step.
+ *
+ * @param[in] simulation
+ *     This describes the fleet to simulate.
+ *
+ * @return
+ *     What happened in the simulation is returned.
+ */
+FleetReport SimulateFleet(const FleetSimulation& simulation);
@@ -0,0 +1,84 @@
+/**
+ * @file FleetSimulatorTests.cpp
+ *
+ * This module contains tests of the simulation of a fleet of
+ * Discord::Gateway sessions on virtual time.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "FleetSimulator.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(FleetSimulatorTests, Same_Seed_Gives_Same_Report) {
+    // Arrange
+    FleetSimulation simulation;
+    simulation.numSessions = 20;
+    simulation.duration = 600.0;
+    simulation.lossRate = 0.02;
+    simulation.zombiesPerSessionHour = 6.0;
+    simulation.maxConcurrency = 4;
+
+    // Act
+    const auto firstReport = SimulateFleet(simulation);
+    const auto secondReport = SimulateFleet(simulation);
+    simulation.seed = 2;
+    const auto otherSeedReport = SimulateFleet(simulation);
+
+    // Assert
+    EXPECT_GT(firstReport.reconnects, 0);
+    EXPECT_TRUE(firstReport == secondReport);
+    EXPECT_FALSE(firstReport == otherSeedReport);
+}
+
+TEST(FleetSimulatorTests, Sessions_Connect_Within_Identify_Limit_On_Quiet_Network) {
+    // Arrange
+    FleetSimulation simulation;
+    simulation.numSessions = 50;
+    simulation.duration = 600.0;
+    simulation.maxConcurrency = 2;
+    simulation.guildsPerSession = 3;
+    simulation.eventsPerSecond = 0.5;
+
+    // Act
+    const auto report = SimulateFleet(simulation);
+    simulation.connectWindow = simulation.identifyWindow;
+    const auto tightReport = SimulateFleet(simulation);
+
+    // Assert
+    EXPECT_EQ(50, report.connects);
+    EXPECT_EQ(50, report.identifies);
+    EXPECT_EQ(50, report.readies);
+    EXPECT_EQ(50, report.sessionsReady);
+    EXPECT_EQ(0, report.reconnects);
+    EXPECT_EQ(0, report.connectTimeouts);
+    EXPECT_EQ(0, report.identifyRateViolations);
+    EXPECT_EQ(2, report.maxIdentifiesPerWindow);
+    EXPECT_GE(report.identifyWaitMax, 24 * 5.5);
+    EXPECT_LT(report.identifyWaitMax, 24 * 5.5 + 1.0);
+    EXPECT_GT(report.eventsDelivered, 50 * 4);
+    EXPECT_LE(report.heartbeatJitterMax, simulation.tickSeconds + simulation.latencyJitter + 0.000001);
+    EXPECT_GT(tightReport.identifyRateViolations, 0);
+}
+
+TEST(FleetSimulatorTests, Zombies_Detected_By_Missing_Heartbeat_Acknowledgments) {
+    // Arrange
+    FleetSimulation simulation;
+    simulation.numSessions = 20;
+    simulation.duration = 3600.0;
+    simulation.zombiesPerSessionHour = 4.0;
+    simulation.maxConcurrency = 20;
+    const auto heartbeatInterval = (double)simulation.heartbeatIntervalMilliseconds / 1000.0;
+
+    // Act
+    const auto report = SimulateFleet(simulation);
+
+    // Assert
+    EXPECT_GT(report.zombies, 20);
+    EXPECT_GE(report.zombiesDetected + 20, report.zombies);
+    EXPECT_GE(report.reconnects, report.zombiesDetected);
+    EXPECT_GE(report.zombieDetectionMean, heartbeatInterval * 0.5);
+    EXPECT_LE(report.zombieDetectionMax, heartbeatInterval * 2.0 + 1.0);
+    EXPECT_EQ(report.connects, report.identifies + report.connectTimeouts);
+}
@@ -0,0 +1,277 @@
+/**
+ * @file GatewayEndpointCacheTests.cpp
+ *
+ * This module contains unit tests of the Discord::GatewayEndpointCache
+ * class, and of the Discord::Gateway class in using it.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+
+#include <chrono>
+#include <Discord/GatewayEndpointCache.hpp>
+#include <future>
+#include <gtest/gtest.h>
+#include <Json/Value.hpp>
+#include <memory>
+#include <string>
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct GatewayEndpointCacheTests
+    : public CommonTextFixture
+{
+    // Properties
+
+    std::shared_ptr< Discord::GatewayEndpointCache > endpointCache = std::make_shared< Discord::GatewayEndpointCache >(60.0);
+
+    // Methods
+
+    static bool IsReady(std::future< std::string >& endpoint) {
+        return (
+            endpoint.wait_for(std::chrono::milliseconds(100))
+            == std::future_status::ready
+        );
+    }
+
+    void RespondWithEndpoint(
+        size_t requestIndex,
+        const std::string& endpoint
+    ) {
+        connections->RespondToResourceRequest(requestIndex, {
+            200,
+            {},
+            Json::Object({
+                {"url", endpoint},
+            }).ToEncoding(),
+        });
+    }
+
+    // ::testing::Test
+
+    virtual void SetUp() override {
+        CommonTextFixture::SetUp();
+        endpointCache->SetClock(clock);
+    }
+};
+
+TEST_F(GatewayEndpointCacheTests, Concurrent_Lookups_Share_One_Request) {
+    // Arrange
+    auto firstLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    auto secondLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+
+    // Act
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    RespondWithEndpoint(0, "wss://gateway.discord.gg");
+
+    // Assert
+    ASSERT_TRUE(IsReady(firstLookup.endpoint));
+    ASSERT_TRUE(IsReady(secondLookup.endpoint));
+    EXPECT_EQ("wss://gateway.discord.gg", firstLookup.endpoint.get());
+    EXPECT_EQ("wss://gateway.discord.gg", secondLookup.endpoint.get());
+    EXPECT_EQ(1, connections->resourceRequests.size());
+}
+
+TEST_F(GatewayEndpointCacheTests, Refresh_Keeps_Remembered_Endpoint_Until_Replaced) {
+    // Arrange
+    auto firstLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    RespondWithEndpoint(0, "wss://gateway.discord.gg");
+    ASSERT_TRUE(IsReady(firstLookup.endpoint));
+
+    // Act
+    auto refreshLookup = endpointCache->GetEndpoint(connections, "DiscordBot", true);
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    auto otherLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    const auto endpointDuringRefresh = endpointCache->GetCachedEndpoint();
+    RespondWithEndpoint(1, "wss://gateway2.discord.gg");
+
+    // Assert
+    ASSERT_TRUE(IsReady(otherLookup.endpoint));
+    EXPECT_EQ("wss://gateway.discord.gg", otherLookup.endpoint.get());
+    EXPECT_EQ("wss://gateway.discord.gg", endpointDuringRefresh);
+    ASSERT_TRUE(IsReady(refreshLookup.endpoint));
+    EXPECT_EQ("wss://gateway2.discord.gg", refreshLookup.endpoint.get());
+    EXPECT_EQ("wss://gateway2.discord.gg", endpointCache->GetCachedEndpoint());
+}
+
+TEST_F(GatewayEndpointCacheTests, Endpoint_Remembered_Until_Time_To_Live_Passes) {
+    // Arrange
+    auto firstLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    RespondWithEndpoint(0, "wss://gateway.discord.gg");
+    ASSERT_TRUE(IsReady(firstLookup.endpoint));
+
+    // Act
+    clock->currentTime = 59.0;
+    auto secondLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    clock->currentTime = 61.0;
+    auto thirdLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+
+    // Assert
+    ASSERT_TRUE(IsReady(secondLookup.endpoint));
+    EXPECT_EQ("wss://gateway.discord.gg", secondLookup.endpoint.get());
+    EXPECT_TRUE(connections->RequireResourceRequests(2));
+}
+
+TEST_F(GatewayEndpointCacheTests, Endpoint_Forgotten_When_Invalidated) {
+    // Arrange
+    auto firstLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    RespondWithEndpoint(0, "wss://gateway.discord.gg");
+    ASSERT_TRUE(IsReady(firstLookup.endpoint));
+
+    // Act
+    endpointCache->Invalidate("wss://gateway.discord.gg");
+
+    // Assert
+    EXPECT_EQ("", endpointCache->GetCachedEndpoint());
+    auto secondLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    EXPECT_TRUE(connections->RequireResourceRequests(2));
+}
+
+TEST_F(GatewayEndpointCacheTests, Request_Canceled_Only_Once_All_Lookups_Canceled) {
+    // Arrange
+    auto firstLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    auto secondLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    auto requestCanceled = connections->resourceRequests[0]->canceled.get_future();
+
+    // Act
+    firstLookup.cancel();
+    const auto canceledAfterFirst = (
+        requestCanceled.wait_for(std::chrono::milliseconds(0))
+        == std::future_status::ready
+    );
+    secondLookup.cancel();
+    const auto canceledAfterSecond = (
+        requestCanceled.wait_for(std::chrono::milliseconds(0))
+        == std::future_status::ready
+    );
+
+    // Assert
+    ASSERT_TRUE(IsReady(firstLookup.endpoint));
+    EXPECT_EQ("", firstLookup.endpoint.get());
+    EXPECT_FALSE(canceledAfterFirst);
+    EXPECT_TRUE(canceledAfterSecond);
+}
+
+TEST_F(GatewayEndpointCacheTests, New_Lookup_Made_Once_Abandoned_One_Canceled) {
+    // Arrange
+    auto firstLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    firstLookup.cancel();
+
+    // Act
+    auto secondLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    RespondWithEndpoint(1, "wss://gateway.discord.gg");
+
+    // Assert
+    ASSERT_TRUE(IsReady(secondLookup.endpoint));
+    EXPECT_EQ("wss://gateway.discord.gg", secondLookup.endpoint.get());
+    EXPECT_EQ("wss://gateway.discord.gg", endpointCache->GetCachedEndpoint());
+}
+
+TEST_F(GatewayEndpointCacheTests, Gateway_Uses_Endpoint_Remembered_By_Shared_Cache) {
+    // Arrange
+    auto lookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    RespondWithEndpoint(0, "wss://gateway2.discord.gg");
+    ASSERT_TRUE(IsReady(lookup.endpoint));
+    gateway.SetGatewayEndpointCache(endpointCache);
+
+    // Act
+    connected = gateway.Connect(connections, configuration);
+
+    // Assert
+    ASSERT_TRUE(connections->RequireWebSocketRequests(1));
+    EXPECT_EQ(
+        "wss://gateway2.discord.gg/?v=6&encoding=json",
+        connections->webSocketRequests[0]->request.uri
+    );
+    EXPECT_EQ(1, connections->resourceRequests.size());
+}
+
+TEST_F(GatewayEndpointCacheTests, Gateway_Invalidates_Shared_Endpoint_When_WebSocket_Open_Fails) {
+    // Arrange
+    auto lookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    RespondWithEndpoint(0, "wss://gateway2.discord.gg");
+    ASSERT_TRUE(IsReady(lookup.endpoint));
+    gateway.SetGatewayEndpointCache(endpointCache);
+    connected = gateway.Connect(connections, configuration);
+
+    // Act
+    ASSERT_TRUE(connections->RequireWebSocketRequests(1));
+    connections->RespondToWebSocketRequest(0, nullptr);
+
+    // Assert
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    EXPECT_EQ("", endpointCache->GetCachedEndpoint());
+    RespondWithEndpoint(1, "wss://gateway3.discord.gg");
+    ASSERT_TRUE(connections->RequireWebSocketRequests(2));
+    EXPECT_EQ(
+        "wss://gateway3.discord.gg/?v=6&encoding=json",
+        connections->webSocketRequests[1]->request.uri
+    );
+    EXPECT_EQ("wss://gateway3.discord.gg", endpointCache->GetCachedEndpoint());
+}
+
+TEST_F(GatewayEndpointCacheTests, Hedged_Connect_Looks_Up_Fresh_Endpoint_Through_Shared_Cache) {
+    // Arrange
+    auto lookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    RespondWithEndpoint(0, "wss://gateway2.discord.gg");
+    ASSERT_TRUE(IsReady(lookup.endpoint));
+    gateway.SetGatewayEndpointCache(endpointCache);
+    configuration.hedgedConnectDelay = 0.01;
+    connected = gateway.Connect(connections, configuration);
+
+    // Act
+    ASSERT_TRUE(connections->RequireWebSocketRequests(1));
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    auto otherLookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    RespondWithEndpoint(1, "wss://gateway3.discord.gg");
+    ASSERT_TRUE(connections->RequireWebSocketRequests(2));
+
+    // Assert
+    ASSERT_TRUE(IsReady(otherLookup.endpoint));
+    EXPECT_EQ("wss://gateway2.discord.gg", otherLookup.endpoint.get());
+    EXPECT_EQ(2, connections->resourceRequests.size());
+    EXPECT_EQ(
+        "wss://gateway3.discord.gg/?v=6&encoding=json",
+        connections->webSocketRequests[1]->request.uri
+    );
+    EXPECT_EQ("wss://gateway3.discord.gg", endpointCache->GetCachedEndpoint());
+}
+
+TEST_F(GatewayEndpointCacheTests, Hedged_Connect_Keeps_Relearned_Endpoint_When_Slow_Cached_Attempt_Fails) {
+    // Arrange
+    auto lookup = endpointCache->GetEndpoint(connections, "DiscordBot");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    RespondWithEndpoint(0, "wss://gateway2.discord.gg");
+    ASSERT_TRUE(IsReady(lookup.endpoint));
+    gateway.SetGatewayEndpointCache(endpointCache);
+    configuration.hedgedConnectDelay = 0.01;
+    connected = gateway.Connect(connections, configuration);
+    ASSERT_TRUE(connections->RequireWebSocketRequests(1));
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+
+    // Act
+    RespondWithEndpoint(1, "wss://gateway2.discord.gg");
+    ASSERT_TRUE(connections->RequireWebSocketRequests(2));
+    connections->RespondToWebSocketRequest(0, nullptr);
+    connections->RespondToWebSocketRequest(1, nullptr);
+
+    // Assert
+    ASSERT_EQ(
+        std::future_status::ready,
+        connected.wait_for(std::chrono::milliseconds(1000))
+    );
+    EXPECT_FALSE(connected.get());
+    EXPECT_EQ("wss://gateway2.discord.gg", endpointCache->GetCachedEndpoint());
+}
@@ -0,0 +1,82 @@
+/**
+ * @file GlobalRateLimiterTests.cpp
+ *
+ * This module contains unit tests of the Discord::GlobalRateLimiter class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <atomic>
+#include <Discord/GlobalRateLimiter.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(GlobalRateLimiterTests, Burst_Allowed_Then_Requests_Spaced_At_Rate) {
+    // Arrange
+    Discord::GlobalRateLimiter limiter(10.0, 3);
+
+    // Act
+    std::vector< double > waits;
+    for (size_t i = 0; i < 4; ++i) {
+        waits.push_back(limiter.TryAcquire(100.0));
+    }
+    const auto waitAfterInterval = limiter.TryAcquire(100.1);
+    const auto waitBeforeNextInterval = limiter.TryAcquire(100.15);
+
+    // Assert
+    EXPECT_EQ(std::vector< double >({0.0, 0.0, 0.0}), std::vector< double >(waits.begin(), waits.begin() + 3));
+    EXPECT_NEAR(0.1, waits[3], 1e-6);
+    EXPECT_EQ(0.0, waitAfterInterval);
+    EXPECT_NEAR(0.05, waitBeforeNextInterval, 1e-6);
+}
+
+TEST(GlobalRateLimiterTests, Pause_Refuses_Requests_Until_Given_Time) {
+    // Arrange
+    Discord::GlobalRateLimiter limiter(10.0, 3);
+
+    // Act
+    limiter.Pause(105.0);
+    const auto waitDuringPause = limiter.TryAcquire(104.0);
+    const auto waitAfterPause = limiter.TryAcquire(105.0);
+
+    // Assert
+    EXPECT_NEAR(1.0, waitDuringPause, 1e-6);
+    EXPECT_EQ(0.0, waitAfterPause);
+}
+
+TEST(GlobalRateLimiterTests, Earlier_Pause_Does_Not_Shorten_Later_Pause) {
+    // Arrange
+    Discord::GlobalRateLimiter limiter(10.0, 3);
+
+    // Act
+    limiter.Pause(105.0);
+    limiter.Pause(102.0);
+
+    // Assert
+    EXPECT_NEAR(1.0, limiter.TryAcquire(104.0), 1e-6);
+}
+
+TEST(GlobalRateLimiterTests, Burst_Shared_Exactly_Among_Concurrent_Threads) {
+    // Arrange
+    Discord::GlobalRateLimiter limiter(1.0, 100);
+    std::atomic< size_t > numAcquired{0};
+    std::vector< std::thread > threads;
+
+    // Act
+    for (size_t i = 0; i < 8; ++i) {
+        threads.emplace_back([&]{
+            for (size_t j = 0; j < 50; ++j) {
+                if (limiter.TryAcquire(10.0) == 0.0) {
+                    ++numAcquired;
+                }
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    // Assert
+    EXPECT_EQ(100, numAcquired);
+}
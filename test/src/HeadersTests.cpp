@@ -0,0 +1,175 @@
+/**
+ * @file HeadersTests.cpp
+ *
+ * This module contains unit tests of the Discord::Headers class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <Discord/Headers.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(HeadersTests, Find_Ignores_Case_Of_Common_And_Other_Names) {
+    // Arrange
+    const Discord::Headers headers{
+        {"Content-Type", "application/json"},
+        {"X-Custom-Thing", "42"},
+    };
+
+    // Act
+    const auto contentType = headers.Find("content-type");
+    const auto custom = headers.Find("x-CUSTOM-thing");
+    const auto missing = headers.Find("x-custom");
+
+    // Assert
+    ASSERT_FALSE(contentType == nullptr);
+    EXPECT_EQ("application/json", *contentType);
+    ASSERT_FALSE(custom == nullptr);
+    EXPECT_EQ("42", *custom);
+    EXPECT_TRUE(missing == nullptr);
+    EXPECT_EQ("", headers.Get("Accept"));
+}
+
+TEST(HeadersTests, Headers_Kept_In_Order_Beyond_Inline_Capacity) {
+    // Arrange
+    Discord::Headers headers;
+    std::vector< Discord::Header > expected;
+
+    // Act
+    for (size_t i = 0; i < 10; ++i) {
+        Discord::Header header{"X-Header-" + std::to_string(i), std::to_string(i)};
+        expected.push_back(header);
+        headers.push_back(std::move(header));
+    }
+
+    // Assert
+    ASSERT_EQ(expected.size(), headers.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(expected[i].key, headers[i].key);
+        EXPECT_EQ(expected[i].value, headers[i].value);
+    }
+    EXPECT_EQ("7", headers.Get("x-header-7"));
+}
+
+TEST(HeadersTests, Set_Replaces_All_Headers_With_Name) {
+    // Arrange
+    Discord::Headers headers{
+        {"Accept", "text/plain"},
+        {"User-Agent", "test"},
+        {"ACCEPT", "text/html"},
+    };
+
+    // Act
+    headers.Set("accept", "application/json");
+
+    // Assert
+    ASSERT_EQ(2, headers.size());
+    EXPECT_EQ("Accept", headers[0].key);
+    EXPECT_EQ("application/json", headers[0].value);
+    EXPECT_EQ("User-Agent", headers[1].key);
+}
+
+TEST(HeadersTests, Remove_Returns_To_Inline_Storage) {
+    // Arrange
+    Discord::Headers headers;
+    for (size_t i = 0; i < 6; ++i) {
+        headers.push_back({(i % 2 == 0) ? "X-Even" : "X-Odd", std::to_string(i)});
+    }
+
+    // Act
+    const auto numRemoved = headers.Remove("x-even");
+    headers.push_back({"X-Last", "6"});
+
+    // Assert
+    EXPECT_EQ(3, numRemoved);
+    EXPECT_EQ(
+        std::vector< std::string >({"1", "3", "5", "6"}),
+        [&]{
+            std::vector< std::string > values;
+            for (const auto& header: headers) {
+                values.push_back(header.value);
+            }
+            return values;
+        }()
+    );
+}
+
+TEST(HeadersTests, Move_Takes_Headers_And_Leaves_Source_Empty) {
+    // Arrange
+    Discord::Headers headers{
+        {"Authorization", "Bot 1234"},
+    };
+
+    // Act
+    Discord::Headers moved(std::move(headers));
+
+    // Assert
+    EXPECT_TRUE(headers.empty());
+    EXPECT_EQ("Bot 1234", moved.Get("authorization"));
+}
+
+TEST(HeadersTests, Every_Common_Header_Found_By_Header_Name) {
+    // Arrange
+    const std::vector< std::pair< std::string, Discord::HeaderName > > names{
+        {"Accept", Discord::HeaderName::Accept},
+        {"accept-encoding", Discord::HeaderName::AcceptEncoding},
+        {"Authorization", Discord::HeaderName::Authorization},
+        {"Cache-Control", Discord::HeaderName::CacheControl},
+        {"Connection", Discord::HeaderName::Connection},
+        {"Content-Encoding", Discord::HeaderName::ContentEncoding},
+        {"Content-Length", Discord::HeaderName::ContentLength},
+        {"Content-Type", Discord::HeaderName::ContentType},
+        {"Date", Discord::HeaderName::Date},
+        {"ETag", Discord::HeaderName::ETag},
+        {"If-Modified-Since", Discord::HeaderName::IfModifiedSince},
+        {"If-None-Match", Discord::HeaderName::IfNoneMatch},
+        {"Retry-After", Discord::HeaderName::RetryAfter},
+        {"Transfer-Encoding", Discord::HeaderName::TransferEncoding},
+        {"User-Agent", Discord::HeaderName::UserAgent},
+        {"X-Audit-Log-Reason", Discord::HeaderName::XAuditLogReason},
+        {"X-RateLimit-Bucket", Discord::HeaderName::XRateLimitBucket},
+        {"X-RateLimit-Global", Discord::HeaderName::XRateLimitGlobal},
+        {"X-RateLimit-Limit", Discord::HeaderName::XRateLimitLimit},
+        {"X-RateLimit-Remaining", Discord::HeaderName::XRateLimitRemaining},
+        {"X-RateLimit-Reset", Discord::HeaderName::XRateLimitReset},
+        {"X-RateLimit-Reset-After", Discord::HeaderName::XRateLimitResetAfter},
+        {"X-RateLimit-Scope", Discord::HeaderName::XRateLimitScope},
+    };
+    Discord::Headers headers;
+    for (const auto& name: names) {
+        headers.push_back({name.first, name.first + " value"});
+    }
+
+    // Act
+    // Assert
+    for (const auto& name: names) {
+        EXPECT_EQ(name.first + " value", headers.Get(name.second)) << name.first;
+    }
+}
+
+TEST(HeadersTests, Find_By_Header_Name) {
+    // Arrange
+    Discord::Headers headers{
+        {"X-Custom-Thing", "42"},
+        {"content-type", "application/json"},
+    };
+    for (size_t i = 0; i < 4; ++i) {
+        headers.push_back({"X-Header-" + std::to_string(i), std::to_string(i)});
+    }
+    headers.push_back({"X-RATELIMIT-REMAINING", "4"});
+
+    // Act
+    const auto contentType = headers.Find(Discord::HeaderName::ContentType);
+    const auto other = headers.Find(Discord::HeaderName::Other);
+
+    // Assert
+    ASSERT_FALSE(contentType == nullptr);
+    EXPECT_EQ("application/json", *contentType);
+    EXPECT_TRUE(other == nullptr);
+    EXPECT_EQ("4", headers.Get(Discord::HeaderName::XRateLimitRemaining));
+    EXPECT_TRUE(headers.Has(Discord::HeaderName::XRateLimitRemaining));
+    EXPECT_FALSE(headers.Has(Discord::HeaderName::XRateLimitReset));
+}
@@ -9,8 +9,13 @@
 
 #include "Common.hpp"
 
+#include <Discord/TimerWheel.hpp>
 #include <gtest/gtest.h>
 #include <Json/Value.hpp>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
 #include <string>
 #include <vector>
 
@@ -41,11 +46,154 @@ TEST_F(HeartbeatTests, Heartbeat_Sent_After_Hello_Received) {
     );
 }
 
+TEST_F(HeartbeatTests, First_Heartbeat_Delayed_Within_Interval_When_Phase_Random) {
+    // Arrange
+    configuration.heartbeatPhase = Discord::Gateway::HeartbeatPhase::Random;
+    ASSERT_TRUE(ConnectWebSocket(configuration));
+
+    // Act
+    SendHello();
+    ASSERT_TRUE(webSocket->AwaitTexts(1));
+    const auto textSentAfterHello = webSocket->textSent;
+    clock->currentTime += (double)heartbeatIntervalMilliseconds / 1000.0;
+    scheduler->WakeUp();
+    ASSERT_TRUE(webSocket->AwaitTexts(2));
+
+    // Assert
+    ASSERT_EQ(1, textSentAfterHello.size());
+    EXPECT_EQ(Json::Value(2), Json::Value::FromEncoding(textSentAfterHello[0])["op"]);
+    EXPECT_EQ(
+        Json::Object({
+            {"op", 1},
+            {"d", nullptr},
+        }).ToEncoding(),
+        webSocket->textSent[1]
+    );
+}
+
+TEST_F(HeartbeatTests, First_Heartbeats_Spread_Across_Interval_When_Phase_Spread) {
+    // Arrange
+    configuration.heartbeatPhase = Discord::Gateway::HeartbeatPhase::Spread;
+    std::mutex mutex;
+    std::vector< double > firstHeartbeatDelays;
+    gateway.RegisterDiagnosticMessageCallback(
+        [&](
+            size_t level,
+            std::string&& message
+        ){
+            double delay;
+            if (sscanf(message.c_str(), "First heartbeat in %lg seconds", &delay) == 1) {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                firstHeartbeatDelays.push_back(delay);
+            }
+        }
+    );
+
+    // Act
+    ASSERT_TRUE(ConnectWebSocket(configuration));
+    SendHello();
+    ASSERT_TRUE(webSocket->AwaitTexts(1));
+    ASSERT_EQ(
+        std::future_status::ready,
+        connected.wait_for(std::chrono::milliseconds(100))
+    );
+    for (size_t i = 1; i < 3; ++i) {
+        // Reconnecting reuses the WebSocket endpoint from before.
+        gateway.Disconnect();
+        webSocket = std::make_shared< MockWebSocket >();
+        connected = gateway.Connect(connections, configuration);
+        ASSERT_TRUE(connections->RequireWebSocketRequests(i + 1));
+        connections->RespondToWebSocketRequest(i, webSocket);
+        ASSERT_EQ(
+            std::future_status::ready,
+            webSocket->onTextRegistered.get_future().wait_for(
+                std::chrono::milliseconds(100)
+            )
+        );
+        SendHello();
+        ASSERT_TRUE(webSocket->AwaitTexts(1));
+        ASSERT_EQ(
+            std::future_status::ready,
+            connected.wait_for(std::chrono::milliseconds(100))
+        );
+    }
+
+    // Assert
+    std::lock_guard< decltype(mutex) > lock(mutex);
+    ASSERT_EQ(3, firstHeartbeatDelays.size());
+    const auto heartbeatInterval = (double)heartbeatIntervalMilliseconds / 1000.0;
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_GT(firstHeartbeatDelays[i], 0.0);
+        EXPECT_LT(firstHeartbeatDelays[i], heartbeatInterval);
+        for (size_t j = 0; j < i; ++j) {
+            EXPECT_GT(
+                fabs(firstHeartbeatDelays[i] - firstHeartbeatDelays[j]),
+                heartbeatInterval / 5.0
+            );
+        }
+    }
+}
+
+TEST_F(HeartbeatTests, Spread_Heartbeats_Anchored_To_Clock_Not_Connect_Time) {
+    // Arrange
+    configuration.heartbeatPhase = Discord::Gateway::HeartbeatPhase::Spread;
+    std::mutex mutex;
+    std::vector< double > firstHeartbeatTimes;
+    gateway.RegisterDiagnosticMessageCallback(
+        [&](
+            size_t level,
+            std::string&& message
+        ){
+            double delay;
+            if (sscanf(message.c_str(), "First heartbeat in %lg seconds", &delay) == 1) {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                firstHeartbeatTimes.push_back(clock->currentTime + delay);
+            }
+        }
+    );
+    const auto heartbeatInterval = (double)heartbeatIntervalMilliseconds / 1000.0;
+    clock->currentTime = 1000.0;
+    ASSERT_TRUE(ConnectWebSocket(configuration));
+    SendHello();
+    ASSERT_TRUE(webSocket->AwaitTexts(1));
+    ASSERT_EQ(
+        std::future_status::ready,
+        connected.wait_for(std::chrono::milliseconds(100))
+    );
+
+    // Act
+    gateway.Disconnect();
+    clock->currentTime += heartbeatInterval * 0.37;
+    webSocket = std::make_shared< MockWebSocket >();
+    connected = gateway.Connect(connections, configuration);
+    ASSERT_TRUE(connections->RequireWebSocketRequests(2));
+    connections->RespondToWebSocketRequest(1, webSocket);
+    ASSERT_EQ(
+        std::future_status::ready,
+        webSocket->onTextRegistered.get_future().wait_for(
+            std::chrono::milliseconds(100)
+        )
+    );
+    SendHello();
+    ASSERT_TRUE(webSocket->AwaitTexts(1));
+
+    // Assert
+    std::lock_guard< decltype(mutex) > lock(mutex);
+    ASSERT_EQ(2, firstHeartbeatTimes.size());
+    double wholePart;
+    const auto phaseDifference = modf(
+        (firstHeartbeatTimes[1] - firstHeartbeatTimes[0]) / heartbeatInterval + 1.0,
+        &wholePart
+    );
+    EXPECT_NEAR(0.6180339887498949, phaseDifference, 1e-3);
+}
+
 TEST_F(HeartbeatTests, Heartbeat_Sent_After_Heartbeat_Received) {
     // Arrange
     ASSERT_TRUE(Connect(configuration));
 
     // Act
+    webSocket->textSent.clear();
     webSocket->onText(
         Json::Object({
             {"op", 1},
@@ -65,6 +213,32 @@ TEST_F(HeartbeatTests, Heartbeat_Sent_After_Heartbeat_Received) {
     );
 }
 
+TEST_F(HeartbeatTests, Heartbeat_Includes_Last_Sequence_Number_Received) {
+    // Arrange
+    ASSERT_TRUE(Connect(configuration));
+    SendDispatch("TYPING_START", 42, Json::Object({}));
+
+    // Act
+    webSocket->textSent.clear();
+    webSocket->onText(
+        Json::Object({
+            {"op", 1},
+            {"d", nullptr},
+        }).ToEncoding()
+    );
+
+    // Assert
+    EXPECT_EQ(
+        std::vector< std::string >({
+            Json::Object({
+                {"op", 1},
+                {"d", 42},
+            }).ToEncoding(),
+        }),
+        webSocket->textSent
+    );
+}
+
 TEST_F(HeartbeatTests, Heartbeat_Not_Sent_Before_Heartbeat_Interval) {
     // Arrange
     ASSERT_TRUE(Connect(configuration));
@@ -79,6 +253,21 @@ TEST_F(HeartbeatTests, Heartbeat_Not_Sent_Before_Heartbeat_Interval) {
     EXPECT_FALSE(webSocket->AwaitTexts(1));
 }
 
+TEST_F(HeartbeatTests, Heartbeat_Interval_Counted_From_Hello) {
+    // Arrange
+    clock->currentTime = 30.0;
+    ASSERT_TRUE(Connect(configuration));
+
+    // Act
+    webSocket->textSent.clear();
+    SendHeartbeatAck();
+    clock->currentTime += (double)(heartbeatIntervalMilliseconds - 1) / 1000.0;
+    scheduler->WakeUp();
+
+    // Assert
+    EXPECT_FALSE(webSocket->AwaitTexts(1));
+}
+
 TEST_F(HeartbeatTests, Heartbeat_Sent_After_Heartbeat_Interval) {
     // Arrange
     ASSERT_TRUE(Connect(configuration));
@@ -102,6 +291,37 @@ TEST_F(HeartbeatTests, Heartbeat_Sent_After_Heartbeat_Interval) {
     );
 }
 
+TEST_F(HeartbeatTests, Heartbeat_Sent_After_Heartbeat_Interval_Using_Timer_Wheel) {
+    // Arrange
+    const auto timerWheel = std::make_shared< Discord::TimerWheel >();
+    timerWheel->SetClock(clock);
+    gateway.SetTimerWheel(timerWheel);
+    ASSERT_TRUE(Connect(configuration));
+
+    // Act
+    webSocket->textSent.clear();
+    SendHeartbeatAck();
+    clock->currentTime += (double)(heartbeatIntervalMilliseconds - 1) / 1000.0;
+    timerWheel->WakeUp();
+    const auto sentBeforeInterval = webSocket->AwaitTexts(1);
+    clock->currentTime += 0.002;
+    timerWheel->WakeUp();
+    const auto sentAfterInterval = webSocket->AwaitTexts(1);
+
+    // Assert
+    EXPECT_FALSE(sentBeforeInterval);
+    EXPECT_TRUE(sentAfterInterval);
+    EXPECT_EQ(
+        std::vector< std::string >({
+            Json::Object({
+                {"op", 1},
+                {"d", nullptr},
+            }).ToEncoding(),
+        }),
+        webSocket->textSent
+    );
+}
+
 TEST_F(HeartbeatTests, WebSocket_Closed_Non_1000_Status_If_No_Heartbeat_Ack_Between_Heartbeats) {
     // Arrange
     ASSERT_TRUE(Connect(configuration));
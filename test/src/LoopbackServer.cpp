@@ -0,0 +1,152 @@
+/**
+ * @file LoopbackServer.cpp
+ *
+ * This module contains the implementation of the stand-in server used
+ * to test the Discord::SocketConnections class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "LoopbackServer.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdlib.h>
+#include <StringExtensions/StringExtensions.hpp>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+LoopbackServer::~LoopbackServer() {
+    (void)shutdown(listenFd, SHUT_RDWR);
+    (void)close(listenFd);
+    if (acceptor.joinable()) {
+        acceptor.join();
+    }
+    {
+        std::lock_guard< decltype(mutex) > lock(mutex);
+        for (const auto fd: connectionFds) {
+            (void)shutdown(fd, SHUT_RDWR);
+        }
+    }
+    for (auto& connectionThread: connectionThreads) {
+        connectionThread.join();
+    }
+    for (const auto fd: connectionFds) {
+        (void)close(fd);
+    }
+}
+
+LoopbackServer::LoopbackServer(Handler handler)
+    : handler(handler)
+{
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    const int reuse = 1;
+    (void)setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address;
+    (void)memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    (void)bind(listenFd, (const sockaddr*)&address, sizeof(address));
+    (void)listen(listenFd, SOMAXCONN);
+    socklen_t addressLength = sizeof(address);
+    (void)getsockname(listenFd, (sockaddr*)&address, &addressLength);
+    port = ntohs(address.sin_port);
+    acceptor = std::thread(
+        [this]{
+            for (;;) {
+                const auto fd = accept4(listenFd, NULL, NULL, SOCK_CLOEXEC);
+                if (fd < 0) {
+                    return;
+                }
+                const int noDelay = 1;
+                (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                const auto connectionIndex = numConnections++;
+                connectionFds.push_back(fd);
+                connectionThreads.emplace_back(
+                    [this, connectionIndex, fd]{
+                        this->handler(connectionIndex, fd);
+                        (void)shutdown(fd, SHUT_RDWR);
+                    }
+                );
+            }
+        }
+    );
+}
+
+std::string LoopbackServer::GetUri(
+    const std::string& path,
+    const std::string& scheme
+) const {
+    return scheme + "://127.0.0.1:" + std::to_string(port) + path;
+}
+
+bool LoopbackServer::ReadRequest(
+    int fd,
+    std::string& buffer,
+    std::string& request
+) {
+    for (;;) {
+        const auto headEnd = buffer.find("\r\n\r\n");
+        if (headEnd != std::string::npos) {
+            const auto head = buffer.substr(0, headEnd + 4);
+            const auto bodyLength = (size_t)atoi(GetHeader(head, "Content-Length").c_str());
+            if (buffer.length() >= head.length() + bodyLength) {
+                request = buffer.substr(0, head.length() + bodyLength);
+                buffer.erase(0, request.length());
+                return true;
+            }
+        }
+        char chunk[65536];
+        const auto amountReceived = recv(fd, chunk, sizeof(chunk), 0);
+        if (amountReceived <= 0) {
+            return false;
+        }
+        buffer.append(chunk, (size_t)amountReceived);
+    }
+}
+
+void LoopbackServer::WriteAll(
+    int fd,
+    const std::string& data
+) {
+    size_t amountSent = 0;
+    while (amountSent < data.length()) {
+        const auto amount = send(fd, data.data() + amountSent, data.length() - amountSent, MSG_NOSIGNAL);
+        if (amount <= 0) {
+            return;
+        }
+        amountSent += (size_t)amount;
+    }
+}
+
+std::string LoopbackServer::GetHeader(
+    const std::string& request,
+    const std::string& name
+) {
+    const auto lowerName = StringExtensions::ToLower(name);
+    for (const auto& line: StringExtensions::Split(request, '\n')) {
+        const auto delimiter = line.find(':');
+        if (
+            (delimiter != std::string::npos)
+            && (StringExtensions::ToLower(line.substr(0, delimiter)) == lowerName)
+        ) {
+            return StringExtensions::Trim(line.substr(delimiter + 1));
+        }
+    }
+    return "";
+}
+
+std::string LoopbackServer::MakeResponse(
+    unsigned int status,
+    const std::string& body
+) {
+    return (
+        "HTTP/1.1 " + std::to_string(status) + " X\r\n"
+        + "Content-Length: " + std::to_string(body.length()) + "\r\n"
+        + "\r\n"
+        + body
+    );
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+/**
+ * @file LoopbackServer.hpp
+ *
+ * This module declares a stand-in server, listening on the loopback
+ * interface, which is used to test the Discord::SocketConnections class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * This accepts connections on an ephemeral port of the loopback interface,
+ * handing each one to a handler on a thread of its own.  The connection
+ * is closed once the handler returns.
+ */
+struct LoopbackServer {
+    // Types
+
+    /**
+     * This is called for each connection, with the number of
+     * connections accepted before it and the connection's socket.
+     */
+    using Handler = std::function<
+        void(
+            size_t connectionIndex,
+            int fd
+        )
+    >;
+
+    // Properties
+
+    uint16_t port = 0;
+    std::atomic< size_t > numConnections{0};
+    Handler handler;
+    int listenFd = -1;
+    std::thread acceptor;
+    std::mutex mutex;
+    std::vector< int > connectionFds;
+    std::vector< std::thread > connectionThreads;
+
+    // Lifecycle
+
+    ~LoopbackServer();
+    LoopbackServer(const LoopbackServer&) = delete;
+    LoopbackServer(LoopbackServer&&) = delete;
+    LoopbackServer& operator=(const LoopbackServer&) = delete;
+    LoopbackServer& operator=(LoopbackServer&&) = delete;
+
+    // Methods
+
+    explicit LoopbackServer(Handler handler);
+
+    /**
+     * Return the URI of the given path on the server, using
+     * the given scheme.
+     */
+    std::string GetUri(
+        const std::string& path,
+        const std::string& scheme = "http"
+    ) const;
+
+    /**
+     * Read one whole request from the given connection, using the given
+     * buffer to hold anything received past the end of it.
+     *
+     * @return
+     *     An indication of whether or not a whole request
+     *     was read is returned.
+     */
+    static bool ReadRequest(
+        int fd,
+        std::string& buffer,
+        std::string& request
+    );
+
+    static void WriteAll(
+        int fd,
+        const std::string& data
+    );
+
+    /**
+     * Return the value of the header with the given name in
+     * the given request.
+     */
+    static std::string GetHeader(
+        const std::string& request,
+        const std::string& name
+    );
+
+    /**
+     * Return an HTTP response with the given status and body,
+     * and headers which keep the connection open.
+     */
+    static std::string MakeResponse(
+        unsigned int status,
+        const std::string& body
+    );
+};
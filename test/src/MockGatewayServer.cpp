@@ -0,0 +1,363 @@
+/**
+ * @file MockGatewayServer.cpp
+ *
+ * This module contains the implementation of the stand-in for Discord's
+ * gateway used to load test many gateway sessions at once.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "../../src/WebSocketHandshake.hpp"
+#include "MockGatewayServer.hpp"
+
+#include <chrono>
+#include <Json/Value.hpp>
+#include <poll.h>
+#include <sys/socket.h>
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+    using Opcode = Discord::WebSocketHandshake::Opcode;
+
+    /**
+     * This is the part of every URI of Discord's REST API which is
+     * replaced by the URI of the mock gateway server.
+     */
+    const std::string DISCORD_BASE_URI = "https://discordapp.com";
+
+    void SendText(
+        int fd,
+        const std::string& text
+    ) {
+        LoopbackServer::WriteAll(
+            fd,
+            Discord::WebSocketHandshake::EncodeFrame(Opcode::Text, text, false)
+        );
+    }
+
+    void SendClose(
+        int fd,
+        unsigned int code
+    ) {
+        std::string payload;
+        payload.push_back((char)(code >> 8));
+        payload.push_back((char)(code & 0xFF));
+        LoopbackServer::WriteAll(
+            fd,
+            Discord::WebSocketHandshake::EncodeFrame(Opcode::Close, payload, false)
+        );
+    }
+
+    std::string MakeDispatch(
+        const std::string& eventName,
+        int sequenceNumber,
+        const std::string& data
+    ) {
+        return (
+            "{\"t\":\"" + eventName
+            + "\",\"s\":" + std::to_string(sequenceNumber)
+            + ",\"op\":0,\"d\":" + data
+            + "}"
+        );
+    }
+
+}
+
+MockGatewayServer::MockGatewayServer(const Configuration& configuration)
+    : configuration(configuration)
+{
+    server.reset(
+        new LoopbackServer(
+            [this](size_t, int fd){
+                Serve(fd);
+            }
+        )
+    );
+}
+
+std::string MockGatewayServer::GetBaseUri() const {
+    return server->GetUri("");
+}
+
+auto MockGatewayServer::GetStatistics() const -> Statistics {
+    Statistics statistics;
+    statistics.webSocketsOpened = webSocketsOpened;
+    statistics.identifies = identifies;
+    statistics.resumes = resumes;
+    statistics.heartbeats = heartbeats;
+    statistics.eventsSent = eventsSent;
+    statistics.reconnectsRequested = reconnectsRequested;
+    statistics.connectionsDropped = connectionsDropped;
+    return statistics;
+}
+
+void MockGatewayServer::Serve(int fd) {
+    std::string buffer;
+    std::string request;
+    while (LoopbackServer::ReadRequest(fd, buffer, request)) {
+        const auto key = LoopbackServer::GetHeader(request, "Sec-WebSocket-Key");
+        if (!key.empty()) {
+            LoopbackServer::WriteAll(
+                fd,
+                "HTTP/1.1 101 Switching Protocols\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                "Sec-WebSocket-Accept: " + Discord::WebSocketHandshake::ComputeAccept(key) + "\r\n"
+                "\r\n"
+            );
+            ServeSession(fd, buffer);
+            return;
+        }
+        if (request.compare(0, 23, "GET /api/v6/gateway HTT") == 0) {
+            LoopbackServer::WriteAll(
+                fd,
+                LoopbackServer::MakeResponse(
+                    200,
+                    Json::Object({
+                        {"url", server->GetUri("", "ws")},
+                    }).ToEncoding()
+                )
+            );
+        } else {
+            LoopbackServer::WriteAll(fd, LoopbackServer::MakeResponse(404, ""));
+        }
+    }
+}
+
+void MockGatewayServer::ServeSession(
+    int fd,
+    std::string& buffer
+) {
+    ++webSocketsOpened;
+    SendText(
+        fd,
+        Json::Object({
+            {"op", 10},
+            {"d", Json::Object({
+                {"heartbeat_interval", configuration.heartbeatIntervalMilliseconds},
+            })},
+        }).ToEncoding()
+    );
+    std::string sessionId;
+    int sequenceNumber = 0;
+    bool ready = false;
+    size_t numEventsSent = 0;
+    const auto eventInterval = std::chrono::duration_cast< Clock::duration >(
+        std::chrono::duration< double >(
+            (configuration.eventsPerSecond > 0.0)
+            ? 1.0 / configuration.eventsPerSecond
+            : 0.0
+        )
+    );
+    auto nextEventTime = Clock::now();
+    const auto eventData = Json::Object({
+        {"id", "700000000000000000"},
+        {"channel_id", "200"},
+        {"guild_id", "100"},
+        {"author", Json::Object({
+            {"id", "1000"},
+            {"username", "Frog"},
+            {"discriminator", "0001"},
+        })},
+        {"content", std::string(configuration.eventContentLength, 'x')},
+    }).ToEncoding();
+    const auto rememberSequenceNumber = [&]{
+        std::lock_guard< decltype(mutex) > lock(mutex);
+        sessions[sessionId] = sequenceNumber;
+    };
+    for (;;) {
+        // Handle every frame received so far.
+        Discord::WebSocketHandshake::Frame frame;
+        size_t offset = 0;
+        while (
+            Discord::WebSocketHandshake::DecodeFrame(buffer, offset, frame)
+            == Discord::WebSocketHandshake::DecodeResult::Complete
+        ) {
+            if (frame.opcode == Opcode::Close) {
+                SendClose(fd, 1000);
+                return;
+            } else if (frame.opcode == Opcode::Ping) {
+                LoopbackServer::WriteAll(
+                    fd,
+                    Discord::WebSocketHandshake::EncodeFrame(Opcode::Pong, frame.payload, false)
+                );
+                continue;
+            } else if (frame.opcode != Opcode::Text) {
+                continue;
+            }
+            const auto message = Json::Value::FromEncoding(frame.payload);
+            const int opcode = message["op"];
+            if (opcode == 1) {
+                ++heartbeats;
+                if (configuration.ackHeartbeats) {
+                    SendText(fd, "{\"op\":11}");
+                }
+            } else if (opcode == 2) {
+                sessionId = "session" + std::to_string(++identifies);
+                auto guilds = Json::Array({});
+                for (size_t i = 0; i < configuration.guildsPerSession; ++i) {
+                    guilds.Add(
+                        Json::Object({
+                            {"id", std::to_string(i + 100)},
+                            {"unavailable", true},
+                        })
+                    );
+                }
+                SendText(
+                    fd,
+                    MakeDispatch(
+                        "READY",
+                        ++sequenceNumber,
+                        Json::Object({
+                            {"v", 6},
+                            {"session_id", sessionId},
+                            {"user", Json::Object({
+                                {"id", "1"},
+                                {"username", "Bot"},
+                                {"discriminator", "0001"},
+                            })},
+                            {"guilds", std::move(guilds)},
+                        }).ToEncoding()
+                    )
+                );
+                for (size_t i = 0; i < configuration.guildsPerSession; ++i) {
+                    SendText(
+                        fd,
+                        MakeDispatch(
+                            "GUILD_CREATE",
+                            ++sequenceNumber,
+                            Json::Object({
+                                {"id", std::to_string(i + 100)},
+                                {"name", "Pepe's Pond"},
+                            }).ToEncoding()
+                        )
+                    );
+                }
+                rememberSequenceNumber();
+                ready = true;
+                nextEventTime = Clock::now();
+            } else if (opcode == 6) {
+                ++resumes;
+                const std::string requestedSessionId = message["d"]["session_id"];
+                std::unique_lock< decltype(mutex) > lock(mutex);
+                const auto sessionsEntry = sessions.find(requestedSessionId);
+                if (sessionsEntry == sessions.end()) {
+                    lock.unlock();
+                    SendText(fd, "{\"op\":9,\"d\":false}");
+                    continue;
+                }
+                sessionId = requestedSessionId;
+                sequenceNumber = sessionsEntry->second;
+                lock.unlock();
+                SendText(fd, MakeDispatch("RESUMED", ++sequenceNumber, "{}"));
+                rememberSequenceNumber();
+                ready = true;
+                nextEventTime = Clock::now();
+            }
+        }
+        buffer.erase(0, offset);
+
+        // Send any events which are due, injecting failures
+        // along the way.
+        const auto now = Clock::now();
+        while (
+            ready
+            && (configuration.eventsPerSecond > 0.0)
+            && (now >= nextEventTime)
+        ) {
+            SendText(
+                fd,
+                MakeDispatch(configuration.eventName, ++sequenceNumber, eventData)
+            );
+            ++eventsSent;
+            ++numEventsSent;
+            nextEventTime += eventInterval;
+            if (numEventsSent == configuration.dropAfterEvents) {
+                rememberSequenceNumber();
+                ++connectionsDropped;
+                (void)shutdown(fd, SHUT_RDWR);
+                return;
+            }
+            if (numEventsSent == configuration.reconnectAfterEvents) {
+                rememberSequenceNumber();
+                ++reconnectsRequested;
+                SendText(fd, "{\"op\":7,\"d\":null}");
+                SendClose(fd, 4000);
+                return;
+            }
+        }
+
+        // Wait for more frames or the next event, whichever comes first.
+        int timeout = -1;
+        if (
+            ready
+            && (configuration.eventsPerSecond > 0.0)
+        ) {
+            // Round up, so as not to spin while the next event
+            // is less than a millisecond away.
+            const auto microseconds = std::chrono::duration_cast< std::chrono::microseconds >(
+                nextEventTime - Clock::now()
+            ).count();
+            timeout = (
+                (microseconds > 0)
+                ? (int)((microseconds + 999) / 1000)
+                : 0
+            );
+        }
+        struct pollfd pollFd;
+        pollFd.fd = fd;
+        pollFd.events = POLLIN;
+        pollFd.revents = 0;
+        if (poll(&pollFd, 1, timeout) < 0) {
+            return;
+        }
+        if (pollFd.revents != 0) {
+            char chunk[65536];
+            const auto amountReceived = recv(fd, chunk, sizeof(chunk), 0);
+            if (amountReceived <= 0) {
+                return;
+            }
+            buffer.append(chunk, (size_t)amountReceived);
+        }
+    }
+}
+
+RedirectedConnections::RedirectedConnections(
+    const std::shared_ptr< Discord::Connections >& connections,
+    const std::string& baseUri
+)
+    : connections(connections)
+    , baseUri(baseUri)
+{
+}
+
+auto RedirectedConnections::QueueResourceRequest(
+    const ResourceRequest& request
+) -> ResourceRequestTransaction {
+    if (request.uri.compare(0, DISCORD_BASE_URI.length(), DISCORD_BASE_URI) != 0) {
+        return connections->QueueResourceRequest(request);
+    }
+    auto redirectedRequest = request;
+    redirectedRequest.uri = baseUri + request.uri.substr(DISCORD_BASE_URI.length());
+    return connections->QueueResourceRequest(std::move(redirectedRequest));
+}
+
+auto RedirectedConnections::QueueResourceRequest(
+    ResourceRequest&& request,
+    ResponseDelegate&& onResponse
+) -> CancelDelegate {
+    if (request.uri.compare(0, DISCORD_BASE_URI.length(), DISCORD_BASE_URI) == 0) {
+        request.uri = baseUri + request.uri.substr(DISCORD_BASE_URI.length());
+    }
+    return connections->QueueResourceRequest(
+        std::move(request),
+        std::move(onResponse)
+    );
+}
+
+auto RedirectedConnections::QueueWebSocketRequest(
+    const WebSocketRequest& request
+) -> WebSocketRequestTransaction {
+    return connections->QueueWebSocketRequest(request);
+}
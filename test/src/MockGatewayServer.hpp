@@ -0,0 +1,182 @@
+#pragma once
+
+/**
+ * @file MockGatewayServer.hpp
+ *
+ * This module declares a stand-in for Discord's gateway, listening on
+ * the loopback interface, which is used to load test many gateway
+ * sessions at once over real sockets.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "LoopbackServer.hpp"
+
+#include <atomic>
+#include <Discord/Connections.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <string>
+
+/**
+ * This speaks enough of Discord's gateway protocol to stand in for it:
+ * it answers the request for the gateway URL, greets each WebSocket with
+ * a "hello" message, acknowledges heartbeats, answers "identify" with
+ * "READY" followed by a burst of guilds, and answers "resume" with
+ * "RESUMED" (or "invalid session", for sessions it doesn't know).
+ *
+ * Once a session is ready, it's sent a steady stream of events at
+ * a configured rate.  Failures can be injected into each session after
+ * it has been sent a given number of events: asking the client to
+ * reconnect, or dropping the connection without a word.
+ *
+ * Each connection is served on a thread of its own.
+ */
+struct MockGatewayServer {
+    // Types
+
+    struct Configuration {
+        int heartbeatIntervalMilliseconds = 41250;
+
+        /**
+         * This is the number of GUILD_CREATE events sent to each session
+         * right after READY.
+         */
+        size_t guildsPerSession = 0;
+
+        /**
+         * This is the number of events per second sent to each session
+         * once it's ready.  If zero, no events are sent.
+         */
+        double eventsPerSecond = 0.0;
+
+        /**
+         * This is the name of the events sent to each session once
+         * it's ready.
+         */
+        std::string eventName = "MESSAGE_CREATE";
+
+        /**
+         * This is the length of the content of each event sent to
+         * each session once it's ready.
+         */
+        size_t eventContentLength = 64;
+
+        /**
+         * If this is not zero, each session is asked to reconnect
+         * (opcode 7), and then closed, once it has been sent this many
+         * events.
+         */
+        size_t reconnectAfterEvents = 0;
+
+        /**
+         * If this is not zero, the connection of each session is dropped,
+         * without a close frame, once it has been sent this many events.
+         */
+        size_t dropAfterEvents = 0;
+
+        /**
+         * If this is false, heartbeats aren't acknowledged, making
+         * the connections look like zombies to the clients.
+         */
+        bool ackHeartbeats = true;
+    };
+
+    struct Statistics {
+        size_t webSocketsOpened = 0;
+        size_t identifies = 0;
+        size_t resumes = 0;
+        size_t heartbeats = 0;
+        size_t eventsSent = 0;
+        size_t reconnectsRequested = 0;
+        size_t connectionsDropped = 0;
+    };
+
+    // Properties
+
+    Configuration configuration;
+    std::mutex mutex;
+
+    /**
+     * These are the last sequence numbers sent in each session,
+     * by session ID, so that sessions can be resumed.
+     */
+    std::map< std::string, int > sessions;
+
+    std::atomic< size_t > webSocketsOpened{0};
+    std::atomic< size_t > identifies{0};
+    std::atomic< size_t > resumes{0};
+    std::atomic< size_t > heartbeats{0};
+    std::atomic< size_t > eventsSent{0};
+    std::atomic< size_t > reconnectsRequested{0};
+    std::atomic< size_t > connectionsDropped{0};
+
+    /**
+     * This is declared last, so that it stops serving connections
+     * before anything they use is destroyed.
+     */
+    std::unique_ptr< LoopbackServer > server;
+
+    // Lifecycle
+
+    ~MockGatewayServer() = default;
+    MockGatewayServer(const MockGatewayServer&) = delete;
+    MockGatewayServer(MockGatewayServer&&) = delete;
+    MockGatewayServer& operator=(const MockGatewayServer&) = delete;
+    MockGatewayServer& operator=(MockGatewayServer&&) = delete;
+
+    // Methods
+
+    explicit MockGatewayServer(const Configuration& configuration);
+
+    /**
+     * Return the URL of the server, standing in for
+     * "https://discordapp.com".
+     */
+    std::string GetBaseUri() const;
+
+    Statistics GetStatistics() const;
+
+    void Serve(int fd);
+    void ServeSession(
+        int fd,
+        std::string& buffer
+    );
+};
+
+/**
+ * This wraps another set of connections, sending the requests meant for
+ * Discord's REST API to a mock gateway server instead.  WebSocket requests
+ * are passed through unchanged, since the server hands out its own
+ * gateway URL.
+ */
+struct RedirectedConnections
+    : public Discord::Connections
+{
+    // Properties
+
+    std::shared_ptr< Discord::Connections > connections;
+    std::string baseUri;
+
+    // Methods
+
+    RedirectedConnections(
+        const std::shared_ptr< Discord::Connections >& connections,
+        const std::string& baseUri
+    );
+
+    // Discord::Connections
+
+    virtual ResourceRequestTransaction QueueResourceRequest(
+        const ResourceRequest& request
+    ) override;
+    virtual CancelDelegate QueueResourceRequest(
+        ResourceRequest&& request,
+        ResponseDelegate&& onResponse
+    ) override;
+    virtual WebSocketRequestTransaction QueueWebSocketRequest(
+        const WebSocketRequest& request
+    ) override;
+};
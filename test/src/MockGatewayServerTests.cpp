@@ -0,0 +1,250 @@
+/**
+ * @file MockGatewayServerTests.cpp
+ *
+ * This module contains tests of the stand-in for Discord's gateway
+ * used to load test many gateway sessions at once, driving it with
+ * Discord::Gateway over Discord::SocketConnections.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+#include "MockGatewayServer.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <Discord/Gateway.hpp>
+#include <Discord/SocketConnections.hpp>
+#include <future>
+#include <gtest/gtest.h>
+#include <Json/Value.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <Timekeeping/Scheduler.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * This collects the texts received on a WebSocket, so that tests
+     * can wait for them.
+     */
+    struct ReceivedTexts {
+        std::condition_variable condition;
+        std::mutex mutex;
+        std::vector< std::string > texts;
+
+        void Register(Discord::WebSocket& webSocket) {
+            webSocket.RegisterTextCallback(
+                [this](std::string&& message){
+                    std::lock_guard< decltype(mutex) > lock(mutex);
+                    texts.push_back(std::move(message));
+                    condition.notify_all();
+                }
+            );
+        }
+
+        bool Await(size_t numTexts) {
+            std::unique_lock< decltype(mutex) > lock(mutex);
+            return condition.wait_for(
+                lock,
+                std::chrono::seconds(1),
+                [&]{ return texts.size() >= numTexts; }
+            );
+        }
+
+        Json::Value Get(size_t index) {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            return Json::Value::FromEncoding(texts[index]);
+        }
+    };
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct MockGatewayServerTests
+    : public ::testing::Test
+{
+    // Properties
+
+    MockGatewayServer::Configuration serverConfiguration;
+    std::unique_ptr< MockGatewayServer > server;
+    std::shared_ptr< Discord::SocketConnections > socketConnections = std::make_shared< Discord::SocketConnections >();
+    std::shared_ptr< Discord::Connections > connections;
+    std::shared_ptr< Timekeeping::Scheduler > scheduler = std::make_shared< Timekeeping::Scheduler >();
+    Discord::Gateway gateway;
+    std::condition_variable eventsReceivedCondition;
+    std::mutex mutex;
+    std::vector< Discord::Gateway::Event > receivedEvents;
+
+    // Methods
+
+    void StartServer() {
+        server.reset(new MockGatewayServer(serverConfiguration));
+        connections = std::make_shared< RedirectedConnections >(
+            socketConnections,
+            server->GetBaseUri()
+        );
+    }
+
+    bool AwaitEvents(size_t numEvents) {
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        return eventsReceivedCondition.wait_for(
+            lock,
+            std::chrono::seconds(1),
+            [&]{ return receivedEvents.size() >= numEvents; }
+        );
+    }
+
+    bool ConnectGateway() {
+        Discord::Gateway::Configuration configuration;
+        configuration.userAgent = "DiscordBot";
+        auto connected = gateway.Connect(connections, configuration);
+        return (
+            (
+                connected.wait_for(std::chrono::seconds(1))
+                == std::future_status::ready
+            )
+            && connected.get()
+        );
+    }
+
+    std::shared_ptr< Discord::WebSocket > OpenWebSocket() {
+        auto transaction = connections->QueueWebSocketRequest({
+            server->GetBaseUri().replace(0, 4, "ws") + "/?v=6&encoding=json"
+        });
+        if (
+            transaction.webSocket.wait_for(std::chrono::seconds(1))
+            != std::future_status::ready
+        ) {
+            return nullptr;
+        }
+        return transaction.webSocket.get();
+    }
+
+    // ::testing::Test
+
+    virtual void SetUp() override {
+        scheduler->SetClock(std::make_shared< SteadyClock >());
+        gateway.SetScheduler(scheduler);
+        gateway.RegisterEventCallback(
+            [this](Discord::Gateway::Event&& event){
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                receivedEvents.push_back(std::move(event));
+                eventsReceivedCondition.notify_all();
+            }
+        );
+    }
+
+    virtual void TearDown() override {
+        gateway.Disconnect();
+    }
+};
+
+TEST_F(MockGatewayServerTests, Gateway_Identifies_And_Receives_Ready_Burst) {
+    // Arrange
+    serverConfiguration.heartbeatIntervalMilliseconds = 50;
+    serverConfiguration.guildsPerSession = 3;
+    StartServer();
+
+    // Act
+    const auto connected = ConnectGateway();
+
+    // Assert
+    ASSERT_TRUE(connected);
+    ASSERT_TRUE(AwaitEvents(4));
+    EXPECT_EQ("READY", receivedEvents[0].name);
+    for (size_t i = 1; i < 4; ++i) {
+        EXPECT_EQ("GUILD_CREATE", receivedEvents[i].name);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    const auto statistics = server->GetStatistics();
+    EXPECT_EQ(1, statistics.webSocketsOpened);
+    EXPECT_EQ(1, statistics.identifies);
+    EXPECT_GE(statistics.heartbeats, 2);
+}
+
+TEST_F(MockGatewayServerTests, Session_Asked_To_Reconnect_After_Given_Number_Of_Events) {
+    // Arrange
+    serverConfiguration.eventsPerSecond = 1000.0;
+    serverConfiguration.reconnectAfterEvents = 5;
+    StartServer();
+    std::promise< void > closed;
+    gateway.RegisterCloseCallback(
+        [&]{
+            closed.set_value();
+        }
+    );
+
+    // Act
+    ASSERT_TRUE(ConnectGateway());
+
+    // Assert
+    ASSERT_EQ(
+        std::future_status::ready,
+        closed.get_future().wait_for(std::chrono::seconds(1))
+    );
+    ASSERT_TRUE(AwaitEvents(6));
+    EXPECT_EQ("READY", receivedEvents[0].name);
+    for (size_t i = 1; i < 6; ++i) {
+        EXPECT_EQ("MESSAGE_CREATE", receivedEvents[i].name);
+        EXPECT_EQ((int)i + 1, receivedEvents[i].sequenceNumber);
+    }
+    const auto statistics = server->GetStatistics();
+    EXPECT_EQ(5, statistics.eventsSent);
+    EXPECT_EQ(1, statistics.reconnectsRequested);
+}
+
+TEST_F(MockGatewayServerTests, Known_Sessions_Resumed_And_Unknown_Ones_Invalidated) {
+    // Arrange
+    StartServer();
+    const auto firstWebSocket = OpenWebSocket();
+    ASSERT_FALSE(firstWebSocket == nullptr);
+    ReceivedTexts firstTexts;
+    firstTexts.Register(*firstWebSocket);
+    ASSERT_TRUE(firstTexts.Await(1));
+    firstWebSocket->Text("{\"op\":2,\"d\":{\"token\":\"xyz\"}}");
+    ASSERT_TRUE(firstTexts.Await(2));
+    const std::string sessionId = firstTexts.Get(1)["d"]["session_id"];
+    firstWebSocket->Close(1000);
+    const auto secondWebSocket = OpenWebSocket();
+    ASSERT_FALSE(secondWebSocket == nullptr);
+    ReceivedTexts secondTexts;
+    secondTexts.Register(*secondWebSocket);
+    ASSERT_TRUE(secondTexts.Await(1));
+
+    // Act
+    secondWebSocket->Text(
+        Json::Object({
+            {"op", 6},
+            {"d", Json::Object({
+                {"token", "xyz"},
+                {"session_id", "bogus"},
+                {"seq", 1},
+            })},
+        }).ToEncoding()
+    );
+    secondWebSocket->Text(
+        Json::Object({
+            {"op", 6},
+            {"d", Json::Object({
+                {"token", "xyz"},
+                {"session_id", sessionId},
+                {"seq", 1},
+            })},
+        }).ToEncoding()
+    );
+
+    // Assert
+    ASSERT_TRUE(secondTexts.Await(3));
+    EXPECT_EQ(9, (int)secondTexts.Get(1)["op"]);
+    EXPECT_EQ("RESUMED", (std::string)secondTexts.Get(2)["t"]);
+    EXPECT_EQ(2, (int)secondTexts.Get(2)["s"]);
+    EXPECT_EQ(2, server->GetStatistics().resumes);
+    secondWebSocket->Close(1000);
+}
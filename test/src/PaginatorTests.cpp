@@ -0,0 +1,180 @@
+/**
+ * @file PaginatorTests.cpp
+ *
+ * This module contains unit tests of the Discord::Paginator class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+
+#include <chrono>
+#include <Discord/Paginator.hpp>
+#include <Discord/Rest.hpp>
+#include <future>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <Timekeeping/Scheduler.hpp>
+
+namespace {
+
+    const std::string MESSAGES_URI = "https://discordapp.com/api/v6/channels/1234/messages";
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct PaginatorTests
+    : public ::testing::Test
+{
+    // Properties
+
+    std::shared_ptr< MockConnections > connections = std::make_shared< MockConnections >();
+
+    // Methods
+
+    static bool IsReady(std::future< Discord::Paginator::Page >& page) {
+        return (
+            page.wait_for(std::chrono::milliseconds(100))
+            == std::future_status::ready
+        );
+    }
+
+    size_t GetNumRequestsMade() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::lock_guard< decltype(connections->mutex) > lock(connections->mutex);
+        return connections->resourceRequests.size();
+    }
+
+    Discord::Paginator::Configuration MakeConfiguration(
+        Discord::Paginator::Direction direction,
+        size_t limit
+    ) {
+        Discord::Paginator::Configuration configuration;
+        configuration.direction = direction;
+        configuration.limit = limit;
+        return configuration;
+    }
+
+    // ::testing::Test
+
+    virtual void TearDown() override {
+        connections->TearDown();
+    }
+};
+
+TEST_F(PaginatorTests, Next_Page_Read_Ahead_When_Page_Arrives) {
+    // Arrange
+    Discord::Paginator paginator(
+        connections,
+        {"GET", MESSAGES_URI},
+        MakeConfiguration(Discord::Paginator::Direction::Before, 2)
+    );
+
+    // Act
+    auto page = paginator.NextPage();
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    EXPECT_EQ(MESSAGES_URI + "?limit=2", connections->resourceRequests[0]->request.uri);
+    EXPECT_EQ(Discord::Connections::Priority::Normal, connections->resourceRequests[0]->request.priority);
+    connections->RespondToResourceRequest(0, {200, {}, "[{\"id\":\"30\"},{\"id\":\"20\"}]"});
+
+    // Assert
+    ASSERT_TRUE(IsReady(page));
+    const auto firstPage = page.get();
+    EXPECT_EQ(2, firstPage.items.GetSize());
+    EXPECT_FALSE(firstPage.last);
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    EXPECT_EQ(MESSAGES_URI + "?before=20&limit=2", connections->resourceRequests[1]->request.uri);
+    EXPECT_EQ(Discord::Connections::Priority::Background, connections->resourceRequests[1]->request.priority);
+}
+
+TEST_F(PaginatorTests, Short_Page_Is_Last) {
+    // Arrange
+    Discord::Paginator paginator(
+        connections,
+        {"GET", MESSAGES_URI},
+        MakeConfiguration(Discord::Paginator::Direction::Before, 2)
+    );
+    auto page = paginator.NextPage();
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+
+    // Act
+    connections->RespondToResourceRequest(0, {200, {}, "[{\"id\":\"30\"}]"});
+
+    // Assert
+    ASSERT_TRUE(IsReady(page));
+    EXPECT_TRUE(page.get().last);
+    EXPECT_EQ(1, GetNumRequestsMade());
+    auto afterLast = paginator.NextPage();
+    ASSERT_TRUE(IsReady(afterLast));
+    const auto emptyPage = afterLast.get();
+    EXPECT_TRUE(emptyPage.last);
+    EXPECT_EQ(0, emptyPage.items.GetSize());
+}
+
+TEST_F(PaginatorTests, After_Direction_Continues_From_Highest_Nested_Id) {
+    // Arrange
+    auto configuration = MakeConfiguration(Discord::Paginator::Direction::After, 2);
+    configuration.idField = "user.id";
+    configuration.start = "5";
+    Discord::Paginator paginator(
+        connections,
+        {"GET", "https://discordapp.com/api/v6/guilds/1234/members"},
+        configuration
+    );
+    auto page = paginator.NextPage();
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    EXPECT_EQ(
+        "https://discordapp.com/api/v6/guilds/1234/members?after=5&limit=2",
+        connections->resourceRequests[0]->request.uri
+    );
+
+    // Act
+    connections->RespondToResourceRequest(
+        0,
+        {200, {}, "[{\"user\":{\"id\":\"9\"}},{\"user\":{\"id\":\"10\"}}]"}
+    );
+
+    // Assert
+    ASSERT_TRUE(IsReady(page));
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    EXPECT_EQ(
+        "https://discordapp.com/api/v6/guilds/1234/members?after=10&limit=2",
+        connections->resourceRequests[1]->request.uri
+    );
+}
+
+TEST_F(PaginatorTests, Read_Ahead_Page_Asked_For_Shares_Request_Through_Rest) {
+    // Arrange
+    const auto clock = std::make_shared< MockClock >();
+    const auto scheduler = std::make_shared< Timekeeping::Scheduler >();
+    scheduler->SetClock(clock);
+    const auto rest = std::make_shared< Discord::Rest >(connections);
+    rest->SetScheduler(scheduler);
+    Discord::Paginator paginator(
+        rest,
+        {"GET", MESSAGES_URI},
+        MakeConfiguration(Discord::Paginator::Direction::Before, 1)
+    );
+    auto firstPage = paginator.NextPage();
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    connections->RespondToResourceRequest(0, {200, {}, "[{\"id\":\"30\"}]"});
+    ASSERT_TRUE(IsReady(firstPage));
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+
+    // Act
+    auto secondPage = paginator.NextPage();
+    const auto numRequestsMade = GetNumRequestsMade();
+    connections->RespondToResourceRequest(1, {200, {}, "[]"});
+
+    // Assert
+    EXPECT_EQ(2, numRequestsMade);
+    ASSERT_TRUE(IsReady(secondPage));
+    const auto page = secondPage.get();
+    EXPECT_EQ(200, page.status);
+    EXPECT_TRUE(page.last);
+}
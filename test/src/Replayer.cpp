@@ -0,0 +1,60 @@
+/**
+ * @file Replayer.cpp
+ *
+ * This module contains the implementation of the function used by the
+ * tests and benchmarks of the Discord library to play back captured
+ * WebSocket traffic.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Replayer.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+size_t Replay(
+    const Discord::Capture& capture,
+    size_t connection,
+    MockWebSocket& webSocket,
+    bool atRecordedSpeed
+) {
+    const auto start = std::chrono::steady_clock::now();
+    bool haveFirstFrame = false;
+    double firstFrameTime = 0.0;
+    size_t numFramesReplayed = 0;
+    for (const auto& frame: capture.frames) {
+        if (frame.connection != connection) {
+            continue;
+        }
+        if (!haveFirstFrame) {
+            haveFirstFrame = true;
+            firstFrameTime = frame.time;
+        }
+        if (atRecordedSpeed) {
+            std::this_thread::sleep_until(
+                start
+                + std::chrono::duration_cast< std::chrono::steady_clock::duration >(
+                    std::chrono::duration< double >(frame.time - firstFrameTime)
+                )
+            );
+        }
+        switch (frame.kind) {
+            case Discord::Capture::FrameKind::Text: {
+                webSocket.onText(std::string(frame.data));
+            } break;
+
+            case Discord::Capture::FrameKind::Close: {
+                webSocket.RemoteClose();
+            } break;
+
+            case Discord::Capture::FrameKind::Binary:
+            default: {
+                continue;
+            }
+        }
+        ++numFramesReplayed;
+    }
+    return numFramesReplayed;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+/**
+ * @file Replayer.hpp
+ *
+ * This module declares the function used by the tests and benchmarks
+ * of the Discord library to play back captured WebSocket traffic.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+
+#include <Discord/Capture.hpp>
+#include <stddef.h>
+
+/**
+ * Hand the frames received on one connection of the given capture
+ * to the callbacks registered with the given mock WebSocket, in order.
+ * Text frames are received as text, and a close frame as the remote end
+ * closing the WebSocket.  Binary frames are skipped, since the mock
+ * doesn't take a binary callback.
+ *
+ * @param[in] capture
+ *     This is the traffic to play back.
+ *
+ * @param[in] connection
+ *     This is the number of the connection in the capture whose frames
+ *     are played back.
+ *
+ * @param[in] webSocket
+ *     This is the WebSocket into which to play back the frames.
+ *
+ * @param[in] atRecordedSpeed
+ *     If true, each frame is held until the same time has passed
+ *     since the first frame as when it was recorded.  Otherwise,
+ *     frames are played back as fast as they're taken.
+ *
+ * @return
+ *     The number of frames played back is returned.
+ */
+size_t Replay(
+    const Discord::Capture& capture,
+    size_t connection,
+    MockWebSocket& webSocket,
+    bool atRecordedSpeed
+);
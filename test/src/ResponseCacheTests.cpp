@@ -0,0 +1,296 @@
+/**
+ * @file ResponseCacheTests.cpp
+ *
+ * This module contains unit tests of the Discord::ResponseCache class,
+ * and of the Discord::Rest and Discord::Gateway classes in using it.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+
+#include <chrono>
+#include <Discord/ResponseCache.hpp>
+#include <Discord/Rest.hpp>
+#include <future>
+#include <gtest/gtest.h>
+#include <Json/Value.hpp>
+#include <memory>
+#include <string>
+
+namespace {
+
+    const std::string ROLES_URI = "https://discordapp.com/api/v6/guilds/1234/roles";
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct ResponseCacheTests
+    : public CommonTextFixture
+{
+    // Properties
+
+    std::shared_ptr< Discord::ResponseCache > responseCache = std::make_shared< Discord::ResponseCache >(2);
+    std::shared_ptr< Discord::Rest > rest = std::make_shared< Discord::Rest >(connections);
+
+    // Methods
+
+    static bool IsReady(std::future< Discord::Connections::Response >& response) {
+        return (
+            response.wait_for(std::chrono::milliseconds(100))
+            == std::future_status::ready
+        );
+    }
+
+    void Remember(
+        const std::string& uri,
+        const std::string& body,
+        const std::string& entityTag = ""
+    ) {
+        Discord::Connections::Response response{200, {}, body};
+        if (!entityTag.empty()) {
+            response.headers.push_back({"ETag", entityTag});
+        }
+        (void)responseCache->Update({"GET", uri}, std::move(response), clock->currentTime);
+    }
+
+    // ::testing::Test
+
+    virtual void SetUp() override {
+        CommonTextFixture::SetUp();
+        responseCache->SetTimeToLive("GET /guilds/{id}/roles", 60.0);
+        responseCache->SetTimeToLive("GET /channels/{id}", 60.0);
+        rest->SetScheduler(scheduler);
+        rest->SetResponseCache(responseCache);
+    }
+};
+
+TEST_F(ResponseCacheTests, Response_Remembered_For_Time_To_Live) {
+    // Arrange
+    Remember(ROLES_URI, "[]");
+
+    // Act
+    clock->currentTime = 59.0;
+    const auto freshLookup = responseCache->Find({"GET", ROLES_URI}, clock->currentTime);
+    clock->currentTime = 60.0;
+    const auto expiredLookup = responseCache->Find({"GET", ROLES_URI}, clock->currentTime);
+
+    // Assert
+    EXPECT_EQ(Discord::ResponseCache::Freshness::Fresh, freshLookup.freshness);
+    EXPECT_EQ("[]", freshLookup.response.body);
+    EXPECT_EQ(Discord::ResponseCache::Freshness::Missing, expiredLookup.freshness);
+    const auto statistics = responseCache->GetStatistics();
+    EXPECT_EQ(1, statistics.hits);
+    EXPECT_EQ(1, statistics.misses);
+}
+
+TEST_F(ResponseCacheTests, Responses_Not_Remembered_For_Routes_Without_Time_To_Live) {
+    // Arrange
+    const std::string uri = "https://discordapp.com/api/v6/guilds/1234/members/5678";
+
+    // Act
+    Remember(uri, "{}");
+
+    // Assert
+    EXPECT_EQ(
+        Discord::ResponseCache::Freshness::Missing,
+        responseCache->Find({"GET", uri}, clock->currentTime).freshness
+    );
+}
+
+TEST_F(ResponseCacheTests, Least_Recently_Used_Response_Evicted_When_Full) {
+    // Arrange
+    Remember("https://discordapp.com/api/v6/channels/1", "1");
+    Remember("https://discordapp.com/api/v6/channels/2", "2");
+    (void)responseCache->Find({"GET", "https://discordapp.com/api/v6/channels/1"}, clock->currentTime);
+
+    // Act
+    Remember("https://discordapp.com/api/v6/channels/3", "3");
+
+    // Assert
+    EXPECT_EQ(
+        Discord::ResponseCache::Freshness::Fresh,
+        responseCache->Find({"GET", "https://discordapp.com/api/v6/channels/1"}, clock->currentTime).freshness
+    );
+    EXPECT_EQ(
+        Discord::ResponseCache::Freshness::Missing,
+        responseCache->Find({"GET", "https://discordapp.com/api/v6/channels/2"}, clock->currentTime).freshness
+    );
+    EXPECT_EQ(1, responseCache->GetStatistics().evictions);
+}
+
+TEST_F(ResponseCacheTests, Successful_Change_Invalidates_Resource_And_Collection) {
+    // Arrange
+    Remember(ROLES_URI, "[]");
+
+    // Act
+    (void)responseCache->Update(
+        {"PATCH", ROLES_URI + "/5678"},
+        {200, {}, "{}"},
+        clock->currentTime
+    );
+
+    // Assert
+    EXPECT_EQ(
+        Discord::ResponseCache::Freshness::Missing,
+        responseCache->Find({"GET", ROLES_URI}, clock->currentTime).freshness
+    );
+    EXPECT_EQ(1, responseCache->GetStatistics().invalidations);
+}
+
+TEST_F(ResponseCacheTests, Rest_Answers_Fresh_Request_From_Cache) {
+    // Arrange
+    Remember(ROLES_URI, "[{\"id\":\"1\"}]");
+
+    // Act
+    auto transaction = rest->QueueResourceRequest({"GET", ROLES_URI});
+
+    // Assert
+    ASSERT_TRUE(IsReady(transaction.response));
+    EXPECT_EQ("[{\"id\":\"1\"}]", transaction.response.get().body);
+    EXPECT_TRUE(connections->resourceRequests.empty());
+}
+
+TEST_F(ResponseCacheTests, Rest_Revalidates_Stale_Response_With_Entity_Tag) {
+    // Arrange
+    Remember(ROLES_URI, "[{\"id\":\"1\"}]", "\"abc\"");
+    clock->currentTime = 61.0;
+
+    // Act
+    auto transaction = rest->QueueResourceRequest({"GET", ROLES_URI});
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    ExpectHeaders(
+        {{"If-None-Match", "\"abc\""}},
+        connections->resourceRequests[0]->request.headers
+    );
+    connections->RespondToResourceRequest(0, {304, {}, ""});
+
+    // Assert
+    ASSERT_TRUE(IsReady(transaction.response));
+    const auto response = transaction.response.get();
+    EXPECT_EQ(200, response.status);
+    EXPECT_EQ("[{\"id\":\"1\"}]", response.body);
+    EXPECT_EQ(1, responseCache->GetStatistics().revalidations);
+    EXPECT_EQ(
+        Discord::ResponseCache::Freshness::Fresh,
+        responseCache->Find({"GET", ROLES_URI}, clock->currentTime).freshness
+    );
+}
+
+TEST_F(ResponseCacheTests, Gateway_Event_Invalidates_Changed_Resources) {
+    // Arrange
+    Remember(ROLES_URI, "[]");
+    Remember("https://discordapp.com/api/v6/channels/5678", "{}");
+    gateway.SetResponseCache(responseCache);
+    std::promise< void > eventReceived;
+    gateway.RegisterEventCallback(
+        [&](Discord::Gateway::Event&& event){
+            eventReceived.set_value();
+        }
+    );
+    ASSERT_TRUE(Connect(configuration));
+
+    // Act
+    SendDispatch(
+        "GUILD_ROLE_UPDATE",
+        1,
+        Json::Object({
+            {"guild_id", "1234"},
+            {"role", Json::Object({
+                {"id", "42"},
+            })},
+        })
+    );
+
+    // Assert
+    ASSERT_EQ(
+        std::future_status::ready,
+        eventReceived.get_future().wait_for(std::chrono::milliseconds(100))
+    );
+    EXPECT_EQ(
+        Discord::ResponseCache::Freshness::Missing,
+        responseCache->Find({"GET", ROLES_URI}, clock->currentTime).freshness
+    );
+    EXPECT_EQ(
+        Discord::ResponseCache::Freshness::Fresh,
+        responseCache->Find({"GET", "https://discordapp.com/api/v6/channels/5678"}, clock->currentTime).freshness
+    );
+}
+
+TEST_F(ResponseCacheTests, Invalidating_Subpaths_Leaves_Sibling_Paths_Alone) {
+    // Arrange
+    responseCache = std::make_shared< Discord::ResponseCache >(10);
+    responseCache->SetTimeToLive("GET /channels/{id}", 60.0);
+    responseCache->SetTimeToLive("GET /channels/{id}/messages", 60.0);
+    Remember("https://discordapp.com/api/v6/channels/5678", "{}");
+    Remember("https://discordapp.com/api/v6/channels/5678/messages", "[]");
+    Remember("https://discordapp.com/api/v6/channels/5678/messages?limit=5", "[]");
+    Remember("https://discordapp.com/api/v6/channels/56789", "{}");
+    Remember("https://discordapp.com/api/v6/channels/56789/messages", "[]");
+
+    // Act
+    responseCache->Invalidate("/channels/5678", true);
+
+    // Assert
+    for (const auto& uri: {
+        "https://discordapp.com/api/v6/channels/5678",
+        "https://discordapp.com/api/v6/channels/5678/messages",
+        "https://discordapp.com/api/v6/channels/5678/messages?limit=5",
+    }) {
+        EXPECT_EQ(
+            Discord::ResponseCache::Freshness::Missing,
+            responseCache->Find({"GET", uri}, clock->currentTime).freshness
+        ) << uri;
+    }
+    for (const auto& uri: {
+        "https://discordapp.com/api/v6/channels/56789",
+        "https://discordapp.com/api/v6/channels/56789/messages",
+    }) {
+        EXPECT_EQ(
+            Discord::ResponseCache::Freshness::Fresh,
+            responseCache->Find({"GET", uri}, clock->currentTime).freshness
+        ) << uri;
+    }
+    EXPECT_EQ(3, responseCache->GetStatistics().invalidations);
+}
+
+TEST_F(ResponseCacheTests, Rest_Asks_Again_If_Revalidated_Response_Gone_From_Cache) {
+    // Arrange
+    Remember(ROLES_URI, "[{\"id\":\"1\"}]", "\"abc\"");
+    clock->currentTime = 61.0;
+    auto transaction = rest->QueueResourceRequest({"GET", ROLES_URI});
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    responseCache->Invalidate("/guilds/1234/roles", false);
+
+    // Act
+    connections->RespondToResourceRequest(0, {304, {}, ""});
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    EXPECT_FALSE(connections->resourceRequests[1]->request.headers.Has("If-None-Match"));
+    connections->RespondToResourceRequest(1, {200, {}, "[{\"id\":\"2\"}]"});
+
+    // Assert
+    ASSERT_TRUE(IsReady(transaction.response));
+    const auto response = transaction.response.get();
+    EXPECT_EQ(200, response.status);
+    EXPECT_EQ("[{\"id\":\"2\"}]", response.body);
+}
+
+TEST_F(ResponseCacheTests, Rest_Returns_Not_Modified_To_Caller_Who_Asked_For_It) {
+    // Arrange
+    responseCache->SetTimeToLive("GET /guilds/{id}/roles", 0.0);
+    Discord::Connections::ResourceRequest request{"GET", ROLES_URI};
+    request.headers.push_back({"If-None-Match", "\"abc\""});
+
+    // Act
+    auto transaction = rest->QueueResourceRequest(request);
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    connections->RespondToResourceRequest(0, {304, {}, ""});
+
+    // Assert
+    ASSERT_TRUE(IsReady(transaction.response));
+    EXPECT_EQ(304, transaction.response.get().status);
+    EXPECT_EQ(1, connections->resourceRequests.size());
+}
@@ -0,0 +1,553 @@
+/**
+ * @file RestTests.cpp
+ *
+ * This module contains unit tests of the Discord::Rest class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+
+#include <chrono>
+#include <Discord/Rest.hpp>
+#include <future>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <Timekeeping/Scheduler.hpp>
+#include <vector>
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct RestTests
+    : public ::testing::Test
+{
+    // Properties
+
+    std::shared_ptr< MockClock > clock = std::make_shared< MockClock >();
+    std::shared_ptr< MockConnections > connections = std::make_shared< MockConnections >();
+    std::shared_ptr< Timekeeping::Scheduler > scheduler = std::make_shared< Timekeeping::Scheduler >();
+    std::shared_ptr< Discord::Rest > rest = std::make_shared< Discord::Rest >(connections);
+
+    // Methods
+
+    static bool IsReady(std::future< Discord::Connections::Response >& response) {
+        return (
+            response.wait_for(std::chrono::milliseconds(100))
+            == std::future_status::ready
+        );
+    }
+
+    size_t GetNumRequestsMade() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::lock_guard< decltype(connections->mutex) > lock(connections->mutex);
+        return connections->resourceRequests.size();
+    }
+
+    void AdvanceTo(double time) {
+        clock->currentTime = time;
+        scheduler->WakeUp();
+    }
+
+    Discord::Connections::ResourceRequestTransaction Get(const std::string& path) {
+        return rest->QueueResourceRequest({
+            "GET",
+            "https://discordapp.com/api/v6" + path,
+        });
+    }
+
+    void Respond(
+        size_t requestIndex,
+        unsigned int status,
+        const std::string& bucketHash,
+        int remaining,
+        double resetAfter
+    ) {
+        connections->RespondToResourceRequest(requestIndex, {
+            status,
+            {
+                {"X-RateLimit-Bucket", bucketHash},
+                {"X-RateLimit-Limit", "5"},
+                {"X-RateLimit-Remaining", std::to_string(remaining)},
+                {"X-RateLimit-Reset-After", std::to_string(resetAfter)},
+            },
+            "{}",
+        });
+    }
+
+    // ::testing::Test
+
+    virtual void SetUp() override {
+        scheduler->SetClock(clock);
+        rest->SetScheduler(scheduler);
+    }
+
+    virtual void TearDown() override {
+        connections->TearDown();
+    }
+};
+
+TEST_F(RestTests, Route_Keeps_Major_Parameter_Only) {
+    EXPECT_EQ(
+        "GET /channels/1234/messages/{id}",
+        Discord::Rest::GetRoute({"GET", "https://discordapp.com/api/v6/channels/1234/messages/5678?limit=5"})
+    );
+    EXPECT_EQ(
+        "PUT /guilds/1234/members/{id}/roles/{id}",
+        Discord::Rest::GetRoute({"PUT", "https://discordapp.com/api/guilds/1234/members/5678/roles/9012"})
+    );
+    EXPECT_EQ(
+        "POST /webhooks/1234/token",
+        Discord::Rest::GetRoute({"POST", "https://discordapp.com/api/v6/webhooks/1234/token"})
+    );
+    EXPECT_EQ(
+        "PUT /channels/1234/messages/{id}/reactions/{emoji}/@me",
+        Discord::Rest::GetRoute({"PUT", "https://discordapp.com/api/v6/channels/1234/messages/5678/reactions/%F0%9F%91%8D/@me"})
+    );
+    EXPECT_EQ(
+        "GET /users/{id}",
+        Discord::Rest::GetRoute({"GET", "https://discordapp.com/api/v6/users/1234"})
+    );
+}
+
+TEST_F(RestTests, One_Request_At_A_Time_Until_Limits_Known) {
+    // Arrange
+    auto first = Get("/channels/1234/messages/1");
+    auto second = Get("/channels/1234/messages/2");
+    auto third = Get("/channels/1234/messages/3");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    const auto numRequestsBeforeLimitsKnown = GetNumRequestsMade();
+
+    // Act
+    Respond(0, 200, "abcd", 4, 1.0);
+
+    // Assert
+    EXPECT_EQ(1, numRequestsBeforeLimitsKnown);
+    ASSERT_TRUE(connections->RequireResourceRequests(3));
+    ASSERT_TRUE(IsReady(first.response));
+    EXPECT_EQ(200, first.response.get().status);
+}
+
+TEST_F(RestTests, Requests_Held_Until_Bucket_Resets) {
+    // Arrange
+    auto first = Get("/channels/1234/messages/1");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    Respond(0, 200, "abcd", 0, 2.0);
+    ASSERT_TRUE(IsReady(first.response));
+    auto second = Get("/channels/1234/messages/2");
+
+    // Act
+    AdvanceTo(1.999);
+    const auto numRequestsBeforeReset = GetNumRequestsMade();
+    AdvanceTo(2.0);
+
+    // Assert
+    EXPECT_EQ(1, numRequestsBeforeReset);
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    EXPECT_EQ(
+        "https://discordapp.com/api/v6/channels/1234/messages/2",
+        connections->resourceRequests[1]->request.uri
+    );
+}
+
+TEST_F(RestTests, Rate_Limited_Request_Made_Again_After_Reset) {
+    // Arrange
+    auto first = Get("/channels/1234/messages/1");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+
+    // Act
+    connections->RespondToResourceRequest(0, {
+        429,
+        {
+            {"Retry-After", "1"},
+        },
+        "{}",
+    });
+    const auto respondedBeforeRetry = IsReady(first.response);
+    AdvanceTo(1.0);
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    Respond(1, 200, "abcd", 4, 1.0);
+
+    // Assert
+    EXPECT_FALSE(respondedBeforeRetry);
+    ASSERT_TRUE(IsReady(first.response));
+    EXPECT_EQ(200, first.response.get().status);
+}
+
+TEST_F(RestTests, Routes_Reported_In_Same_Bucket_Share_Limits) {
+    // Arrange
+    auto first = Get("/channels/1234/messages/1");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    Respond(0, 200, "abcd", 1, 5.0);
+    auto second = rest->QueueResourceRequest({
+        "DELETE",
+        "https://discordapp.com/api/v6/channels/1234/messages/2",
+    });
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    Respond(1, 200, "abcd", 0, 5.0);
+    ASSERT_TRUE(IsReady(second.response));
+
+    // Act
+    auto third = rest->QueueResourceRequest({
+        "DELETE",
+        "https://discordapp.com/api/v6/channels/1234/messages/3",
+    });
+    auto fourth = Get("/channels/1234/messages/4");
+
+    // Assert
+    EXPECT_EQ(2, GetNumRequestsMade());
+    AdvanceTo(5.0);
+    EXPECT_TRUE(connections->RequireResourceRequests(4));
+}
+
+TEST_F(RestTests, Different_Major_Parameters_Limited_Separately) {
+    // Arrange
+    auto first = Get("/channels/1234/messages/1");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    Respond(0, 200, "abcd", 0, 5.0);
+
+    // Act
+    auto second = Get("/channels/5678/messages/1");
+
+    // Assert
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+}
+
+TEST_F(RestTests, Canceled_Request_Never_Made) {
+    // Arrange
+    auto first = Get("/channels/1234/messages/1");
+    auto second = Get("/channels/1234/messages/2");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+
+    // Act
+    second.cancel();
+    Respond(0, 200, "abcd", 4, 1.0);
+
+    // Assert
+    ASSERT_TRUE(IsReady(second.response));
+    EXPECT_EQ(499, second.response.get().status);
+    EXPECT_EQ(1, GetNumRequestsMade());
+}
+
+TEST_F(RestTests, Routes_Without_Rate_Limits_Not_Held_Back) {
+    // Arrange
+    auto first = Get("/gateway");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    connections->RespondToResourceRequest(0, {200, {}, "{}"});
+    ASSERT_TRUE(IsReady(first.response));
+
+    // Act
+    auto second = Get("/gateway?a=1");
+    auto third = Get("/gateway?a=2");
+
+    // Assert
+    EXPECT_TRUE(connections->RequireResourceRequests(3));
+}
+
+TEST_F(RestTests, Global_Rate_Limit_Pauses_All_Routes) {
+    // Arrange
+    auto first = Get("/channels/1234/messages/1");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+
+    // Act
+    connections->RespondToResourceRequest(0, {
+        429,
+        {
+            {"Retry-After", "3"},
+            {"X-RateLimit-Global", "true"},
+        },
+        "{}",
+    });
+    const auto numRequestsAfterRateLimited = GetNumRequestsMade();
+    auto second = Get("/guilds/5678");
+    AdvanceTo(2.9);
+    const auto numRequestsDuringPause = GetNumRequestsMade();
+    AdvanceTo(3.0);
+
+    // Assert
+    EXPECT_EQ(1, numRequestsAfterRateLimited);
+    EXPECT_EQ(1, numRequestsDuringPause);
+    EXPECT_TRUE(connections->RequireResourceRequests(3));
+}
+
+TEST_F(RestTests, Global_Rate_Limiter_Shared_By_Clients) {
+    // Arrange
+    const auto globalRateLimiter = std::make_shared< Discord::GlobalRateLimiter >(1.0, 1);
+    const auto otherRest = std::make_shared< Discord::Rest >(connections);
+    otherRest->SetScheduler(scheduler);
+    rest->SetGlobalRateLimiter(globalRateLimiter);
+    otherRest->SetGlobalRateLimiter(globalRateLimiter);
+
+    // Act
+    auto first = Get("/channels/1234/messages/1");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    auto second = otherRest->QueueResourceRequest({
+        "GET",
+        "https://discordapp.com/api/v6/guilds/5678",
+    });
+    const auto numRequestsBeforeInterval = GetNumRequestsMade();
+    AdvanceTo(1.0);
+
+    // Assert
+    EXPECT_EQ(1, numRequestsBeforeInterval);
+    EXPECT_TRUE(connections->RequireResourceRequests(2));
+}
+
+TEST_F(RestTests, Identical_Gets_In_Progress_Share_One_Request) {
+    // Arrange
+    auto first = Get("/channels/1234");
+    auto second = Get("/channels/1234");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+
+    // Act
+    connections->RespondToResourceRequest(0, {200, {}, "{\"id\":\"1234\"}"});
+
+    // Assert
+    ASSERT_TRUE(IsReady(first.response));
+    ASSERT_TRUE(IsReady(second.response));
+    EXPECT_EQ("{\"id\":\"1234\"}", first.response.get().body);
+    EXPECT_EQ("{\"id\":\"1234\"}", second.response.get().body);
+    EXPECT_EQ(1, GetNumRequestsMade());
+    auto third = Get("/channels/1234");
+    EXPECT_TRUE(connections->RequireResourceRequests(2));
+}
+
+TEST_F(RestTests, Gets_With_Different_Headers_Or_Other_Methods_Not_Shared) {
+    // Arrange
+    auto earlier = rest->QueueResourceRequest({
+        "GET",
+        "https://discordapp.com/api/v6/users/@me",
+        {{"Authorization", "Bot a"}},
+    });
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    connections->RespondToResourceRequest(0, {200, {}, "{}"});
+    ASSERT_TRUE(IsReady(earlier.response));
+
+    // Act
+    auto first = rest->QueueResourceRequest({
+        "GET",
+        "https://discordapp.com/api/v6/users/@me",
+        {{"Authorization", "Bot a"}},
+    });
+    auto second = rest->QueueResourceRequest({
+        "GET",
+        "https://discordapp.com/api/v6/users/@me",
+        {{"Authorization", "Bot b"}},
+    });
+    auto third = rest->QueueResourceRequest({
+        "POST",
+        "https://discordapp.com/api/v6/users/@me",
+        {{"Authorization", "Bot a"}},
+    });
+
+    // Assert
+    EXPECT_TRUE(connections->RequireResourceRequests(4));
+}
+
+TEST_F(RestTests, Shared_Get_Canceled_Only_Once_All_Callers_Cancel) {
+    // Arrange
+    auto first = Get("/channels/1234");
+    auto second = Get("/channels/1234");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    auto requestCanceled = connections->resourceRequests[0]->canceled.get_future();
+
+    // Act
+    first.cancel();
+    const auto canceledAfterFirst = (
+        requestCanceled.wait_for(std::chrono::milliseconds(0))
+        == std::future_status::ready
+    );
+    second.cancel();
+    const auto canceledAfterSecond = (
+        requestCanceled.wait_for(std::chrono::milliseconds(0))
+        == std::future_status::ready
+    );
+
+    // Assert
+    ASSERT_TRUE(IsReady(first.response));
+    EXPECT_EQ(499, first.response.get().status);
+    ASSERT_TRUE(IsReady(second.response));
+    EXPECT_EQ(499, second.response.get().status);
+    EXPECT_FALSE(canceledAfterFirst);
+    EXPECT_TRUE(canceledAfterSecond);
+}
+
+TEST_F(RestTests, Shared_Get_Still_Answered_After_One_Caller_Cancels) {
+    // Arrange
+    auto first = Get("/channels/1234");
+    auto second = Get("/channels/1234");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+
+    // Act
+    first.cancel();
+    connections->RespondToResourceRequest(0, {200, {}, "{}"});
+
+    // Assert
+    ASSERT_TRUE(IsReady(second.response));
+    EXPECT_EQ(200, second.response.get().status);
+}
+
+TEST_F(RestTests, Requests_Taken_In_Proportion_To_Priority) {
+    // Arrange
+    auto first = Get("/channels/1234/messages/0");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    connections->RespondToResourceRequest(0, {
+        200,
+        {
+            {"X-RateLimit-Bucket", "abcd"},
+            {"X-RateLimit-Limit", "8"},
+            {"X-RateLimit-Remaining", "0"},
+            {"X-RateLimit-Reset-After", "1"},
+        },
+        "{}",
+    });
+    ASSERT_TRUE(IsReady(first.response));
+    std::vector< Discord::Connections::ResourceRequestTransaction > transactions;
+    const std::vector< std::pair< std::string, Discord::Connections::Priority > > priorities = {
+        {"b", Discord::Connections::Priority::Background},
+        {"n", Discord::Connections::Priority::Normal},
+        {"i", Discord::Connections::Priority::Interactive},
+    };
+    for (size_t i = 0; i < 7; ++i) {
+        for (const auto& priority: priorities) {
+            transactions.push_back(
+                rest->QueueResourceRequest({
+                    "GET",
+                    "https://discordapp.com/api/v6/channels/1234/messages/" + std::to_string(i + 1) + "?p=" + priority.first,
+                    {},
+                    "",
+                    priority.second,
+                })
+            );
+        }
+    }
+
+    // Act
+    AdvanceTo(1.0);
+
+    // Assert
+    ASSERT_TRUE(connections->RequireResourceRequests(8));
+    std::string order;
+    for (size_t i = 1; i < 8; ++i) {
+        order += connections->resourceRequests[i]->request.uri.back();
+    }
+    EXPECT_EQ("nibinii", order);
+}
+
+TEST_F(RestTests, Background_Requests_Leave_Last_Request_Of_Window) {
+    // Arrange
+    auto first = Get("/channels/1234/messages/0");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    Respond(0, 200, "abcd", 1, 5.0);
+    ASSERT_TRUE(IsReady(first.response));
+
+    // Act
+    auto background = rest->QueueResourceRequest({
+        "GET",
+        "https://discordapp.com/api/v6/channels/1234/messages/1",
+        {},
+        "",
+        Discord::Connections::Priority::Background,
+    });
+    const auto numRequestsAfterBackground = GetNumRequestsMade();
+    auto interactive = rest->QueueResourceRequest({
+        "GET",
+        "https://discordapp.com/api/v6/channels/1234/messages/2",
+        {},
+        "",
+        Discord::Connections::Priority::Interactive,
+    });
+
+    // Assert
+    EXPECT_EQ(1, numRequestsAfterBackground);
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    EXPECT_EQ(
+        "https://discordapp.com/api/v6/channels/1234/messages/2",
+        connections->resourceRequests[1]->request.uri
+    );
+    AdvanceTo(5.0);
+    EXPECT_TRUE(connections->RequireResourceRequests(3));
+}
+
+TEST_F(RestTests, Queue_Delays_Reported_Per_Priority) {
+    // Arrange
+    auto first = Get("/channels/1234/messages/0");
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    Respond(0, 200, "abcd", 0, 2.0);
+    ASSERT_TRUE(IsReady(first.response));
+
+    // Act
+    auto interactive = rest->QueueResourceRequest({
+        "GET",
+        "https://discordapp.com/api/v6/channels/1234/messages/1",
+        {},
+        "",
+        Discord::Connections::Priority::Interactive,
+    });
+    AdvanceTo(2.0);
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+
+    // Assert
+    const auto interactiveDelays = rest->GetQueueDelayStatistics(Discord::Connections::Priority::Interactive);
+    EXPECT_EQ(1, interactiveDelays.numRequests);
+    EXPECT_DOUBLE_EQ(2.0, interactiveDelays.maxDelay);
+    EXPECT_DOUBLE_EQ(2.0, interactiveDelays.totalDelay);
+    const auto normalDelays = rest->GetQueueDelayStatistics(Discord::Connections::Priority::Normal);
+    EXPECT_EQ(1, normalDelays.numRequests);
+    EXPECT_DOUBLE_EQ(0.0, normalDelays.maxDelay);
+}
+
+TEST_F(RestTests, Large_Body_Shared_And_Made_Again_When_Rate_Limited) {
+    // Arrange
+    const std::string body(100000, 'x');
+    Discord::Connections::ResourceRequest request{
+        "POST",
+        "https://discordapp.com/api/v6/channels/1234/messages",
+        {{"Content-Type", "application/json"}},
+        body,
+    };
+    auto transaction = rest->QueueResourceRequest(std::move(request));
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    const auto& firstRequest = connections->resourceRequests[0]->request;
+    EXPECT_EQ(body, firstRequest.GetBody());
+    EXPECT_EQ("application/json", firstRequest.headers.Get("content-type"));
+
+    // Act
+    connections->RespondToResourceRequest(0, {429, {{"Retry-After", "1"}}, "{}"});
+    AdvanceTo(2.0);
+
+    // Assert
+    ASSERT_TRUE(connections->RequireResourceRequests(2));
+    const auto& retriedRequest = connections->resourceRequests[1]->request;
+    EXPECT_EQ(body, retriedRequest.GetBody());
+    EXPECT_EQ(firstRequest.sharedBody, retriedRequest.sharedBody);
+    connections->RespondToResourceRequest(1, {200, {}, "{}"});
+    ASSERT_TRUE(IsReady(transaction.response));
+    EXPECT_EQ(200, transaction.response.get().status);
+}
+
+TEST_F(RestTests, Requests_Are_Normal_Priority_Unless_Given_One) {
+    // Arrange
+    Discord::Connections::ResourceRequest declared;
+    Discord::Connections::ResourceRequest braced{
+        "GET",
+        "https://discordapp.com/api/v6/channels/1234/messages/0",
+    };
+
+    // Act
+    auto transaction = rest->QueueResourceRequest(std::move(braced));
+
+    // Assert
+    EXPECT_EQ(Discord::Connections::Priority::Normal, declared.priority);
+    ASSERT_TRUE(connections->RequireResourceRequests(1));
+    EXPECT_EQ(
+        Discord::Connections::Priority::Normal,
+        connections->resourceRequests[0]->request.priority
+    );
+    EXPECT_EQ(1, rest->GetQueueDelayStatistics(Discord::Connections::Priority::Normal).numRequests);
+    Respond(0, 200, "abcd", 4, 5.0);
+    EXPECT_TRUE(IsReady(transaction.response));
+}
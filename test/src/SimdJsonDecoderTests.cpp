@@ -0,0 +1,285 @@
+/**
+ * @file SimdJsonDecoderTests.cpp
+ *
+ * This module contains the unit tests of the
+ * Discord::SimdJsonDecoder class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include <Discord/SimdJsonDecoder.hpp>
+#include <gtest/gtest.h>
+#include <Json/Value.hpp>
+#include <memory>
+#include <random>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * Return a decoder for each kernel there is.
+     */
+    std::vector< std::shared_ptr< Discord::SimdJsonDecoder > > MakeDecoders() {
+        return {
+            std::make_shared< Discord::SimdJsonDecoder >(Discord::SimdJsonDecoder::Kernel::Vector),
+            std::make_shared< Discord::SimdJsonDecoder >(Discord::SimdJsonDecoder::Kernel::Scalar),
+        };
+    }
+
+    /**
+     * This makes up random JSON text, with random whitespace, escapes,
+     * and characters which aren't ASCII, to compare decoders.
+     */
+    struct RandomJsonWriter {
+        // Properties
+
+        std::mt19937 generator;
+        std::string encoding;
+
+        // Methods
+
+        explicit RandomJsonWriter(unsigned int seed)
+            : generator(seed)
+        {
+        }
+
+        size_t Pick(size_t numChoices) {
+            return std::uniform_int_distribution< size_t >(0, numChoices - 1)(generator);
+        }
+
+        void WriteWhitespace() {
+            static const char* const whitespace[] = {"", "", "", " ", "\n", "\r\n\t  "};
+            encoding += whitespace[Pick(6)];
+        }
+
+        void WriteString() {
+            static const char* const pieces[] = {
+                "a", "Frog", " ", "\\\"", "\\\\", "\\/", "\\n", "\\t", "\\u00e9",
+                "\\u263A", "\xC3\xA9", "\xE2\x98\xBA", "{", "]", ",", ":",
+            };
+            encoding += '"';
+            const auto length = Pick(12);
+            for (size_t i = 0; i < length; ++i) {
+                encoding += pieces[Pick(16)];
+            }
+            encoding += '"';
+        }
+
+        void WriteValue(size_t depth) {
+            WriteWhitespace();
+            switch (Pick((depth < 4) ? 8 : 6)) {
+                case 0: encoding += "null"; break;
+                case 1: encoding += (Pick(2) ? "true" : "false"); break;
+                case 2: encoding += std::to_string((int)Pick(2000000) - 1000000); break;
+                case 3: encoding += "-12.5e-3"; break;
+                case 4:
+                case 5: WriteString(); break;
+
+                case 6: {
+                    encoding += '[';
+                    const auto numElements = Pick(5);
+                    for (size_t i = 0; i < numElements; ++i) {
+                        if (i > 0) {
+                            encoding += ',';
+                        }
+                        WriteValue(depth + 1);
+                    }
+                    WriteWhitespace();
+                    encoding += ']';
+                } break;
+
+                default: {
+                    encoding += '{';
+                    const auto numMembers = Pick(5);
+                    for (size_t i = 0; i < numMembers; ++i) {
+                        if (i > 0) {
+                            encoding += ',';
+                        }
+                        WriteWhitespace();
+                        encoding += "\"k" + std::to_string(i) + "\"";
+                        WriteWhitespace();
+                        encoding += ':';
+                        WriteValue(depth + 1);
+                    }
+                    WriteWhitespace();
+                    encoding += '}';
+                } break;
+            }
+            WriteWhitespace();
+        }
+    };
+
+}
+
+TEST(SimdJsonDecoderTests, Kernel_Reported) {
+    // Arrange
+    const Discord::SimdJsonDecoder vectorDecoder(Discord::SimdJsonDecoder::Kernel::Vector);
+    const Discord::SimdJsonDecoder scalarDecoder(Discord::SimdJsonDecoder::Kernel::Scalar);
+
+    // Act
+    const auto vectorKernel = vectorDecoder.GetKernel();
+    const auto scalarKernel = scalarDecoder.GetKernel();
+
+    // Assert
+    EXPECT_EQ(
+        (
+            Discord::SimdJsonDecoder::IsVectorKernelAvailable()
+            ? Discord::SimdJsonDecoder::Kernel::Vector
+            : Discord::SimdJsonDecoder::Kernel::Scalar
+        ),
+        vectorKernel
+    );
+    EXPECT_EQ(Discord::SimdJsonDecoder::Kernel::Scalar, scalarKernel);
+}
+
+TEST(SimdJsonDecoderTests, Decode_Gateway_Messages) {
+    // Arrange
+    const std::vector< std::string > encodings{
+        "{\"op\":10,\"d\":{\"heartbeat_interval\":41250,\"_trace\":[\"gateway-prd-main-abcd\"]}}",
+        "{\"t\":null,\"s\":null,\"op\":11,\"d\":null}",
+        "{\"t\":\"MESSAGE_CREATE\",\"s\":42,\"op\":0,\"d\":{\"id\":\"700000001\",\"channel_id\":\"200\",\"content\":\"Hello, World!\",\"tts\":false,\"pinned\":true,\"embeds\":[],\"mentions\":[{\"id\":\"1000\"}],\"nonce\":-12345}}",
+        "  [ 1 , -0 , 0.5 , 1e3 , 2.5E-2 , -7.25e+1 , \"\" , { } , [ ] ]\r\n",
+        "\"just a string\"",
+        "12345",
+        "true",
+    };
+
+    // Act & Assert
+    for (const auto& decoder: MakeDecoders()) {
+        for (const auto& encoding: encodings) {
+            const auto value = decoder->Decode(encoding);
+            EXPECT_NE(Json::Value::Type::Invalid, value.GetType()) << encoding;
+            EXPECT_EQ(Json::Value::FromEncoding(encoding), value) << encoding;
+        }
+    }
+}
+
+TEST(SimdJsonDecoderTests, Decode_Escapes_Straddling_Blocks) {
+    // Try runs of backslashes and quotation marks at every position
+    // around the boundaries of the 64-byte blocks the decoder scans.
+    for (const auto& decoder: MakeDecoders()) {
+        for (size_t numBackslashes = 1; numBackslashes <= 5; ++numBackslashes) {
+            for (size_t offset = 0; offset < 140; ++offset) {
+                // Arrange
+                const auto text = (
+                    std::string(offset, 'x')
+                    + std::string(numBackslashes, '\\')
+                    + "\"]"
+                );
+                const auto expected = Json::Array({text, "after"});
+                const auto encoding = expected.ToEncoding();
+
+                // Act
+                const auto value = decoder->Decode(encoding);
+
+                // Assert
+                EXPECT_EQ(expected, value) << encoding;
+            }
+        }
+    }
+}
+
+TEST(SimdJsonDecoderTests, Decode_Unicode) {
+    // Arrange
+    const std::string encoding = (
+        "[\"\\u00e9\\u263a\\ud83d\\ude00\","
+        "\"\xC3\xA9\xE2\x98\xBA\xF0\x9F\x98\x80\"]"
+    );
+
+    // Act & Assert
+    for (const auto& decoder: MakeDecoders()) {
+        EXPECT_EQ(
+            Json::Array({
+                "\xC3\xA9\xE2\x98\xBA\xF0\x9F\x98\x80",
+                "\xC3\xA9\xE2\x98\xBA\xF0\x9F\x98\x80",
+            }),
+            decoder->Decode(encoding)
+        );
+    }
+}
+
+TEST(SimdJsonDecoderTests, Decode_Utf8_Straddling_Blocks) {
+    for (const auto& decoder: MakeDecoders()) {
+        for (size_t offset = 50; offset < 70; ++offset) {
+            // Arrange
+            const auto text = std::string(offset, 'x') + "\xF0\x9F\x98\x80";
+            const auto encoding = "\"" + text + "\"";
+            const auto truncatedEncoding = "\"" + text.substr(0, text.length() - 1) + "\"";
+
+            // Act
+            const auto value = decoder->Decode(encoding);
+            const auto truncatedValue = decoder->Decode(truncatedEncoding);
+
+            // Assert
+            EXPECT_EQ(Json::Value(text), value);
+            EXPECT_EQ(Json::Value::Type::Invalid, truncatedValue.GetType());
+        }
+    }
+}
+
+TEST(SimdJsonDecoderTests, Reject_Invalid_Text) {
+    // Arrange
+    const std::vector< std::string > encodings{
+        "",
+        "   ",
+        "{",
+        "}",
+        "[1,]",
+        "[1 2]",
+        "{\"a\" 1}",
+        "{\"a\":1,}",
+        "{1:2}",
+        "{\"a\":1}}",
+        "[\"abc]",
+        "[\"abc\"def]",
+        "\"tab\there\"",
+        "\"bad \\x escape\"",
+        "\"bad \\u12G4 escape\"",
+        "\"\xC3\"",
+        "\"\xC0\xAF\"",
+        "\"\xED\xA0\x80\"",
+        "\"\x80\"",
+        "tru",
+        "truely",
+        "nul",
+        "[01]",
+        "[1.]",
+        "[.5]",
+        "[1e]",
+        "[-]",
+        "[+1]",
+        "[1]x",
+        "[1]\x01",
+        std::string(2000, '['),
+    };
+
+    // Act & Assert
+    for (const auto& decoder: MakeDecoders()) {
+        for (const auto& encoding: encodings) {
+            EXPECT_EQ(
+                Json::Value::Type::Invalid,
+                decoder->Decode(encoding).GetType()
+            ) << encoding;
+        }
+    }
+}
+
+TEST(SimdJsonDecoderTests, Decode_Random_Text_Same_As_From_Encoding) {
+    // Arrange
+    const auto decoders = MakeDecoders();
+    RandomJsonWriter writer(42);
+
+    for (size_t i = 0; i < 500; ++i) {
+        writer.encoding.clear();
+        writer.WriteValue(0);
+        const auto expected = Json::Value::FromEncoding(writer.encoding);
+        ASSERT_NE(Json::Value::Type::Invalid, expected.GetType()) << writer.encoding;
+
+        // Act & Assert
+        for (const auto& decoder: decoders) {
+            EXPECT_EQ(expected, decoder->Decode(writer.encoding)) << writer.encoding;
+        }
+    }
+}
@@ -0,0 +1,515 @@
+/**
+ * @file SocketConnectionsTests.cpp
+ *
+ * This module contains unit tests of the Discord::SocketConnections class,
+ * made against a stand-in server on the loopback interface.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "../../src/WebSocketHandshake.hpp"
+#include "LoopbackServer.hpp"
+
+#include <chrono>
+#include <Discord/SocketConnections.hpp>
+#include <future>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <StringExtensions/StringExtensions.hpp>
+#include <sys/socket.h>
+#include <vector>
+
+namespace {
+
+    /**
+     * Return the path given in the request line of the given request.
+     */
+    std::string GetPath(const std::string& request) {
+        const auto parts = StringExtensions::Split(request.substr(0, request.find('\r')), ' ');
+        return (parts.size() < 2) ? "" : parts[1];
+    }
+
+    /**
+     * Answer every request on the given connection with its own path.
+     */
+    void Echo(int fd) {
+        std::string buffer, request;
+        while (LoopbackServer::ReadRequest(fd, buffer, request)) {
+            LoopbackServer::WriteAll(fd, LoopbackServer::MakeResponse(200, GetPath(request)));
+        }
+    }
+
+}
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct SocketConnectionsTests
+    : public ::testing::Test
+{
+    // Properties
+
+    std::unique_ptr< LoopbackServer > server;
+    std::shared_ptr< Discord::SocketConnections > connections = std::make_shared< Discord::SocketConnections >();
+
+    // Methods
+
+    void Serve(LoopbackServer::Handler handler) {
+        server.reset(new LoopbackServer(handler));
+    }
+
+    template< typename T > static bool IsReady(std::future< T >& future) {
+        return (
+            future.wait_for(std::chrono::seconds(1))
+            == std::future_status::ready
+        );
+    }
+
+    Discord::Connections::ResourceRequestTransaction Get(const std::string& path) {
+        return connections->QueueResourceRequest({"GET", server->GetUri(path)});
+    }
+
+    // ::testing::Test
+
+    virtual void TearDown() override {
+        connections = nullptr;
+        server = nullptr;
+    }
+};
+
+TEST_F(SocketConnectionsTests, Connection_Kept_Alive_And_Reused) {
+    // Arrange
+    Serve([](size_t, int fd){ Echo(fd); });
+
+    // Act
+    auto first = Get("/first");
+    ASSERT_TRUE(IsReady(first.response));
+    auto second = Get("/second");
+    ASSERT_TRUE(IsReady(second.response));
+
+    // Assert
+    const auto firstResponse = first.response.get();
+    EXPECT_EQ(200, firstResponse.status);
+    EXPECT_EQ("/first", firstResponse.body);
+    EXPECT_EQ("/second", second.response.get().body);
+    EXPECT_EQ(1, server->numConnections);
+    const auto statistics = connections->GetStatistics();
+    EXPECT_EQ(1, statistics.connectionsOpened);
+    EXPECT_EQ(1, statistics.connectionsReused);
+}
+
+TEST_F(SocketConnectionsTests, Gets_Pipelined_Once_Connection_Proven) {
+    // Arrange
+    Serve(
+        [](size_t, int fd){
+            std::string buffer, request;
+            if (!LoopbackServer::ReadRequest(fd, buffer, request)) {
+                return;
+            }
+            LoopbackServer::WriteAll(fd, LoopbackServer::MakeResponse(200, GetPath(request)));
+
+            // Only answer the next requests once all of them have
+            // arrived, which can only happen if they're pipelined.
+            std::string responses;
+            for (size_t i = 0; i < 3; ++i) {
+                if (!LoopbackServer::ReadRequest(fd, buffer, request)) {
+                    return;
+                }
+                responses += LoopbackServer::MakeResponse(200, GetPath(request));
+            }
+            LoopbackServer::WriteAll(fd, responses);
+        }
+    );
+    Discord::SocketConnections::Configuration configuration;
+    configuration.maxConnectionsPerHost = 1;
+    connections->Configure(configuration);
+    auto first = Get("/1");
+    ASSERT_TRUE(IsReady(first.response));
+
+    // Act
+    std::vector< Discord::Connections::ResourceRequestTransaction > transactions;
+    for (const auto path: {"/2", "/3", "/4"}) {
+        transactions.push_back(Get(path));
+    }
+
+    // Assert
+    std::vector< std::string > bodies;
+    for (auto& transaction: transactions) {
+        ASSERT_TRUE(IsReady(transaction.response));
+        bodies.push_back(transaction.response.get().body);
+    }
+    EXPECT_EQ(std::vector< std::string >({"/2", "/3", "/4"}), bodies);
+    EXPECT_EQ(1, server->numConnections);
+    EXPECT_EQ(2, connections->GetStatistics().requestsPipelined);
+}
+
+TEST_F(SocketConnectionsTests, Chunked_Response_And_Connection_Close) {
+    // Arrange
+    Serve(
+        [](size_t, int fd){
+            std::string buffer, request;
+            if (!LoopbackServer::ReadRequest(fd, buffer, request)) {
+                return;
+            }
+            LoopbackServer::WriteAll(
+                fd,
+                "HTTP/1.1 200 OK\r\n"
+                "Transfer-Encoding: chunked\r\n"
+                "Connection: close\r\n"
+                "\r\n"
+                "5\r\nHello\r\n"
+                "7\r\n, World\r\n"
+                "0\r\n\r\n"
+            );
+        }
+    );
+
+    // Act
+    auto first = Get("/");
+    ASSERT_TRUE(IsReady(first.response));
+    auto second = Get("/");
+    ASSERT_TRUE(IsReady(second.response));
+
+    // Assert
+    EXPECT_EQ("Hello, World", first.response.get().body);
+    EXPECT_EQ("Hello, World", second.response.get().body);
+    EXPECT_EQ(2, server->numConnections);
+}
+
+TEST_F(SocketConnectionsTests, Get_Made_Again_When_Reused_Connection_Lost) {
+    // Arrange
+    Serve(
+        [](size_t connectionIndex, int fd){
+            if (connectionIndex > 0) {
+                Echo(fd);
+                return;
+            }
+            std::string buffer, request;
+            if (!LoopbackServer::ReadRequest(fd, buffer, request)) {
+                return;
+            }
+            LoopbackServer::WriteAll(fd, LoopbackServer::MakeResponse(200, GetPath(request)));
+            (void)LoopbackServer::ReadRequest(fd, buffer, request);
+        }
+    );
+    auto first = Get("/first");
+    ASSERT_TRUE(IsReady(first.response));
+
+    // Act
+    auto second = Get("/second");
+
+    // Assert
+    ASSERT_TRUE(IsReady(second.response));
+    const auto response = second.response.get();
+    EXPECT_EQ(200, response.status);
+    EXPECT_EQ("/second", response.body);
+    EXPECT_EQ(2, server->numConnections);
+}
+
+TEST_F(SocketConnectionsTests, Canceled_Request_Answered_Immediately) {
+    // Arrange
+    Serve(
+        [](size_t, int fd){
+            std::string buffer, request;
+            while (LoopbackServer::ReadRequest(fd, buffer, request)) {
+            }
+        }
+    );
+    auto transaction = Get("/never");
+
+    // Act
+    transaction.cancel();
+
+    // Assert
+    ASSERT_TRUE(IsReady(transaction.response));
+    EXPECT_EQ(499, transaction.response.get().status);
+}
+
+TEST_F(SocketConnectionsTests, Delegate_Given_Response_And_May_Make_Another_Request) {
+    // Arrange
+    Serve([](size_t, int fd){ Echo(fd); });
+    std::promise< std::string > secondBody;
+    auto secondBodyFuture = secondBody.get_future();
+    const auto connections = this->connections;
+    const auto secondUri = server->GetUri("/second");
+
+    // Act
+    (void)connections->QueueResourceRequest(
+        {"GET", server->GetUri("/first")},
+        [connections, secondUri, &secondBody](Discord::Connections::Response&& response){
+            EXPECT_EQ("/first", response.body);
+            (void)connections->QueueResourceRequest(
+                {"GET", secondUri},
+                [&secondBody](Discord::Connections::Response&& response){
+                    secondBody.set_value(response.body);
+                }
+            );
+        }
+    );
+
+    // Assert
+    ASSERT_TRUE(IsReady(secondBodyFuture));
+    EXPECT_EQ("/second", secondBodyFuture.get());
+}
+
+TEST_F(SocketConnectionsTests, Canceled_Request_Given_To_Delegate_Immediately) {
+    // Arrange
+    Serve(
+        [](size_t, int fd){
+            std::string buffer, request;
+            while (LoopbackServer::ReadRequest(fd, buffer, request)) {
+            }
+        }
+    );
+    std::promise< unsigned int > status;
+    auto statusFuture = status.get_future();
+    const auto cancel = connections->QueueResourceRequest(
+        {"GET", server->GetUri("/never")},
+        [&status](Discord::Connections::Response&& response){
+            status.set_value(response.status);
+        }
+    );
+
+    // Act
+    cancel();
+
+    // Assert
+    ASSERT_TRUE(IsReady(statusFuture));
+    EXPECT_EQ(499, statusFuture.get());
+}
+
+TEST_F(SocketConnectionsTests, Unsupported_Scheme_Refused) {
+    // Act
+    auto transaction = connections->QueueResourceRequest({"GET", "https://discord.com/api/v6/gateway"});
+
+    // Assert
+    ASSERT_TRUE(IsReady(transaction.response));
+    EXPECT_EQ(502, transaction.response.get().status);
+}
+
+TEST_F(SocketConnectionsTests, Request_To_Unknown_Host_Fails_Without_Holding_Up_Others) {
+    // Arrange
+    Serve([](size_t, int fd){ Echo(fd); });
+
+    // Act
+    auto unknown = connections->QueueResourceRequest({"GET", "http://unknown-host.invalid/"});
+    auto known = Get("/known");
+
+    // Assert
+    ASSERT_TRUE(IsReady(known.response));
+    EXPECT_EQ("/known", known.response.get().body);
+    ASSERT_TRUE(
+        unknown.response.wait_for(std::chrono::seconds(30))
+        == std::future_status::ready
+    );
+    EXPECT_EQ(502, unknown.response.get().status);
+}
+
+TEST_F(SocketConnectionsTests, WebSocket_Opened_And_Messages_Exchanged) {
+    // Arrange
+    std::promise< std::string > serverReceived;
+    Serve(
+        [&](size_t, int fd){
+            std::string buffer, request;
+            if (!LoopbackServer::ReadRequest(fd, buffer, request)) {
+                return;
+            }
+            const auto key = LoopbackServer::GetHeader(request, "Sec-WebSocket-Key");
+            LoopbackServer::WriteAll(
+                fd,
+                "HTTP/1.1 101 Switching Protocols\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                "Sec-WebSocket-Accept: " + Discord::WebSocketHandshake::ComputeAccept(key) + "\r\n"
+                "\r\n"
+                + Discord::WebSocketHandshake::EncodeFrame(
+                    Discord::WebSocketHandshake::Opcode::Text,
+                    "Hello",
+                    false
+                )
+            );
+            Discord::WebSocketHandshake::Frame frame;
+            size_t offset = 0;
+            while (
+                Discord::WebSocketHandshake::DecodeFrame(buffer, offset, frame)
+                != Discord::WebSocketHandshake::DecodeResult::Complete
+            ) {
+                char chunk[4096];
+                const auto amountReceived = recv(fd, chunk, sizeof(chunk), 0);
+                if (amountReceived <= 0) {
+                    return;
+                }
+                buffer.append(chunk, (size_t)amountReceived);
+            }
+            serverReceived.set_value(frame.payload);
+            LoopbackServer::WriteAll(
+                fd,
+                Discord::WebSocketHandshake::EncodeFrame(
+                    Discord::WebSocketHandshake::Opcode::Close,
+                    std::string("\x03\xe8", 2),
+                    false
+                )
+            );
+            (void)LoopbackServer::ReadRequest(fd, buffer, request);
+        }
+    );
+    auto transaction = connections->QueueWebSocketRequest({server->GetUri("/gateway", "ws")});
+    ASSERT_TRUE(IsReady(transaction.webSocket));
+    const auto webSocket = transaction.webSocket.get();
+    ASSERT_FALSE(webSocket == nullptr);
+    std::promise< std::string > clientReceived;
+    std::promise< void > closed;
+    webSocket->RegisterCloseCallback([&]{ closed.set_value(); });
+    webSocket->RegisterTextCallback(
+        [&](std::string&& message){
+            clientReceived.set_value(message);
+        }
+    );
+
+    // Act
+    webSocket->Text("World");
+
+    // Assert
+    auto clientReceivedFuture = clientReceived.get_future();
+    ASSERT_TRUE(IsReady(clientReceivedFuture));
+    EXPECT_EQ("Hello", clientReceivedFuture.get());
+    auto serverReceivedFuture = serverReceived.get_future();
+    ASSERT_TRUE(IsReady(serverReceivedFuture));
+    EXPECT_EQ("World", serverReceivedFuture.get());
+    auto closedFuture = closed.get_future();
+    EXPECT_TRUE(IsReady(closedFuture));
+}
+
+TEST_F(SocketConnectionsTests, Close_Callback_Called_Once_Server_Answers_Our_Close) {
+    // Arrange
+    Serve(
+        [&](size_t, int fd){
+            std::string buffer, request;
+            if (!LoopbackServer::ReadRequest(fd, buffer, request)) {
+                return;
+            }
+            const auto key = LoopbackServer::GetHeader(request, "Sec-WebSocket-Key");
+            LoopbackServer::WriteAll(
+                fd,
+                "HTTP/1.1 101 Switching Protocols\r\n"
+                "Upgrade: websocket\r\n"
+                "Connection: Upgrade\r\n"
+                "Sec-WebSocket-Accept: " + Discord::WebSocketHandshake::ComputeAccept(key) + "\r\n"
+                "\r\n"
+            );
+            Discord::WebSocketHandshake::Frame frame;
+            size_t offset = 0;
+            while (
+                Discord::WebSocketHandshake::DecodeFrame(buffer, offset, frame)
+                != Discord::WebSocketHandshake::DecodeResult::Complete
+            ) {
+                char chunk[4096];
+                const auto amountReceived = recv(fd, chunk, sizeof(chunk), 0);
+                if (amountReceived <= 0) {
+                    return;
+                }
+                buffer.append(chunk, (size_t)amountReceived);
+            }
+            LoopbackServer::WriteAll(
+                fd,
+                Discord::WebSocketHandshake::EncodeFrame(
+                    Discord::WebSocketHandshake::Opcode::Close,
+                    frame.payload,
+                    false
+                )
+            );
+            (void)LoopbackServer::ReadRequest(fd, buffer, request);
+        }
+    );
+    auto transaction = connections->QueueWebSocketRequest({server->GetUri("/gateway", "ws")});
+    ASSERT_TRUE(IsReady(transaction.webSocket));
+    const auto webSocket = transaction.webSocket.get();
+    ASSERT_FALSE(webSocket == nullptr);
+    std::promise< void > closed;
+    webSocket->RegisterCloseCallback([&]{ closed.set_value(); });
+
+    // Act
+    webSocket->Close(1000);
+
+    // Assert
+    auto closedFuture = closed.get_future();
+    EXPECT_TRUE(IsReady(closedFuture));
+}
+
+TEST_F(SocketConnectionsTests, WebSocket_Failed_When_Server_Breaks_Protocol) {
+    // Arrange
+    const std::vector< std::pair< std::string, std::string > > cases{
+        // Reserved opcode
+        {std::string("\x83\x00", 2), std::string("\x03\xea", 2)},
+
+        // Reserved bit set
+        {std::string("\xc1\x00", 2), std::string("\x03\xea", 2)},
+
+        // Fragmented control frame
+        {std::string("\x09\x00", 2), std::string("\x03\xea", 2)},
+
+        // Continuation without a message to continue
+        {std::string("\x80\x00", 2), std::string("\x03\xea", 2)},
+
+        // Frame longer than any accepted
+        {std::string("\x81\x7f\x00\x00\x00\x00\x04\x00\x00\x01", 10), std::string("\x03\xf1", 2)},
+    };
+    for (const auto& testCase: cases) {
+        std::promise< std::string > closeSent;
+        Serve(
+            [&](size_t, int fd){
+                std::string buffer, request;
+                if (!LoopbackServer::ReadRequest(fd, buffer, request)) {
+                    return;
+                }
+                const auto key = LoopbackServer::GetHeader(request, "Sec-WebSocket-Key");
+                LoopbackServer::WriteAll(
+                    fd,
+                    "HTTP/1.1 101 Switching Protocols\r\n"
+                    "Upgrade: websocket\r\n"
+                    "Connection: Upgrade\r\n"
+                    "Sec-WebSocket-Accept: " + Discord::WebSocketHandshake::ComputeAccept(key) + "\r\n"
+                    "\r\n"
+                    + testCase.first
+                );
+                Discord::WebSocketHandshake::Frame frame;
+                size_t offset = 0;
+                while (
+                    Discord::WebSocketHandshake::DecodeFrame(buffer, offset, frame)
+                    != Discord::WebSocketHandshake::DecodeResult::Complete
+                ) {
+                    char chunk[4096];
+                    const auto amountReceived = recv(fd, chunk, sizeof(chunk), 0);
+                    if (amountReceived <= 0) {
+                        return;
+                    }
+                    buffer.append(chunk, (size_t)amountReceived);
+                }
+                closeSent.set_value(
+                    (frame.opcode == Discord::WebSocketHandshake::Opcode::Close)
+                    ? frame.payload
+                    : ""
+                );
+                (void)LoopbackServer::ReadRequest(fd, buffer, request);
+            }
+        );
+        auto transaction = connections->QueueWebSocketRequest({server->GetUri("/gateway", "ws")});
+        ASSERT_TRUE(IsReady(transaction.webSocket));
+        const auto webSocket = transaction.webSocket.get();
+        ASSERT_FALSE(webSocket == nullptr);
+        std::promise< void > closed;
+        webSocket->RegisterCloseCallback([&]{ closed.set_value(); });
+
+        // Act
+        auto closeSentFuture = closeSent.get_future();
+        auto closedFuture = closed.get_future();
+
+        // Assert
+        ASSERT_TRUE(IsReady(closeSentFuture));
+        EXPECT_EQ(testCase.second, closeSentFuture.get());
+        EXPECT_TRUE(IsReady(closedFuture));
+        server = nullptr;
+    }
+}
@@ -0,0 +1,161 @@
+/**
+ * @file TimerWheelTests.cpp
+ *
+ * This module contains unit tests of the Discord::TimerWheel class.
+ *
+ * © 2020 by Richard Walters
+ */
+
+#include "Common.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <Discord/TimerWheel.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * This is the test fixture for these tests, providing common
+ * setup and teardown for each test.
+ */
+struct TimerWheelTests
+    : public ::testing::Test
+{
+    // Properties
+
+    std::shared_ptr< MockClock > clock = std::make_shared< MockClock >();
+    std::condition_variable callsMadeCondition;
+    std::vector< int > callsMade;
+    std::mutex mutex;
+    Discord::TimerWheel timerWheel;
+
+    // Methods
+
+    bool AwaitCalls(size_t numCalls) {
+        std::unique_lock< decltype(mutex) > lock(mutex);
+        return callsMadeCondition.wait_for(
+            lock,
+            std::chrono::milliseconds(200),
+            [&]{ return callsMade.size() >= numCalls; }
+        );
+    }
+
+    void AdvanceTo(double time) {
+        clock->currentTime = time;
+        timerWheel.WakeUp();
+    }
+
+    Discord::TimerWheel::Callback MakeCall(int id) {
+        return [this, id]{
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            callsMade.push_back(id);
+            callsMadeCondition.notify_all();
+        };
+    }
+
+    // ::testing::Test
+
+    virtual void SetUp() override {
+        timerWheel.SetClock(clock);
+    }
+};
+
+TEST_F(TimerWheelTests, Call_Made_Once_Due) {
+    // Arrange
+    (void)timerWheel.Schedule(MakeCall(1), 45.0);
+
+    // Act
+    AdvanceTo(44.999);
+    const auto calledBeforeDue = AwaitCalls(1);
+    AdvanceTo(45.0);
+    const auto calledWhenDue = AwaitCalls(1);
+
+    // Assert
+    EXPECT_FALSE(calledBeforeDue);
+    EXPECT_TRUE(calledWhenDue);
+    EXPECT_EQ(std::vector< int >({1}), callsMade);
+}
+
+TEST_F(TimerWheelTests, Call_Not_Made_Once_Canceled) {
+    // Arrange
+    const auto token = timerWheel.Schedule(MakeCall(1), 45.0);
+    (void)timerWheel.Schedule(MakeCall(2), 45.0);
+
+    // Act
+    timerWheel.Cancel(token);
+    AdvanceTo(50.0);
+
+    // Assert
+    EXPECT_TRUE(AwaitCalls(1));
+    EXPECT_EQ(std::vector< int >({2}), callsMade);
+}
+
+TEST_F(TimerWheelTests, Call_Already_Due_Made_Promptly) {
+    // Arrange
+    AdvanceTo(10.0);
+
+    // Act
+    (void)timerWheel.Schedule(MakeCall(1), 5.0);
+
+    // Assert
+    EXPECT_TRUE(AwaitCalls(1));
+}
+
+TEST_F(TimerWheelTests, Calls_At_Every_Level_Made_In_Order) {
+    // Arrange
+    const std::vector< double > dueTimes = {
+        0.5,            // a few ticks
+        100.0,          // second level
+        1000.0,         // third level
+        200000.0,       // fourth level
+        50000000.0,     // beyond the wheel
+    };
+    for (size_t i = dueTimes.size(); i > 0; --i) {
+        (void)timerWheel.Schedule(MakeCall((int)i), dueTimes[i - 1]);
+    }
+
+    // Act
+    std::vector< bool > calledEarly;
+    for (size_t i = 0; i < dueTimes.size(); ++i) {
+        AdvanceTo(dueTimes[i] - 0.1);
+        calledEarly.push_back(AwaitCalls(i + 1));
+        AdvanceTo(dueTimes[i]);
+        ASSERT_TRUE(AwaitCalls(i + 1)) << i;
+    }
+
+    // Assert
+    EXPECT_EQ(std::vector< bool >(dueTimes.size(), false), calledEarly);
+    EXPECT_EQ(std::vector< int >({1, 2, 3, 4, 5}), callsMade);
+}
+
+TEST_F(TimerWheelTests, Wheel_Without_Thread_Only_Calls_When_Advanced) {
+    // Arrange
+    Discord::TimerWheel manualWheel(0.01, false);
+    manualWheel.SetClock(clock);
+    std::vector< double > callTimes;
+    for (const auto due: {0.05, 0.2}) {
+        (void)manualWheel.Schedule(
+            [&]{ callTimes.push_back(clock->currentTime); },
+            due
+        );
+    }
+
+    // Act
+    clock->currentTime = 1.0;
+    manualWheel.WakeUp();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    const auto callsBeforeAdvance = callTimes.size();
+    for (int tick = 0; tick <= 20; ++tick) {
+        clock->currentTime = 0.01 * tick;
+        manualWheel.Advance();
+    }
+
+    // Assert
+    EXPECT_EQ(0, callsBeforeAdvance);
+    ASSERT_EQ(2, callTimes.size());
+    EXPECT_NEAR(0.05, callTimes[0], 0.000001);
+    EXPECT_NEAR(0.2, callTimes[1], 0.000001);
+}